@@ -0,0 +1,48 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// required filesystem layout, checked once per boot
+// every directory must be listed before anything inside it
+
+#define BOOT_FS_DIR   1
+#define BOOT_FS_FILE  0
+
+typedef struct {
+    const char *path;
+    uint8_t is_dir;
+    const char *content;        // initial file content (NULL = empty)
+    const char *only_if_empty;  // only provisioned if this dir was empty at boot (NULL = always)
+} boot_fs_entry_t;
+
+// storage primitives, called with the bus already held for the whole pass
+typedef struct {
+    // calls found() once per child of path, returns 0 or -1 if path isn't a directory
+    int (*list_dir)(const char *path, void (*found)(const char *name, int is_dir, void *ctx), void *ctx);
+    int (*make_dir)(const char *path);
+    int (*make_file)(const char *path, const char *content);
+} boot_fs_io_t;
+
+typedef struct {
+    uint16_t dirs_scanned;
+    uint16_t created;
+    uint16_t present;
+    uint16_t skipped;
+    uint16_t failed;
+} boot_fs_report_t;
+
+extern const boot_fs_entry_t boot_fs_manifest[];
+extern const size_t boot_fs_manifest_count;
+
+// scans each parent directory once and creates only what is missing
+// returns 0 if everything is in place, -1 if anything could not be created
+int boot_fs_provision(const boot_fs_entry_t *manifest, size_t count,
+                      const boot_fs_io_t *io, boot_fs_report_t *report);
+
+#ifdef __cplusplus
+}
+#endif
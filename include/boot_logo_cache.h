@@ -0,0 +1,69 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// boot logo cache, a copy of the logo already scaled to the panel
+// stored next to the source as <logo>.cache so later boots just stream it
+//
+// file layout: 20 byte header (little endian) then RLE pixel data
+//   magic u32, version u16, encoding u16, width u16, height u16,
+//   source_key u32, payload_size u32
+
+#define BOOT_LOGO_CACHE_SUFFIX ".cache"
+#define BOOT_LOGO_CACHE_MAGIC 0x43584C54u  // "TLXC"
+#define BOOT_LOGO_CACHE_VERSION 1
+#define BOOT_LOGO_CACHE_HEADER_SIZE 20
+#define BOOT_LOGO_ENC_RLE 1
+
+// RLE records: u16 header, top bit set = run of (low 15 bits + 1) copies of the next pixel,
+// clear = (low 15 bits + 1) literal pixels follow
+#define BOOT_LOGO_RLE_MAX_RECORD 32768
+#define BOOT_LOGO_RLE_BOUND(pixels) ((pixels) * 2 + (((pixels) / BOOT_LOGO_RLE_MAX_RECORD) + 1) * 2)
+
+#define BOOT_LOGO_HASH_INIT 2166136261u
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t encoding;
+    uint16_t width;
+    uint16_t height;
+    uint32_t source_key;    // hash of the source it was built from
+    uint32_t payload_size;
+} boot_logo_cache_header_t;
+
+// streaming decoder state, records may be split anywhere across input chunks
+typedef struct {
+    uint8_t state;
+    uint8_t partial_len;
+    uint8_t partial[2];
+    uint16_t run_pixel;
+    uint32_t remaining;
+} boot_logo_rle_t;
+
+void boot_logo_cache_header_pack(const boot_logo_cache_header_t *hdr, uint8_t out[BOOT_LOGO_CACHE_HEADER_SIZE]);
+// returns 1 if the bytes are a usable header for this build, 0 otherwise
+int boot_logo_cache_header_unpack(const uint8_t in[BOOT_LOGO_CACHE_HEADER_SIZE], boot_logo_cache_header_t *hdr);
+int boot_logo_cache_path(const char *source_path, char *out, size_t out_len);
+
+// FNV-1a, feed it whatever identifies the source (size, mtime, sampled bytes)
+uint32_t boot_logo_hash(uint32_t hash, const void *data, size_t len);
+
+// nearest neighbour, src_row is little endian RGB565 bytes
+void boot_logo_scale_row(const uint8_t *src_row, uint16_t src_w, uint16_t *dst, uint16_t dst_w);
+
+// returns bytes written, 0 if out_cap is too small (BOOT_LOGO_RLE_BOUND is always enough)
+size_t boot_logo_rle_encode(const uint16_t *pixels, size_t count, uint8_t *out, size_t out_cap);
+
+void boot_logo_rle_init(boot_logo_rle_t *dec);
+// decodes until out is full or the input runs out, returns pixels written
+size_t boot_logo_rle_decode(boot_logo_rle_t *dec, const uint8_t *in, size_t in_len, size_t *in_used,
+                            uint16_t *out, size_t out_cap);
+
+#ifdef __cplusplus
+}
+#endif
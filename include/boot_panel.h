@@ -0,0 +1,74 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// double buffered panel transfers
+// the CPU composes into one tile buffer while the other one is going out to the panel,
+// every submitted tile gets a fence value and the transmit side reports the last fence it finished
+// the overlap is only real if sending doesn't need the composing CPU: on the ESP32 the transmit
+// side (boot_splash.cpp) queues each tile as one SPI DMA transaction and sleeps until it's done;
+// if it has to fall back to polled writes, composing only overlaps for callers on the other core
+
+#define panel_tile_count 2
+#define panel_tile_pixels 4800  // 10 lines of a 480 wide panel, 9.6KB per buffer
+
+typedef struct {
+    int16_t x;
+    int16_t y;
+    int16_t w;
+    int16_t h;
+    uint16_t *pixels;  // w * h, row major
+    uint32_t fence;    // done once the pipe's completed fence reaches this
+} panel_tile_t;
+
+typedef struct {
+    // hand a filled tile to the transmit side, must not wait for the transfer itself
+    void (*start)(void *ctx, panel_tile_t *tile);
+    // block until the transmit side finishes at least one more tile
+    void (*wait)(void *ctx);
+    void *ctx;
+} panel_ops_t;
+
+typedef struct {
+    panel_tile_t tiles[panel_tile_count];
+    uint8_t next;                 // tile the CPU composes into next
+    uint32_t submitted;           // last fence handed out
+    volatile uint32_t completed;  // last fence the transmit side finished, only it writes this
+    int16_t width;                // panel size, everything drawn is clipped to it
+    int16_t height;
+    uint32_t stalls;              // times a tile wasn't free yet and the CPU had to wait
+    panel_ops_t ops;
+} panel_pipe_t;
+
+// returns 0 on success, -1 on bad args or no memory (internal RAM on ESP32, the bus reads it)
+int panel_pipe_init(panel_pipe_t *pipe, const panel_ops_t *ops, int16_t width, int16_t height);
+// drains whatever is still in flight before freeing the tiles
+void panel_pipe_free(panel_pipe_t *pipe);
+
+// next free tile to compose into, waits on its fence if it's still being sent
+panel_tile_t *panel_pipe_acquire(panel_pipe_t *pipe);
+// queues the composed tile, returns its fence
+uint32_t panel_pipe_submit(panel_pipe_t *pipe, panel_tile_t *tile,
+                           int16_t x, int16_t y, int16_t w, int16_t h);
+// called by the transmit side once a tile is fully on the panel
+void panel_pipe_complete(panel_pipe_t *pipe, uint32_t fence);
+
+int panel_pipe_done(const panel_pipe_t *pipe, uint32_t fence);
+void panel_pipe_wait(panel_pipe_t *pipe, uint32_t fence);
+// everything submitted so far is on the panel, call before anything else touches the bus
+void panel_pipe_sync(panel_pipe_t *pipe);
+
+// copy a block into tiles and queue them, data can be reused as soon as this returns
+// returns the fence of the last tile, 0 if nothing was visible
+uint32_t panel_pipe_draw(panel_pipe_t *pipe, int16_t x, int16_t y, const uint16_t *data,
+                         int16_t w, int16_t h);
+uint32_t panel_pipe_fill(panel_pipe_t *pipe, int16_t x, int16_t y, int16_t w, int16_t h,
+                         uint16_t color);
+
+#ifdef __cplusplus
+}
+#endif
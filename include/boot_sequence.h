@@ -52,6 +52,12 @@ int boot_sd_ensure_file(const char *path, const char *content);
 int boot_sd_get_username(char *out_name, size_t out_len);
 int boot_sd_find_bootlogo(const char *username, char *out_path, size_t out_len);
 
+// raw SD primitives for boot_fs_provision, these never switch SPI
+// so the caller has to hold the SD bus (boot_sd_switch_to_sd_spi) for the whole pass
+int boot_sd_list_dir(const char *path, void (*found)(const char *name, int is_dir, void *ctx), void *ctx);
+int boot_sd_make_dir(const char *path);
+int boot_sd_make_file(const char *path, const char *content);
+
 // boot completion status
 int boot_is_complete(void);
 
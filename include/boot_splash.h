@@ -20,6 +20,11 @@ int boot_draw_rgb565_scaled(const char *path, int16_t x, int16_t y,
                             int16_t width, int16_t height);
 void boot_tft_draw_rgb565(int16_t x, int16_t y, const uint16_t *data,
                           int16_t width, int16_t height);
+// waits until every queued panel transfer is out, before anything else uses the SPI bus
+void boot_tft_sync(void);
+// exclusive use of the panel / SPI bus across tasks, recursive
+void boot_tft_lock(void);
+void boot_tft_unlock(void);
 
 #ifdef __cplusplus
 }
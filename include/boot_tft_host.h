@@ -0,0 +1,41 @@
+#pragma once
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// host side panel emulator
+// the boot_tft_* calls from boot_splash.cpp, backed by an RGB565 framebuffer in memory,
+// so the renderer runs in make test and its cost can be measured in pixels and calls
+
+#define boot_tft_host_width 480   // same landscape panel as the device
+#define boot_tft_host_height 320
+
+// traffic since the last boot_tft_host_take_stats()
+typedef struct {
+    uint32_t pixels;     // pixels written, clipped to the panel
+    uint32_t fills;      // solid rects (fill_screen, fill_rect, each side of draw_rect)
+    uint32_t transfers;  // bulk pixel blocks (draw_rgb565)
+    uint32_t texts;      // print calls, the slow path without a glyph atlas
+    uint32_t commands;   // other panel commands (scrolling)
+} boot_tft_stats_t;
+
+// returns 0 on success, -1 on bad size or no memory
+// until this is called nothing is drawn and a flush on the host renders nothing
+int boot_tft_host_init(int16_t width, int16_t height);
+void boot_tft_host_free(void);
+int boot_tft_host_active(void);
+
+const uint16_t *boot_tft_host_pixels(void);
+uint16_t boot_tft_host_pixel(int16_t x, int16_t y);
+void boot_tft_host_take_stats(boot_tft_stats_t *out);  // copies and zeroes the counters
+
+// FNV-1a of the framebuffer, golden frames are compared by this
+uint32_t boot_tft_host_hash(void);
+// binary PPM (P6), returns 0 on success
+int boot_tft_host_dump_ppm(const char *path);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,55 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// boot profiler, every boot_step() and a few sub operations get a timestamp
+// written to BOOT_TRACE_PATH once boot is done, `bootchart` draws it
+
+#define BOOT_TRACE_PATH "/var/log/boot.trace"
+#define BOOT_TRACE_MAX 48
+#define BOOT_TRACE_NAME_LEN 28
+
+typedef struct {
+    char name[BOOT_TRACE_NAME_LEN];
+    uint32_t start_ms;      // since power on (ESP32) or first trace call (PC)
+    uint32_t duration_ms;   // total across all hits for counted entries
+    uint16_t count;         // how many times boot_trace_add() hit this name
+    uint8_t depth;          // 0 = boot step, 1+ = sub operation
+    uint8_t open;
+} boot_trace_entry_t;
+
+void boot_trace_reset(void);
+uint32_t boot_trace_now(void);
+
+// nested spans, returns a slot for boot_trace_end() (-1 if the trace is full or stopped)
+int boot_trace_begin(const char *name);
+void boot_trace_end(int slot);
+
+// repeated short operations (SPI switches...), summed into one entry per name
+void boot_trace_add(const char *name, uint32_t start_ms, uint32_t duration_ms);
+
+// readiness polling instead of blind delays, polls ready(ctx) every poll_ms
+// until it returns non-zero or timeout_ms runs out, traced under name either way
+// returns 0 when ready, -1 on timeout
+int boot_wait_until(const char *name, int (*ready)(void *ctx), void *ctx,
+                    uint32_t timeout_ms, uint32_t poll_ms);
+
+// stop recording, anything after boot isn't part of the trace
+void boot_trace_stop(void);
+int boot_trace_active(void);
+
+size_t boot_trace_count(void);
+const boot_trace_entry_t* boot_trace_get(size_t index);
+
+// persisted form is one entry per line: start duration depth count name
+size_t boot_trace_format(char *out, size_t out_len);
+int boot_trace_save(const char *path);
+int boot_trace_load(const char *path, boot_trace_entry_t *out, size_t max_entries);
+
+#ifdef __cplusplus
+}
+#endif
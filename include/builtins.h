@@ -8,15 +8,30 @@ extern "C" {
 
 typedef int (*builtin_handler)(terminal_state *term, int argc, char **argv);
 
+// a command that can take its input piece by piece after a '|', without the input being held whole
+// open returns SHELL_OK to stream, SHELL_ENOTSUP if these arguments don't read the input
+// (the input is dropped and the handler runs without it), anything else fails the stage
+typedef struct {
+    size_t state_size;  // zeroed for open, freed after close
+    int (*open)(terminal_state *term, void *state, int argc, char **argv);
+    int (*feed)(terminal_state *term, void *state, const char *buf, size_t len);
+    int (*close)(terminal_state *term, void *state);
+} builtin_filter;
+
 typedef struct {
     const char *name;
     builtin_handler handler;
     const char *help;
+    const builtin_filter *filter;  // NULL if the command can't take its input piece by piece
+    uint8_t reads_input;  // the handler reads term->pipe_input, the input is kept whole for it
+                          // when it can't stream; after a '|' every other command's input is dropped
 } builtin_cmd;
 
 void builtins_register(const char *name, builtin_handler handler, const char *help);
 void builtins_register_descriptor(const builtin_cmd *cmd);
 builtin_cmd *builtins_find(const char *name);
+int builtins_count(void);
+const builtin_cmd *builtins_at(int index);  // in registration order, NULL past the end
 void builtins_init(void);
 
 #ifdef __cplusplus
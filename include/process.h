@@ -49,8 +49,10 @@ typedef struct {
     uint32_t runtime;                    // runtime in ticks/ms
     uint8_t active;                      // is this PCB slot in use
     vfs_node_t *cwd;                     // current working directory
+    uint8_t initialized;                 // set by process_signal_ready()
 #ifdef PLATFORM_ESP32
     TaskHandle_t task_handle;            // FreeRTOS task handle (ESP32 only)
+    TaskHandle_t ready_waiter;           // task blocked in process_wait_ready()
 #endif
 } process_control_block_t;
 
@@ -65,6 +67,12 @@ void process_set_state(process_id_t pid, process_state_t state);
 process_state_t process_get_state(process_id_t pid);
 process_control_block_t *process_get_pcb(process_id_t pid);
 
+// startup handshake, a process calls process_signal_ready() once its own setup is done
+// process_wait_ready() blocks (task notification on ESP32) until then or timeout
+// returns 0 if the process signalled, -1 on timeout or if it went away
+void process_signal_ready(process_id_t pid);
+int process_wait_ready(process_id_t pid, uint32_t timeout_ms);
+
 // process registry functions
 void init_process_system(void);
 uint8_t get_process_count(void);
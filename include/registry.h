@@ -0,0 +1,45 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// one hashed table for everything that gets looked up by name or key:
+// shell builtins, actions, script handlers and hotkeys
+// there is no cap, the table grows while entries are added, a name added again to the same kind
+// replaces the record and keeps its place in the registration order
+
+typedef enum {
+    registry_builtin,
+    registry_action,
+    registry_script,
+    registry_hotkey,
+    registry_kind_count
+} registry_kind;
+
+#define registry_flag_streams (1 << 0)  // builtin with a filter, reads a pipe piece by piece
+
+typedef struct {
+    uint8_t kind;
+    uint32_t hash;
+    const char *name;      // kept by pointer, NULL for entries keyed by number
+    uint32_t id;
+    const char *help;
+    const char *category;  // the kind's name unless the caller sets another one
+    uint32_t flags;
+    void *item;            // copy of the kind's record, stays put until the kind is reset
+} registry_entry;
+
+registry_entry *registry_add(registry_kind kind, const char *name, const void *item, size_t size);
+registry_entry *registry_add_id(registry_kind kind, uint32_t id, const void *item, size_t size);
+registry_entry *registry_find(registry_kind kind, const char *name);
+registry_entry *registry_find_id(registry_kind kind, uint32_t id);
+uint32_t registry_count(registry_kind kind);
+registry_entry *registry_at(registry_kind kind, uint32_t index);  // in registration order
+void registry_reset(registry_kind kind);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,75 @@
+#pragma once
+
+// host side SD card emulator
+// stores the filesystem in a FAT16/FAT32 disk image and charges every bus
+// access against a latency model, so vfs work can be measured on a PC with
+// roughly the same I/O pattern the ESP32 + SD library produces
+//
+// the file api below mirrors the subset of SD.h that vfs_sd.cpp uses, the
+// vfs_sdemu.c backend is a C port of vfs_sd.cpp sitting on top of it
+
+#include <sys/types.h>  // ssize_t
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// latency model, all values in microseconds
+typedef struct {
+    uint32_t spi_switch_us;     // one boot_sd_switch_to_sd_spi() or boot_sd_restore_tft_spi()
+    uint32_t command_us;        // per SD command (CMD17/CMD24 framing + response wait)
+    uint32_t sector_read_us;    // one 512 byte block in
+    uint32_t sector_write_us;   // one 512 byte block out incl. card busy time
+} sdemu_latency_t;
+
+// counters since the last sdemu_stats_reset()
+typedef struct {
+    uint32_t spi_switches;
+    uint32_t commands;
+    uint32_t sectors_read;
+    uint32_t sectors_written;
+    uint32_t cache_hits;        // sector accesses served from the driver cache
+    uint64_t sim_us;            // simulated bus time
+} sdemu_stats_t;
+
+typedef struct sdemu_file sdemu_file_t;
+
+// image management
+// sdemu_format picks FAT16 below 64MB and FAT32 above, sectors are 512 bytes
+int sdemu_format(const char *image_path, uint32_t sectors);
+int sdemu_attach(const char *image_path);
+void sdemu_detach(void);
+int sdemu_is_attached(void);
+
+// latency model + stats
+void sdemu_set_latency(const sdemu_latency_t *model);
+void sdemu_get_latency(sdemu_latency_t *out);
+void sdemu_stats_reset(void);
+void sdemu_stats_get(sdemu_stats_t *out);
+uint32_t sdemu_stats_ms(const sdemu_stats_t *stats);
+
+// SD.h style api, paths are absolute, names compare case insensitive like FAT
+// returns VFS_* codes unless noted
+int sdemu_exists(const char *path);        // 1 or 0
+int sdemu_mkdir(const char *path);
+int sdemu_rmdir(const char *path);
+int sdemu_remove(const char *path);
+int sdemu_rename(const char *from, const char *to);
+sdemu_file_t* sdemu_open(const char *path, int write, int create);
+void sdemu_close(sdemu_file_t *file);
+int sdemu_is_directory(sdemu_file_t *file);
+ssize_t sdemu_read(sdemu_file_t *file, void *buf, size_t size);
+ssize_t sdemu_write(sdemu_file_t *file, const void *buf, size_t size);
+int sdemu_flush(sdemu_file_t *file);
+int sdemu_seek(sdemu_file_t *file, size_t pos);
+size_t sdemu_position(sdemu_file_t *file);
+size_t sdemu_size(sdemu_file_t *file);
+
+// directory handles only, returns 1 with an entry, 0 at the end, < 0 on error
+int sdemu_next_entry(sdemu_file_t *dir, char *name, size_t name_len, int *is_dir);
+
+#ifdef __cplusplus
+}
+#endif
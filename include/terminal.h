@@ -1,6 +1,7 @@
 #pragma once
 #include <stdint.h>
-#include "terminal_cmd.h"
+#include <stdio.h>
+#include <string.h>
 #include "debug_helper.h"
 #include "keyboard_core.h"
 #include "vfs.h"
@@ -11,11 +12,14 @@ extern "C" {
 
 // terminal char dimensions
 #define max_windows 8
-#define terminal_rows 60
+#define terminal_rows 60  // largest grid, a window's own grid fits its cell area at the current zoom
 #define terminal_cols 80
 #define terminal_buffer_size (terminal_rows * terminal_cols)
-#define max_input_history 16
-#define max_pipe_commands 8
+#define terminal_scrollback_rows 500  // rows kept per window after they scroll off the grid
+#define terminal_history_size 2048  // shared command history, a power of two
+#define max_pipe_commands 8  // stages in one pipeline
+#define terminal_pipe_buffer_size 512  // input buffered per pipeline stage before it runs on it
+#define terminal_redirect_buffer_size 2048  // output to a > file goes out in writes this big
 
 // pipe structure for command chaining
 typedef struct {
@@ -34,6 +38,15 @@ typedef struct {
     uint8_t token_count;
     uint8_t has_pipe;  // 1 if command contains pipe
     uint8_t pipe_pos;  // position of pipe in tokens
+    uint8_t pipe_count;  // pipes seen, may be more than fit in pipe_positions
+    uint8_t pipe_positions[max_pipe_commands - 1];  // token each stage after the first starts at
+    // redirections, for the whole line (< into the first stage, > and 2> out of the last), "" if none
+    char redirect_in[max_token_length];
+    char redirect_out[max_token_length];
+    char redirect_err[max_token_length];
+    uint8_t redirect_out_append;  // >> instead of >
+    uint8_t redirect_err_append;  // 2>>
+    uint8_t redirect_invalid;     // an operator without a file
 } command_tokens_t;
 
 // split direction for window splitting
@@ -43,12 +56,37 @@ typedef enum {
     SPLIT_VERTICAL    // split vertically (left/right)
 } split_direction_t;
 
+// one character cell as it sits on the panel
+// attr picks how it was drawn, image cells belong to a bitmap and are never drawn over
+#define terminal_attr_text 0
+#define terminal_attr_hint 1      // gray autocomplete suggestion
+#define terminal_attr_image 2
+#define terminal_attr_unknown 0xFF  // panel content not known, always repainted
+#define terminal_span_gap 2         // unchanged cells bridged to keep spans few
+
+typedef struct {
+    char ch;
+    uint8_t attr;
+} terminal_cell_t;
+
+// panel area in pixels
 typedef struct {
-    char buffer[terminal_buffer_size];  // whats being displayed
+    int16_t x;
+    int16_t y;
+    int16_t w;
+    int16_t h;
+} terminal_rect_t;
+
+// called for each run of cells that has to be drawn
+typedef void (*terminal_span_fn)(void *ctx, int16_t row, int16_t col,
+                                 const char *text, int16_t len, uint8_t attr);
+
+typedef struct {
+    char *buffer;       // whats being displayed, a ring of grid_rows rows, use terminal_row()
+    uint8_t grid_rows;  // grid size, 0 while no grid is allocated
+    uint8_t grid_cols;
     char input_line[terminal_cols];
-    char history[max_input_history][terminal_cols];  // command history
-    uint8_t history_count;
-    uint8_t history_pos;  // current position in history
+    uint32_t history_pos;  // entry the arrow keys are on in the shared history, terminal_history_live if none
     uint8_t cursor_row;
     uint8_t cursor_col;
     uint8_t active;     // is terminal in use
@@ -58,6 +96,12 @@ typedef struct {
     uint8_t autocomplete_len;
     uint8_t autocomplete_base_len;
     uint8_t autocomplete_applied;
+    uint8_t autocomplete_index;  // candidate shown, tab steps through them
+    uint8_t search_active;  // ctrl-r, the input row shows the search instead of input_line
+    uint8_t search_failed;  // nothing older matches, search_pos stays on the last match
+    uint8_t search_len;
+    char search_query[terminal_cols];
+    uint32_t search_pos;    // history entry matched, terminal_history_live if none yet
     terminal_pipe_t pipes[max_pipe_commands];  // pipes for command chaining
     vfs_node_t *cwd;    // current working directory
     const char *pipe_input;  // piped input buffer (owned by pipeline)
@@ -79,6 +123,31 @@ typedef struct {
     int16_t width;      // window width
     int16_t height;     // window height
     split_direction_t split_dir;  // how this window was split
+    uint16_t scrolled_rows;       // buffer rows scrolled off the top so far, wraps
+    uint8_t row_base;             // buffer row that is grid row 0
+    char *scrollback;             // rows that scrolled off, terminal_scrollback_rows ring, NULL until the first scroll
+    uint16_t scrollback_head;     // slot the next row goes into
+    uint16_t scrollback_count;
+    uint16_t view_offset;         // rows the view is paged back from the live grid
+
+    // everything above is content, everything from here down belongs to whoever paints the window
+    // repaint tracking, rows written since the last paint get their bit set
+    // painted_valid == 0 means the next paint redraws the whole window
+    uint8_t dirty_rows[(terminal_rows + 7) / 8];
+    uint8_t painted_valid;
+    uint8_t painted_mode;         // fullscreen app / selection state at the last paint
+    int16_t painted_start_row;    // first buffer row on screen at the last paint
+    int16_t painted_cursor_row;   // screen cell of the cursor drawn at the last paint, -1 if none
+    int16_t painted_cursor_col;
+    const uint16_t *painted_image;
+    uint16_t painted_scrolled_rows;  // scrolled_rows at the last paint
+    terminal_rect_t painted_rect;    // where the window sits on the panel, empty if nowhere
+
+    // shadow of the visible grid, diffed against what should be shown so only changed cells get drawn
+    terminal_cell_t *shadow;
+    int16_t shadow_rows;
+    int16_t shadow_cols;
+    uint8_t shadow_zoom;
 } terminal_state;
 
 // expose for testing
@@ -96,12 +165,180 @@ void terminal_set_initial_output_suppressed(int suppressed);
 // terminal I/O
 void terminal_write_char(terminal_state *term, char c);
 void terminal_write_string(terminal_state *term, const char *str);
+void terminal_write_n(terminal_state *term, const char *buf, size_t len);  // bulk, row runs are memcpy'd
 void terminal_write_line(terminal_state *term, const char *str);
 void terminal_clear(terminal_state *term);
 void terminal_newline(terminal_state *term);
+void terminal_mark_row_dirty(terminal_state *term, int row);
+void terminal_mark_dirty(terminal_state *term);  // geometry, scroll or mode changed
+int terminal_row_is_dirty(const terminal_state *term, int row);
+void terminal_clear_dirty(terminal_state *term);
+
+// row storage and scrollback, see terminal_scrollback.c
+char *terminal_row(terminal_state *term, int row);  // grid row, NULL outside the grid
+// row as the view sees it, -1 and up are the scrollback from the newest back, NULL past its end
+const char *terminal_view_row(const terminal_state *term, int row);
+void terminal_scroll_up(terminal_state *term);  // top row into the scrollback, blank row at the bottom
+void terminal_scroll_view(terminal_state *term, int rows);  // page the view back (> 0) or forward
+void terminal_scrollback_release(terminal_state *term);
+// cell and history storage, PSRAM on the device when there is some
+void *terminal_storage_alloc(size_t size);
+// (re)sizes the grid to the window, returns 0 on success, -1 on no memory (the old grid stays)
+int terminal_grid_fit(terminal_state *term);
+void terminal_storage_release(terminal_state *term);  // the grid, on close
+
+// command history shared by all windows, see terminal_history.c
+#define terminal_history_live 0xFFFFFFFFu  // history_pos while editing a new line
+int terminal_history_add(const char *line);  // returns 0 on success, -1 on empty line or no memory
+// steps a window's position to the entry before / after it, NULL when there is none
+// (next moves back to terminal_history_live past the newest entry)
+const char *terminal_history_prev(uint32_t *pos);
+const char *terminal_history_next(uint32_t *pos);
+uint32_t terminal_history_count(void);
+const char *terminal_history_at(uint32_t seq);  // NULL once the entry is gone
+// newest entry older than *pos that contains needle, *pos moves onto it, NULL if there is none
+// this covers every line added since the last clear (the loaded history file too), not only the
+// ring, so at() answers for the seqs it hands out; text from past the ring moves on the next add
+const char *terminal_history_search(const char *needle, uint32_t *pos);
+// live entries in byte order, for prefix searches, seq (may be NULL) tells which is newer
+const char *terminal_history_sorted(uint32_t index, uint32_t *seq);
+uint32_t terminal_history_version(void);  // changes whenever an entry comes or goes
+void terminal_history_clear(void);
+void terminal_history_free(void);
+void terminal_scroll_back(void);     // hotkey actions, a page on the active window
+void terminal_scroll_forward(void);
+
+// shadow grid, see terminal_shadow.c
+// returns 1 when the grid was (re)allocated and everything on it is unknown, -1 on no memory
+int terminal_shadow_prepare(terminal_state *term, int16_t rows, int16_t cols, uint8_t zoom);
+void terminal_shadow_fill(terminal_state *term, char ch, uint8_t attr);
+void terminal_shadow_forget_cell(terminal_state *term, int16_t row, int16_t col);
+int terminal_shadow_diff_row(terminal_state *term, int16_t row, const terminal_cell_t *want,
+                             terminal_span_fn emit, void *ctx);
+void terminal_shadow_release(terminal_state *term);
+// screen content moved up by rows, the shadow follows and the rows that came in are unknown
+void terminal_shadow_scroll(terminal_state *term, int16_t rows);
+// panel line a y in a hardware scrolled area [top, top + height) actually lives on
+int16_t terminal_vscroll_map(int16_t y, int16_t top, int16_t height, int16_t offset);
+
+// render scheduling, see terminal_frame.c
+// writes and UI changes request a repaint, the main loop draws them at a capped frame rate
+#define terminal_frame_ms 33  // ~30 fps
+void terminal_render_request(terminal_state *term);
+void terminal_render_request_all(void);  // clear the panel and redraw every window
+void terminal_render_request_windows(void);  // every window repaints, the panel around them stays
+void terminal_render_flush(void);        // draw pending damage now, for echo and prompts
+int terminal_render_tick(uint32_t now_ms);  // returns 1 if a frame was drawn
+int terminal_render_pending(void);
+void terminal_render_reset(void);
+// drawing holds the panel lock, anything freeing memory a window points at (images) does it in between frames
+void terminal_render_lock(void);
+void terminal_render_unlock(void);
+#ifdef ARDUINO
+// moves drawing onto a task on the other core, returns 0 on success, frames are drawn inline otherwise
+int terminal_render_start_task(void);
+// time the render task spent per frame, composing plus handing the tiles over
+typedef struct {
+    uint32_t frames;
+    uint32_t last_us;
+    uint32_t avg_us;
+    uint32_t max_us;
+} terminal_frame_stats;
+void terminal_render_frame_stats(terminal_frame_stats *out);
+#endif
+
+// damage rectangle compositor, see terminal_compose.c
+// windows that moved, resized or closed since the last frame expose their old area,
+// only the part of it no window covers any more gets cleared
+#define terminal_damage_max 32
+
+typedef struct {
+    terminal_rect_t rects[terminal_damage_max];
+    uint8_t count;
+} terminal_damage_t;
+
+int terminal_rect_empty(const terminal_rect_t *r);
+int terminal_rect_equal(const terminal_rect_t *a, const terminal_rect_t *b);
+void terminal_damage_add(terminal_damage_t *damage, const terminal_rect_t *r);
+// cuts r out of every rect, returns -1 if the pieces didn't fit (the list is left as it was)
+int terminal_damage_subtract(terminal_damage_t *damage, const terminal_rect_t *r);
+// compares every window with where it was painted, returns a bit per window that has to repaint
+// in full, exposed gets the panel area left uncovered
+uint8_t terminal_compose_layout(terminal_state *windows, terminal_damage_t *exposed);
+
+// state snapshots for the render task, see terminal_snapshot.c
+// the shell side publishes copies of the damaged windows, the render task takes the newest one,
+// neither side ever waits on the other
+#define terminal_mode_nano 0x01
+#define terminal_mode_firstboot 0x02
+#define terminal_mode_passwd 0x04
+#define terminal_mode_login 0x08
+#define terminal_mode_selected 0x10  // only in painted_mode
+
+// everything a frame reads besides the windows
+typedef struct {
+    uint8_t selected;       // selected_terminal
+    uint8_t zoom;
+    uint8_t modes;          // terminal_mode_* of the fullscreen apps running
+    uint16_t active_color;
+} terminal_render_env_t;
+
+typedef struct {
+    terminal_state windows[max_windows];  // only the content part of the damaged ones is filled in
+    char cells[max_windows][terminal_buffer_size];  // their grids, windows[i].buffer points here
+    uint8_t damaged;   // bit per window copied into this snapshot
+    uint8_t invalid;   // bit per window that has to be repainted in full
+    uint8_t full;      // clear the panel and repaint every window
+    terminal_render_env_t env;
+} terminal_snapshot_t;
+
+void terminal_render_env_capture(terminal_render_env_t *env);
+int terminal_snapshot_init(void);  // returns 0 on success, -1 on no memory
+void terminal_snapshot_free(void);
+// copies the damaged windows out and marks them painted, returns -1 without slots
+int terminal_snapshot_publish(uint8_t damaged, uint8_t full);
+// newest snapshot not taken yet, or NULL, stays valid until the next take
+const terminal_snapshot_t *terminal_snapshot_take(void);
+// brings a persistent copy of the windows up to date with a snapshot
+void terminal_snapshot_apply(terminal_state *windows, const terminal_snapshot_t *snap);
+
 void terminal_capture_start(void);
 char *terminal_capture_stop(size_t *out_len);
 int terminal_capture_is_active(void);
+// output of terminal_write_*() goes to fn instead of the window while it is set (pipeline stages),
+// returns what was set before so it can be put back
+typedef void (*terminal_output_fn)(void *ctx, const char *buf, size_t len);
+typedef struct {
+    terminal_output_fn fn;
+    void *ctx;
+} terminal_output_t;
+terminal_output_t terminal_output_set(terminal_output_t out);
+terminal_output_t terminal_output_get(void);
+// error messages (shell_error()), to the window even while the output goes elsewhere unless set
+terminal_output_t terminal_error_output_set(terminal_output_t out);
+void terminal_write_error(terminal_state *term, const char *buf, size_t len);
+
+// shell redirections of a command line, see terminal_redirect.c
+typedef struct {
+    vfs_file_t *file;
+    char *buffer;  // NULL writes straight through
+    size_t len;
+    uint8_t failed;
+} terminal_stream_t;
+
+typedef struct {
+    vfs_file_t *in;  // NULL if the input isn't redirected, read by terminal_execute_pipeline()
+    terminal_stream_t out;
+    terminal_stream_t err;
+    terminal_output_t prev_out;
+    terminal_output_t prev_err;
+} terminal_redirect_t;
+
+// opens the files and points the output at them, returns SHELL_OK or an error already reported
+int terminal_redirect_begin(terminal_state *term, const command_tokens_t *tokens, terminal_redirect_t *redirect);
+void terminal_redirect_end(terminal_state *term, terminal_redirect_t *redirect);  // flushes and closes
+int terminal_redirect_has(const command_tokens_t *tokens);
+int terminal_redirect_only(terminal_state *term, const command_tokens_t *tokens);  // a line with no command
 
 // terminal input
 void terminal_handle_key(terminal_state *term, char key);
@@ -122,6 +359,20 @@ void terminal_zoom_out(void);
 uint16_t terminal_get_active_color(void);
 void terminal_reload_config(void);
 
+// completion, see terminal_complete.c
+// suffix of the index-th candidate for input (the text before the cursor), returns 1 if there is one
+int terminal_complete(terminal_state *term, const char *input, size_t len, uint16_t index,
+                      char *suffix, size_t suffix_size);
+void terminal_complete_invalidate(void);  // directory listings may be stale, after every command
+void terminal_complete_free(void);
+void terminal_handle_tab(terminal_state *term);
+
+// ctrl-r history search, the keys go here while term->search_active
+void terminal_search_start(terminal_state *term);  // pressed again it steps to the next older match
+void terminal_search_key(terminal_state *term, char key);
+void terminal_search_backspace(terminal_state *term);
+void terminal_search_end(terminal_state *term, int accept);  // accept puts the match on the input line
+
 // command parsing and execution
 void terminal_parse_command(const char *input, command_tokens_t *out_tokens);
 void terminal_execute_command(terminal_state *term, command_tokens_t *tokens);
@@ -135,12 +386,15 @@ void terminal_wire_pipes(terminal_pipe_t *pipe1, terminal_pipe_t *pipe2);
 // keyboard input handling
 void terminal_handle_key_event(key_event evt);
 
-// terminal rendering (ESP32 only)
-#ifdef ARDUINO
+// terminal rendering, onto the panel on ESP32 and the framebuffer emulator on the host (boot_tft_host.h)
 void terminal_render_all(void);
 void terminal_render_all_full(void);  // force full screen refresh
 void terminal_render_window(terminal_state *term);
-#endif
+// hides or re-shows a painted window's caret (blinking), touches only the caret's own pixels
+void terminal_render_caret(terminal_state *term, int visible);
+// draws windows (terminals[] or the render task's copies) as env describes them
+void terminal_render_frame(terminal_state *windows, const terminal_render_env_t *env,
+                           uint8_t damaged, uint8_t full);
 
 #ifdef __cplusplus
 }
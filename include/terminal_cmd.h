@@ -1,24 +1,15 @@
 #pragma once
-#include <string.h>
-#include <stdint.h>
-#include <stdio.h>
+#include "builtins.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-typedef int (*cmd_handler) (int argc, char **argv); // tells us the number of arguments and what each argument is (array of pointers to strings)
+// the terminal's commands are the shell builtins (builtins.h), there is no second table with
+// its own copies of echo, ls and the rest; find_cmd() is builtins_find() under its old name
+typedef builtin_cmd term_cmd;
 
-typedef struct {
-    cmd_handler handler;
-    const char *name;
-    const char *help;
-} term_cmd;
-
-// functions
-void register_cmd(cmd_handler handler, const char *name, const char *help);
 term_cmd *find_cmd(const char *name);
-void init_terminal_commands(void);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,88 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// glyph atlas + span blitter for terminal text
+// every printable glyph is rasterized once per zoom and colour into RGB565,
+// a span of text is composed into one line buffer and pushed as a single block
+
+#define glyph_first 32
+#define glyph_last 126
+#define glyph_count (glyph_last - glyph_first + 1)
+#define glyph_base_w 6   // 5 pixel glyph + 1 column spacing, same cell as Adafruit GFX classic font
+#define glyph_base_h 8
+#define glyph_max_zoom 3
+
+// 1 bit glyph source, returns the 8 pixel column bits (bit 0 = top row) of column col (0..4)
+typedef uint8_t (*glyph_column_fn)(void *ctx, char c, int col);
+
+typedef struct {
+    uint8_t zoom;
+    uint16_t fg;
+    uint16_t bg;
+    int16_t glyph_w;
+    int16_t glyph_h;
+    uint16_t *pixels;  // glyph_count glyphs of glyph_w * glyph_h, each row major
+} glyph_atlas_t;
+
+// where composed spans go, the panel on ESP32 or a framebuffer on the host
+typedef struct {
+    void (*push)(void *ctx, int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *pixels);
+    void *ctx;
+} glyph_target_t;
+
+// returns 0 on success, -1 on bad zoom or no memory (PSRAM first on ESP32)
+int glyph_atlas_build(glyph_atlas_t *atlas, uint8_t zoom, uint16_t fg, uint16_t bg,
+                      glyph_column_fn column, void *ctx);
+void glyph_atlas_free(glyph_atlas_t *atlas);
+const uint16_t *glyph_atlas_glyph(const glyph_atlas_t *atlas, char c);
+
+// line buffer has to hold len * glyph_w * glyph_h pixels, see glyph_span_pixels()
+size_t glyph_span_pixels(const glyph_atlas_t *atlas, int16_t len);
+// returns pixels pushed, 0 if the span doesn't fit line_buf
+size_t glyph_draw_span(const glyph_atlas_t *atlas, const glyph_target_t *target,
+                       int16_t x, int16_t y, const char *text, int16_t len,
+                       uint16_t *line_buf, size_t line_buf_pixels);
+
+// underline caret over one cell, it keeps the pixels it covers so moving or blinking it
+// only touches its own line instead of redrawing the cell or the row
+#define glyph_caret_max_w (glyph_base_w * glyph_max_zoom)
+
+typedef struct {
+    int16_t x;
+    int16_t y;       // the underline's own line, the bottom line of the cell
+    int16_t w;       // 0 when not placed anywhere
+    uint16_t color;
+    uint8_t shown;
+    uint16_t saved[glyph_caret_max_w];  // what the panel shows there without the caret
+} glyph_caret_t;
+
+// saves the bottom line of c's glyph (the background if atlas is NULL) and draws the caret over it
+// returns 0, -1 if the cell is wider than a caret can save
+int glyph_caret_place(glyph_caret_t *caret, const glyph_target_t *target, const glyph_atlas_t *atlas,
+                      char c, int16_t x, int16_t cell_y, int16_t cell_w, int16_t cell_h, uint16_t color);
+// puts the saved pixels back, the caret stays placed so it can blink back on
+void glyph_caret_hide(glyph_caret_t *caret, const glyph_target_t *target);
+void glyph_caret_show(glyph_caret_t *caret, const glyph_target_t *target);
+// whatever is under it was redrawn, nothing to restore
+void glyph_caret_forget(glyph_caret_t *caret);
+
+// host side framebuffer target, clips whatever is pushed to it
+typedef struct {
+    uint16_t *pixels;
+    int16_t width;
+    int16_t height;
+    uint32_t pushes;
+} glyph_fb_t;
+
+int glyph_fb_init(glyph_fb_t *fb, int16_t width, int16_t height);
+void glyph_fb_free(glyph_fb_t *fb);
+void glyph_fb_push(void *ctx, int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *pixels);
+
+#ifdef __cplusplus
+}
+#endif
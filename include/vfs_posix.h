@@ -0,0 +1,17 @@
+#pragma once
+
+// PC vfs backend that passes straight through to a host directory
+// the host directory becomes "/" for the whole shell
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// point the vfs root at a host directory, drops every cached node
+// vfs_init() calls this with $TILIXI_ROOT (or the working directory)
+int vfs_posix_mount(const char *host_root);
+const char* vfs_posix_root(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,34 +1,29 @@
 #include "action_manager.h"
+#include "registry.h"
 
 // forward declaration for process actions
 void register_process_actions(void);
 
-#define max_actions 32
-static action actions[max_actions];
-static uint8_t action_count = 0;
-
 void register_action(const char *name, action_handler handler) {
-    if (action_count < max_actions) {
-        actions[action_count++] = (action) {name, handler};
+    if (name == NULL || handler == NULL) {
+        return;
+    }
+    action entry = { name, handler };
+    if (registry_add(registry_action, name, &entry, sizeof(entry)) != NULL) {
         DEBUG_PRINT("[ACTION] Registered: %s\n", name);
     }
 }
 
 // reset all registered actions (primarily for tests)
 void reset_actions(void) {
-    action_count = 0;
-    for (uint8_t i = 0; i < max_actions; i++) {
-        actions[i].name = NULL;
-        actions[i].handler = NULL;
-    }
+    registry_reset(registry_action);
 }
 
 void execute_action(const char *name) {
-    for (uint8_t i = 0; i < action_count; i++) {
-        if (strcmp(actions[i].name, name) == 0) {
-            actions[i].handler();   // assign the function pointer the action
-            return;
-        }
+    registry_entry *entry = registry_find(registry_action, name);
+    if (entry != NULL) {
+        ((action*)entry->item)->handler();   // assign the function pointer the action
+        return;
     }
     DEBUG_PRINT("[ACTION?] Unknown action %s\n", name);
 }
@@ -42,6 +37,8 @@ void init_actions(void) {
     register_action("select_down", terminal_select_down);
     register_action("zoom_in", terminal_zoom_in);
     register_action("zoom_out", terminal_zoom_out);
+    register_action("scroll_back", terminal_scroll_back);
+    register_action("scroll_forward", terminal_scroll_forward);
     
     // register process-related actions
     register_process_actions();
@@ -0,0 +1,197 @@
+#include "registry.h"
+#include "debug_helper.h"
+#include <stdlib.h>
+#include <string.h>
+
+// symbol registry
+// every entry is one allocation, the kind's record sits right behind the header so pointers
+// handed out (builtins_find() and friends) stay valid while the table grows
+// the table is open addressing with linear probing, kept at most half full, so a lookup is a
+// hash and usually one compare; entries only leave when their whole kind is reset, the table is
+// rebuilt from what is left then and never needs tombstones
+// each kind also keeps its entries in registration order for listings (help, completion)
+
+#define registry_item_offset ((sizeof(registry_entry) + 15) & ~(size_t)15)
+
+typedef struct {
+    registry_entry **entries;
+    uint32_t count;
+    uint32_t cap;
+} registry_list;
+
+static registry_entry **table = NULL;
+static uint32_t table_size = 0;  // power of two
+static uint32_t table_used = 0;
+static registry_list lists[registry_kind_count];
+
+static const char *kind_names[registry_kind_count] = {
+    "builtin", "action", "script", "hotkey"
+};
+
+static uint32_t hash_name(registry_kind kind, const char *name) {
+    uint32_t hash = 2166136261u ^ (uint32_t)kind;
+    for (; *name != '\0'; name++) {
+        hash ^= (uint8_t)*name;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static uint32_t hash_id(registry_kind kind, uint32_t id) {
+    uint32_t hash = (id ^ ((uint32_t)kind << 24)) * 2654435761u;
+    return hash ^ (hash >> 15);
+}
+
+static int entry_matches(const registry_entry *entry, registry_kind kind, uint32_t hash,
+                         const char *name, uint32_t id) {
+    if (entry->kind != kind || entry->hash != hash) {
+        return 0;
+    }
+    if (name == NULL) {
+        return entry->name == NULL && entry->id == id;
+    }
+    return entry->name != NULL && strcmp(entry->name, name) == 0;
+}
+
+static registry_entry *lookup(registry_kind kind, uint32_t hash, const char *name, uint32_t id) {
+    if (table == NULL) {
+        return NULL;
+    }
+    uint32_t mask = table_size - 1;
+    for (uint32_t i = hash & mask; table[i] != NULL; i = (i + 1) & mask) {
+        if (entry_matches(table[i], kind, hash, name, id)) {
+            return table[i];
+        }
+    }
+    return NULL;
+}
+
+static void table_insert(registry_entry *entry) {
+    uint32_t mask = table_size - 1;
+    uint32_t i = entry->hash & mask;
+    while (table[i] != NULL) {
+        i = (i + 1) & mask;
+    }
+    table[i] = entry;
+    table_used++;
+}
+
+// puts every listed entry back into an empty table
+static void table_fill(void) {
+    table_used = 0;
+    for (int kind = 0; kind < registry_kind_count; kind++) {
+        for (uint32_t i = 0; i < lists[kind].count; i++) {
+            table_insert(lists[kind].entries[i]);
+        }
+    }
+}
+
+static int table_grow(void) {
+    uint32_t size = table_size ? table_size * 2 : 64;
+    registry_entry **fresh = (registry_entry**)calloc(size, sizeof(*fresh));
+    if (fresh == NULL) {
+        return -1;
+    }
+    free(table);
+    table = fresh;
+    table_size = size;
+    table_fill();
+    return 0;
+}
+
+static registry_entry *add(registry_kind kind, uint32_t hash, const char *name, uint32_t id,
+                           const void *item, size_t size) {
+    if ((int)kind < 0 || kind >= registry_kind_count || item == NULL) {
+        return NULL;
+    }
+    registry_entry *entry = lookup(kind, hash, name, id);
+    if (entry != NULL) {
+        memcpy(entry->item, item, size);
+        return entry;
+    }
+
+    if ((table_used + 1) * 2 > table_size && table_grow() != 0) {
+        DEBUG_PRINT("[REGISTRY] No room for %s %s", kind_names[kind], name ? name : "");
+        return NULL;
+    }
+    registry_list *list = &lists[kind];
+    if (list->count >= list->cap) {
+        uint32_t cap = list->cap ? list->cap * 2 : 16;
+        registry_entry **entries = (registry_entry**)realloc(list->entries, cap * sizeof(*entries));
+        if (entries == NULL) {
+            DEBUG_PRINT("[REGISTRY] No room for %s %s", kind_names[kind], name ? name : "");
+            return NULL;
+        }
+        list->entries = entries;
+        list->cap = cap;
+    }
+    entry = (registry_entry*)malloc(registry_item_offset + size);
+    if (entry == NULL) {
+        DEBUG_PRINT("[REGISTRY] No room for %s %s", kind_names[kind], name ? name : "");
+        return NULL;
+    }
+    memset(entry, 0, sizeof(*entry));
+    entry->kind = (uint8_t)kind;
+    entry->hash = hash;
+    entry->name = name;
+    entry->id = id;
+    entry->category = kind_names[kind];
+    entry->item = (char*)entry + registry_item_offset;
+    memcpy(entry->item, item, size);
+
+    list->entries[list->count++] = entry;
+    table_insert(entry);
+    return entry;
+}
+
+registry_entry *registry_add(registry_kind kind, const char *name, const void *item, size_t size) {
+    if (name == NULL) {
+        return NULL;
+    }
+    return add(kind, hash_name(kind, name), name, 0, item, size);
+}
+
+registry_entry *registry_add_id(registry_kind kind, uint32_t id, const void *item, size_t size) {
+    return add(kind, hash_id(kind, id), NULL, id, item, size);
+}
+
+registry_entry *registry_find(registry_kind kind, const char *name) {
+    if (name == NULL || (int)kind < 0 || kind >= registry_kind_count) {
+        return NULL;
+    }
+    return lookup(kind, hash_name(kind, name), name, 0);
+}
+
+registry_entry *registry_find_id(registry_kind kind, uint32_t id) {
+    if ((int)kind < 0 || kind >= registry_kind_count) {
+        return NULL;
+    }
+    return lookup(kind, hash_id(kind, id), NULL, id);
+}
+
+uint32_t registry_count(registry_kind kind) {
+    if ((int)kind < 0 || kind >= registry_kind_count) {
+        return 0;
+    }
+    return lists[kind].count;
+}
+
+registry_entry *registry_at(registry_kind kind, uint32_t index) {
+    if ((int)kind < 0 || kind >= registry_kind_count || index >= lists[kind].count) {
+        return NULL;
+    }
+    return lists[kind].entries[index];
+}
+
+void registry_reset(registry_kind kind) {
+    if ((int)kind < 0 || kind >= registry_kind_count || lists[kind].count == 0) {
+        return;
+    }
+    for (uint32_t i = 0; i < lists[kind].count; i++) {
+        free(lists[kind].entries[i]);
+    }
+    lists[kind].count = 0;
+    // same size, only the other kinds go back in
+    memset(table, 0, table_size * sizeof(*table));
+    table_fill();
+}
@@ -2,6 +2,7 @@
 #include "terminal.h"
 #include "terminal_cmd.h"
 #include "builtins.h"
+#include "shell_codes.h"
 #include "debug_helper.h"
 #include "compat.h"
 #include <string.h>
@@ -15,6 +16,7 @@ uint8_t window_count = 0;
 uint8_t selected_terminal = 0;  // last opened terminal (for splitting) - accessed by terminal_layout.c
 static uint8_t terminal_zoom = 1;
 static char history_path[256] = {0};
+static uint8_t history_loaded = 0;  // the history file goes into the shared history once
 static uint16_t terminal_active_color = 0x0000;
 static uint8_t terminal_active_color_loaded = 0;
 
@@ -22,6 +24,7 @@ void init_terminal_system(void) {
     window_count = 0;
     active_terminal = 0;
     selected_terminal = 0;
+    terminal_render_reset();
 #ifdef ARDUINO
     extern void terminal_image_view_release(terminal_state *term);
 #endif
@@ -38,8 +41,9 @@ void init_terminal_system(void) {
         terminals[i].autocomplete_len = 0;
         terminals[i].autocomplete_base_len = 0;
         terminals[i].autocomplete_applied = 0;
-        terminals[i].history_count = 0;
-        terminals[i].history_pos = 0;
+        terminals[i].autocomplete_index = 0;
+        terminals[i].search_active = 0;
+        terminals[i].history_pos = terminal_history_live;
         terminals[i].cwd = NULL;
         terminals[i].pipe_input = NULL;
         terminals[i].pipe_input_len = 0;
@@ -53,22 +57,25 @@ void init_terminal_system(void) {
         terminals[i].fastfetch_text_lines = 0;
         terminals[i].image_view_active = 0;
         terminals[i].image_view_path[0] = '\0';
-        memset(terminals[i].buffer, ' ', terminal_buffer_size);
+        terminal_storage_release(&terminals[i]);
         memset(terminals[i].input_line, 0, terminal_cols);
+        terminal_mark_dirty(&terminals[i]);
+        terminal_shadow_release(&terminals[i]);
+        terminal_scrollback_release(&terminals[i]);
         terminals[i].x = 0;
         terminals[i].y = 0;
         terminals[i].width = 0;
         terminals[i].height = 0;
         terminals[i].split_dir = SPLIT_NONE;
-        for (uint8_t j = 0; j < max_input_history; j++) {
-            memset(terminals[i].history[j], 0, terminal_cols);
-        }
         for (uint8_t j = 0; j < max_pipe_commands; j++) {
             terminals[i].pipes[j].active = 0;
             terminals[i].pipes[j].read_fd = -1;
             terminals[i].pipes[j].write_fd = -1;
         }
     }
+    terminal_history_clear();
+    terminal_complete_invalidate();
+    history_loaded = 0;
     DEBUG_PRINT("[TERMINAL] Terminal system initialized\n");
 }
 
@@ -181,32 +188,6 @@ static void terminal_history_ensure_dirs(void) {
     terminal_ensure_dir(shell_path);
 }
 
-static void terminal_history_push(terminal_state *term, const char *line) {
-    if (term == NULL || line == NULL) {
-        return;
-    }
-    size_t copy_len = strlen(line);
-    if (copy_len > terminal_cols - 1) {
-        copy_len = terminal_cols - 1;
-    }
-    if (copy_len == 0) {
-        return;
-    }
-    if (term->history_count < max_input_history) {
-        memcpy(term->history[term->history_count], line, copy_len);
-        term->history[term->history_count][copy_len] = '\0';
-        term->history_count++;
-    } else {
-        for (uint8_t i = 0; i < max_input_history - 1; i++) {
-            memcpy(term->history[i], term->history[i + 1], terminal_cols - 1);
-            term->history[i][terminal_cols - 1] = '\0';
-        }
-        memcpy(term->history[max_input_history - 1], line, copy_len);
-        term->history[max_input_history - 1][copy_len] = '\0';
-    }
-    term->history_pos = term->history_count;
-}
-
 static void terminal_history_append_persistent(const char *line) {
     if (line == NULL || line[0] == '\0') {
         return;
@@ -227,10 +208,7 @@ static void terminal_history_append_persistent(const char *line) {
     vfs_close(file);
 }
 
-static void terminal_history_load(terminal_state *term) {
-    if (term == NULL) {
-        return;
-    }
+static void terminal_history_load(void) {
     if (history_path[0] == '\0') {
         if (!terminal_history_get_path(history_path, sizeof(history_path))) {
             return;
@@ -250,7 +228,7 @@ static void terminal_history_load(terminal_state *term) {
             if (c == '\n' || c == '\r') {
                 if (line_len > 0) {
                     line[line_len] = '\0';
-                    terminal_history_push(term, line);
+                    terminal_history_add(line);
                     line_len = 0;
                 }
             } else {
@@ -262,7 +240,7 @@ static void terminal_history_load(terminal_state *term) {
     }
     if (line_len > 0) {
         line[line_len] = '\0';
-        terminal_history_push(term, line);
+        terminal_history_add(line);
     }
     vfs_close(file);
 }
@@ -275,34 +253,24 @@ static void terminal_update_autocomplete(terminal_state *term) {
     term->autocomplete_len = 0;
     term->autocomplete_base_len = term->input_len;
     term->autocomplete_applied = 0;
-    if (term->input_len == 0 || term->history_count == 0) {
+    term->autocomplete_index = 0;
+    if (term->input_len == 0) {
         return;
     }
-    for (int i = (int)term->history_count - 1; i >= 0; i--) {
-        const char *cmd = term->history[i];
-        if (cmd == NULL || cmd[0] == '\0') {
-            continue;
-        }
-        size_t cmd_len = strlen(cmd);
-        if (cmd_len <= term->input_len) {
-            continue;
-        }
-        if (strncmp(cmd, term->input_line, term->input_len) == 0) {
-            size_t suffix_len = cmd_len - term->input_len;
-            if (suffix_len > terminal_cols - 1) {
-                suffix_len = terminal_cols - 1;
-            }
-            memcpy(term->autocomplete_suffix, cmd + term->input_len, suffix_len);
-            term->autocomplete_suffix[suffix_len] = '\0';
-            term->autocomplete_len = (uint8_t)suffix_len;
-            term->autocomplete_base_len = term->input_len;
-            return;
-        }
+    if (terminal_complete(term, term->input_line, term->input_len, 0,
+                          term->autocomplete_suffix, sizeof(term->autocomplete_suffix))) {
+        term->autocomplete_len = (uint8_t)strlen(term->autocomplete_suffix);
     }
 }
 
 void terminal_load_history(terminal_state *term) {
-    terminal_history_load(term);
+    if (!history_loaded) {
+        history_loaded = 1;
+        terminal_history_load();
+    }
+    if (term != NULL) {
+        term->history_pos = terminal_history_live;
+    }
 }
 
 static int parse_rgb_component(const char *s, uint8_t *out) {
@@ -487,28 +455,37 @@ uint16_t terminal_get_active_color(void) {
 void terminal_reload_config(void) {
     terminal_active_color_loaded = 0;
     terminal_load_active_color();
-#ifdef ARDUINO
-    extern void terminal_render_all(void);
-    terminal_render_all();
-#endif
+    terminal_render_request_all();
+}
+
+// (reverse-i-search)`query': match, the caret sits at the end of the query like bash
+static void terminal_redraw_search_line(terminal_state *term, char *line) {
+    char text[terminal_cols * 3];
+    const char *match = term->search_pos != terminal_history_live ? terminal_history_at(term->search_pos) : NULL;
+    int caret = snprintf(text, sizeof(text), "(%sreverse-i-search)`%s",
+                         term->search_failed ? "failed " : "", term->search_query);
+    int len = snprintf(text + caret, sizeof(text) - caret, "': %s", match != NULL ? match : "");
+    len += caret;
+    for (int i = 0; i < len && i < term->grid_cols; i++) {
+        line[i] = text[i];
+    }
+    term->cursor_col = caret < term->grid_cols ? (uint8_t)caret : term->grid_cols - 1;
 }
 
 static void terminal_redraw_input_line(terminal_state *term) {
     if (term == NULL || !term->active) return;
-    uint16_t line_start = term->cursor_row * terminal_cols;
-    if (line_start >= terminal_buffer_size) return;
-    for (uint16_t col = 0; col < terminal_cols; col++) {
-        if (line_start + col < terminal_buffer_size) {
-            term->buffer[line_start + col] = ' ';
-        }
+    char *line = terminal_row(term, term->cursor_row);
+    if (line == NULL) return;
+    terminal_mark_row_dirty(term, term->cursor_row);
+    memset(line, ' ', term->grid_cols);
+    if (term->search_active) {
+        terminal_redraw_search_line(term, line);
+        return;
     }
-    if (line_start + 0 < terminal_buffer_size) term->buffer[line_start + 0] = '$';
-    if (line_start + 1 < terminal_buffer_size) term->buffer[line_start + 1] = ' ';
-    for (uint16_t i = 0; i < term->input_len && (2 + i) < terminal_cols; i++) {
-        uint16_t buf_pos = line_start + 2 + i;
-        if (buf_pos < terminal_buffer_size) {
-            term->buffer[buf_pos] = term->input_line[i];
-        }
+    line[0] = '$';
+    line[1] = ' ';
+    for (uint16_t i = 0; i < term->input_len && (2 + i) < term->grid_cols; i++) {
+        line[2 + i] = term->input_line[i];
     }
     term->cursor_col = 2 + term->input_pos;
 }
@@ -559,18 +536,12 @@ void terminal_handle_enter(terminal_state *term) {
     command_tokens_t tokens;
     terminal_parse_command(term->input_line, &tokens);
     
-    // add to history
-    // theres probably a more unified way to do this that looks a lot better
-    // butttttttt im too lazy and dumb...
+    // add to history, one copy every window sees
     if (term->input_len > 0) {
-        terminal_history_push(term, term->input_line);
+        terminal_history_add(term->input_line);
         terminal_history_append_persistent(term->input_line);
-        for (uint8_t i = 0; i < max_windows; i++) {
-            if (&terminals[i] != term && terminals[i].active) {
-                terminal_history_push(&terminals[i], term->input_line);
-            }
-        }
     }
+    term->history_pos = terminal_history_live;
     
     // move to next line (off the input line) - always do this
     terminal_newline(term);
@@ -583,9 +554,11 @@ void terminal_handle_enter(terminal_state *term) {
     term->autocomplete_len = 0;
     term->autocomplete_base_len = 0;
     term->autocomplete_applied = 0;
+    term->autocomplete_index = 0;
+    terminal_complete_invalidate();  // the command may change the directories listed
     
-    // execute command if there is one
-    if (tokens.token_count > 0) {
+    // execute command if there is one, a bare redirect still opens its file
+    if (tokens.token_count > 0 || terminal_redirect_has(&tokens)) {
         if (tokens.has_pipe) {
             terminal_execute_pipeline(term, &tokens);
         } else {
@@ -613,9 +586,9 @@ void terminal_handle_enter(terminal_state *term) {
 void terminal_handle_arrow_up(terminal_state *term) {
     if (term == NULL || !term->active) return;
     
-    if (term->history_pos > 0) {
-        term->history_pos--;
-        strncpy(term->input_line, term->history[term->history_pos], terminal_cols - 1);
+    const char *line = terminal_history_prev(&term->history_pos);
+    if (line != NULL) {
+        strncpy(term->input_line, line, terminal_cols - 1);
         term->input_line[terminal_cols - 1] = '\0';
         term->input_len = strlen(term->input_line);
         term->input_pos = term->input_len;
@@ -627,10 +600,10 @@ void terminal_handle_arrow_up(terminal_state *term) {
 void terminal_handle_arrow_down(terminal_state *term) {
     if (term == NULL || !term->active) return;
     
-    if (term->history_pos < term->history_count) {
-        term->history_pos++;
-        if (term->history_pos < term->history_count) {
-            strncpy(term->input_line, term->history[term->history_pos], terminal_cols - 1);
+    if (term->history_pos != terminal_history_live) {
+        const char *line = terminal_history_next(&term->history_pos);
+        if (line != NULL) {
+            strncpy(term->input_line, line, terminal_cols - 1);
             term->input_line[terminal_cols - 1] = '\0';
         } else {
             memset(term->input_line, 0, terminal_cols);
@@ -688,6 +661,91 @@ void terminal_handle_arrow_right(terminal_state *term) {
     }
 }
 
+// tab takes the suggestion, pressed again right away it swaps in the next candidate
+void terminal_handle_tab(terminal_state *term) {
+    if (term == NULL || !term->active || term->input_pos != term->input_len) return;
+    if (term->autocomplete_applied &&
+        term->input_len == term->autocomplete_base_len + term->autocomplete_len) {
+        // the first candidate comes back after the last
+        uint8_t base_len = term->autocomplete_base_len;
+        uint16_t next = (uint16_t)(term->autocomplete_index + 1);
+        char suffix[terminal_cols];
+        if (!terminal_complete(term, term->input_line, base_len, next, suffix, sizeof(suffix))) {
+            next = 0;
+            if (!terminal_complete(term, term->input_line, base_len, next, suffix, sizeof(suffix))) {
+                return;
+            }
+        }
+        memcpy(term->autocomplete_suffix, suffix, sizeof(suffix));
+        term->autocomplete_len = (uint8_t)strlen(suffix);
+        term->autocomplete_index = (uint8_t)next;
+        term->autocomplete_applied = 0;
+        term->input_len = base_len;
+        term->input_pos = base_len;
+        term->input_line[base_len] = '\0';
+    }
+    terminal_handle_arrow_right(term);
+}
+
+// looks for the query in entries older than from, the match stays put when there is none
+static void terminal_search_update(terminal_state *term, uint32_t from) {
+    uint32_t pos = from;
+    if (term->search_len > 0 && terminal_history_search(term->search_query, &pos) != NULL) {
+        term->search_pos = pos;
+        term->search_failed = 0;
+    } else {
+        term->search_failed = term->search_len > 0;
+    }
+    terminal_redraw_input_line(term);
+}
+
+void terminal_search_start(terminal_state *term) {
+    if (term == NULL || !term->active) return;
+    if (!term->search_active) {
+        term->search_active = 1;
+        term->search_failed = 0;
+        term->search_len = 0;
+        term->search_query[0] = '\0';
+        term->search_pos = terminal_history_live;
+        terminal_redraw_input_line(term);
+        return;
+    }
+    terminal_search_update(term, term->search_pos);
+}
+
+void terminal_search_key(terminal_state *term, char key) {
+    if (term == NULL || !term->search_active) return;
+    if (term->search_len >= terminal_cols - 1 || key < 32 || key >= 127) return;
+    term->search_query[term->search_len++] = key;
+    term->search_query[term->search_len] = '\0';
+    // the current match may still contain the longer query, so it is searched again too
+    uint32_t from = term->search_pos != terminal_history_live ? term->search_pos + 1 : terminal_history_live;
+    terminal_search_update(term, from);
+}
+
+void terminal_search_backspace(terminal_state *term) {
+    if (term == NULL || !term->search_active || term->search_len == 0) return;
+    term->search_query[--term->search_len] = '\0';
+    term->search_pos = terminal_history_live;
+    terminal_search_update(term, terminal_history_live);
+}
+
+void terminal_search_end(terminal_state *term, int accept) {
+    if (term == NULL || !term->search_active) return;
+    term->search_active = 0;
+    const char *match = accept && term->search_pos != terminal_history_live ?
+                        terminal_history_at(term->search_pos) : NULL;
+    if (match != NULL) {
+        strncpy(term->input_line, match, terminal_cols - 1);
+        term->input_line[terminal_cols - 1] = '\0';
+        term->input_len = strlen(term->input_line);
+        term->input_pos = term->input_len;
+        term->history_pos = term->search_pos;  // the arrows go on from the match
+    }
+    terminal_redraw_input_line(term);
+    terminal_update_autocomplete(term);
+}
+
 uint8_t terminal_get_zoom(void) {
     return terminal_zoom;
 }
@@ -699,16 +757,21 @@ static void terminal_set_zoom(uint8_t zoom) {
         return;
     }
     terminal_zoom = zoom;
+    for (uint8_t i = 0; i < max_windows; i++) {
+        if (terminals[i].active) {
+            terminal_grid_fit(&terminals[i]);  // keeps the old grid if there's no memory
+        }
+    }
 #ifdef ARDUINO
-    extern void terminal_render_all(void);
     extern void fastfetch_rescale_image(terminal_state *term);
     for (uint8_t i = 0; i < max_windows; i++) {
         if (terminals[i].active && terminals[i].fastfetch_image_active) {
-            fastfetch_rescale_image(&terminals[i]);
+            fastfetch_rescale_image(&terminals[i]);  // takes the render lock around its free
         }
     }
-    terminal_render_all();
 #endif
+    // new cell size, every window reflows in place
+    terminal_render_request_windows();
 }
 
 void terminal_zoom_in(void) {
@@ -726,7 +789,19 @@ extern void terminal_execute_pipeline(terminal_state *term, command_tokens_t *to
 
 // command execution
 void terminal_execute_command(terminal_state *term, command_tokens_t *tokens) {
-    if (term == NULL || tokens == NULL || tokens->token_count == 0) {
+    if (term == NULL || tokens == NULL) {
+        return;
+    }
+    if (tokens->token_count == 0) {
+        if (terminal_redirect_has(tokens)) {
+            terminal_redirect_only(term, tokens);
+        }
+        return;
+    }
+    
+    // input from a file goes through the pipeline code, the command is its only stage
+    if (tokens->redirect_in[0] != '\0') {
+        terminal_execute_pipeline(term, tokens);
         return;
     }
     
@@ -737,7 +812,12 @@ void terminal_execute_command(terminal_state *term, command_tokens_t *tokens) {
     // find and execute command using builtin system
     builtin_cmd *cmd = builtins_find(cmd_name);
     if (cmd != NULL) {
+        terminal_redirect_t redirect;
+        if (terminal_redirect_begin(term, tokens, &redirect) != SHELL_OK) {
+            return;
+        }
         int result = cmd->handler(term, argc, argv);
+        terminal_redirect_end(term, &redirect);
         if (result != 0) {
             char error_msg[64];
             snprintf(error_msg, sizeof(error_msg), "Command failed with code %d\n", result);
@@ -0,0 +1,321 @@
+#include "terminal.h"
+#include "builtins.h"
+#include "vfs.h"
+#include <stdlib.h>
+#include <string.h>
+
+// completion engine
+// candidates for the input come out of three sorted lists, a binary search finds the range of
+// entries that start with what was typed:
+//   history entries for the whole line (terminal_history_sorted(), the newest match is shown first)
+//   builtin names for the first word
+//   the directory a path argument points into, listed once and cached until the next command
+// every list remembers the range of its last search, a keystroke that only adds to the prefix
+// searches inside that range instead of the whole list
+
+typedef const char *(*complete_item_fn)(uint32_t index);
+
+typedef struct {
+    uint8_t valid;
+    uint32_t version;  // of the list the range was found in
+    uint32_t lo;       // [lo, hi) start with prefix
+    uint32_t hi;
+    size_t len;
+    char prefix[terminal_cols];
+} complete_range_t;
+
+static complete_range_t history_range;
+static complete_range_t builtin_range;
+static complete_range_t dir_range;
+
+static const char **builtin_names = NULL;  // sorted, rebuilt when the builtin count changes
+static uint32_t builtin_names_count = 0;
+static uint32_t builtin_names_cap = 0;
+
+// listing of one directory, names are NUL separated in one block, directories end in '/'
+static struct {
+    uint8_t valid;
+    uint32_t version;
+    vfs_node_t *cwd;          // the key: where the typed directory was resolved from
+    char dir[terminal_cols];  // and the directory part as typed
+    char *names;
+    size_t names_len;
+    size_t names_cap;
+    uint32_t *sorted;         // offsets into names
+    uint32_t count;
+    uint32_t sorted_cap;
+} dir_cache;
+
+static const char *history_item(uint32_t index) {
+    return terminal_history_sorted(index, NULL);
+}
+
+static const char *builtin_item(uint32_t index) {
+    return builtin_names[index];
+}
+
+static const char *dir_item(uint32_t index) {
+    return dir_cache.names + dir_cache.sorted[index];
+}
+
+// narrows range to the entries of list that start with prefix
+static void complete_search(complete_range_t *range, complete_item_fn item, uint32_t count,
+                            uint32_t version, const char *prefix, size_t len) {
+    uint32_t lo = 0;
+    uint32_t hi = count;
+    if (range->valid && range->version == version && range->len <= len &&
+        memcmp(range->prefix, prefix, range->len) == 0) {
+        lo = range->lo;
+        hi = range->hi;
+    }
+    uint32_t a = lo, b = hi;
+    while (a < b) {
+        uint32_t mid = a + (b - a) / 2;
+        if (strncmp(item(mid), prefix, len) < 0) {
+            a = mid + 1;
+        } else {
+            b = mid;
+        }
+    }
+    lo = a;
+    b = hi;
+    while (a < b) {
+        uint32_t mid = a + (b - a) / 2;
+        if (strncmp(item(mid), prefix, len) <= 0) {
+            a = mid + 1;
+        } else {
+            b = mid;
+        }
+    }
+    range->valid = 1;
+    range->version = version;
+    range->lo = lo;
+    range->hi = a;
+    range->len = len;
+    memcpy(range->prefix, prefix, len);
+}
+
+static int compare_names(const void *a, const void *b) {
+    return strcmp(*(const char * const *)a, *(const char * const *)b);
+}
+
+static int compare_offsets(const void *a, const void *b) {
+    return strcmp(dir_cache.names + *(const uint32_t*)a, dir_cache.names + *(const uint32_t*)b);
+}
+
+static void builtin_names_load(void) {
+    int count = builtins_count();
+    if ((uint32_t)count == builtin_names_count) {
+        return;
+    }
+    if ((uint32_t)count > builtin_names_cap) {
+        const char **names = (const char**)realloc(builtin_names, (size_t)count * sizeof(*names));
+        if (names == NULL) {
+            return;
+        }
+        builtin_names = names;
+        builtin_names_cap = (uint32_t)count;
+    }
+    builtin_names_count = 0;
+    for (int i = 0; i < count; i++) {
+        builtin_names[builtin_names_count++] = builtins_at(i)->name;
+    }
+    qsort(builtin_names, builtin_names_count, sizeof(builtin_names[0]), compare_names);
+    builtin_range.valid = 0;
+}
+
+static int dir_cache_add(const char *name, size_t len) {
+    if (dir_cache.names_len + len + 2 > dir_cache.names_cap) {
+        size_t cap = dir_cache.names_cap ? dir_cache.names_cap * 2 : 512;
+        while (cap < dir_cache.names_len + len + 2) {
+            cap *= 2;
+        }
+        char *names = (char*)realloc(dir_cache.names, cap);
+        if (names == NULL) {
+            return -1;
+        }
+        dir_cache.names = names;
+        dir_cache.names_cap = cap;
+    }
+    if (dir_cache.count >= dir_cache.sorted_cap) {
+        uint32_t cap = dir_cache.sorted_cap ? dir_cache.sorted_cap * 2 : 64;
+        uint32_t *sorted = (uint32_t*)realloc(dir_cache.sorted, cap * sizeof(*sorted));
+        if (sorted == NULL) {
+            return -1;
+        }
+        dir_cache.sorted = sorted;
+        dir_cache.sorted_cap = cap;
+    }
+    dir_cache.sorted[dir_cache.count++] = (uint32_t)dir_cache.names_len;
+    memcpy(dir_cache.names + dir_cache.names_len, name, len);
+    // a second NUL leaves room for the '/' a directory gets
+    dir_cache.names[dir_cache.names_len + len] = '\0';
+    dir_cache.names[dir_cache.names_len + len + 1] = '\0';
+    dir_cache.names_len += len + 2;
+    return 0;
+}
+
+// lists the directory dir (as typed, relative to the window's cwd) unless it is cached already
+static int dir_cache_load(terminal_state *term, const char *dir, size_t dir_len) {
+    if (dir_cache.valid && dir_cache.cwd == term->cwd &&
+        strlen(dir_cache.dir) == dir_len && memcmp(dir_cache.dir, dir, dir_len) == 0) {
+        return dir_cache.count > 0;
+    }
+    dir_cache.valid = 1;
+    dir_cache.version++;
+    dir_cache.cwd = term->cwd;
+    memcpy(dir_cache.dir, dir, dir_len);
+    dir_cache.dir[dir_len] = '\0';
+    dir_cache.names_len = 0;
+    dir_cache.count = 0;
+    dir_range.valid = 0;
+
+    vfs_node_t *node = NULL;
+    if (dir_len > 0) {
+        node = vfs_resolve_at(term->cwd, dir_cache.dir);
+    } else {
+        node = term->cwd != NULL ? term->cwd : vfs_resolve("/");
+    }
+    if (node == NULL) {
+        return 0;
+    }
+    if (node->type == VFS_NODE_DIR) {
+        vfs_dir_iter_t *iter = vfs_dir_iter_create_node(node);
+        if (iter != NULL) {
+            while (vfs_dir_iter_next(iter) > 0) {
+                if (iter->current_name != NULL && iter->current_name[0] != '\0' &&
+                    dir_cache_add(iter->current_name, strlen(iter->current_name)) != 0) {
+                    break;
+                }
+            }
+            vfs_dir_iter_destroy(iter);
+        }
+        // types once the listing is done, the backend's iterator may not like lookups in between
+        for (uint32_t i = 0; i < dir_cache.count; i++) {
+            char *name = dir_cache.names + dir_cache.sorted[i];
+            vfs_node_t *child = vfs_resolve_at(node, name);
+            if (child != NULL) {
+                if (child->type == VFS_NODE_DIR) {
+                    name[strlen(name)] = '/';
+                }
+                vfs_node_release(child);
+            }
+        }
+        qsort(dir_cache.sorted, dir_cache.count, sizeof(*dir_cache.sorted), compare_offsets);
+    }
+    if (node != term->cwd) {
+        vfs_node_release(node);
+    }
+    return dir_cache.count > 0;
+}
+
+void terminal_complete_invalidate(void) {
+    dir_cache.valid = 0;
+    dir_range.valid = 0;
+}
+
+void terminal_complete_free(void) {
+    free(dir_cache.names);
+    free(dir_cache.sorted);
+    free(builtin_names);
+    memset(&dir_cache, 0, sizeof(dir_cache));
+    builtin_names = NULL;
+    builtin_names_cap = 0;
+    history_range.valid = 0;
+    builtin_range.valid = 0;
+    dir_range.valid = 0;
+    builtin_names_count = 0;
+}
+
+// copies the part of candidate past what was typed, returns its length
+static size_t complete_suffix(const char *candidate, size_t typed, char *suffix, size_t suffix_size) {
+    size_t len = strlen(candidate + typed);
+    if (len >= suffix_size) {
+        len = suffix_size - 1;
+    }
+    memcpy(suffix, candidate + typed, len);
+    suffix[len] = '\0';
+    return len;
+}
+
+int terminal_complete(terminal_state *term, const char *input, size_t len, uint16_t index,
+                      char *suffix, size_t suffix_size) {
+    if (term == NULL || input == NULL || len == 0 || suffix == NULL || suffix_size == 0) {
+        return 0;
+    }
+    if (len >= terminal_cols) {
+        len = terminal_cols - 1;
+    }
+    suffix[0] = '\0';
+
+    // the newest history line that continues the input comes first
+    const char *history_line = NULL;
+    complete_search(&history_range, history_item, terminal_history_count(),
+                    terminal_history_version(), input, len);
+    uint32_t newest = 0;
+    for (uint32_t i = history_range.lo; i < history_range.hi; i++) {
+        uint32_t seq = 0;
+        const char *line = terminal_history_sorted(i, &seq);
+        if (line[len] != '\0' && (history_line == NULL || seq > newest)) {
+            history_line = line;
+            newest = seq;
+        }
+    }
+    if (history_line != NULL) {
+        if (index == 0) {
+            return complete_suffix(history_line, len, suffix, suffix_size) > 0;
+        }
+        index--;
+    }
+
+    // then the word under the cursor, a command name or a path
+    size_t word = len;
+    while (word > 0 && input[word - 1] != ' ') {
+        word--;
+    }
+    const char *prefix = input + word;
+    size_t prefix_len = len - word;
+    const char *slash = NULL;
+    for (size_t i = 0; i < prefix_len; i++) {
+        if (prefix[i] == '/') {
+            slash = prefix + i;
+        }
+    }
+    complete_range_t *range;
+    complete_item_fn item;
+    if (word == 0 && slash == NULL) {
+        if (prefix_len == 0) {
+            return 0;
+        }
+        builtin_names_load();
+        complete_search(&builtin_range, builtin_item, builtin_names_count, builtin_names_count,
+                        prefix, prefix_len);
+        range = &builtin_range;
+        item = builtin_item;
+    } else {
+        size_t dir_len = slash != NULL ? (size_t)(slash - prefix) + 1 : 0;
+        if (!dir_cache_load(term, prefix, dir_len)) {
+            return 0;
+        }
+        prefix += dir_len;
+        prefix_len -= dir_len;
+        complete_search(&dir_range, dir_item, dir_cache.count, dir_cache.version, prefix, prefix_len);
+        range = &dir_range;
+        item = dir_item;
+    }
+    for (uint32_t i = range->lo; i < range->hi; i++) {
+        const char *name = item(i);
+        if (name[prefix_len] == '\0') {
+            continue;  // typed out already
+        }
+        // skip what the history candidate already offers
+        if (history_line != NULL && strcmp(history_line + len, name + prefix_len) == 0) {
+            continue;
+        }
+        if (index == 0) {
+            return complete_suffix(name, prefix_len, suffix, suffix_size) > 0;
+        }
+        index--;
+    }
+    return 0;
+}
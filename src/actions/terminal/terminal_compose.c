@@ -0,0 +1,125 @@
+#include "terminal.h"
+
+// window compositor
+// layout changes used to clear the whole panel and repaint every window, now each window
+// remembers the rect it was painted at and a frame only touches what actually changed:
+// windows with a new rect repaint themselves (border and background included), and of the
+// area they left behind only what no window covers now is cleared to the background
+
+int terminal_rect_empty(const terminal_rect_t *r) {
+    return r == NULL || r->w <= 0 || r->h <= 0;
+}
+
+int terminal_rect_equal(const terminal_rect_t *a, const terminal_rect_t *b) {
+    return a->x == b->x && a->y == b->y && a->w == b->w && a->h == b->h;
+}
+
+static terminal_rect_t rect_bounds(const terminal_rect_t *a, const terminal_rect_t *b) {
+    int16_t x0 = a->x < b->x ? a->x : b->x;
+    int16_t y0 = a->y < b->y ? a->y : b->y;
+    int16_t x1 = a->x + a->w > b->x + b->w ? a->x + a->w : b->x + b->w;
+    int16_t y1 = a->y + a->h > b->y + b->h ? a->y + a->h : b->y + b->h;
+    terminal_rect_t out = { x0, y0, (int16_t)(x1 - x0), (int16_t)(y1 - y0) };
+    return out;
+}
+
+void terminal_damage_add(terminal_damage_t *damage, const terminal_rect_t *r) {
+    if (damage == NULL || terminal_rect_empty(r)) {
+        return;
+    }
+    if (damage->count < terminal_damage_max) {
+        damage->rects[damage->count++] = *r;
+        return;
+    }
+    // out of slots, the last one grows to cover it (only ever clears more background)
+    damage->rects[terminal_damage_max - 1] = rect_bounds(&damage->rects[terminal_damage_max - 1], r);
+}
+
+// a minus b in at most 4 pieces: full width bands above and below, then left and right of b
+static int rect_subtract(const terminal_rect_t *a, const terminal_rect_t *b, terminal_rect_t out[4]) {
+    int16_t ax1 = a->x + a->w, ay1 = a->y + a->h;
+    int16_t bx1 = b->x + b->w, by1 = b->y + b->h;
+    if (b->x >= ax1 || bx1 <= a->x || b->y >= ay1 || by1 <= a->y) {
+        out[0] = *a;
+        return 1;
+    }
+    int n = 0;
+    int16_t top = b->y > a->y ? b->y : a->y;
+    int16_t bottom = by1 < ay1 ? by1 : ay1;
+    if (b->y > a->y) {
+        terminal_rect_t r = { a->x, a->y, a->w, (int16_t)(b->y - a->y) };
+        out[n++] = r;
+    }
+    if (by1 < ay1) {
+        terminal_rect_t r = { a->x, by1, a->w, (int16_t)(ay1 - by1) };
+        out[n++] = r;
+    }
+    if (b->x > a->x) {
+        terminal_rect_t r = { a->x, top, (int16_t)(b->x - a->x), (int16_t)(bottom - top) };
+        out[n++] = r;
+    }
+    if (bx1 < ax1) {
+        terminal_rect_t r = { bx1, top, (int16_t)(ax1 - bx1), (int16_t)(bottom - top) };
+        out[n++] = r;
+    }
+    return n;
+}
+
+int terminal_damage_subtract(terminal_damage_t *damage, const terminal_rect_t *r) {
+    if (damage == NULL || terminal_rect_empty(r)) {
+        return 0;
+    }
+    terminal_damage_t out;
+    out.count = 0;
+    for (uint8_t i = 0; i < damage->count; i++) {
+        terminal_rect_t pieces[4];
+        int n = rect_subtract(&damage->rects[i], r, pieces);
+        if (out.count + n > terminal_damage_max) {
+            return -1;
+        }
+        for (int p = 0; p < n; p++) {
+            out.rects[out.count++] = pieces[p];
+        }
+    }
+    *damage = out;
+    return 0;
+}
+
+uint8_t terminal_compose_layout(terminal_state *windows, terminal_damage_t *exposed) {
+    uint8_t repaint = 0;
+    exposed->count = 0;
+    if (windows == NULL) {
+        return 0;
+    }
+    for (uint8_t i = 0; i < max_windows; i++) {
+        terminal_state *term = &windows[i];
+        terminal_rect_t now = { 0, 0, 0, 0 };
+        if (term->active) {
+            now.x = term->x;
+            now.y = term->y;
+            now.w = term->width;
+            now.h = term->height;
+        }
+        if (terminal_rect_equal(&now, &term->painted_rect)) {
+            continue;
+        }
+        terminal_damage_add(exposed, &term->painted_rect);
+        term->painted_rect = now;
+        if (term->active) {
+            terminal_mark_dirty(term);
+            repaint |= (uint8_t)(1u << i);
+        }
+    }
+    // whatever a window covers now it paints itself
+    for (uint8_t i = 0; i < max_windows && exposed->count > 0; i++) {
+        if (!windows[i].active || terminal_rect_empty(&windows[i].painted_rect)) {
+            continue;
+        }
+        if (terminal_damage_subtract(exposed, &windows[i].painted_rect) != 0) {
+            // too fragmented to cut around it, the clear may hit it so it repaints after
+            terminal_mark_dirty(&windows[i]);
+            repaint |= (uint8_t)(1u << i);
+        }
+    }
+    return repaint;
+}
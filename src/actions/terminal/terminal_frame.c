@@ -0,0 +1,174 @@
+#include "terminal.h"
+
+#ifdef ARDUINO
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <esp_timer.h>
+#include "boot_splash.h"
+#include "debug_helper.h"
+#else
+#include "boot_tft_host.h"
+#endif
+
+// render scheduling
+// writes only mark their window damaged, the main loop draws at most one frame per
+// terminal_frame_ms so a cat of a big file or a chatty script never waits on the panel,
+// keystroke echo and prompts use terminal_render_flush() to skip the wait
+// once the render task runs, a "frame" on this side is only a snapshot handed to it,
+// composing and sending happen on the other core while the shell keeps going
+
+static volatile uint8_t damaged_windows = 0;  // bit per terminals[] slot
+static volatile uint8_t damaged_all = 0;      // layout changed, clear and redraw every window
+static uint32_t last_frame_ms = 0;
+
+#ifdef ARDUINO
+// the loop task is pinned to core 1, this one takes core 0
+// panel_tx shares it only while tiles go out by DMA and it sleeps on the transfer (higher
+// priority, so a finished tile is handed back right away); a polling panel_tx sits on core 1
+// frame times are kept so that can be checked on the device, see terminal_render_frame_stats()
+#define render_task_stack 8192
+#define render_task_priority 1
+#define render_task_core 0
+#define render_stats_every 128  // frames between DEBUG_PRINT reports
+
+static TaskHandle_t render_task = NULL;
+static terminal_state render_windows[max_windows];  // the render task's copy, painted state lives here
+static terminal_frame_stats render_stats;
+static uint64_t render_stats_total_us = 0;
+
+static void render_stats_add(uint32_t us) {
+    render_stats.frames++;
+    render_stats.last_us = us;
+    if (us > render_stats.max_us) {
+        render_stats.max_us = us;
+    }
+    render_stats_total_us += us;
+    render_stats.avg_us = (uint32_t)(render_stats_total_us / render_stats.frames);
+    if (render_stats.frames % render_stats_every == 0) {
+        DEBUG_PRINT("[RENDER] %u frames, avg %u us, max %u us", (unsigned)render_stats.frames,
+                    (unsigned)render_stats.avg_us, (unsigned)render_stats.max_us);
+    }
+}
+
+static void render_task_main(void *arg) {
+    (void)arg;
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        // held for the whole frame, SD access and image frees on the loop side wait for it
+        boot_tft_lock();
+        const terminal_snapshot_t *snap = terminal_snapshot_take();
+        if (snap != NULL) {
+            // from the snapshot to the last tile handed to panel_tx
+            int64_t start = esp_timer_get_time();
+            terminal_snapshot_apply(render_windows, snap);
+            terminal_render_frame(render_windows, &snap->env, snap->damaged, snap->full);
+            render_stats_add((uint32_t)(esp_timer_get_time() - start));
+        }
+        boot_tft_unlock();
+    }
+}
+
+int terminal_render_start_task(void) {
+    if (render_task != NULL) {
+        return 0;
+    }
+    if (terminal_snapshot_init() != 0) {
+        return -1;
+    }
+    TaskHandle_t task = NULL;
+    if (xTaskCreatePinnedToCore(render_task_main, "render", render_task_stack, NULL,
+                                render_task_priority, &task, render_task_core) != pdPASS) {
+        terminal_snapshot_free();
+        return -1;
+    }
+    render_task = task;
+    // the copies start out empty
+    terminal_render_request_all();
+    terminal_render_flush();
+    return 0;
+}
+
+void terminal_render_frame_stats(terminal_frame_stats *out) {
+    if (out != NULL) {
+        *out = render_stats;
+    }
+}
+#endif
+
+void terminal_render_request(terminal_state *term) {
+    if (term == NULL || term < terminals || term >= terminals + max_windows) {
+        return;
+    }
+    damaged_windows |= (uint8_t)(1u << (term - terminals));
+}
+
+void terminal_render_request_all(void) {
+    damaged_all = 1;
+}
+
+void terminal_render_request_windows(void) {
+    damaged_windows = (uint8_t)((1u << max_windows) - 1);
+}
+
+int terminal_render_pending(void) {
+    return damaged_all || damaged_windows != 0;
+}
+
+void terminal_render_flush(void) {
+    uint8_t windows = damaged_windows;
+    uint8_t all = damaged_all;
+    // cleared first, output written while this frame draws lands in the next one
+    damaged_windows = 0;
+    damaged_all = 0;
+#ifdef ARDUINO
+    if (render_task != NULL) {
+        terminal_snapshot_publish(windows, all);
+        xTaskNotifyGive(render_task);
+        return;
+    }
+    terminal_render_env_t env;
+    terminal_render_env_capture(&env);
+    boot_tft_lock();
+    terminal_render_frame(terminals, &env, windows, all);
+    boot_tft_unlock();
+#else
+    // host builds only draw once a test has set up the framebuffer emulator
+    if (boot_tft_host_active()) {
+        terminal_render_env_t env;
+        terminal_render_env_capture(&env);
+        terminal_render_frame(terminals, &env, windows, all);
+    }
+#endif
+}
+
+int terminal_render_tick(uint32_t now_ms) {
+    if (!terminal_render_pending() || (uint32_t)(now_ms - last_frame_ms) < terminal_frame_ms) {
+        return 0;
+    }
+    last_frame_ms = now_ms;
+    terminal_render_flush();
+    return 1;
+}
+
+void terminal_render_reset(void) {
+    damaged_windows = 0;
+    damaged_all = 0;
+    last_frame_ms = 0;
+}
+
+void terminal_render_lock(void) {
+#ifdef ARDUINO
+    boot_tft_lock();
+#endif
+}
+
+// anything the render task still has queued may point at what was just freed,
+// a new snapshot replaces it before the task can take the lock again
+void terminal_render_unlock(void) {
+#ifdef ARDUINO
+    if (render_task != NULL) {
+        terminal_render_flush();
+    }
+    boot_tft_unlock();
+#endif
+}
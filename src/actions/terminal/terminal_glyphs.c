@@ -0,0 +1,218 @@
+#include "terminal_glyphs.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef ARDUINO
+#include <esp_heap_caps.h>
+#endif
+
+// atlases are big (a zoom 3 atlas is ~80KB), keep them out of internal RAM when there is PSRAM
+static void *atlas_alloc(size_t bytes) {
+#ifdef ARDUINO
+    void *p = heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (p != NULL) {
+        return p;
+    }
+#endif
+    return malloc(bytes);
+}
+
+static void atlas_release(void *p) {
+#ifdef ARDUINO
+    heap_caps_free(p);
+#else
+    free(p);
+#endif
+}
+
+int glyph_atlas_build(glyph_atlas_t *atlas, uint8_t zoom, uint16_t fg, uint16_t bg,
+                      glyph_column_fn column, void *ctx) {
+    if (atlas == NULL || column == NULL || zoom < 1 || zoom > glyph_max_zoom) {
+        return -1;
+    }
+    int16_t gw = glyph_base_w * zoom;
+    int16_t gh = glyph_base_h * zoom;
+    size_t glyph_pixels = (size_t)gw * (size_t)gh;
+    uint16_t *pixels = (uint16_t*)atlas_alloc(glyph_pixels * glyph_count * sizeof(uint16_t));
+    if (pixels == NULL) {
+        return -1;
+    }
+
+    for (int g = 0; g < glyph_count; g++) {
+        uint16_t *glyph = pixels + (size_t)g * glyph_pixels;
+        char c = (char)(glyph_first + g);
+        for (int16_t col = 0; col < glyph_base_w; col++) {
+            uint8_t bits = col < glyph_base_w - 1 ? column(ctx, c, col) : 0;  // last column is spacing
+            for (int16_t row = 0; row < glyph_base_h; row++) {
+                uint16_t pix = (bits >> row) & 1 ? fg : bg;
+                // each font pixel becomes a zoom x zoom block
+                for (int16_t dy = 0; dy < zoom; dy++) {
+                    uint16_t *out = glyph + (size_t)(row * zoom + dy) * gw + col * zoom;
+                    for (int16_t dx = 0; dx < zoom; dx++) {
+                        out[dx] = pix;
+                    }
+                }
+            }
+        }
+    }
+
+    glyph_atlas_free(atlas);
+    atlas->zoom = zoom;
+    atlas->fg = fg;
+    atlas->bg = bg;
+    atlas->glyph_w = gw;
+    atlas->glyph_h = gh;
+    atlas->pixels = pixels;
+    return 0;
+}
+
+void glyph_atlas_free(glyph_atlas_t *atlas) {
+    if (atlas == NULL) {
+        return;
+    }
+    if (atlas->pixels != NULL) {
+        atlas_release(atlas->pixels);
+    }
+    memset(atlas, 0, sizeof(*atlas));
+}
+
+const uint16_t *glyph_atlas_glyph(const glyph_atlas_t *atlas, char c) {
+    if (atlas == NULL || atlas->pixels == NULL) {
+        return NULL;
+    }
+    unsigned char uc = (unsigned char)c;
+    if (uc < glyph_first || uc > glyph_last) {
+        uc = ' ';
+    }
+    return atlas->pixels + (size_t)(uc - glyph_first) * (size_t)atlas->glyph_w * (size_t)atlas->glyph_h;
+}
+
+size_t glyph_span_pixels(const glyph_atlas_t *atlas, int16_t len) {
+    if (atlas == NULL || len <= 0) {
+        return 0;
+    }
+    return (size_t)len * (size_t)atlas->glyph_w * (size_t)atlas->glyph_h;
+}
+
+size_t glyph_draw_span(const glyph_atlas_t *atlas, const glyph_target_t *target,
+                       int16_t x, int16_t y, const char *text, int16_t len,
+                       uint16_t *line_buf, size_t line_buf_pixels) {
+    if (atlas == NULL || atlas->pixels == NULL || target == NULL || target->push == NULL ||
+        text == NULL || line_buf == NULL || len <= 0) {
+        return 0;
+    }
+    size_t need = glyph_span_pixels(atlas, len);
+    if (need > line_buf_pixels) {
+        return 0;
+    }
+
+    // line buffer is the whole span row major, so each glyph row is one memcpy
+    int16_t gw = atlas->glyph_w;
+    int16_t gh = atlas->glyph_h;
+    int16_t span_w = gw * len;
+    size_t row_bytes = (size_t)gw * sizeof(uint16_t);
+    for (int16_t i = 0; i < len; i++) {
+        const uint16_t *glyph = glyph_atlas_glyph(atlas, text[i]);
+        uint16_t *dst = line_buf + (size_t)i * gw;
+        for (int16_t row = 0; row < gh; row++) {
+            memcpy(dst + (size_t)row * span_w, glyph + (size_t)row * gw, row_bytes);
+        }
+    }
+    target->push(target->ctx, x, y, span_w, gh, line_buf);
+    return need;
+}
+
+int glyph_caret_place(glyph_caret_t *caret, const glyph_target_t *target, const glyph_atlas_t *atlas,
+                      char c, int16_t x, int16_t cell_y, int16_t cell_w, int16_t cell_h, uint16_t color) {
+    if (caret == NULL || target == NULL || target->push == NULL || cell_w <= 0 || cell_h <= 0 ||
+        cell_w > glyph_caret_max_w) {
+        return -1;
+    }
+    const uint16_t *glyph = glyph_atlas_glyph(atlas, c);
+    if (glyph != NULL && (atlas->glyph_w != cell_w || atlas->glyph_h != cell_h)) {
+        return -1;
+    }
+    uint16_t bg = atlas != NULL ? atlas->bg : 0;
+    for (int16_t i = 0; i < cell_w; i++) {
+        caret->saved[i] = glyph != NULL ? glyph[(size_t)(cell_h - 1) * cell_w + i] : bg;
+    }
+    caret->x = x;
+    caret->y = cell_y + cell_h - 1;
+    caret->w = cell_w;
+    caret->color = color;
+    caret->shown = 0;
+    glyph_caret_show(caret, target);
+    return 0;
+}
+
+void glyph_caret_hide(glyph_caret_t *caret, const glyph_target_t *target) {
+    if (caret == NULL || target == NULL || target->push == NULL || caret->w <= 0 || !caret->shown) {
+        return;
+    }
+    target->push(target->ctx, caret->x, caret->y, caret->w, 1, caret->saved);
+    caret->shown = 0;
+}
+
+void glyph_caret_show(glyph_caret_t *caret, const glyph_target_t *target) {
+    if (caret == NULL || target == NULL || target->push == NULL || caret->w <= 0 || caret->shown) {
+        return;
+    }
+    uint16_t line[glyph_caret_max_w];
+    for (int16_t i = 0; i < caret->w; i++) {
+        line[i] = caret->color;
+    }
+    target->push(target->ctx, caret->x, caret->y, caret->w, 1, line);
+    caret->shown = 1;
+}
+
+void glyph_caret_forget(glyph_caret_t *caret) {
+    if (caret == NULL) {
+        return;
+    }
+    caret->w = 0;
+    caret->shown = 0;
+}
+
+int glyph_fb_init(glyph_fb_t *fb, int16_t width, int16_t height) {
+    if (fb == NULL || width <= 0 || height <= 0) {
+        return -1;
+    }
+    fb->pixels = (uint16_t*)calloc((size_t)width * (size_t)height, sizeof(uint16_t));
+    if (fb->pixels == NULL) {
+        return -1;
+    }
+    fb->width = width;
+    fb->height = height;
+    fb->pushes = 0;
+    return 0;
+}
+
+void glyph_fb_free(glyph_fb_t *fb) {
+    if (fb == NULL) {
+        return;
+    }
+    free(fb->pixels);
+    memset(fb, 0, sizeof(*fb));
+}
+
+void glyph_fb_push(void *ctx, int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *pixels) {
+    glyph_fb_t *fb = (glyph_fb_t*)ctx;
+    if (fb == NULL || fb->pixels == NULL || pixels == NULL) {
+        return;
+    }
+    fb->pushes++;
+    for (int16_t row = 0; row < h; row++) {
+        int16_t fy = y + row;
+        if (fy < 0 || fy >= fb->height) {
+            continue;
+        }
+        int16_t from = x < 0 ? -x : 0;
+        int16_t to = x + w > fb->width ? fb->width - x : w;
+        if (from >= to) {
+            continue;
+        }
+        memcpy(fb->pixels + (size_t)fy * fb->width + x + from,
+               pixels + (size_t)row * w + from,
+               (size_t)(to - from) * sizeof(uint16_t));
+    }
+}
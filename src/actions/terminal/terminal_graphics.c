@@ -1,302 +1,743 @@
 #include "terminal.h"
 #include "debug_helper.h"
-#include "login.h"
+#include "terminal_glyphs.h"
+#include "boot_splash.h"
+#include "vfs.h"
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
-extern int nano_is_active(void);
-extern int firstboot_is_active(void);
-extern int passwd_is_active(void);
-
-#ifdef ARDUINO
-    #include "boot_splash.h"
-    #include "vfs.h"
-    #include <stdlib.h>
-    extern void boot_tft_set_cursor(int16_t x, int16_t y);
-    extern void boot_tft_set_text_size(uint8_t size);
-    extern void boot_tft_set_text_color(uint16_t color, uint16_t bg);
-    extern void boot_tft_print(const char *str);
-    extern void boot_tft_fill_screen(uint16_t color);
-    extern void boot_tft_fill_rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
-    extern void boot_tft_draw_rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
-    #define COLOR_BLACK   0x0000
-    #define COLOR_WHITE  0xFFFF
-    #define COLOR_GRAY   0xC618
-
-    // external terminal state (defined in terminal.c)
-    extern terminal_state terminals[max_windows];
-    extern uint8_t selected_terminal;
-
-    static uint16_t *image_cache_pixels[max_windows] = {0};
-    static uint16_t image_cache_w[max_windows] = {0};
-    static uint16_t image_cache_h[max_windows] = {0};
-    static char image_cache_path[max_windows][256] = {{0}};
-    static uint16_t *image_src_pixels[max_windows] = {0};
-    static char image_src_path[max_windows][256] = {{0}};
-    static uint16_t *fastfetch_tint_pixels[max_windows] = {0};
-    static uint16_t fastfetch_tint_w[max_windows] = {0};
-    static uint16_t fastfetch_tint_h[max_windows] = {0};
-    static uint16_t fastfetch_tint_color[max_windows] = {0};
-
-    static int terminal_index(terminal_state *term) {
-        if (term == NULL) {
-            return -1;
-        }
-        for (uint8_t i = 0; i < max_windows; i++) {
-            if (&terminals[i] == term) {
-                return (int)i;
-            }
-        }
-        return -1;
+// panel primitives, boot_splash.cpp on ESP32, the framebuffer emulator in boot_tft_host.c on the host
+extern void boot_tft_set_cursor(int16_t x, int16_t y);
+extern void boot_tft_set_text_size(uint8_t size);
+extern void boot_tft_set_text_color(uint16_t color, uint16_t bg);
+extern void boot_tft_print(const char *str);
+extern void boot_tft_fill_screen(uint16_t color);
+extern void boot_tft_fill_rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+extern void boot_tft_draw_rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+extern uint8_t boot_tft_glyph_column(void *ctx, char c, int col);
+extern int16_t boot_tft_get_width(void);
+extern int16_t boot_tft_vscroll_lines(void);
+extern void boot_tft_vscroll_define(int16_t top, int16_t height);
+extern void boot_tft_vscroll_to(int16_t line);
+#define COLOR_BLACK   0x0000
+#define COLOR_WHITE  0xFFFF
+#define COLOR_GRAY   0xC618
+
+// external terminal state (defined in terminal.c)
+extern terminal_state terminals[max_windows];
+
+// the frame being drawn, either terminals[] itself or the render task's copy of it,
+// nothing below reads the shell's live state directly
+static terminal_state *frame_windows = terminals;
+static terminal_render_env_t frame_env = { 0, 1, 0, 0x0000 };
+
+static uint16_t *image_cache_pixels[max_windows] = {0};
+static uint16_t image_cache_w[max_windows] = {0};
+static uint16_t image_cache_h[max_windows] = {0};
+static char image_cache_path[max_windows][256] = {{0}};
+static uint16_t *image_src_pixels[max_windows] = {0};
+static char image_src_path[max_windows][256] = {{0}};
+static uint16_t *fastfetch_tint_pixels[max_windows] = {0};
+static uint16_t fastfetch_tint_w[max_windows] = {0};
+static uint16_t fastfetch_tint_h[max_windows] = {0};
+static uint16_t fastfetch_tint_color[max_windows] = {0};
+
+// text is blitted from pre-rasterized glyphs, one atlas per zoom for text and for hints
+static glyph_atlas_t glyph_atlases[glyph_max_zoom][2];
+static uint16_t *span_line = NULL;
+static size_t span_line_pixels = 0;
+
+// one caret per window, moving it restores the few pixels it covered instead of redrawing the cell
+static glyph_caret_t carets[max_windows];
+
+// the panel has one hardware scroll area, owned by at most one full width window
+// its text rows sit rotated by vscroll_offset lines in frame memory, so every draw into
+// them goes through terminal_vscroll_map()
+static terminal_state *vscroll_owner = NULL;
+static int16_t vscroll_top = 0;
+static int16_t vscroll_height = 0;
+static int16_t vscroll_offset = 0;
+
+// back to an unrotated panel, returns the owner if what it shows is now scrambled
+static terminal_state *vscroll_release(void) {
+    terminal_state *scrambled = NULL;
+    if (vscroll_owner != NULL && vscroll_offset != 0) {
+        boot_tft_vscroll_to(vscroll_top);
+        terminal_mark_dirty(vscroll_owner);
+        scrambled = vscroll_owner;
     }
+    vscroll_owner = NULL;
+    vscroll_height = 0;
+    vscroll_offset = 0;
+    return scrambled;
+}
 
-    static void tint_black_to_color(uint16_t *dst, const uint16_t *src,
-                                    size_t count, uint16_t active_color) {
-        if (dst == NULL || src == NULL) {
-            return;
-        }
-        for (size_t i = 0; i < count; i++) {
-            uint16_t pix = src[i];
-            dst[i] = (pix == 0x0000) ? active_color : pix;
+static int terminal_index(terminal_state *term) {
+    if (term == NULL) {
+        return -1;
+    }
+    // caches are per slot, whichever copy of the window asks
+    for (uint8_t i = 0; i < max_windows; i++) {
+        if (&terminals[i] == term || &frame_windows[i] == term) {
+            return (int)i;
         }
     }
+    return -1;
+}
 
-    void terminal_image_view_release(terminal_state *term) {
-        int idx = terminal_index(term);
-        if (idx < 0) {
-            return;
-        }
-        if (image_cache_pixels[idx] != NULL) {
-            free(image_cache_pixels[idx]);
-            image_cache_pixels[idx] = NULL;
-        }
-        image_cache_w[idx] = 0;
-        image_cache_h[idx] = 0;
-        image_cache_path[idx][0] = '\0';
-        if (image_src_pixels[idx] != NULL) {
-            free(image_src_pixels[idx]);
-            image_src_pixels[idx] = NULL;
-        }
-        image_src_path[idx][0] = '\0';
+static void tint_black_to_color(uint16_t *dst, const uint16_t *src,
+                                size_t count, uint16_t active_color) {
+    if (dst == NULL || src == NULL) {
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        uint16_t pix = src[i];
+        dst[i] = (pix == 0x0000) ? active_color : pix;
     }
+}
 
-    static uint16_t *load_rgb565_source_vfs(const char *path) {
-        if (path == NULL || path[0] == '\0') {
-            return NULL;
-        }
-        const int16_t src_w = 480;
-        const int16_t src_h = 320;
-        const size_t expected = (size_t)src_w * (size_t)src_h * 2;
-        ssize_t file_size = vfs_size(path);
-        if (file_size >= 0 && (size_t)file_size < expected) {
-            return NULL;
-        }
-        vfs_file_t *file = vfs_open(path, VFS_O_READ);
-        if (file == NULL) {
-            return NULL;
-        }
-        uint16_t *src = (uint16_t*)malloc(expected);
-        if (src == NULL) {
+void terminal_image_view_release(terminal_state *term) {
+    int idx = terminal_index(term);
+    if (idx < 0) {
+        return;
+    }
+    if (image_cache_pixels[idx] != NULL) {
+        free(image_cache_pixels[idx]);
+        image_cache_pixels[idx] = NULL;
+    }
+    image_cache_w[idx] = 0;
+    image_cache_h[idx] = 0;
+    image_cache_path[idx][0] = '\0';
+    if (image_src_pixels[idx] != NULL) {
+        free(image_src_pixels[idx]);
+        image_src_pixels[idx] = NULL;
+    }
+    image_src_path[idx][0] = '\0';
+}
+
+static uint16_t *load_rgb565_source_vfs(const char *path) {
+    if (path == NULL || path[0] == '\0') {
+        return NULL;
+    }
+    const int16_t src_w = 480;
+    const int16_t src_h = 320;
+    const size_t expected = (size_t)src_w * (size_t)src_h * 2;
+    ssize_t file_size = vfs_size(path);
+    if (file_size >= 0 && (size_t)file_size < expected) {
+        return NULL;
+    }
+    vfs_file_t *file = vfs_open(path, VFS_O_READ);
+    if (file == NULL) {
+        return NULL;
+    }
+    uint16_t *src = (uint16_t*)malloc(expected);
+    if (src == NULL) {
+        vfs_close(file);
+        return NULL;
+    }
+    const int16_t chunk_lines = 20;
+    size_t row_bytes = (size_t)src_w * 2;
+    int16_t y = 0;
+    while (y < src_h) {
+        int16_t lines = chunk_lines;
+        if (y + lines > src_h) {
+            lines = src_h - y;
+        }
+        size_t bytes = (size_t)lines * row_bytes;
+        uint8_t *dest_bytes = (uint8_t*)src + (size_t)y * row_bytes;
+        ssize_t read_bytes = vfs_read(file, dest_bytes, bytes);
+        if (read_bytes != (ssize_t)bytes) {
+            free(src);
             vfs_close(file);
             return NULL;
         }
+        y += lines;
+    }
+    vfs_close(file);
+    return src;
+}
+
+static uint16_t *scale_rgb565_from_source(const uint16_t *src, int16_t width, int16_t height) {
+    if (src == NULL || width <= 0 || height <= 0) {
+        return NULL;
+    }
+    const int16_t src_w = 480;
+    const int16_t src_h = 320;
+    uint16_t *dest = (uint16_t*)malloc((size_t)width * (size_t)height * 2);
+    if (dest == NULL) {
+        return NULL;
+    }
+    uint16_t *x_map = (uint16_t*)malloc((size_t)width * sizeof(uint16_t));
+    uint16_t *dest_sy = (uint16_t*)malloc((size_t)height * sizeof(uint16_t));
+    if (x_map == NULL || dest_sy == NULL) {
+        if (x_map) free(x_map);
+        if (dest_sy) free(dest_sy);
+        free(dest);
+        return NULL;
+    }
+    for (int16_t dx = 0; dx < width; dx++) {
+        x_map[dx] = (uint16_t)((dx * src_w) / width);
+    }
+    for (int16_t dy = 0; dy < height; dy++) {
+        dest_sy[dy] = (uint16_t)((dy * src_h) / height);
+    }
+    for (int16_t dy = 0; dy < height; dy++) {
+        const uint16_t *src_row = src + (size_t)dest_sy[dy] * (size_t)src_w;
+        uint16_t *out_row = dest + (size_t)dy * (size_t)width;
+        for (int16_t dx = 0; dx < width; dx++) {
+            out_row[dx] = src_row[x_map[dx]];
+        }
+    }
+    free(x_map);
+    free(dest_sy);
+    return dest;
+}
+
+static uint16_t *load_rgb565_scaled_vfs(const char *path, int16_t width, int16_t height) {
+    if (path == NULL || path[0] == '\0' || width <= 0 || height <= 0) {
+        return NULL;
+    }
+    const int16_t src_w = 480;
+    const int16_t src_h = 320;
+    const size_t expected = (size_t)src_w * (size_t)src_h * 2;
+    ssize_t file_size = vfs_size(path);
+    if (file_size >= 0 && (size_t)file_size < expected) {
+        return NULL;
+    }
+    
+    vfs_file_t *file = vfs_open(path, VFS_O_READ);
+    if (file == NULL) {
+        return NULL;
+    }
+    
+    size_t src_row_bytes = (size_t)src_w * 2;
+    uint16_t *dest = (uint16_t*)malloc((size_t)width * (size_t)height * 2);
+    if (dest == NULL) {
+        vfs_close(file);
+        return NULL;
+    }
+
+    if (width == src_w && height == src_h) {
         const int16_t chunk_lines = 20;
-        size_t row_bytes = (size_t)src_w * 2;
         int16_t y = 0;
         while (y < src_h) {
             int16_t lines = chunk_lines;
             if (y + lines > src_h) {
                 lines = src_h - y;
             }
-            size_t bytes = (size_t)lines * row_bytes;
-            uint8_t *dest_bytes = (uint8_t*)src + (size_t)y * row_bytes;
+            size_t bytes = (size_t)lines * src_row_bytes;
+            uint8_t *dest_bytes = (uint8_t*)dest + (size_t)y * src_row_bytes;
             ssize_t read_bytes = vfs_read(file, dest_bytes, bytes);
             if (read_bytes != (ssize_t)bytes) {
-                free(src);
+                free(dest);
                 vfs_close(file);
                 return NULL;
             }
             y += lines;
         }
         vfs_close(file);
-        return src;
+        return dest;
     }
 
-    static uint16_t *scale_rgb565_from_source(const uint16_t *src, int16_t width, int16_t height) {
-        if (src == NULL || width <= 0 || height <= 0) {
-            return NULL;
-        }
-        const int16_t src_w = 480;
-        const int16_t src_h = 320;
-        uint16_t *dest = (uint16_t*)malloc((size_t)width * (size_t)height * 2);
-        if (dest == NULL) {
-            return NULL;
-        }
-        uint16_t *x_map = (uint16_t*)malloc((size_t)width * sizeof(uint16_t));
-        uint16_t *dest_sy = (uint16_t*)malloc((size_t)height * sizeof(uint16_t));
-        if (x_map == NULL || dest_sy == NULL) {
-            if (x_map) free(x_map);
-            if (dest_sy) free(dest_sy);
+    const int16_t chunk_lines = 16;
+    size_t chunk_bytes = (size_t)chunk_lines * src_row_bytes;
+    uint8_t *src_chunk = (uint8_t*)malloc(chunk_bytes);
+    uint16_t *x_map = (uint16_t*)malloc((size_t)width * sizeof(uint16_t));
+    uint16_t *dest_sy = (uint16_t*)malloc((size_t)height * sizeof(uint16_t));
+    if (src_chunk == NULL || x_map == NULL || dest_sy == NULL) {
+        if (src_chunk) free(src_chunk);
+        if (x_map) free(x_map);
+        if (dest_sy) free(dest_sy);
+        free(dest);
+        vfs_close(file);
+        return NULL;
+    }
+
+    for (int16_t dx = 0; dx < width; dx++) {
+        x_map[dx] = (uint16_t)((dx * src_w) / width);
+    }
+    for (int16_t dy = 0; dy < height; dy++) {
+        dest_sy[dy] = (uint16_t)((dy * src_h) / height);
+    }
+    
+    for (int16_t sy_base = 0; sy_base < src_h; sy_base += chunk_lines) {
+        int16_t lines = chunk_lines;
+        if (sy_base + lines > src_h) {
+            lines = src_h - sy_base;
+        }
+        size_t bytes = (size_t)lines * src_row_bytes;
+        ssize_t read_bytes = vfs_read(file, src_chunk, bytes);
+        if (read_bytes != (ssize_t)bytes) {
+            free(src_chunk);
+            free(x_map);
+            free(dest_sy);
             free(dest);
+            vfs_close(file);
             return NULL;
         }
-        for (int16_t dx = 0; dx < width; dx++) {
-            x_map[dx] = (uint16_t)((dx * src_w) / width);
-        }
-        for (int16_t dy = 0; dy < height; dy++) {
-            dest_sy[dy] = (uint16_t)((dy * src_h) / height);
-        }
+        
         for (int16_t dy = 0; dy < height; dy++) {
-            const uint16_t *src_row = src + (size_t)dest_sy[dy] * (size_t)src_w;
+            int16_t sy = (int16_t)dest_sy[dy];
+            if (sy < sy_base || sy >= sy_base + lines) {
+                continue;
+            }
+            uint8_t *src_row = src_chunk + (size_t)(sy - sy_base) * src_row_bytes;
             uint16_t *out_row = dest + (size_t)dy * (size_t)width;
             for (int16_t dx = 0; dx < width; dx++) {
-                out_row[dx] = src_row[x_map[dx]];
+                size_t idx = (size_t)x_map[dx] * 2;
+                uint16_t pix = (uint16_t)src_row[idx] | ((uint16_t)src_row[idx + 1] << 8);
+                out_row[dx] = pix;
             }
         }
-        free(x_map);
-        free(dest_sy);
-        return dest;
     }
+    
+    free(src_chunk);
+    free(x_map);
+    free(dest_sy);
+    vfs_close(file);
+    return dest;
+}
 
-    static uint16_t *load_rgb565_scaled_vfs(const char *path, int16_t width, int16_t height) {
-        if (path == NULL || path[0] == '\0' || width <= 0 || height <= 0) {
-            return NULL;
+// render all active terminal windows
+// clears screen first to ensure clean rendering
+void terminal_render_all(void) {
+    vscroll_release();  // every window repaints below anyway
+    // clear screen first (background stays black)
+    boot_tft_fill_screen(COLOR_WHITE);
+    
+    // render each active terminal
+    for (uint8_t i = 0; i < max_windows; i++) {
+        if (frame_windows[i].active) {
+            terminal_mark_dirty(&frame_windows[i]);
+            terminal_render_window(&frame_windows[i]);
         }
-        const int16_t src_w = 480;
-        const int16_t src_h = 320;
-        const size_t expected = (size_t)src_w * (size_t)src_h * 2;
-        ssize_t file_size = vfs_size(path);
-        if (file_size >= 0 && (size_t)file_size < expected) {
-            return NULL;
+    }
+}
+
+void terminal_render_frame(terminal_state *windows, const terminal_render_env_t *env,
+                           uint8_t damaged, uint8_t full) {
+    if (windows == NULL || env == NULL) {
+        return;
+    }
+    if (windows != frame_windows && vscroll_owner != NULL) {
+        vscroll_release();  // owner points into the other copy
+    }
+    frame_windows = windows;
+    frame_env = *env;
+    terminal_damage_t exposed;
+    damaged |= terminal_compose_layout(windows, &exposed);
+    if (full) {
+        terminal_render_all();
+        return;
+    }
+    if (exposed.count > 0 && vscroll_owner != NULL) {
+        vscroll_release();  // the clears below are in screen lines
+    }
+    for (uint8_t i = 0; i < exposed.count; i++) {
+        boot_tft_fill_rect(exposed.rects[i].x, exposed.rects[i].y,
+                           exposed.rects[i].w, exposed.rects[i].h, COLOR_WHITE);
+    }
+    for (uint8_t i = 0; i < max_windows; i++) {
+        if ((damaged & (1u << i)) && windows[i].active) {
+            terminal_render_window(&windows[i]);
+        }
+    }
+}
+
+// render only a specific terminal (for incremental updates)
+void terminal_render_window_only(terminal_state *term) {
+    if (term == NULL || !term->active) return;
+    terminal_render_window(term);
+}
+
+// everything a row paint needs, worked out once per terminal_render_window()
+typedef struct {
+    uint16_t active_color;
+    int16_t char_width;
+    int16_t char_height;
+    int16_t base_text_x;
+    int16_t text_y;
+    int16_t base_max_cols;
+    int16_t max_rows;
+    int16_t start_row;
+    int16_t image_cols;
+    int16_t vs_height;  // 0 unless this window owns the hardware scroll area
+    uint8_t zoom;
+    uint8_t shell_input;  // cursor row is the shell prompt, not a fullscreen app
+} window_paint_t;
+
+static uint8_t row_in_fastfetch(const terminal_state *term, const window_paint_t *wp, int16_t row) {
+    if (!term->fastfetch_image_active || wp->image_cols <= 0 || term->fastfetch_line_count == 0) {
+        return 0;
+    }
+    uint8_t ff_start = term->fastfetch_start_row;
+    uint8_t ff_end = ff_start + term->fastfetch_line_count;
+    return row >= ff_start && row < ff_end;
+}
+
+// the cells one screen row should show, prompt row gets "$ " + input + gray suggestion
+static void build_row_cells(terminal_state *term, const window_paint_t *wp,
+                            int16_t current_row, terminal_cell_t *cells) {
+    int16_t cols = wp->base_max_cols;
+    for (int16_t col = 0; col < cols; col++) {
+        cells[col].ch = ' ';
+        cells[col].attr = terminal_attr_text;
+    }
+    int16_t text_col = 0;
+    if (row_in_fastfetch(term, wp, current_row)) {
+        for (int16_t col = 0; col < wp->image_cols && col < cols; col++) {
+            cells[col].ch = '\0';
+            cells[col].attr = terminal_attr_image;
+        }
+        text_col = wp->image_cols;
+    }
+    if (text_col >= cols) {
+        return;
+    }
+    terminal_cell_t *out = cells + text_col;
+    int16_t chars_to_show = cols - text_col;
+    if (chars_to_show > term->grid_cols) chars_to_show = term->grid_cols;
+    
+    // check if this is the current input line (where cursor is)
+    if (wp->shell_input && current_row == term->cursor_row) {
+        // render prompt + input_line for current input line
+        // this ensures the current input line shows exactly what's being typed
+        // first, clear the buffer positions for this line to remove old characters
+        char *line = terminal_row(term, current_row);
+        if (line != NULL) {
+            memset(line, ' ', term->grid_cols);
+            // now write the prompt and input_line to the buffer
+            line[0] = '$';
+            line[1] = ' ';
+            for (int16_t i = 0; i < term->input_len && (2 + i) < term->grid_cols; i++) {
+                line[2 + i] = term->input_line[i];
+            }
         }
         
-        vfs_file_t *file = vfs_open(path, VFS_O_READ);
-        if (file == NULL) {
-            return NULL;
+        int16_t base_len = 0;
+        out[base_len++].ch = '$';
+        if (base_len < chars_to_show) {
+            out[base_len++].ch = ' ';
+        }
+        for (int16_t i = 0; i < term->input_len && base_len < chars_to_show; i++) {
+            char c = term->input_line[i];
+            if (c < 32 || c >= 127) c = ' ';
+            out[base_len++].ch = c;
         }
         
-        size_t src_row_bytes = (size_t)src_w * 2;
-        uint16_t *dest = (uint16_t*)malloc((size_t)width * (size_t)height * 2);
-        if (dest == NULL) {
-            vfs_close(file);
+        // autocomplete suffix in gray
+        if (!term->autocomplete_applied &&
+            term->input_pos == term->input_len &&
+            term->autocomplete_len > 0) {
+            for (int16_t i = 0; i < term->autocomplete_len && base_len + i < chars_to_show; i++) {
+                out[base_len + i].ch = term->autocomplete_suffix[i];
+                out[base_len + i].attr = terminal_attr_hint;
+            }
+        }
+        return;
+    }
+
+    // normal buffer line, or a scrollback line when the view is paged back
+    const char *line = terminal_view_row(term, current_row);
+    if (line == NULL) {
+        return;
+    }
+    for (int16_t col = 0; col < chars_to_show; col++) {
+        char c = line[col];
+        if (c < 32 || c >= 127) c = ' ';  // sanitize
+        out[col].ch = c;
+    }
+}
+
+static void glyph_push_tft(void *ctx, int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *pixels) {
+    (void)ctx;
+    boot_tft_draw_rgb565(x, y, pixels, w, h);
+}
+
+// atlas for this zoom and colour, rebuilt when the theme colour changes
+static const glyph_atlas_t *glyph_atlas_for(uint8_t zoom, uint8_t attr, uint16_t fg) {
+    if (zoom < 1 || zoom > glyph_max_zoom) {
+        return NULL;
+    }
+    glyph_atlas_t *atlas = &glyph_atlases[zoom - 1][attr == terminal_attr_hint ? 1 : 0];
+    if (atlas->pixels == NULL || atlas->fg != fg || atlas->bg != COLOR_WHITE) {
+        if (glyph_atlas_build(atlas, zoom, fg, COLOR_WHITE, boot_tft_glyph_column, NULL) != 0) {
             return NULL;
         }
+    }
+    return atlas;
+}
 
-        if (width == src_w && height == src_h) {
-            const int16_t chunk_lines = 20;
-            int16_t y = 0;
-            while (y < src_h) {
-                int16_t lines = chunk_lines;
-                if (y + lines > src_h) {
-                    lines = src_h - y;
-                }
-                size_t bytes = (size_t)lines * src_row_bytes;
-                uint8_t *dest_bytes = (uint8_t*)dest + (size_t)y * src_row_bytes;
-                ssize_t read_bytes = vfs_read(file, dest_bytes, bytes);
-                if (read_bytes != (ssize_t)bytes) {
-                    free(dest);
-                    vfs_close(file);
-                    return NULL;
-                }
-                y += lines;
+static void draw_span(void *ctx, int16_t row, int16_t col, const char *text, int16_t len, uint8_t attr) {
+    const window_paint_t *wp = (const window_paint_t*)ctx;
+    int16_t x = wp->base_text_x + (col * wp->char_width);
+    int16_t y = terminal_vscroll_map(wp->text_y + (row * wp->char_height),
+                                     vscroll_top, wp->vs_height, vscroll_offset);
+    uint16_t fg = attr == terminal_attr_hint ? COLOR_GRAY : wp->active_color;
+
+    // whole span composed in one line buffer and pushed as one block
+    const glyph_atlas_t *atlas = glyph_atlas_for(wp->zoom, attr, fg);
+    if (atlas != NULL) {
+        size_t need = glyph_span_pixels(atlas, len);
+        if (need > span_line_pixels) {
+            uint16_t *grown = (uint16_t*)realloc(span_line, need * sizeof(uint16_t));
+            if (grown != NULL) {
+                span_line = grown;
+                span_line_pixels = need;
             }
-            vfs_close(file);
-            return dest;
-        }
-
-        const int16_t chunk_lines = 16;
-        size_t chunk_bytes = (size_t)chunk_lines * src_row_bytes;
-        uint8_t *src_chunk = (uint8_t*)malloc(chunk_bytes);
-        uint16_t *x_map = (uint16_t*)malloc((size_t)width * sizeof(uint16_t));
-        uint16_t *dest_sy = (uint16_t*)malloc((size_t)height * sizeof(uint16_t));
-        if (src_chunk == NULL || x_map == NULL || dest_sy == NULL) {
-            if (src_chunk) free(src_chunk);
-            if (x_map) free(x_map);
-            if (dest_sy) free(dest_sy);
-            free(dest);
-            vfs_close(file);
-            return NULL;
         }
+        glyph_target_t target = { glyph_push_tft, NULL };
+        if (glyph_draw_span(atlas, &target, x, y, text, len, span_line, span_line_pixels) > 0) {
+            return;
+        }
+    }
 
-        for (int16_t dx = 0; dx < width; dx++) {
-            x_map[dx] = (uint16_t)((dx * src_w) / width);
+    // no memory for the atlas, let Adafruit GFX draw it
+    boot_tft_set_cursor(x, y);
+    boot_tft_set_text_color(fg, COLOR_WHITE);
+    boot_tft_print(text);
+}
+
+// caret over the shadow's cell, the saved line comes from the same atlas the cell was drawn with
+static int place_caret(terminal_state *term, int idx, const window_paint_t *wp,
+                       int16_t x, int16_t cell_y) {
+    if (idx < 0) {
+        return 0;
+    }
+    glyph_caret_forget(&carets[idx]);
+    int16_t row = term->painted_cursor_row;
+    int16_t col = term->painted_cursor_col;
+    if (term->shadow == NULL || row < 0 || row >= term->shadow_rows || col < 0 || col >= term->shadow_cols) {
+        return 0;
+    }
+    const terminal_cell_t *cell = &term->shadow[(size_t)row * term->shadow_cols + col];
+    if (cell->attr != terminal_attr_text && cell->attr != terminal_attr_hint) {
+        return 0;  // image or unknown pixels underneath, nothing to save them from
+    }
+    uint16_t fg = cell->attr == terminal_attr_hint ? COLOR_GRAY : wp->active_color;
+    const glyph_atlas_t *atlas = glyph_atlas_for(wp->zoom, cell->attr, fg);
+    if (atlas == NULL) {
+        return 0;
+    }
+    glyph_target_t target = { glyph_push_tft, NULL };
+    return glyph_caret_place(&carets[idx], &target, atlas, cell->ch, x, cell_y,
+                             wp->char_width, wp->char_height, wp->active_color) == 0;
+}
+
+void terminal_render_caret(terminal_state *term, int visible) {
+    int idx = terminal_index(term);
+    if (idx < 0 || term == NULL || !term->active) {
+        return;
+    }
+    glyph_target_t target = { glyph_push_tft, NULL };
+    if (visible) {
+        glyph_caret_show(&carets[idx], &target);
+    } else {
+        glyph_caret_hide(&carets[idx], &target);
+    }
+}
+
+// render a single terminal window
+// after the first paint only rows marked dirty (or every row after a scroll) are rebuilt,
+// and of those only the cells that differ from the shadow are drawn, in as few spans as possible
+void terminal_render_window(terminal_state *term) {
+    if (term == NULL || !term->active) return;
+    
+    int16_t border = 2;
+    int16_t padding = 3;
+    window_paint_t wp;
+    wp.active_color = frame_env.active_color;
+    int16_t font_size = frame_env.zoom;
+    if (font_size < 1) font_size = 1;
+    wp.char_width = glyph_base_w * font_size;
+    wp.char_height = glyph_base_h * font_size;
+    wp.zoom = (uint8_t)font_size;
+    
+    int idx = terminal_index(term);
+    if (idx >= 0 && !term->fastfetch_image_active && fastfetch_tint_pixels[idx] != NULL) {
+        free(fastfetch_tint_pixels[idx]);
+        fastfetch_tint_pixels[idx] = NULL;
+        fastfetch_tint_w[idx] = 0;
+        fastfetch_tint_h[idx] = 0;
+        fastfetch_tint_color[idx] = 0;
+    }
+    
+    if (term->image_view_active && term->image_view_path[0] != '\0') {
+        if (vscroll_owner == term) {
+            vscroll_release();
         }
-        for (int16_t dy = 0; dy < height; dy++) {
-            dest_sy[dy] = (uint16_t)((dy * src_h) / height);
+        if (idx >= 0) {
+            glyph_caret_forget(&carets[idx]);
         }
-        
-        for (int16_t sy_base = 0; sy_base < src_h; sy_base += chunk_lines) {
-            int16_t lines = chunk_lines;
-            if (sy_base + lines > src_h) {
-                lines = src_h - sy_base;
-            }
-            size_t bytes = (size_t)lines * src_row_bytes;
-            ssize_t read_bytes = vfs_read(file, src_chunk, bytes);
-            if (read_bytes != (ssize_t)bytes) {
-                free(src_chunk);
-                free(x_map);
-                free(dest_sy);
-                free(dest);
-                vfs_close(file);
-                return NULL;
-            }
-            
-            for (int16_t dy = 0; dy < height; dy++) {
-                int16_t sy = (int16_t)dest_sy[dy];
-                if (sy < sy_base || sy >= sy_base + lines) {
-                    continue;
+        // draw window border, the image covers the rest
+        for (int i = 0; i < border; i++) {
+            boot_tft_draw_rect(term->x + i, term->y + i,
+                              term->width - (i * 2),
+                              term->height - (i * 2),
+                              wp.active_color);
+        }
+        boot_tft_fill_rect(term->x + border, term->y + border,
+                          term->width - (border * 2),
+                          term->height - (border * 2),
+                          COLOR_WHITE);
+        int16_t image_x = term->x + border;
+        int16_t image_y = term->y + border;
+        int16_t image_w = term->width - (border * 2);
+        int16_t image_h = term->height - (border * 2);
+        if (image_w > 0 && image_h > 0) {
+            if (idx >= 0) {
+                uint8_t path_match = (image_cache_path[idx][0] != '\0' &&
+                                      strcmp(image_cache_path[idx], term->image_view_path) == 0);
+                if (image_cache_pixels[idx] == NULL ||
+                    image_cache_w[idx] != (uint16_t)image_w ||
+                    image_cache_h[idx] != (uint16_t)image_h ||
+                    !path_match) {
+                    if (image_cache_pixels[idx] != NULL) {
+                        free(image_cache_pixels[idx]);
+                        image_cache_pixels[idx] = NULL;
+                    }
+                    image_cache_w[idx] = 0;
+                    image_cache_h[idx] = 0;
+                    image_cache_path[idx][0] = '\0';
+                    if (!path_match && image_src_pixels[idx] != NULL) {
+                        free(image_src_pixels[idx]);
+                        image_src_pixels[idx] = NULL;
+                        image_src_path[idx][0] = '\0';
+                    }
+                    if (image_src_pixels[idx] == NULL) {
+                        image_src_pixels[idx] = load_rgb565_source_vfs(term->image_view_path);
+                        if (image_src_pixels[idx] != NULL) {
+                            snprintf(image_src_path[idx], sizeof(image_src_path[idx]), "%s", term->image_view_path);
+                        }
+                    }
+                    if (image_src_pixels[idx] != NULL) {
+                        image_cache_pixels[idx] = scale_rgb565_from_source(
+                            image_src_pixels[idx], image_w, image_h);
+                    } else {
+                        image_cache_pixels[idx] = load_rgb565_scaled_vfs(
+                            term->image_view_path, image_w, image_h);
+                    }
+                    if (image_cache_pixels[idx] != NULL) {
+                        image_cache_w[idx] = (uint16_t)image_w;
+                        image_cache_h[idx] = (uint16_t)image_h;
+                        snprintf(image_cache_path[idx], sizeof(image_cache_path[idx]), "%s", term->image_view_path);
+                    }
                 }
-                uint8_t *src_row = src_chunk + (size_t)(sy - sy_base) * src_row_bytes;
-                uint16_t *out_row = dest + (size_t)dy * (size_t)width;
-                for (int16_t dx = 0; dx < width; dx++) {
-                    size_t idx = (size_t)x_map[dx] * 2;
-                    uint16_t pix = (uint16_t)src_row[idx] | ((uint16_t)src_row[idx + 1] << 8);
-                    out_row[dx] = pix;
+                if (image_cache_pixels[idx] != NULL) {
+                    boot_tft_draw_rgb565(image_x, image_y, image_cache_pixels[idx],
+                                         (int16_t)image_cache_w[idx],
+                                         (int16_t)image_cache_h[idx]);
+                } else {
+                    boot_draw_rgb565_scaled(term->image_view_path, image_x, image_y, image_w, image_h);
                 }
+            } else {
+                boot_draw_rgb565_scaled(term->image_view_path, image_x, image_y, image_w, image_h);
             }
         }
-        
-        free(src_chunk);
-        free(x_map);
-        free(dest_sy);
-        vfs_close(file);
-        return dest;
+        // whatever was under the image has to come back in full
+        terminal_mark_dirty(term);
+        return;
     }
-
-    // render all active terminal windows
-    // clears screen first to ensure clean rendering
-    void terminal_render_all(void) {
-        uint16_t active_color = terminal_get_active_color();
-        // clear screen first (background stays black)
-        boot_tft_fill_screen(COLOR_WHITE);
-        
-        // render each active terminal
-        for (uint8_t i = 0; i < max_windows; i++) {
-            if (terminals[i].active) {
-                terminal_render_window(&terminals[i]);
-            }
+    
+    wp.image_cols = 0;
+    const int16_t image_padding_cols = 2;
+    uint8_t modes = frame_env.modes;
+    uint8_t fastfetch_visible = !(modes & terminal_mode_nano) &&
+        term->fastfetch_image_active && term->fastfetch_image_pixels != NULL &&
+        term->fastfetch_image_w > 0 && term->fastfetch_image_h > 0 &&
+        term->fastfetch_line_count > 0;
+    if (fastfetch_visible) {
+        wp.image_cols = (term->fastfetch_image_w + wp.char_width - 1) / wp.char_width;
+        wp.image_cols += image_padding_cols;
+    }
+    
+    // calculate how many characters fit in window
+    wp.base_text_x = term->x + border + padding;
+    wp.text_y = term->y + border + padding;
+    wp.base_max_cols = (term->width - (border * 2) - (padding * 2)) / wp.char_width;
+    wp.max_rows = (term->height - (border * 2) - (padding * 2)) / wp.char_height;
+    wp.shell_input = modes == 0;
+    
+    // render terminal buffer (simplified - just show visible portion)
+    wp.start_row = 0;
+    if (!(modes & terminal_mode_nano)) {
+        if (term->cursor_row >= wp.max_rows) {
+            wp.start_row = term->cursor_row - wp.max_rows + 1;
+        }
+        // paged back, rows above the grid come from the scrollback
+        wp.start_row -= term->view_offset;
+        if (wp.start_row < -(int16_t)term->scrollback_count) {
+            wp.start_row = -(int16_t)term->scrollback_count;
         }
     }
 
-    // render only a specific terminal (for incremental updates)
-    void terminal_render_window_only(terminal_state *term) {
-        if (term == NULL || !term->active) return;
-        terminal_render_window(term);
+    uint8_t selected = (terminal_index(term) == frame_env.selected && !(modes & terminal_mode_login));
+    uint8_t mode = (uint8_t)(modes | (selected ? terminal_mode_selected : 0));
+    const uint16_t *image = fastfetch_visible ? term->fastfetch_image_pixels : NULL;
+    // selection only moves the cursor, handled by the diff below
+    uint8_t full = !term->painted_valid || (term->painted_mode & ~terminal_mode_selected) != modes ||
+                   term->painted_image != image ||
+                   (image != NULL && term->painted_start_row != wp.start_row);
+    // a scroll without an image on screen is just another diff against the shadow
+    uint8_t all_rows = full || term->painted_start_row != wp.start_row;
+    
+    if (wp.base_max_cols <= 0 || wp.max_rows <= 0 ||
+        terminal_shadow_prepare(term, wp.max_rows, wp.base_max_cols, (uint8_t)font_size) != 0) {
+        full = 1;  // new grid (zoom or resize) or no memory for one
+        all_rows = 1;
     }
 
-    // render a single terminal window
-    void terminal_render_window(terminal_state *term) {
-        if (term == NULL || !term->active) return;
-        
-        int16_t border = 2;
-        int16_t padding = 3;
-        uint16_t active_color = terminal_get_active_color();
-        int16_t font_size = terminal_get_zoom();
-        if (font_size < 1) font_size = 1;
-        int16_t char_width = 6 * font_size;
-        int16_t char_height = 8 * font_size;
-        
+    if (vscroll_owner != NULL && (full || !vscroll_owner->active)) {
+        // full paints assume an unrotated panel, a scrambled owner repaints right after
+        terminal_state *scrambled = vscroll_release();
+        if (scrambled == term) {
+            full = 1;
+            all_rows = 1;
+        } else if (scrambled != NULL && scrambled->active) {
+            terminal_render_window(scrambled);
+        }
+    }
+
+    // text moved up by a few rows in a full width window: rotate the panel's scroll area
+    // instead of redrawing it, then only the rows that came in at the bottom differ
+    // (in landscape the panel can only scroll sideways, boot_tft_vscroll_lines() is 0 and this never runs)
+    int16_t area_top = wp.text_y;
+    int16_t area_height = wp.max_rows * wp.char_height;
+    int16_t moved = (int16_t)(uint16_t)((term->scrolled_rows + wp.start_row) -
+                                        (term->painted_scrolled_rows + term->painted_start_row));
+    if (!full && image == NULL && term->shadow != NULL && moved > 0 && moved < wp.max_rows &&
+        term->x == 0 && term->width == boot_tft_get_width() &&
+        area_top + area_height <= boot_tft_vscroll_lines()) {
+        if (vscroll_owner != term || vscroll_top != area_top || vscroll_height != area_height) {
+            terminal_state *scrambled = vscroll_release();
+            boot_tft_vscroll_define(area_top, area_height);
+            vscroll_owner = term;
+            vscroll_top = area_top;
+            vscroll_height = area_height;
+            if (scrambled != NULL && scrambled != term && scrambled->active) {
+                terminal_render_window(scrambled);
+            }
+        }
+        vscroll_offset = (int16_t)((vscroll_offset + moved * wp.char_height) % vscroll_height);
+        boot_tft_vscroll_to(vscroll_top + vscroll_offset);
+        terminal_shadow_scroll(term, moved);
+        if (idx >= 0) {
+            glyph_caret_forget(&carets[idx]);  // its underline moved with the text, the diff handles it
+        }
+        if (term->painted_cursor_row >= 0) {
+            term->painted_cursor_row -= moved;
+            if (term->painted_cursor_row < 0) {
+                term->painted_cursor_row = -1;
+            }
+        }
+        all_rows = 1;
+    }
+    wp.vs_height = vscroll_owner == term ? vscroll_height : 0;
+    
+    if (full) {
         // draw window border (highlight selected without new color)
-        uint16_t border_color = active_color;
+        uint16_t border_color = wp.active_color;
         for (int i = 0; i < border; i++) {
             boot_tft_draw_rect(term->x + i, term->y + i, 
                               term->width - (i * 2), 
@@ -305,316 +746,149 @@ extern int passwd_is_active(void);
         }
         // selection is indicated by cursor only
         
-        // fill window background
+        // fill window background, the panel now shows blank cells everywhere
         boot_tft_fill_rect(term->x + border, term->y + border, 
                           term->width - (border * 2), 
                           term->height - (border * 2), 
                           COLOR_WHITE);
-        
-        int idx = terminal_index(term);
-        if (idx >= 0 && !term->fastfetch_image_active && fastfetch_tint_pixels[idx] != NULL) {
-            free(fastfetch_tint_pixels[idx]);
-            fastfetch_tint_pixels[idx] = NULL;
-            fastfetch_tint_w[idx] = 0;
-            fastfetch_tint_h[idx] = 0;
-            fastfetch_tint_color[idx] = 0;
-        }
-        
-        if (term->image_view_active && term->image_view_path[0] != '\0') {
-            int16_t image_x = term->x + border;
-            int16_t image_y = term->y + border;
-            int16_t image_w = term->width - (border * 2);
-            int16_t image_h = term->height - (border * 2);
-            if (image_w > 0 && image_h > 0) {
-                if (idx >= 0) {
-                    uint8_t path_match = (image_cache_path[idx][0] != '\0' &&
-                                          strcmp(image_cache_path[idx], term->image_view_path) == 0);
-                    if (image_cache_pixels[idx] == NULL ||
-                        image_cache_w[idx] != (uint16_t)image_w ||
-                        image_cache_h[idx] != (uint16_t)image_h ||
-                        !path_match) {
-                        if (image_cache_pixels[idx] != NULL) {
-                            free(image_cache_pixels[idx]);
-                            image_cache_pixels[idx] = NULL;
-                        }
-                        image_cache_w[idx] = 0;
-                        image_cache_h[idx] = 0;
-                        image_cache_path[idx][0] = '\0';
-                        if (!path_match && image_src_pixels[idx] != NULL) {
-                            free(image_src_pixels[idx]);
-                            image_src_pixels[idx] = NULL;
-                            image_src_path[idx][0] = '\0';
-                        }
-                        if (image_src_pixels[idx] == NULL) {
-                            image_src_pixels[idx] = load_rgb565_source_vfs(term->image_view_path);
-                            if (image_src_pixels[idx] != NULL) {
-                                strncpy(image_src_path[idx], term->image_view_path,
-                                        sizeof(image_src_path[idx]) - 1);
-                                image_src_path[idx][sizeof(image_src_path[idx]) - 1] = '\0';
-                            }
-                        }
-                        if (image_src_pixels[idx] != NULL) {
-                            image_cache_pixels[idx] = scale_rgb565_from_source(
-                                image_src_pixels[idx], image_w, image_h);
-                        } else {
-                            image_cache_pixels[idx] = load_rgb565_scaled_vfs(
-                                term->image_view_path, image_w, image_h);
-                        }
-                        if (image_cache_pixels[idx] != NULL) {
-                            image_cache_w[idx] = (uint16_t)image_w;
-                            image_cache_h[idx] = (uint16_t)image_h;
-                            strncpy(image_cache_path[idx], term->image_view_path,
-                                    sizeof(image_cache_path[idx]) - 1);
-                            image_cache_path[idx][sizeof(image_cache_path[idx]) - 1] = '\0';
-                        }
-                    }
-                    if (image_cache_pixels[idx] != NULL) {
-                        boot_tft_draw_rgb565(image_x, image_y, image_cache_pixels[idx],
-                                             (int16_t)image_cache_w[idx],
-                                             (int16_t)image_cache_h[idx]);
-                    } else {
-                        boot_draw_rgb565_scaled(term->image_view_path, image_x, image_y, image_w, image_h);
-                    }
-                } else {
-                    boot_draw_rgb565_scaled(term->image_view_path, image_x, image_y, image_w, image_h);
-                }
-            }
-            return;
+        terminal_shadow_fill(term, ' ', terminal_attr_text);
+        if (idx >= 0) {
+            glyph_caret_forget(&carets[idx]);
         }
-        
-        int16_t image_cols = 0;
-        const int16_t image_padding_cols = 2;
-        if (!nano_is_active() &&
-            term->fastfetch_image_active && term->fastfetch_image_pixels != NULL &&
-            term->fastfetch_image_w > 0 && term->fastfetch_image_h > 0 &&
-            term->fastfetch_line_count > 0) {
-            image_cols = (term->fastfetch_image_w + char_width - 1) / char_width;
-            image_cols += image_padding_cols;
-        }
-        
-        // set text properties
-        boot_tft_set_text_size(font_size);
-        boot_tft_set_text_color(active_color, COLOR_WHITE);
-        
-        // calculate how many characters fit in window
-        int16_t base_text_x = term->x + border + padding;
-        int16_t text_y = term->y + border + padding;
-        int16_t base_max_cols = (term->width - (border * 2) - (padding * 2)) / char_width;
-        int16_t max_rows = (term->height - (border * 2) - (padding * 2)) / char_height;
-        
-        // render terminal buffer (simplified - just show visible portion)
-        int16_t start_row = 0;
-        if (!nano_is_active()) {
-            if (term->cursor_row >= max_rows) {
-                start_row = term->cursor_row - max_rows + 1;
+    }
+    
+    if (full && fastfetch_visible) {
+        int16_t ff_start = term->fastfetch_start_row;
+        int16_t ff_end = ff_start + term->fastfetch_line_count;
+        if (ff_end > wp.start_row && ff_start < wp.start_row + wp.max_rows) {
+            int16_t visible_start = ff_start;
+            if (visible_start < wp.start_row) {
+                visible_start = wp.start_row;
             }
-        }
-
-            if (!nano_is_active() &&
-                term->fastfetch_image_active && term->fastfetch_image_pixels != NULL &&
-            term->fastfetch_image_w > 0 && term->fastfetch_image_h > 0 &&
-            term->fastfetch_line_count > 0) {
-            int16_t ff_start = term->fastfetch_start_row;
-            int16_t ff_end = ff_start + term->fastfetch_line_count;
-            if (ff_end > start_row && ff_start < start_row + max_rows) {
-                int16_t visible_start = ff_start;
-                if (visible_start < start_row) {
-                    visible_start = start_row;
+            int16_t y_offset = (visible_start - wp.start_row) * wp.char_height;
+            const uint16_t *src_pixels = term->fastfetch_image_pixels;
+            uint16_t *draw_pixels = term->fastfetch_image_pixels;
+            if (idx >= 0) {
+                size_t pixel_count = (size_t)term->fastfetch_image_w * (size_t)term->fastfetch_image_h;
+                if (fastfetch_tint_pixels[idx] == NULL ||
+                    fastfetch_tint_w[idx] != term->fastfetch_image_w ||
+                    fastfetch_tint_h[idx] != term->fastfetch_image_h) {
+                    free(fastfetch_tint_pixels[idx]);
+                    fastfetch_tint_pixels[idx] = (uint16_t*)malloc(pixel_count * sizeof(uint16_t));
+                    fastfetch_tint_w[idx] = term->fastfetch_image_w;
+                    fastfetch_tint_h[idx] = term->fastfetch_image_h;
+                    fastfetch_tint_color[idx] = 0;
                 }
-                int16_t y_offset = (visible_start - start_row) * char_height;
-                const uint16_t *src_pixels = term->fastfetch_image_pixels;
-                uint16_t *draw_pixels = term->fastfetch_image_pixels;
-                if (idx >= 0) {
-                    size_t pixel_count = (size_t)term->fastfetch_image_w * (size_t)term->fastfetch_image_h;
-                    if (fastfetch_tint_pixels[idx] == NULL ||
-                        fastfetch_tint_w[idx] != term->fastfetch_image_w ||
-                        fastfetch_tint_h[idx] != term->fastfetch_image_h) {
-                        free(fastfetch_tint_pixels[idx]);
-                        fastfetch_tint_pixels[idx] = (uint16_t*)malloc(pixel_count * sizeof(uint16_t));
-                        fastfetch_tint_w[idx] = term->fastfetch_image_w;
-                        fastfetch_tint_h[idx] = term->fastfetch_image_h;
-                        fastfetch_tint_color[idx] = 0;
-                    }
-                    if (fastfetch_tint_pixels[idx] != NULL &&
-                        fastfetch_tint_color[idx] != active_color) {
-                        tint_black_to_color(fastfetch_tint_pixels[idx], src_pixels,
-                                            pixel_count, active_color);
-                        fastfetch_tint_color[idx] = active_color;
-                    }
-                    if (fastfetch_tint_pixels[idx] != NULL &&
-                        fastfetch_tint_color[idx] == active_color) {
-                        draw_pixels = fastfetch_tint_pixels[idx];
-                    }
+                if (fastfetch_tint_pixels[idx] != NULL &&
+                    fastfetch_tint_color[idx] != wp.active_color) {
+                    tint_black_to_color(fastfetch_tint_pixels[idx], src_pixels,
+                                        pixel_count, wp.active_color);
+                    fastfetch_tint_color[idx] = wp.active_color;
                 }
-                boot_tft_draw_rgb565(term->x + border + padding,
-                                     term->y + border + padding + y_offset,
-                                     draw_pixels,
-                                     term->fastfetch_image_w,
-                                     term->fastfetch_image_h);
-            }
-        }
-        
-        for (int16_t row = 0; row < max_rows && (start_row + row) < terminal_rows; row++) {
-            int16_t y_pos = text_y + (row * char_height);
-            int16_t current_row = start_row + row;
-            uint8_t in_fastfetch = 0;
-            if (term->fastfetch_image_active && image_cols > 0 &&
-                term->fastfetch_line_count > 0) {
-                uint8_t ff_start = term->fastfetch_start_row;
-                uint8_t ff_end = ff_start + term->fastfetch_line_count;
-                if (current_row >= ff_start && current_row < ff_end) {
-                    in_fastfetch = 1;
+                if (fastfetch_tint_pixels[idx] != NULL &&
+                    fastfetch_tint_color[idx] == wp.active_color) {
+                    draw_pixels = fastfetch_tint_pixels[idx];
                 }
             }
-            int16_t row_text_x = base_text_x + (in_fastfetch ? (image_cols * char_width) : 0);
-            int16_t row_max_cols = base_max_cols;
-            if (in_fastfetch && image_cols > 0) {
-                if (row_max_cols > image_cols) {
-                    row_max_cols -= image_cols;
-                } else {
-                    row_max_cols = 0;
+            boot_tft_draw_rgb565(term->x + border + padding,
+                                 term->y + border + padding + y_offset,
+                                 draw_pixels,
+                                 term->fastfetch_image_w,
+                                 term->fastfetch_image_h);
+
+            // cells under the bitmap no longer show text
+            int16_t image_rows = (term->fastfetch_image_h + wp.char_height - 1) / wp.char_height;
+            int16_t image_cells = (term->fastfetch_image_w + wp.char_width - 1) / wp.char_width;
+            for (int16_t r = 0; r < image_rows; r++) {
+                for (int16_t c = 0; c < image_cells; c++) {
+                    terminal_shadow_forget_cell(term, (visible_start - wp.start_row) + r, c);
                 }
             }
-            boot_tft_set_cursor(row_text_x, y_pos);
-            
-            // check if this is the current input line (where cursor is)
-            if (!nano_is_active() && !firstboot_is_active() &&
-                !passwd_is_active() && !login_is_active() &&
-                current_row == term->cursor_row) {
-                // render prompt + input_line for current input line
-                // this ensures the current input line shows exactly what's being typed
-                // first, clear the buffer positions for this line to remove old characters
-                int16_t line_start = current_row * terminal_cols;
-                for (int16_t col = 0; col < terminal_cols; col++) {
-                    if (line_start + col < terminal_buffer_size) {
-                        term->buffer[line_start + col] = ' ';
-                    }
-                }
-                
-                // now write the prompt and input_line to the buffer
-                if (line_start + 0 < terminal_buffer_size) term->buffer[line_start + 0] = '$';
-                if (line_start + 1 < terminal_buffer_size) term->buffer[line_start + 1] = ' ';
-                for (int16_t i = 0; i < term->input_len && (2 + i) < terminal_cols; i++) {
-                    int16_t buf_pos = line_start + 2 + i;
-                    if (buf_pos < terminal_buffer_size) {
-                        term->buffer[buf_pos] = term->input_line[i];
-                    }
-                }
-                
-                // render prompt + input, then autocomplete suffix in gray
-                int16_t chars_to_show = row_max_cols;
-                if (chars_to_show > terminal_cols) chars_to_show = terminal_cols;
-                if (chars_to_show > 0) {
-                    char base_line[terminal_cols + 1];
-                    int16_t base_len = 0;
-                    base_line[base_len++] = '$';
-                    if (base_len < chars_to_show) {
-                        base_line[base_len++] = ' ';
-                    }
-                    for (int16_t i = 0;
-                         i < term->input_len && base_len < chars_to_show;
-                         i++) {
-                        char c = term->input_line[i];
-                        if (c < 32 || c >= 127) c = ' ';
-                        base_line[base_len++] = c;
-                    }
-                    base_line[base_len] = '\0';
-                    
-                    boot_tft_set_text_color(active_color, COLOR_WHITE);
-                    boot_tft_print(base_line);
-                    
-                    int16_t suffix_len = 0;
-                    if (!term->autocomplete_applied &&
-                        term->input_pos == term->input_len &&
-                        term->autocomplete_len > 0 &&
-                        base_len < chars_to_show) {
-                        int16_t max_suffix = chars_to_show - base_len;
-                        suffix_len = term->autocomplete_len;
-                        if (suffix_len > max_suffix) {
-                            suffix_len = max_suffix;
-                        }
-                        if (suffix_len > 0) {
-                            char suffix[terminal_cols + 1];
-                            memcpy(suffix, term->autocomplete_suffix, (size_t)suffix_len);
-                            suffix[suffix_len] = '\0';
-                            boot_tft_set_cursor(row_text_x + (base_len * char_width), y_pos);
-                            boot_tft_set_text_color(COLOR_GRAY, COLOR_WHITE);
-                            boot_tft_print(suffix);
-                            boot_tft_set_text_color(active_color, COLOR_WHITE);
-                        }
-                    }
-                    
-                    int16_t remaining = chars_to_show - base_len - suffix_len;
-                    if (remaining > 0) {
-                        char spaces[terminal_cols + 1];
-                        if (remaining > terminal_cols) {
-                            remaining = terminal_cols;
-                        }
-                        memset(spaces, ' ', (size_t)remaining);
-                        spaces[remaining] = '\0';
-                        boot_tft_set_cursor(row_text_x + ((base_len + suffix_len) * char_width), y_pos);
-                        boot_tft_set_text_color(active_color, COLOR_WHITE);
-                        boot_tft_print(spaces);
-                    }
-                }
+        }
+    }
+
+    // the old underline sits in a cell that may not have changed otherwise, put back what was
+    // under it, or if that wasn't saved redraw the cell with its row
+    glyph_target_t tft_target = { glyph_push_tft, NULL };
+    int16_t old_cursor_row = -1;
+    if (!full && term->painted_cursor_row >= 0) {
+        if (idx >= 0 && carets[idx].w > 0) {
+            glyph_caret_hide(&carets[idx], &tft_target);
+        } else {
+            old_cursor_row = term->painted_cursor_row;
+            terminal_shadow_forget_cell(term, term->painted_cursor_row, term->painted_cursor_col);
+        }
+    }
+    
+    // set text properties
+    boot_tft_set_text_size(font_size);
+    
+    if (wp.base_max_cols > 0) {
+        terminal_cell_t cells[wp.base_max_cols];
+        // rows past the grid (the cursor waiting below the last row) are built blank, a paged
+        // back view may have left text there
+        for (int16_t row = 0; row < wp.max_rows; row++) {
+            int16_t current_row = wp.start_row + row;
+            if (!all_rows && row != old_cursor_row && !terminal_row_is_dirty(term, current_row)) {
+                continue;
+            }
+            build_row_cells(term, &wp, current_row, cells);
+            if (term->shadow != NULL) {
+                terminal_shadow_diff_row(term, row, cells, draw_span, &wp);
             } else {
-                // render normal buffer line
-                char line[terminal_cols + 1];
-                int16_t line_start = current_row * terminal_cols;
-                int16_t chars_to_show = row_max_cols;
-                if (chars_to_show > terminal_cols) chars_to_show = terminal_cols;
-                
-                for (int16_t col = 0; col < chars_to_show; col++) {
-                    if (line_start + col < terminal_buffer_size) {
-                        char c = term->buffer[line_start + col];
-                        if (c < 32 || c >= 127) c = ' ';  // sanitize
-                        line[col] = c;
-                    } else {
-                        line[col] = ' ';
+                // no shadow, draw the row as one span per attr
+                int16_t col = 0;
+                while (col < wp.base_max_cols) {
+                    int16_t end = col;
+                    char text[wp.base_max_cols + 1];
+                    while (end < wp.base_max_cols && cells[end].attr == cells[col].attr) {
+                        text[end - col] = cells[end].ch;
+                        end++;
                     }
+                    text[end - col] = '\0';
+                    if (cells[col].attr != terminal_attr_image) {
+                        draw_span(&wp, row, col, text, end - col, cells[col].attr);
+                    }
+                    col = end;
                 }
-                line[chars_to_show] = '\0';
-                
-                // print line (truncate if needed)
-                if (row_max_cols > 0) {
-                    char display_line[row_max_cols + 1];
-                    strncpy(display_line, line, row_max_cols);
-                    display_line[row_max_cols] = '\0';
-                    boot_tft_print(display_line);
-                }
-            }
-        }
-        
-        // draw cursor at current position
-        // for the input line, cursor should be after prompt "$ " (2 chars) plus input cursor
-        int16_t cursor_col_display = term->cursor_col;
-        
-        // if cursor is on the current input line (within visible range), calculate based on input_pos
-        if (!nano_is_active() && !firstboot_is_active() &&
-            !passwd_is_active() && !login_is_active() &&
-            term->cursor_row >= start_row && term->cursor_row < start_row + max_rows) {
-            // for simplicity, if cursor_row is the last row or matches the input line, use input_pos
-            cursor_col_display = 2 + term->input_pos;  // "$ " is 2 chars, then input_pos
-        }
-        if (term->fastfetch_image_active && image_cols > 0 &&
-            term->fastfetch_line_count > 0) {
-            uint8_t ff_start = term->fastfetch_start_row;
-            uint8_t ff_end = ff_start + term->fastfetch_line_count;
-            if (term->cursor_row >= ff_start && term->cursor_row < ff_end) {
-                cursor_col_display += image_cols;
             }
         }
-        
-        if (term == &terminals[selected_terminal] && !login_is_active()) {
-            int16_t cursor_x = base_text_x + (cursor_col_display * char_width);
-            int16_t cursor_y = text_y + ((term->cursor_row - start_row) * char_height);
-            if (cursor_y >= text_y && cursor_y < text_y + (max_rows * char_height) && 
-                cursor_x >= base_text_x && cursor_x < base_text_x + (base_max_cols * char_width)) {
-                // draw a thin underline cursor without overwriting the character
-                boot_tft_fill_rect(cursor_x, cursor_y + char_height - 1, char_width, 1, active_color);
+    }
+    
+    // draw cursor at current position
+    // for the input line, cursor should be after prompt "$ " (2 chars) plus input cursor
+    int16_t cursor_col_display = term->cursor_col;
+    
+    // if cursor is on the current input line (within visible range), calculate based on input_pos
+    if (wp.shell_input &&
+        term->cursor_row >= wp.start_row && term->cursor_row < wp.start_row + wp.max_rows) {
+        // for simplicity, if cursor_row is the last row or matches the input line, use input_pos
+        cursor_col_display = 2 + term->input_pos;  // "$ " is 2 chars, then input_pos
+    }
+    if (row_in_fastfetch(term, &wp, term->cursor_row)) {
+        cursor_col_display += wp.image_cols;
+    }
+    
+    term->painted_cursor_row = -1;
+    if (selected) {
+        int16_t cursor_x = wp.base_text_x + (cursor_col_display * wp.char_width);
+        int16_t cursor_y = wp.text_y + ((term->cursor_row - wp.start_row) * wp.char_height);
+        if (cursor_y >= wp.text_y && cursor_y < wp.text_y + (wp.max_rows * wp.char_height) && 
+            cursor_x >= wp.base_text_x && cursor_x < wp.base_text_x + (wp.base_max_cols * wp.char_width)) {
+            // draw a thin underline cursor without overwriting the character
+            int16_t panel_y = terminal_vscroll_map(cursor_y, vscroll_top, wp.vs_height, vscroll_offset);
+            term->painted_cursor_row = term->cursor_row - wp.start_row;
+            term->painted_cursor_col = cursor_col_display;
+            if (!place_caret(term, idx, &wp, cursor_x, panel_y)) {
+                boot_tft_fill_rect(cursor_x, panel_y + wp.char_height - 1, wp.char_width, 1, wp.active_color);
             }
         }
     }
-#endif
-
 
+    term->painted_valid = 1;
+    term->painted_mode = mode;
+    term->painted_start_row = wp.start_row;
+    term->painted_scrolled_rows = term->scrolled_rows;
+    term->painted_image = image;
+    terminal_clear_dirty(term);
+}
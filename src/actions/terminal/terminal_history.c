@@ -0,0 +1,527 @@
+#include "terminal.h"
+#include "compat.h"
+#include <stdlib.h>
+#include <string.h>
+
+// shared command history
+// one ring of terminal_history_size lines for every window, entries are numbered by a sequence
+// that only grows, the slot is seq % size and a window's arrow keys just hold a sequence number
+// a hash index (linear probing, backward shift deletion so it never fills up with tombstones)
+// finds an older copy of a line in O(1), that copy is dropped so each command shows up once
+// prefix searches (terminal_complete.c) want the live entries in byte order, that array is only
+// marked stale by a push or drop and sorted again by the first lookup after it, so a push stays
+// O(1) and the sort is paid once per batch of commands instead of once per command
+
+#define history_index_size (terminal_history_size * 2)  // at most half full
+#define history_index_mask (history_index_size - 1)
+
+static char (*lines)[terminal_cols] = NULL;  // an empty line is a dropped entry
+static uint32_t *line_hash = NULL;            // per slot
+static uint32_t *index_table = NULL;          // seq + 1 of the entry, 0 is empty
+static uint32_t *sorted = NULL;               // seqs of the live entries, ordered by line
+static uint8_t sorted_stale = 0;
+static uint32_t head = 0;   // seq of the next entry
+static uint32_t base = 0;   // first seq after the last clear
+static uint32_t live = 0;   // entries that weren't dropped
+static uint32_t version = 0;
+
+static uint32_t history_hash(const char *line) {
+    uint32_t hash = 2166136261u;
+    for (; *line != '\0'; line++) {
+        hash ^= (uint8_t)*line;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static uint32_t oldest_seq(void) {
+    uint32_t oldest = head > terminal_history_size ? head - terminal_history_size : 0;
+    return oldest > base ? oldest : base;
+}
+
+static int history_alloc(void) {
+    if (lines != NULL) {
+        return 0;
+    }
+    lines = (char (*)[terminal_cols])terminal_storage_alloc(sizeof(*lines) * terminal_history_size);
+    line_hash = (uint32_t*)terminal_storage_alloc(sizeof(*line_hash) * terminal_history_size);
+    index_table = (uint32_t*)terminal_storage_alloc(sizeof(*index_table) * history_index_size);
+    sorted = (uint32_t*)terminal_storage_alloc(sizeof(*sorted) * terminal_history_size);
+    if (lines == NULL || line_hash == NULL || index_table == NULL || sorted == NULL) {
+        terminal_history_free();
+        return -1;
+    }
+    memset(index_table, 0, sizeof(*index_table) * history_index_size);
+    head = 0;
+    base = 0;
+    live = 0;
+    return 0;
+}
+
+// index position of the entry with this seq, or of a live entry holding line when seq is 0
+static int32_t index_find(uint32_t hash, const char *line, uint32_t seq) {
+    for (uint32_t i = hash & history_index_mask; index_table[i] != 0; i = (i + 1) & history_index_mask) {
+        uint32_t entry = index_table[i] - 1;
+        if (seq != 0 ? entry == seq - 1 :
+            line_hash[entry % terminal_history_size] == hash &&
+            strcmp(lines[entry % terminal_history_size], line) == 0) {
+            return (int32_t)i;
+        }
+    }
+    return -1;
+}
+
+static int compare_seqs(const void *a, const void *b) {
+    return strcmp(lines[*(const uint32_t*)a % terminal_history_size],
+                  lines[*(const uint32_t*)b % terminal_history_size]);
+}
+
+static void sorted_refresh(void) {
+    if (!sorted_stale) {
+        return;
+    }
+    uint32_t count = 0;
+    for (uint32_t seq = oldest_seq(); seq < head; seq++) {
+        if (lines[seq % terminal_history_size][0] != '\0') {
+            sorted[count++] = seq;
+        }
+    }
+    qsort(sorted, count, sizeof(*sorted), compare_seqs);
+    sorted_stale = 0;
+}
+
+// entries later in the same probe run move up into the hole, so lookups never need tombstones
+static void index_remove(uint32_t hole) {
+    uint32_t i = hole;
+    for (;;) {
+        i = (i + 1) & history_index_mask;
+        if (index_table[i] == 0) {
+            break;
+        }
+        uint32_t home = line_hash[(index_table[i] - 1) % terminal_history_size] & history_index_mask;
+        if (((i - home) & history_index_mask) >= ((i - hole) & history_index_mask)) {
+            index_table[hole] = index_table[i];
+            hole = i;
+        }
+    }
+    index_table[hole] = 0;
+}
+
+static void history_drop(uint32_t seq) {
+    uint32_t slot = seq % terminal_history_size;
+    if (lines[slot][0] == '\0') {
+        return;
+    }
+    int32_t pos = index_find(line_hash[slot], NULL, seq + 1);
+    if (pos >= 0) {
+        index_remove((uint32_t)pos);
+    }
+    lines[slot][0] = '\0';
+    live--;
+    sorted_stale = 1;
+    version++;
+}
+
+// substring searches (ctrl-r) go through everything added since the last clear, the whole history
+// file included, not just what the ring still holds
+// each distinct line's text is kept once (log_text), log_seqs says which line every seq added and
+// an inverted index maps every byte pair and triple, hashed into log_bucket_count lists, to the
+// seqs whose line contains it, oldest first; a search walks the shortest list among the needle's
+// grams backwards and only runs strstr on those, a seq whose line was added again later is
+// skipped so each line is found once, at its newest spot like in the ring
+// the lists cost 4 bytes per distinct gram of every added line, about 8 per character, a one
+// character needle has no list and checks every line instead (most lines match one of those)
+#define log_bucket_count 4096
+#define log_bucket_shift 20  // 32 - log2(log_bucket_count)
+
+typedef struct {
+    uint32_t text;    // offset in log_text
+    uint32_t hash;
+    uint32_t newest;  // seq of the last time the line was added
+} log_line;
+
+typedef struct {
+    uint32_t *seqs;
+    uint32_t count;
+    uint32_t cap;
+} log_bucket;
+
+static char *log_text = NULL;
+static uint32_t log_text_len = 0;
+static uint32_t log_text_cap = 0;
+static log_line *log_lines = NULL;  // distinct lines
+static uint32_t log_line_count = 0;
+static uint32_t log_line_cap = 0;
+static uint32_t *log_table = NULL;  // line index + 1 by hash, 0 is empty, at most half full
+static uint32_t log_table_size = 0;
+static uint32_t *log_seqs = NULL;   // line index of every seq from log_base on
+static uint32_t log_seq_count = 0;
+static uint32_t log_seq_cap = 0;
+static uint32_t log_base = 0;       // seq of log_seqs[0]
+static log_bucket *log_buckets = NULL;
+
+// a copy of mem with room for need elements (doubling), NULL and mem untouched if there's no memory
+static void *log_grow(void *mem, uint32_t *cap, uint32_t need, size_t elem) {
+    if (need <= *cap && mem != NULL) {
+        return mem;
+    }
+    uint32_t size = *cap ? *cap : 16;
+    while (size < need) {
+        size *= 2;
+    }
+    void *fresh = terminal_storage_alloc((size_t)size * elem);
+    if (fresh == NULL) {
+        return NULL;
+    }
+    if (mem != NULL) {
+        memcpy(fresh, mem, (size_t)*cap * elem);
+        free(mem);
+    }
+    *cap = size;
+    return fresh;
+}
+
+static uint32_t log_bucket_of(const char *gram, int len) {
+    uint32_t key = ((uint32_t)len << 24) | ((uint32_t)(uint8_t)gram[0] << 16) | ((uint32_t)(uint8_t)gram[1] << 8);
+    if (len == 3) {
+        key |= (uint8_t)gram[2];
+    }
+    return (key * 2654435761u) >> log_bucket_shift;
+}
+
+static int log_table_grow(void) {
+    uint32_t size = log_table_size ? log_table_size * 2 : 1024;
+    uint32_t *table = (uint32_t*)terminal_storage_alloc(sizeof(*table) * size);
+    if (table == NULL) {
+        return -1;
+    }
+    memset(table, 0, sizeof(*table) * size);
+    for (uint32_t line = 0; line < log_line_count; line++) {
+        uint32_t i = log_lines[line].hash & (size - 1);
+        while (table[i] != 0) {
+            i = (i + 1) & (size - 1);
+        }
+        table[i] = line + 1;
+    }
+    free(log_table);
+    log_table = table;
+    log_table_size = size;
+    return 0;
+}
+
+// line index of text, adding it if it's new, -1 if there's no memory
+static int32_t log_line_find(const char *text, uint32_t hash) {
+    if ((log_line_count + 1) * 2 > log_table_size && log_table_grow() != 0) {
+        return -1;
+    }
+    uint32_t i = hash & (log_table_size - 1);
+    for (; log_table[i] != 0; i = (i + 1) & (log_table_size - 1)) {
+        log_line *line = &log_lines[log_table[i] - 1];
+        if (line->hash == hash && strcmp(log_text + line->text, text) == 0) {
+            return (int32_t)(log_table[i] - 1);
+        }
+    }
+    uint32_t len = (uint32_t)strlen(text) + 1;
+    char *grown_text = (char*)log_grow(log_text, &log_text_cap, log_text_len + len, 1);
+    if (grown_text == NULL) {
+        return -1;
+    }
+    log_text = grown_text;
+    log_line *grown_lines = (log_line*)log_grow(log_lines, &log_line_cap, log_line_count + 1, sizeof(*log_lines));
+    if (grown_lines == NULL) {
+        return -1;
+    }
+    log_lines = grown_lines;
+    memcpy(log_text + log_text_len, text, len);
+    log_lines[log_line_count].text = log_text_len;
+    log_lines[log_line_count].hash = hash;
+    log_text_len += len;
+    log_table[i] = log_line_count + 1;
+    return (int32_t)log_line_count++;
+}
+
+static int log_post(const char *gram, int len, uint32_t seq) {
+    log_bucket *bucket = &log_buckets[log_bucket_of(gram, len)];
+    if (bucket->count > 0 && bucket->seqs[bucket->count - 1] == seq) {
+        return 0;  // the gram came up earlier in the line, or another one landed in the same list
+    }
+    uint32_t *grown = (uint32_t*)log_grow(bucket->seqs, &bucket->cap, bucket->count + 1, sizeof(*bucket->seqs));
+    if (grown == NULL) {
+        return -1;
+    }
+    bucket->seqs = grown;
+    bucket->seqs[bucket->count++] = seq;
+    return 0;
+}
+
+static void log_reset(uint32_t from) {
+    log_text_len = 0;
+    log_line_count = 0;
+    log_seq_count = 0;
+    log_base = from;
+    if (log_table != NULL) {
+        memset(log_table, 0, sizeof(*log_table) * log_table_size);
+    }
+    if (log_buckets != NULL) {
+        for (uint32_t i = 0; i < log_bucket_count; i++) {
+            log_buckets[i].count = 0;
+        }
+    }
+}
+
+static void log_free(void) {
+    if (log_buckets != NULL) {
+        for (uint32_t i = 0; i < log_bucket_count; i++) {
+            free(log_buckets[i].seqs);
+        }
+    }
+    free(log_buckets);
+    free(log_text);
+    free(log_lines);
+    free(log_table);
+    free(log_seqs);
+    log_buckets = NULL;
+    log_text = NULL;
+    log_lines = NULL;
+    log_table = NULL;
+    log_seqs = NULL;
+    log_text_cap = 0;
+    log_line_cap = 0;
+    log_table_size = 0;
+    log_seq_cap = 0;
+    log_reset(0);
+}
+
+// seq was just given to text in the ring; without memory the log starts over after it and the
+// ring is all a search sees for the seqs before
+static void log_add(const char *text, uint32_t hash, uint32_t seq) {
+    if (log_buckets == NULL) {
+        log_buckets = (log_bucket*)terminal_storage_alloc(sizeof(*log_buckets) * log_bucket_count);
+        if (log_buckets == NULL) {
+            log_reset(seq + 1);
+            return;
+        }
+        memset(log_buckets, 0, sizeof(*log_buckets) * log_bucket_count);
+    }
+    uint32_t *grown = (uint32_t*)log_grow(log_seqs, &log_seq_cap, log_seq_count + 1, sizeof(*log_seqs));
+    if (grown != NULL) {
+        log_seqs = grown;
+    }
+    int32_t line = grown != NULL ? log_line_find(text, hash) : -1;
+    if (line < 0) {
+        DEBUG_PRINT("[HISTORY] No memory for the search log, it starts over");
+        log_reset(seq + 1);
+        return;
+    }
+    log_seqs[log_seq_count++] = (uint32_t)line;
+    log_lines[line].newest = seq;
+    for (const char *gram = text; gram[0] != '\0' && gram[1] != '\0'; gram++) {
+        if (log_post(gram, 2, seq) != 0 || (gram[2] != '\0' && log_post(gram, 3, seq) != 0)) {
+            DEBUG_PRINT("[HISTORY] No memory for the search log, it starts over");
+            log_reset(seq + 1);
+            return;
+        }
+    }
+}
+
+// the text seq added if that's still the line's newest spot and no clear came since
+static const char *log_at(uint32_t seq) {
+    if (seq < base || seq < log_base || seq - log_base >= log_seq_count) {
+        return NULL;
+    }
+    log_line *line = &log_lines[log_seqs[seq - log_base]];
+    return line->newest == seq ? log_text + line->text : NULL;
+}
+
+// newest seq below before whose line contains needle, or terminal_history_live
+static uint32_t log_search(const char *needle, uint32_t before) {
+    size_t len = strlen(needle);
+    if (log_seq_count == 0 || before <= log_base) {
+        return terminal_history_live;
+    }
+    if (len == 1) {
+        for (uint32_t seq = before; seq > log_base;) {
+            seq--;
+            const char *text = log_at(seq);
+            if (text != NULL && strchr(text, needle[0]) != NULL) {
+                return seq;
+            }
+        }
+        return terminal_history_live;
+    }
+    // a two character needle is its own byte pair, longer ones are every triple in them
+    int gram_len = len == 2 ? 2 : 3;
+    const log_bucket *best = NULL;
+    for (size_t i = 0; i + (size_t)gram_len <= len; i++) {
+        const log_bucket *bucket = &log_buckets[log_bucket_of(needle + i, gram_len)];
+        if (best == NULL || bucket->count < best->count) {
+            best = bucket;
+        }
+    }
+    // the lists are in seq order, start at the first entry not below before
+    uint32_t lo = 0;
+    uint32_t hi = best->count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (best->seqs[mid] < before) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    while (lo > 0) {
+        uint32_t seq = best->seqs[--lo];
+        const char *text = log_at(seq);
+        if (text != NULL && strstr(text, needle) != NULL) {
+            return seq;
+        }
+    }
+    return terminal_history_live;
+}
+
+int terminal_history_add(const char *line) {
+    if (line == NULL || line[0] == '\0' || history_alloc() != 0) {
+        return -1;
+    }
+    char entry[terminal_cols];
+    size_t len = strnlen(line, terminal_cols - 1);
+    memcpy(entry, line, len);
+    entry[len] = '\0';
+
+    uint32_t hash = history_hash(entry);
+    int32_t pos = index_find(hash, entry, 0);
+    if (pos >= 0) {
+        history_drop(index_table[pos] - 1);
+    }
+    // a full ring reuses the oldest slot
+    if (head - oldest_seq() >= terminal_history_size) {
+        history_drop(head - terminal_history_size);
+    }
+    uint32_t slot = head % terminal_history_size;
+    memcpy(lines[slot], entry, len + 1);
+    line_hash[slot] = hash;
+    uint32_t i = hash & history_index_mask;
+    while (index_table[i] != 0) {
+        i = (i + 1) & history_index_mask;
+    }
+    index_table[i] = head + 1;
+    log_add(entry, hash, head);
+    head++;
+    live++;
+    sorted_stale = 1;
+    version++;
+    return 0;
+}
+
+const char *terminal_history_prev(uint32_t *pos) {
+    if (pos == NULL || lines == NULL) {
+        return NULL;
+    }
+    uint32_t seq = *pos > head ? head : *pos;
+    uint32_t oldest = oldest_seq();
+    while (seq > oldest) {
+        seq--;
+        if (lines[seq % terminal_history_size][0] != '\0') {
+            *pos = seq;
+            return lines[seq % terminal_history_size];
+        }
+    }
+    return NULL;
+}
+
+const char *terminal_history_next(uint32_t *pos) {
+    if (pos == NULL || lines == NULL || *pos >= head) {
+        if (pos != NULL) {
+            *pos = terminal_history_live;
+        }
+        return NULL;
+    }
+    uint32_t seq = *pos < oldest_seq() ? oldest_seq() : *pos + 1;
+    for (; seq < head; seq++) {
+        if (lines[seq % terminal_history_size][0] != '\0') {
+            *pos = seq;
+            return lines[seq % terminal_history_size];
+        }
+    }
+    *pos = terminal_history_live;
+    return NULL;
+}
+
+const char *terminal_history_at(uint32_t seq) {
+    if (lines == NULL || seq >= head) {
+        return NULL;
+    }
+    if (seq < oldest_seq()) {
+        return log_at(seq);  // dropped out of the ring, searches still reach it
+    }
+    return lines[seq % terminal_history_size][0] != '\0' ? lines[seq % terminal_history_size] : NULL;
+}
+
+const char *terminal_history_search(const char *needle, uint32_t *pos) {
+    if (pos == NULL || needle == NULL || needle[0] == '\0' || lines == NULL) {
+        return NULL;
+    }
+    uint32_t before = *pos > head ? head : *pos;
+    uint32_t seq = log_search(needle, before);
+    if (seq != terminal_history_live) {
+        *pos = seq;
+        return log_at(seq);
+    }
+    // only if the log had to start over, what the ring holds from before that is scanned
+    uint32_t oldest = oldest_seq();
+    for (seq = before < log_base ? before : log_base; seq > oldest;) {
+        seq--;
+        const char *line = lines[seq % terminal_history_size];
+        if (line[0] != '\0' && strstr(line, needle) != NULL) {
+            *pos = seq;
+            return line;
+        }
+    }
+    return NULL;
+}
+
+uint32_t terminal_history_count(void) {
+    return live;
+}
+
+const char *terminal_history_sorted(uint32_t index, uint32_t *seq) {
+    if (lines == NULL || index >= live) {
+        return NULL;
+    }
+    sorted_refresh();
+    if (seq != NULL) {
+        *seq = sorted[index];
+    }
+    return lines[sorted[index] % terminal_history_size];
+}
+
+uint32_t terminal_history_version(void) {
+    return version;
+}
+
+void terminal_history_clear(void) {
+    if (index_table != NULL) {
+        memset(index_table, 0, sizeof(*index_table) * history_index_size);
+    }
+    // sequence numbers keep growing, positions windows still hold just find nothing
+    base = head;
+    live = 0;
+    log_reset(head);
+    version++;
+}
+
+void terminal_history_free(void) {
+    free(lines);
+    free(line_hash);
+    free(index_table);
+    free(sorted);
+    log_free();
+    lines = NULL;
+    line_hash = NULL;
+    index_table = NULL;
+    sorted = NULL;
+    sorted_stale = 0;
+    head = 0;
+    base = 0;
+    live = 0;
+}
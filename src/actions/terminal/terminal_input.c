@@ -114,6 +114,10 @@ void terminal_handle_key_event(key_event evt) {
     if (term->image_view_active) {
         return;
     }
+    // typing goes back to the live grid, only the paging hotkeys keep the view where it is
+    if (term->view_offset != 0) {
+        terminal_scroll_view(term, -(int)term->view_offset);
+    }
     
     if (login_is_active()) {
         login_handle_key_event(evt);
@@ -135,6 +139,41 @@ void terminal_handle_key_event(key_event evt) {
         return;
     }
     
+    if ((evt.modifiers & mod_ctrl) && evt.key == key_r) {
+        terminal_search_start(term);
+        return;
+    }
+    // ctrl-r search takes the keys until it is accepted or cancelled
+    if (term->search_active) {
+        switch (evt.key) {
+            case key_backspace:
+                terminal_search_backspace(term);
+                break;
+            case key_esc:
+                terminal_search_end(term, 0);
+                break;
+            case key_enter:
+                terminal_search_end(term, 1);
+                terminal_handle_enter(term);
+                break;
+            case key_left:
+            case key_right:
+            case key_up:
+            case key_down:
+            case key_tab:
+                terminal_search_end(term, 1);
+                break;
+            default: {
+                char c = key_to_char(evt.key, evt.modifiers);
+                if (c != 0) {
+                    terminal_search_key(term, c);
+                }
+                break;
+            }
+        }
+        return;
+    }
+    
     // handle special keys
     switch (evt.key) {
         case key_enter:
@@ -156,7 +195,7 @@ void terminal_handle_key_event(key_event evt) {
             terminal_handle_arrow_right(term);
             break;
         case key_tab:
-            // tab completion - could be implemented later
+            terminal_handle_tab(term);
             break;
         default: {
             // regular character input
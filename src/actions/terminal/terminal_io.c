@@ -11,6 +11,37 @@ typedef struct {
 } terminal_capture_t;
 
 static terminal_capture_t terminal_capture = {0};
+static terminal_output_t terminal_output = {0};
+static terminal_output_t terminal_error_output = {0};
+
+terminal_output_t terminal_output_set(terminal_output_t out) {
+    terminal_output_t prev = terminal_output;
+    terminal_output = out;
+    return prev;
+}
+
+terminal_output_t terminal_output_get(void) {
+    return terminal_output;
+}
+
+terminal_output_t terminal_error_output_set(terminal_output_t out) {
+    terminal_output_t prev = terminal_error_output;
+    terminal_error_output = out;
+    return prev;
+}
+
+void terminal_write_error(terminal_state *term, const char *buf, size_t len) {
+    if (term == NULL || !term->active || buf == NULL || len == 0) return;
+    if (terminal_error_output.fn != NULL) {
+        terminal_error_output.fn(terminal_error_output.ctx, buf, len);
+        return;
+    }
+    // past a > file or the next pipeline stage, straight to the window (or the capture)
+    terminal_output_t out = terminal_output;
+    terminal_output.fn = NULL;
+    terminal_write_n(term, buf, len);
+    terminal_output = out;
+}
 
 void terminal_capture_start(void) {
     terminal_capture.active = 1;
@@ -48,12 +79,16 @@ int terminal_capture_is_active(void) {
     return terminal_capture.active;
 }
 
-static void terminal_capture_append(char c) {
+// grows once for the whole run, not once per doubling step it crosses
+static void terminal_capture_append(const char *buf, size_t len) {
     if (terminal_capture.buffer == NULL) {
         return;
     }
-    if (terminal_capture.length + 1 >= terminal_capture.capacity) {
+    if (terminal_capture.length + len >= terminal_capture.capacity) {
         size_t new_capacity = terminal_capture.capacity * 2;
+        while (terminal_capture.length + len >= new_capacity) {
+            new_capacity *= 2;
+        }
         char *new_buf = (char*)realloc(terminal_capture.buffer, new_capacity);
         if (new_buf == NULL) {
             return;
@@ -61,34 +96,68 @@ static void terminal_capture_append(char c) {
         terminal_capture.buffer = new_buf;
         terminal_capture.capacity = new_capacity;
     }
-    terminal_capture.buffer[terminal_capture.length++] = c;
+    memcpy(terminal_capture.buffer + terminal_capture.length, buf, len);
+    terminal_capture.length += len;
     terminal_capture.buffer[terminal_capture.length] = '\0';
 }
+void terminal_mark_row_dirty(terminal_state *term, int row) {
+    if (term == NULL || row < 0 || row >= terminal_rows) return;
+    term->dirty_rows[row >> 3] |= (uint8_t)(1u << (row & 7));
+    terminal_render_request(term);
+}
+
+void terminal_mark_dirty(terminal_state *term) {
+    if (term == NULL) return;
+    memset(term->dirty_rows, 0xFF, sizeof(term->dirty_rows));
+    term->painted_valid = 0;
+}
+
+int terminal_row_is_dirty(const terminal_state *term, int row) {
+    if (term == NULL || row < 0 || row >= terminal_rows) return 0;
+    return (term->dirty_rows[row >> 3] >> (row & 7)) & 1;
+}
+
+void terminal_clear_dirty(terminal_state *term) {
+    if (term == NULL) return;
+    memset(term->dirty_rows, 0, sizeof(term->dirty_rows));
+}
+
+// the cursor waits below the last row after a newline or a wrap, the next write scrolls
+static void terminal_scroll_to_cursor(terminal_state *term) {
+    if (term->grid_rows > 0 && term->cursor_row >= term->grid_rows) {
+        // top row into the scrollback, the ring moves on by one
+        terminal_scroll_up(term);
+        term->cursor_row = term->grid_rows - 1;
+        // every row moved, the renderer diffs them against what's on the panel
+        memset(term->dirty_rows, 0xFF, sizeof(term->dirty_rows));
+    }
+}
+
 void terminal_write_char(terminal_state *term, char c) {
     if (term == NULL || !term->active) return;
     
-    if (terminal_capture.active) {
-        terminal_capture_append(c);
+    if (terminal_output.fn != NULL) {
+        terminal_output.fn(terminal_output.ctx, &c, 1);
         return;
     }
-    
-    if (term->cursor_row >= terminal_rows) {
-        // scroll buffer up
-        memmove(term->buffer, term->buffer + terminal_cols, 
-                (terminal_rows - 1) * terminal_cols);
-        memset(term->buffer + (terminal_rows - 1) * terminal_cols, ' ', terminal_cols);
-        term->cursor_row = terminal_rows - 1;
+    if (terminal_capture.active) {
+        terminal_capture_append(&c, 1);
+        return;
     }
+    terminal_render_request(term);  // drawn with the next frame, never here
+    term->view_offset = 0;  // output brings a paged back view to the live grid
+    terminal_scroll_to_cursor(term);
     
     if (c == '\n') {
         term->cursor_col = 0;
         term->cursor_row++;
     } else {
-        uint16_t pos = term->cursor_row * terminal_cols + term->cursor_col;
-        if (pos < terminal_buffer_size) {
-            term->buffer[pos] = c;
+        char *line = terminal_row(term, term->cursor_row);
+        if (line != NULL && term->cursor_col < term->grid_cols) {
+            line[term->cursor_col] = c;
+            terminal_mark_row_dirty(term, term->cursor_row);
             term->cursor_col++;
-            if (term->cursor_col >= terminal_cols) {
+            if (term->cursor_col >= term->grid_cols) {
                 term->cursor_col = 0;
                 term->cursor_row++;
             }
@@ -96,11 +165,57 @@ void terminal_write_char(terminal_state *term, char c) {
     }
 }
 
+// same result as terminal_write_char() per byte, but each run up to the next newline or the
+// end of the row is one memcpy and one dirty mark
+void terminal_write_n(terminal_state *term, const char *buf, size_t len) {
+    if (term == NULL || !term->active || buf == NULL || len == 0) return;
+
+    if (terminal_output.fn != NULL) {
+        terminal_output.fn(terminal_output.ctx, buf, len);
+        return;
+    }
+    if (terminal_capture.active) {
+        terminal_capture_append(buf, len);
+        return;
+    }
+    terminal_render_request(term);
+    term->view_offset = 0;
+
+    size_t i = 0;
+    while (i < len) {
+        terminal_scroll_to_cursor(term);
+        if (buf[i] == '\n') {
+            term->cursor_col = 0;
+            term->cursor_row++;
+            i++;
+            continue;
+        }
+        char *line = terminal_row(term, term->cursor_row);
+        if (line == NULL || term->cursor_col >= term->grid_cols) {
+            return;
+        }
+        size_t run = term->grid_cols - term->cursor_col;
+        if (run > len - i) {
+            run = len - i;
+        }
+        const char *newline = (const char*)memchr(buf + i, '\n', run);
+        if (newline != NULL) {
+            run = (size_t)(newline - (buf + i));
+        }
+        memcpy(line + term->cursor_col, buf + i, run);
+        terminal_mark_row_dirty(term, term->cursor_row);
+        term->cursor_col += run;
+        i += run;
+        if (term->cursor_col >= term->grid_cols) {
+            term->cursor_col = 0;
+            term->cursor_row++;
+        }
+    }
+}
+
 void terminal_write_string(terminal_state *term, const char *str) {
     if (term == NULL || str == NULL) return;
-    while (*str) {
-        terminal_write_char(term, *str++);
-    }
+    terminal_write_n(term, str, strlen(str));
 }
 
 void terminal_write_line(terminal_state *term, const char *str) {
@@ -114,9 +229,15 @@ void terminal_newline(terminal_state *term) {
 
 void terminal_clear(terminal_state *term) {
     if (term == NULL) return;
-    memset(term->buffer, ' ', terminal_buffer_size);
+    if (term->buffer != NULL) {
+        memset(term->buffer, ' ', (size_t)term->grid_rows * term->grid_cols);
+    }
+    term->row_base = 0;
+    term->view_offset = 0;  // the scrollback stays, like a terminal emulator's clear
     term->cursor_row = 0;
     term->cursor_col = 0;
+    terminal_mark_dirty(term);
+    terminal_render_request(term);
 }
 
 
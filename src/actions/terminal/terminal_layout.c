@@ -6,11 +6,8 @@
 
 #ifdef ARDUINO
     #include "boot_splash.h"
-    extern void boot_tft_fill_screen(uint16_t color);
-    extern void boot_tft_fill_rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
     extern int16_t boot_tft_get_width(void);
     extern int16_t boot_tft_get_height(void);
-    #define COLOR_WHITE  0xFFFF
 #endif
 
 // external terminal state (defined in terminal.c)
@@ -173,8 +170,9 @@ void new_terminal(void) {
     new_term->autocomplete_len = 0;
     new_term->autocomplete_base_len = 0;
     new_term->autocomplete_applied = 0;
-    new_term->history_count = 0;
-    new_term->history_pos = 0;
+    new_term->autocomplete_index = 0;
+    new_term->search_active = 0;
+    new_term->history_pos = terminal_history_live;
     new_term->pipe_input = NULL;
     new_term->pipe_input_len = 0;
     new_term->fastfetch_image_active = 0;
@@ -191,8 +189,12 @@ void new_terminal(void) {
     // set initial working directory to root, then try user home from /etc/passwd
     new_term->cwd = vfs_resolve("/");
     set_cwd_from_passwd(new_term);
-    memset(new_term->buffer, ' ', terminal_buffer_size);
+    new_term->row_base = 0;
+    new_term->scrollback_head = 0;
+    new_term->scrollback_count = 0;
+    new_term->view_offset = 0;
     memset(new_term->input_line, 0, terminal_cols);
+    terminal_mark_dirty(new_term);
     terminal_load_history(new_term);
     
 #ifdef ARDUINO
@@ -203,6 +205,7 @@ void new_terminal(void) {
     
     // variables for rendering (need to be accessible in rendering block)
     int16_t orig_x = 0, orig_y = 0, orig_width = 0, orig_height = 0;
+    split_direction_t orig_split = SPLIT_NONE;
     terminal_state *selected = NULL;
     
     if (window_count == 0) {
@@ -226,11 +229,13 @@ void new_terminal(void) {
             }
         }
         
-        // save original geometry for clearing
+        // save original geometry for splitting
+        terminal_mark_dirty(selected);
         orig_x = selected->x;
         orig_y = selected->y;
         orig_width = selected->width;
         orig_height = selected->height;
+        orig_split = selected->split_dir;
         
         // determine split direction:
         // 1. If we already have 4 terminals horizontally at this Y position, force vertical split
@@ -281,7 +286,7 @@ void new_terminal(void) {
                 DEBUG_PRINT("[SANITY] Terminal too short for any split, aborting\n");
                 // can't split - terminal too small, clean up
                 new_term->active = 0;
-                memset(new_term->buffer, ' ', terminal_buffer_size);
+                terminal_storage_release(new_term);
                 memset(new_term->input_line, 0, terminal_cols);
                 return;  // exit early, window_count not incremented yet
             }
@@ -307,6 +312,28 @@ void new_terminal(void) {
     new_term->split_dir = SPLIT_NONE;
 #endif
     
+    // the grid is sized to the cell area the window got
+    if (terminal_grid_fit(new_term) != 0) {
+        DEBUG_PRINT("[ERROR] No memory for terminal\n");
+#ifdef ARDUINO
+        if (selected != NULL) {
+            selected->x = orig_x;
+            selected->y = orig_y;
+            selected->width = orig_width;
+            selected->height = orig_height;
+            selected->split_dir = orig_split;
+        }
+#endif
+        new_term->active = 0;
+        terminal_storage_release(new_term);
+        return;
+    }
+#ifdef ARDUINO
+    if (selected != NULL) {
+        terminal_grid_fit(selected);  // half its old size, keeps the old grid if there's no memory
+    }
+#endif
+    
     active_terminal = new_idx;
     selected_terminal = new_idx;  // newly opened terminal becomes selected
     window_count++;
@@ -320,27 +347,21 @@ void new_terminal(void) {
     }
     
 #ifdef ARDUINO
-    extern void terminal_render_all(void);
-    extern void terminal_render_window(terminal_state *term);
-    
     if (terminal_suppress_initial_output) {
         // defer render until caller is ready (e.g., login screen)
     } else if (window_count == 1) {
         // first terminal: full screen render
-        terminal_render_all();
+        terminal_render_request_all();
     } else {
-        // split case: clear the original area, then render both terminals
-        // we saved the original geometry before modifying it
-        boot_tft_fill_rect(orig_x, orig_y, orig_width, orig_height, COLOR_WHITE);
-        
-        // render both the resized selected terminal and the new one
-        terminal_render_window(selected);
-        terminal_render_window(new_term);
+        // split case: the two halves cover the original area between them, both repaint
+        // with the next frame and nothing else on the panel is touched
+        terminal_render_request(selected);
+        terminal_render_request(new_term);
         
         // validate layout after split
         if (!validate_terminal_layout()) {
             DEBUG_PRINT("[SANITY] Layout validation failed after split, forcing full rebuild\n");
-            terminal_render_all();
+            terminal_render_request_all();
         }
     }
 #endif
@@ -439,12 +460,11 @@ static void terminal_select_direction(int dx, int dy) {
     }
     
     if (best_idx >= 0) {
+        // only the cursor moves between the two windows
+        terminal_render_request(current);
         selected_terminal = best_idx;
         active_terminal = best_idx;
-#ifdef ARDUINO
-        extern void terminal_render_all(void);
-        terminal_render_all();
-#endif
+        terminal_render_request(&terminals[best_idx]);
     }
 }
 
@@ -472,17 +492,16 @@ void close_terminal(void) {
         return;
     }
     
-    // save geometry before closing for clearing
-    int16_t closed_x = to_close->x;
-    int16_t closed_y = to_close->y;
-    int16_t closed_width = to_close->width;
-    int16_t closed_height = to_close->height;
-    
 #ifdef ARDUINO
     extern void terminal_image_view_release(terminal_state *term);
+    terminal_render_lock();
     terminal_image_view_release(to_close);
+    terminal_render_unlock();
 #endif
     
+    terminal_shadow_release(to_close);
+    terminal_scrollback_release(to_close);
+    terminal_storage_release(to_close);
     to_close->active = 0;
     window_count--;
     
@@ -561,23 +580,22 @@ void close_terminal(void) {
             }
         }
         
-        // clear the closed terminal's area
-        boot_tft_fill_rect(closed_x, closed_y, closed_width, closed_height, COLOR_WHITE);
+        for (uint8_t i = 0; i < active_count; i++) {
+            terminal_grid_fit(&terminals[active_indices[i]]);
+        }
+        
+        // repositioned terminals repaint, the compositor clears what the closed one leaves uncovered
+        terminal_render_request_windows();
         
         // validate layout after rebuilding
-        extern void terminal_render_all(void);
         if (!validate_terminal_layout()) {
             DEBUG_PRINT("[SANITY] Layout validation failed after close, forcing full rebuild\n");
             // force full screen clear and rebuild
-            boot_tft_fill_screen(COLOR_WHITE);
-            terminal_render_all();
-        } else {
-            // redraw all remaining terminals (they've been repositioned)
-            terminal_render_all();
+            terminal_render_request_all();
         }
     } else {
-        // no terminals left - clear screen
-        boot_tft_fill_screen(COLOR_WHITE);
+        // no terminals left, its area goes back to the background
+        terminal_render_request(to_close);
     }
 #endif
     
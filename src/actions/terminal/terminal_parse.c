@@ -40,6 +40,41 @@ static char *next_token(char *str, const char *delimiters, char **saveptr) {
     return token_start;
 }
 
+// the file of a redirection operator, attached ("2>log") or the next token ("2> log")
+static int parse_redirect(const char *token, char **saveptr, char *out, uint8_t *append,
+                          uint8_t *invalid) {
+    size_t op = 0;
+    if (token[0] == '2' && token[1] == '>') {
+        op = 2;
+    } else if (token[0] == '>' || token[0] == '<') {
+        op = 1;
+    } else {
+        return 0;
+    }
+    if (append != NULL) {
+        *append = 0;
+        if (token[op] == '>') {
+            *append = 1;
+            op++;
+        }
+    }
+    const char *path = token + op;
+    if (*path == '\0') {
+        path = next_token(NULL, " \t\n", saveptr);
+    }
+    if (path == NULL || *path == '\0' || strchr("<>|", *path) != NULL) {
+        *invalid = 1;
+        return 1;
+    }
+    size_t len = strlen(path);
+    if (len >= max_token_length) {
+        len = max_token_length - 1;
+    }
+    memcpy(out, path, len);
+    out[len] = '\0';
+    return 1;
+}
+
 // command parsing
 void terminal_parse_command(const char *input, command_tokens_t *out_tokens) {
     if (out_tokens == NULL) {
@@ -69,10 +104,34 @@ void terminal_parse_command(const char *input, command_tokens_t *out_tokens) {
     
     while (token != NULL && out_tokens->token_count < max_command_tokens &&
            storage_idx < max_command_tokens) {
+        // redirections don't become tokens
+        int redirected = 0;
+        if (token[0] == '<') {
+            redirected = parse_redirect(token, &saveptr, out_tokens->redirect_in, NULL,
+                                        &out_tokens->redirect_invalid);
+        } else if (token[0] == '>') {
+            redirected = parse_redirect(token, &saveptr, out_tokens->redirect_out,
+                                        &out_tokens->redirect_out_append,
+                                        &out_tokens->redirect_invalid);
+        } else if (token[0] == '2' && token[1] == '>') {
+            redirected = parse_redirect(token, &saveptr, out_tokens->redirect_err,
+                                        &out_tokens->redirect_err_append,
+                                        &out_tokens->redirect_invalid);
+        }
+        if (redirected) {
+            token = next_token(NULL, " \t\n", &saveptr);
+            continue;
+        }
         // check for pipe
         if (strcmp(token, "|") == 0) {
+            if (!out_tokens->has_pipe) {
+                out_tokens->pipe_pos = out_tokens->token_count;
+            }
             out_tokens->has_pipe = 1;
-            out_tokens->pipe_pos = out_tokens->token_count;
+            if (out_tokens->pipe_count < max_pipe_commands - 1) {
+                out_tokens->pipe_positions[out_tokens->pipe_count] = out_tokens->token_count;
+            }
+            out_tokens->pipe_count++;
         } else {
             // copy token to per-instance storage (not static)
             size_t token_len = strlen(token);
@@ -1,5 +1,7 @@
 #include "terminal.h"
 #include "terminal_cmd.h"
+#include "builtins.h"
+#include "shell_codes.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -77,63 +79,216 @@ void terminal_wire_pipes(terminal_pipe_t *pipe1, terminal_pipe_t *pipe2) {
 }
 
 // pipeline execution
-void terminal_execute_pipeline(terminal_state *term, command_tokens_t *tokens) {
-    if (term == NULL || tokens == NULL || !tokens->has_pipe) {
+// every stage gets a bounded buffer for its input, the stage before it writes into the buffer and
+// when it is full the stage runs on it (its filter's feed), writing into the next stage's buffer
+// so a stage runs as soon as its input is there, the producer can't get further ahead than one
+// buffer and the whole pipeline holds N buffers however much goes through it
+// a command that can't stream but reads term->pipe_input (reads_input) collects its input whole
+// and runs at the end, any other command's input is dropped as it comes, it never looks at it
+// a < file takes the place of the first command, every stage is then a consumer
+
+typedef struct pipe_stage {
+    terminal_state *term;
+    char **argv;
+    int argc;
+    builtin_cmd *cmd;
+    void *state;         // filter state, NULL if the stage doesn't stream
+    int result;
+    char buffer[terminal_pipe_buffer_size];
+    size_t len;
+    char *whole;         // input of a stage that doesn't stream
+    size_t whole_len;
+    size_t whole_cap;
+    uint8_t keep_whole;  // the handler reads pipe_input, without it the input is dropped
+    uint8_t failed;      // input is dropped
+    terminal_output_t out;  // the next stage, or wherever the pipeline's output goes for the last
+} pipe_stage_t;
+
+static void pipe_stage_drain(pipe_stage_t *stage) {
+    if (stage->len == 0) {
         return;
     }
-    
-    // split commands at pipe
-    uint8_t cmd1_end = tokens->pipe_pos;
-    uint8_t cmd2_start = tokens->pipe_pos;
-    
-    if (cmd1_end == 0 || cmd2_start >= tokens->token_count) {
-        terminal_write_string(term, "Invalid pipe syntax\n");
+    size_t len = stage->len;
+    stage->len = 0;
+    if (stage->failed) {
         return;
     }
-    
-    // execute first command (write to pipe)
-    command_tokens_t *cmd1_tokens = (command_tokens_t*)malloc(sizeof(command_tokens_t));
-    if (cmd1_tokens == NULL) {
-        terminal_write_string(term, "Failed to allocate pipe command\n");
+    terminal_output_t prev = terminal_output_set(stage->out);
+    int result = stage->cmd->filter->feed(stage->term, stage->state, stage->buffer, len);
+    terminal_output_set(prev);
+    if (result != SHELL_OK) {
+        stage->result = result;
+        stage->failed = 1;
+    }
+}
+
+static void pipe_stage_write(void *ctx, const char *buf, size_t len) {
+    pipe_stage_t *stage = (pipe_stage_t*)ctx;
+    if (stage->failed) {
         return;
     }
-    memset(cmd1_tokens, 0, sizeof(*cmd1_tokens));
-    cmd1_tokens->token_count = cmd1_end;
-    for (uint8_t i = 0; i < cmd1_end; i++) {
-        cmd1_tokens->tokens[i] = tokens->tokens[i];
+    if (stage->state == NULL) {
+        if (!stage->keep_whole) {
+            return;
+        }
+        if (stage->whole_len + len + 1 > stage->whole_cap) {
+            size_t cap = stage->whole_cap ? stage->whole_cap * 2 : 256;
+            while (cap < stage->whole_len + len + 1) {
+                cap *= 2;
+            }
+            char *whole = (char*)realloc(stage->whole, cap);
+            if (whole == NULL) {
+                stage->failed = 1;
+                stage->result = SHELL_ERR;
+                return;
+            }
+            stage->whole = whole;
+            stage->whole_cap = cap;
+        }
+        memcpy(stage->whole + stage->whole_len, buf, len);
+        stage->whole_len += len;
+        stage->whole[stage->whole_len] = '\0';
+        return;
     }
-    
-    // execute second command (read from pipe)
-    command_tokens_t *cmd2_tokens = (command_tokens_t*)malloc(sizeof(command_tokens_t));
-    if (cmd2_tokens == NULL) {
-        free(cmd1_tokens);
-        terminal_write_string(term, "Failed to allocate pipe command\n");
+    while (len > 0) {
+        size_t room = sizeof(stage->buffer) - stage->len;
+        if (room == 0) {
+            pipe_stage_drain(stage);
+            continue;
+        }
+        size_t n = len < room ? len : room;
+        memcpy(stage->buffer + stage->len, buf, n);
+        stage->len += n;
+        buf += n;
+        len -= n;
+    }
+}
+
+static void pipe_stage_open(pipe_stage_t *stage) {
+    const builtin_filter *filter = stage->cmd->filter;
+    stage->keep_whole = stage->cmd->reads_input;
+    if (filter == NULL) {
         return;
     }
-    memset(cmd2_tokens, 0, sizeof(*cmd2_tokens));
-    cmd2_tokens->token_count = tokens->token_count - cmd2_start;
-    for (uint8_t i = 0; i < cmd2_tokens->token_count; i++) {
-        cmd2_tokens->tokens[i] = tokens->tokens[cmd2_start + i];
+    void *state = calloc(1, filter->state_size > 0 ? filter->state_size : 1);
+    if (state == NULL) {
+        return;  // runs on its whole input instead, if it reads it
     }
-    
-    terminal_capture_start();
-    terminal_execute_command(term, cmd1_tokens);
-    size_t pipe_len = 0;
-    char *pipe_buf = terminal_capture_stop(&pipe_len);
-    free(cmd1_tokens);
-    if (pipe_buf == NULL) {
-        free(cmd2_tokens);
-        terminal_write_string(term, "pipe: failed to capture output\n");
+    terminal_output_t prev = terminal_output_set(stage->out);
+    int result = filter->open(stage->term, state, stage->argc, stage->argv);
+    terminal_output_set(prev);
+    if (result == SHELL_OK) {
+        stage->state = state;
         return;
     }
-    
-    term->pipe_input = pipe_buf;
-    term->pipe_input_len = pipe_len;
-    terminal_execute_command(term, cmd2_tokens);
-    term->pipe_input = NULL;
-    term->pipe_input_len = 0;
-    free(cmd2_tokens);
-    free(pipe_buf);
+    free(state);
+    if (result == SHELL_ENOTSUP) {
+        stage->keep_whole = 0;  // these arguments read files, not the input
+    } else {
+        stage->result = result;
+        stage->failed = 1;
+    }
 }
 
+// the input has ended, what's buffered still goes through and whatever the stage writes last
+// reaches the next one before that one ends too
+static void pipe_stage_close(pipe_stage_t *stage) {
+    terminal_output_t prev = terminal_output_set(stage->out);
+    if (stage->state != NULL) {
+        pipe_stage_drain(stage);
+        if (!stage->failed) {
+            stage->result = stage->cmd->filter->close(stage->term, stage->state);
+        }
+        free(stage->state);
+        stage->state = NULL;
+    } else if (!stage->failed) {
+        stage->term->pipe_input = stage->whole;
+        stage->term->pipe_input_len = stage->whole_len;
+        stage->result = stage->cmd->handler(stage->term, stage->argc, stage->argv);
+        stage->term->pipe_input = NULL;
+        stage->term->pipe_input_len = 0;
+    }
+    terminal_output_set(prev);
+    free(stage->whole);
+    stage->whole = NULL;
+}
 
+void terminal_execute_pipeline(terminal_state *term, command_tokens_t *tokens) {
+    if (term == NULL || tokens == NULL) {
+        return;
+    }
+    if (tokens->pipe_count >= max_pipe_commands) {
+        terminal_write_string(term, "pipe: too many commands\n");
+        return;
+    }
+    uint8_t count = tokens->pipe_count + 1;
+    pipe_stage_t *stages = (pipe_stage_t*)calloc(count, sizeof(pipe_stage_t));
+    if (stages == NULL) {
+        terminal_write_string(term, "Failed to allocate pipe command\n");
+        return;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        uint8_t start = i == 0 ? 0 : tokens->pipe_positions[i - 1];
+        uint8_t end = i + 1 < count ? tokens->pipe_positions[i] : tokens->token_count;
+        if (start >= end) {
+            terminal_write_string(term, "Invalid pipe syntax\n");
+            free(stages);
+            return;
+        }
+        stages[i].term = term;
+        stages[i].argv = &tokens->tokens[start];
+        stages[i].argc = end - start;
+        stages[i].cmd = builtins_find(stages[i].argv[0]);
+        if (stages[i].cmd == NULL) {
+            char error_msg[128];
+            snprintf(error_msg, sizeof(error_msg), "damocles: unknown command: %s\n", stages[i].argv[0]);
+            terminal_write_string(term, error_msg);
+            free(stages);
+            return;
+        }
+    }
+
+    terminal_redirect_t redirect;
+    if (terminal_redirect_begin(term, tokens, &redirect) != SHELL_OK) {
+        free(stages);
+        return;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        if (i + 1 < count) {
+            stages[i].out.fn = pipe_stage_write;
+            stages[i].out.ctx = &stages[i + 1];
+        } else {
+            stages[i].out = terminal_output_get();
+        }
+    }
+
+    // the consumers first, so what one writes on open already has somewhere to go
+    uint8_t first = redirect.in != NULL ? 0 : 1;
+    for (uint8_t i = count; i > first; i--) {
+        pipe_stage_open(&stages[i - 1]);
+    }
+    if (redirect.in != NULL) {
+        char buffer[128];
+        ssize_t read_bytes;
+        while ((read_bytes = vfs_read(redirect.in, buffer, sizeof(buffer))) > 0) {
+            pipe_stage_write(&stages[0], buffer, (size_t)read_bytes);
+        }
+    } else {
+        terminal_output_t prev = terminal_output_set(stages[0].out);
+        stages[0].result = stages[0].cmd->handler(term, stages[0].argc, stages[0].argv);
+        terminal_output_set(prev);
+    }
+    for (uint8_t i = first; i < count; i++) {
+        pipe_stage_close(&stages[i]);
+    }
+    terminal_redirect_end(term, &redirect);
+
+    for (uint8_t i = 0; i < count; i++) {
+        if (stages[i].result != 0) {
+            char error_msg[64];
+            snprintf(error_msg, sizeof(error_msg), "Command failed with code %d\n", stages[i].result);
+            terminal_write_string(term, error_msg);
+        }
+    }
+    free(stages);
+}
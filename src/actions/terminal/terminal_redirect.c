@@ -0,0 +1,191 @@
+#include "terminal.h"
+#include "shell_codes.h"
+#include "shell_error.h"
+#include <stdlib.h>
+#include <string.h>
+
+// shell redirections
+// > and 2> files are written through a terminal_redirect_buffer_size buffer, the output never
+// touches the grid and the file gets a few large writes instead of one per terminal_write_*()
+// < is opened here and read by terminal_execute_pipeline(), the first stage gets it like a pipe
+
+static void stream_flush(terminal_stream_t *stream) {
+    if (stream->len == 0) {
+        return;
+    }
+    if (!stream->failed) {
+        ssize_t written = vfs_write(stream->file, stream->buffer, stream->len);
+        if (written < 0 || (size_t)written != stream->len) {
+            stream->failed = 1;
+        }
+    }
+    stream->len = 0;
+}
+
+static void stream_write(void *ctx, const char *buf, size_t len) {
+    terminal_stream_t *stream = (terminal_stream_t*)ctx;
+    if (stream->failed) {
+        return;
+    }
+    if (stream->buffer == NULL || len >= terminal_redirect_buffer_size) {
+        stream_flush(stream);
+        ssize_t written = vfs_write(stream->file, buf, len);
+        if (written < 0 || (size_t)written != len) {
+            stream->failed = 1;
+        }
+        return;
+    }
+    if (stream->len + len > terminal_redirect_buffer_size) {
+        stream_flush(stream);
+    }
+    memcpy(stream->buffer + stream->len, buf, len);
+    stream->len += len;
+}
+
+// an existing file, or a new one in its parent directory
+static vfs_file_t *redirect_open_write(terminal_state *term, const char *path, int append) {
+    int flags = VFS_O_WRITE | VFS_O_CREATE | (append ? VFS_O_APPEND : VFS_O_TRUNC);
+    vfs_node_t *node = vfs_resolve_at(term->cwd, path);
+    if (node == NULL) {
+        char dir[max_token_length];
+        const char *name = strrchr(path, '/');
+        vfs_node_t *parent = NULL;
+        if (name == NULL) {
+            name = path;
+            parent = term->cwd;
+            if (parent == NULL) {
+                parent = vfs_resolve("/");
+            } else {
+                parent->refcount++;
+            }
+        } else {
+            size_t dir_len = (size_t)(name - path);
+            memcpy(dir, path, dir_len);
+            dir[dir_len] = '\0';
+            name++;
+            parent = dir_len == 0 ? vfs_resolve("/") : vfs_resolve_at(term->cwd, dir);
+        }
+        if (parent == NULL || name[0] == '\0') {
+            if (parent != NULL) {
+                vfs_node_release(parent);
+            }
+            return NULL;
+        }
+        if (parent->type == VFS_NODE_DIR) {
+            node = vfs_dir_create_node(parent, name, VFS_NODE_FILE);
+        }
+        vfs_node_release(parent);
+        if (node == NULL) {
+            return NULL;
+        }
+    }
+    vfs_file_t *file = NULL;
+    if (node->type == VFS_NODE_FILE) {
+        file = vfs_open_node(node, flags);
+    }
+    vfs_node_release(node);
+    return file;
+}
+
+static int stream_open(terminal_state *term, terminal_stream_t *stream, const char *path, int append) {
+    stream->file = redirect_open_write(term, path, append);
+    if (stream->file == NULL) {
+        shell_error(term, "damocles: %s: cannot open for writing", path);
+        return SHELL_ERR;
+    }
+    stream->buffer = (char*)malloc(terminal_redirect_buffer_size);  // unbuffered if there's no room
+    return SHELL_OK;
+}
+
+static void stream_close(terminal_state *term, terminal_stream_t *stream, const char *what) {
+    if (stream->file == NULL) {
+        return;
+    }
+    stream_flush(stream);
+    if (stream->failed) {
+        shell_error(term, "damocles: %s: write error", what);
+    }
+    vfs_close(stream->file);
+    free(stream->buffer);
+    memset(stream, 0, sizeof(*stream));
+}
+
+static void redirect_close(terminal_state *term, terminal_redirect_t *redirect) {
+    if (redirect->in != NULL) {
+        vfs_close(redirect->in);
+        redirect->in = NULL;
+    }
+    stream_close(term, &redirect->err, "error output");
+    stream_close(term, &redirect->out, "output");
+}
+
+int terminal_redirect_begin(terminal_state *term, const command_tokens_t *tokens, terminal_redirect_t *redirect) {
+    memset(redirect, 0, sizeof(*redirect));
+    if (term == NULL || tokens == NULL) {
+        return SHELL_ERR;
+    }
+    if (tokens->redirect_invalid) {
+        shell_error(term, "damocles: syntax error: redirection without a file");
+        return SHELL_EINVAL;
+    }
+    if (tokens->redirect_in[0] != '\0') {
+        vfs_node_t *node = vfs_resolve_at(term->cwd, tokens->redirect_in);
+        if (node == NULL || node->type != VFS_NODE_FILE) {
+            shell_error(term, "damocles: %s: no such file", tokens->redirect_in);
+            if (node != NULL) {
+                vfs_node_release(node);
+            }
+            return SHELL_ENOENT;
+        }
+        redirect->in = vfs_open_node(node, VFS_O_READ);
+        vfs_node_release(node);
+        if (redirect->in == NULL) {
+            shell_error(term, "damocles: %s: unable to open", tokens->redirect_in);
+            return SHELL_ERR;
+        }
+    }
+    if (tokens->redirect_err[0] != '\0' &&
+        stream_open(term, &redirect->err, tokens->redirect_err, tokens->redirect_err_append) != SHELL_OK) {
+        redirect_close(term, redirect);
+        return SHELL_ERR;
+    }
+    if (tokens->redirect_out[0] != '\0' &&
+        stream_open(term, &redirect->out, tokens->redirect_out, tokens->redirect_out_append) != SHELL_OK) {
+        redirect_close(term, redirect);
+        return SHELL_ERR;
+    }
+    if (redirect->out.file != NULL) {
+        terminal_output_t out = { stream_write, &redirect->out };
+        redirect->prev_out = terminal_output_set(out);
+    }
+    if (redirect->err.file != NULL) {
+        terminal_output_t err = { stream_write, &redirect->err };
+        redirect->prev_err = terminal_error_output_set(err);
+    }
+    return SHELL_OK;
+}
+
+int terminal_redirect_has(const command_tokens_t *tokens) {
+    return tokens != NULL && (tokens->redirect_invalid || tokens->redirect_in[0] != '\0' ||
+                              tokens->redirect_out[0] != '\0' || tokens->redirect_err[0] != '\0');
+}
+
+// "> file" on its own creates or truncates the file and "< file" checks it exists, like sh
+int terminal_redirect_only(terminal_state *term, const command_tokens_t *tokens) {
+    terminal_redirect_t redirect;
+    int result = terminal_redirect_begin(term, tokens, &redirect);
+    if (result == SHELL_OK) {
+        terminal_redirect_end(term, &redirect);
+    }
+    return result;
+}
+
+void terminal_redirect_end(terminal_state *term, terminal_redirect_t *redirect) {
+    if (redirect->out.file != NULL) {
+        terminal_output_set(redirect->prev_out);
+    }
+    if (redirect->err.file != NULL) {
+        terminal_error_output_set(redirect->prev_err);
+    }
+    redirect_close(term, redirect);
+}
@@ -0,0 +1,214 @@
+#include "terminal.h"
+#include "terminal_glyphs.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef ARDUINO
+#include <esp_heap_caps.h>
+#endif
+
+// row storage
+// the grid is a ring of grid_rows rows starting at row_base, scrolling advances row_base
+// and blanks one row instead of moving the whole buffer up, the row that falls off the top
+// goes into the window's scrollback (another ring, terminal_scrollback_rows deep)
+// the view can be paged back into it, any new output or keystroke brings it back to the live grid
+// the grid is only as big as the window's cell area, scrollback rows are always terminal_cols wide
+
+char *terminal_row(terminal_state *term, int row) {
+    if (term == NULL || term->buffer == NULL || row < 0 || row >= term->grid_rows) {
+        return NULL;
+    }
+    return term->buffer + (size_t)((term->row_base + row) % term->grid_rows) * term->grid_cols;
+}
+
+const char *terminal_view_row(const terminal_state *term, int row) {
+    if (term == NULL || term->buffer == NULL || row >= term->grid_rows) {
+        return NULL;
+    }
+    if (row >= 0) {
+        return term->buffer + (size_t)((term->row_base + row) % term->grid_rows) * term->grid_cols;
+    }
+    // -1 is the newest row in the scrollback
+    if (term->scrollback == NULL || -row > term->scrollback_count) {
+        return NULL;
+    }
+    int slot = (term->scrollback_head + row + terminal_scrollback_rows) % terminal_scrollback_rows;
+    return term->scrollback + (size_t)slot * terminal_cols;
+}
+
+// internal RAM is kept for stacks and DMA buffers, window storage goes to PSRAM on the device
+void *terminal_storage_alloc(size_t size) {
+#ifdef ARDUINO
+    void *mem = heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (mem != NULL) {
+        return mem;
+    }
+#endif
+    return malloc(size);
+}
+
+void terminal_scroll_up(terminal_state *term) {
+    if (term == NULL || term->buffer == NULL) {
+        return;
+    }
+    // only windows that actually scroll pay for a scrollback
+    if (term->scrollback == NULL) {
+        term->scrollback = (char*)terminal_storage_alloc((size_t)terminal_scrollback_rows * terminal_cols);
+        term->scrollback_head = 0;
+        term->scrollback_count = 0;
+    }
+    if (term->scrollback != NULL) {
+        // the oldest row is overwritten once the ring is full
+        char *slot = term->scrollback + (size_t)term->scrollback_head * terminal_cols;
+        memcpy(slot, terminal_row(term, 0), term->grid_cols);
+        memset(slot + term->grid_cols, ' ', terminal_cols - term->grid_cols);
+        term->scrollback_head = (uint16_t)((term->scrollback_head + 1) % terminal_scrollback_rows);
+        if (term->scrollback_count < terminal_scrollback_rows) {
+            term->scrollback_count++;
+        }
+    }
+    term->row_base = (uint8_t)((term->row_base + 1) % term->grid_rows);
+    memset(terminal_row(term, term->grid_rows - 1), ' ', term->grid_cols);
+    term->scrolled_rows++;
+}
+
+// text rows and columns the window shows, same cell layout as terminal_render_window()
+static int visible_rows(const terminal_state *term) {
+    int rows = (term->height - 10) / (glyph_base_h * terminal_get_zoom());
+    return rows > 0 ? rows : 1;
+}
+
+static int visible_cols(const terminal_state *term) {
+    int cols = (term->width - 10) / (glyph_base_w * terminal_get_zoom());
+    return cols > 0 ? cols : 1;
+}
+
+int terminal_grid_fit(terminal_state *term) {
+    if (term == NULL) {
+        return -1;
+    }
+    // the host build lays nothing out, its windows get the largest grid
+    int rows = terminal_rows;
+    int cols = terminal_cols;
+    if (term->width > 0 && term->height > 0) {
+        rows = visible_rows(term);
+        cols = visible_cols(term);
+        if (rows > terminal_rows) rows = terminal_rows;
+        if (cols > terminal_cols) cols = terminal_cols;
+    }
+    if (term->buffer != NULL && rows == term->grid_rows && cols == term->grid_cols) {
+        return 0;
+    }
+    char *grid = (char*)terminal_storage_alloc((size_t)rows * cols);
+    if (grid == NULL) {
+        return -1;
+    }
+    memset(grid, ' ', (size_t)rows * cols);
+
+    int used = 0;   // old rows that move over
+    int pulled = 0; // scrollback rows that come back in on top of them
+    if (term->buffer != NULL) {
+        // the rows up to the cursor stay, whatever doesn't fit goes into the scrollback
+        used = term->cursor_row < term->grid_rows ? term->cursor_row + 1 : term->grid_rows;
+        while (used > rows) {
+            terminal_scroll_up(term);
+            term->cursor_row--;
+            term->fastfetch_start_row = term->fastfetch_start_row > 0 ? term->fastfetch_start_row - 1 : 0;
+            used--;
+        }
+        // a full window that grows gets its newest scrollback rows back
+        if (used == term->grid_rows && rows > used && term->scrollback != NULL) {
+            pulled = rows - used;
+            if (pulled > term->scrollback_count) pulled = term->scrollback_count;
+        }
+        int copy_cols = cols < term->grid_cols ? cols : term->grid_cols;
+        for (int row = 0; row < pulled; row++) {
+            memcpy(grid + (size_t)row * cols, terminal_view_row(term, row - pulled), copy_cols);
+        }
+        for (int row = 0; row < used; row++) {
+            memcpy(grid + (size_t)(pulled + row) * cols, terminal_row(term, row), copy_cols);
+        }
+        term->scrollback_head = (uint16_t)((term->scrollback_head + terminal_scrollback_rows - pulled) %
+                                           terminal_scrollback_rows);
+        term->scrollback_count = (uint16_t)(term->scrollback_count - pulled);
+        term->cursor_row = (uint8_t)(term->cursor_row + pulled);
+        term->fastfetch_start_row = (uint8_t)(term->fastfetch_start_row + pulled);
+        free(term->buffer);
+    }
+    // the render task never sees this grid, snapshots carry their own copy of the cells
+    term->buffer = grid;
+    term->grid_rows = (uint8_t)rows;
+    term->grid_cols = (uint8_t)cols;
+    term->row_base = 0;
+    term->view_offset = 0;
+    if (term->cursor_col >= cols) {
+        term->cursor_col = (uint8_t)(cols - 1);
+    }
+    terminal_mark_dirty(term);
+    return 0;
+}
+
+void terminal_storage_release(terminal_state *term) {
+    if (term == NULL) {
+        return;
+    }
+    free(term->buffer);
+    term->buffer = NULL;
+    term->grid_rows = 0;
+    term->grid_cols = 0;
+    term->row_base = 0;
+}
+
+// the render task's copy of the window points at the same rows, the free waits for its frame
+void terminal_scrollback_release(terminal_state *term) {
+    if (term == NULL) {
+        return;
+    }
+    if (term->scrollback != NULL) {
+        terminal_render_lock();
+        free(term->scrollback);
+        term->scrollback = NULL;
+        terminal_render_unlock();
+    }
+    term->scrollback_head = 0;
+    term->scrollback_count = 0;
+    term->view_offset = 0;
+}
+
+void terminal_scroll_view(terminal_state *term, int rows) {
+    if (term == NULL || !term->active) {
+        return;
+    }
+    // as far back as the oldest scrollback row at the top of the window
+    int visible = visible_rows(term);
+    int above = term->cursor_row >= visible ? term->cursor_row - visible + 1 : 0;
+    int limit = term->scrollback_count + above;
+    int offset = term->view_offset + rows;
+    if (offset > limit) offset = limit;
+    if (offset < 0) offset = 0;
+    if (offset == term->view_offset) {
+        return;
+    }
+    // a new first row on screen, the renderer diffs every visible row against the panel
+    term->view_offset = (uint16_t)offset;
+    terminal_render_request(term);
+}
+
+// hotkey actions on the window that takes the keyboard, a page keeps one row of context
+void terminal_scroll_back(void) {
+    terminal_state *term = get_active_terminal();
+    if (term == NULL) {
+        return;
+    }
+    int page = visible_rows(term) - 1;
+    terminal_scroll_view(term, page > 0 ? page : 1);
+}
+
+void terminal_scroll_forward(void) {
+    terminal_state *term = get_active_terminal();
+    if (term == NULL) {
+        return;
+    }
+    int page = visible_rows(term) - 1;
+    terminal_scroll_view(term, -(page > 0 ? page : 1));
+}
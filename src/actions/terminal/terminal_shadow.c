@@ -0,0 +1,131 @@
+#include "terminal.h"
+#include <stdlib.h>
+#include <string.h>
+
+// shadow copy of what each window currently shows on the panel
+// the renderer builds the cells it wants per row and only draws the ones that differ
+
+int terminal_shadow_prepare(terminal_state *term, int16_t rows, int16_t cols, uint8_t zoom) {
+    if (term == NULL || rows <= 0 || cols <= 0) {
+        return -1;
+    }
+    if (term->shadow != NULL && term->shadow_rows == rows &&
+        term->shadow_cols == cols && term->shadow_zoom == zoom) {
+        return 0;
+    }
+    // zoom or window size changed, nothing in the old grid lines up anymore
+    terminal_cell_t *cells = (terminal_cell_t*)realloc(term->shadow,
+                                                       (size_t)rows * (size_t)cols * sizeof(terminal_cell_t));
+    if (cells == NULL) {
+        terminal_shadow_release(term);
+        return -1;
+    }
+    term->shadow = cells;
+    term->shadow_rows = rows;
+    term->shadow_cols = cols;
+    term->shadow_zoom = zoom;
+    terminal_shadow_fill(term, ' ', terminal_attr_unknown);
+    return 1;
+}
+
+void terminal_shadow_fill(terminal_state *term, char ch, uint8_t attr) {
+    if (term == NULL || term->shadow == NULL) {
+        return;
+    }
+    size_t count = (size_t)term->shadow_rows * (size_t)term->shadow_cols;
+    for (size_t i = 0; i < count; i++) {
+        term->shadow[i].ch = ch;
+        term->shadow[i].attr = attr;
+    }
+}
+
+void terminal_shadow_forget_cell(terminal_state *term, int16_t row, int16_t col) {
+    if (term == NULL || term->shadow == NULL || row < 0 || row >= term->shadow_rows ||
+        col < 0 || col >= term->shadow_cols) {
+        return;
+    }
+    term->shadow[(size_t)row * term->shadow_cols + col].attr = terminal_attr_unknown;
+}
+
+static int cell_changed(const terminal_cell_t *have, const terminal_cell_t *want) {
+    return have->attr == terminal_attr_unknown || have->attr != want->attr || have->ch != want->ch;
+}
+
+int terminal_shadow_diff_row(terminal_state *term, int16_t row, const terminal_cell_t *want,
+                             terminal_span_fn emit, void *ctx) {
+    if (term == NULL || term->shadow == NULL || want == NULL || row < 0 || row >= term->shadow_rows) {
+        return 0;
+    }
+    terminal_cell_t *have = term->shadow + (size_t)row * term->shadow_cols;
+    int16_t cols = term->shadow_cols;
+    char text[cols + 1];
+    int drawn = 0;
+
+    int16_t col = 0;
+    while (col < cols) {
+        // image cells are owned by the bitmap under them, just remember they're there
+        if (want[col].attr == terminal_attr_image || !cell_changed(&have[col], &want[col])) {
+            have[col] = want[col];
+            col++;
+            continue;
+        }
+
+        // grow the span over cells of the same attr, bridging short unchanged gaps
+        uint8_t attr = want[col].attr;
+        int16_t start = col;
+        int16_t end = col + 1;
+        for (int16_t k = col + 1; k < cols && want[k].attr == attr && k - end <= terminal_span_gap; k++) {
+            if (cell_changed(&have[k], &want[k])) {
+                end = k + 1;
+            }
+        }
+
+        int16_t len = end - start;
+        for (int16_t k = 0; k < len; k++) {
+            text[k] = want[start + k].ch;
+            have[start + k] = want[start + k];
+        }
+        text[len] = '\0';
+        if (emit != NULL) {
+            emit(ctx, row, start, text, len, attr);
+        }
+        drawn += len;
+        col = end;
+    }
+    return drawn;
+}
+
+void terminal_shadow_scroll(terminal_state *term, int16_t rows) {
+    if (term == NULL || term->shadow == NULL || rows <= 0) {
+        return;
+    }
+    if (rows > term->shadow_rows) {
+        rows = term->shadow_rows;
+    }
+    size_t row_cells = (size_t)term->shadow_cols;
+    size_t kept = (size_t)(term->shadow_rows - rows) * row_cells;
+    memmove(term->shadow, term->shadow + (size_t)rows * row_cells, kept * sizeof(terminal_cell_t));
+    // whatever the panel has there now is left over from the rows that went off the top
+    for (size_t i = kept; i < (size_t)term->shadow_rows * row_cells; i++) {
+        term->shadow[i].ch = ' ';
+        term->shadow[i].attr = terminal_attr_unknown;
+    }
+}
+
+int16_t terminal_vscroll_map(int16_t y, int16_t top, int16_t height, int16_t offset) {
+    if (height <= 0 || y < top || y >= top + height) {
+        return y;
+    }
+    return (int16_t)(top + (y - top + offset) % height);
+}
+
+void terminal_shadow_release(terminal_state *term) {
+    if (term == NULL) {
+        return;
+    }
+    free(term->shadow);
+    term->shadow = NULL;
+    term->shadow_rows = 0;
+    term->shadow_cols = 0;
+    term->shadow_zoom = 0;
+}
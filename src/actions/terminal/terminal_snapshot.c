@@ -0,0 +1,192 @@
+#include "terminal.h"
+#include "login.h"
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef ARDUINO
+#include <esp_heap_caps.h>
+#endif
+
+extern int nano_is_active(void);
+extern int firstboot_is_active(void);
+extern int passwd_is_active(void);
+extern uint8_t selected_terminal;
+
+// lock free handoff between the shell loop and the render task
+// three slots: the producer fills its back slot and swaps it into ready, the consumer swaps its
+// front slot for ready when that holds something new, one atomic exchange on each side
+// ready carries the slot index and a fresh bit that is set until the consumer took it
+
+#define snapshot_slots 3
+#define snapshot_fresh 0x80
+#define snapshot_index 0x03
+
+// only the content part of a window is copied, painted state and the shadow belong to the renderer
+// the grid goes along in the slot's own cells
+#define snapshot_content_size offsetof(terminal_state, dirty_rows)
+
+static terminal_snapshot_t *slots[snapshot_slots] = {0};
+static uint8_t back_slot = 0;
+static uint8_t ready_slot = 1;  // shared, only touched through __atomic
+static uint8_t front_slot = 2;
+
+// what went into the last publish, replayed if the render task never got to it
+static uint8_t last_damaged = 0;
+static uint8_t last_invalid = 0;
+static uint8_t last_full = 0;
+static uint8_t last_dirty[max_windows][(terminal_rows + 7) / 8];
+
+// three copies of every window are too big for internal RAM
+static terminal_snapshot_t *slot_alloc(void) {
+#ifdef ARDUINO
+    terminal_snapshot_t *slot = (terminal_snapshot_t*)heap_caps_calloc(1, sizeof(terminal_snapshot_t),
+                                                                        MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (slot != NULL) {
+        return slot;
+    }
+#endif
+    return (terminal_snapshot_t*)calloc(1, sizeof(terminal_snapshot_t));
+}
+
+void terminal_render_env_capture(terminal_render_env_t *env) {
+    if (env == NULL) {
+        return;
+    }
+    env->selected = selected_terminal;
+    env->zoom = terminal_get_zoom();
+    env->active_color = terminal_get_active_color();
+    env->modes = (uint8_t)((nano_is_active() ? terminal_mode_nano : 0) |
+                           (firstboot_is_active() ? terminal_mode_firstboot : 0) |
+                           (passwd_is_active() ? terminal_mode_passwd : 0) |
+                           (login_is_active() ? terminal_mode_login : 0));
+}
+
+int terminal_snapshot_init(void) {
+    if (slots[0] != NULL) {
+        return 0;
+    }
+    for (int i = 0; i < snapshot_slots; i++) {
+        slots[i] = slot_alloc();
+        if (slots[i] == NULL) {
+            terminal_snapshot_free();
+            return -1;
+        }
+    }
+    back_slot = 0;
+    __atomic_store_n(&ready_slot, 1, __ATOMIC_RELEASE);
+    front_slot = 2;
+    last_damaged = 0;
+    last_invalid = 0;
+    last_full = 0;
+    return 0;
+}
+
+void terminal_snapshot_free(void) {
+    for (int i = 0; i < snapshot_slots; i++) {
+        free(slots[i]);
+        slots[i] = NULL;
+    }
+}
+
+int terminal_snapshot_publish(uint8_t damaged, uint8_t full) {
+    if (slots[0] == NULL) {
+        return -1;
+    }
+
+    // the last snapshot still sits unread, this one replaces it so it has to carry its damage too
+    // (if the render task takes it in the meantime a few windows just get copied twice)
+    if (__atomic_load_n(&ready_slot, __ATOMIC_ACQUIRE) & snapshot_fresh) {
+        for (uint8_t i = 0; i < max_windows; i++) {
+            if (!(last_damaged & (1u << i))) {
+                continue;
+            }
+            for (size_t b = 0; b < sizeof(last_dirty[i]); b++) {
+                terminals[i].dirty_rows[b] |= last_dirty[i][b];
+            }
+            if (last_invalid & (1u << i)) {
+                terminals[i].painted_valid = 0;
+            }
+        }
+        damaged |= last_damaged;
+        full |= last_full;
+    }
+
+    terminal_snapshot_t *snap = slots[back_slot];
+    snap->damaged = 0;
+    snap->invalid = 0;
+    snap->full = full ? 1 : 0;
+    terminal_render_env_capture(&snap->env);
+    for (uint8_t i = 0; i < max_windows; i++) {
+        if (full && terminals[i].active) {
+            damaged |= (uint8_t)(1u << i);
+        }
+        if (!(damaged & (1u << i))) {
+            continue;
+        }
+        terminal_state *term = &terminals[i];
+        memcpy(&snap->windows[i], term, snapshot_content_size);
+        if (term->buffer != NULL) {
+            memcpy(snap->cells[i], term->buffer, (size_t)term->grid_rows * term->grid_cols);
+            snap->windows[i].buffer = snap->cells[i];
+        }
+        memcpy(snap->windows[i].dirty_rows, term->dirty_rows, sizeof(term->dirty_rows));
+        memcpy(last_dirty[i], term->dirty_rows, sizeof(term->dirty_rows));
+        snap->damaged |= (uint8_t)(1u << i);
+        if (!term->painted_valid) {
+            snap->invalid |= (uint8_t)(1u << i);
+        }
+        // from here on the render task owns this damage
+        terminal_clear_dirty(term);
+        term->painted_valid = 1;
+    }
+    last_damaged = snap->damaged;
+    last_invalid = snap->invalid;
+    last_full = snap->full;
+
+    uint8_t prev = __atomic_exchange_n(&ready_slot, (uint8_t)(back_slot | snapshot_fresh), __ATOMIC_ACQ_REL);
+    back_slot = prev & snapshot_index;
+    return 0;
+}
+
+const terminal_snapshot_t *terminal_snapshot_take(void) {
+    if (slots[0] == NULL || !(__atomic_load_n(&ready_slot, __ATOMIC_ACQUIRE) & snapshot_fresh)) {
+        return NULL;
+    }
+    // only the producer sets the fresh bit, so it is still set here, maybe on an even newer slot
+    uint8_t prev = __atomic_exchange_n(&ready_slot, front_slot, __ATOMIC_ACQ_REL);
+    front_slot = prev & snapshot_index;
+    return slots[front_slot];
+}
+
+void terminal_snapshot_apply(terminal_state *windows, const terminal_snapshot_t *snap) {
+    if (windows == NULL || snap == NULL) {
+        return;
+    }
+    for (uint8_t i = 0; i < max_windows; i++) {
+        if (!(snap->damaged & (1u << i))) {
+            continue;
+        }
+        terminal_state *term = &windows[i];
+        const terminal_state *src = &snap->windows[i];
+        // the copy keeps its own cells, slots are reused under it
+        char *cells = term->buffer;
+        memcpy(term, src, snapshot_content_size);
+        if (cells == NULL && src->buffer != NULL) {
+            cells = (char*)terminal_storage_alloc(terminal_buffer_size);
+        }
+        term->buffer = cells;
+        if (cells != NULL && src->buffer != NULL) {
+            memcpy(cells, src->buffer, (size_t)src->grid_rows * src->grid_cols);
+        } else {
+            term->grid_rows = 0;  // nothing to show, the window paints blank
+        }
+        // damage adds up with whatever the copy hasn't painted yet
+        for (size_t b = 0; b < sizeof(term->dirty_rows); b++) {
+            term->dirty_rows[b] |= src->dirty_rows[b];
+        }
+        if (snap->invalid & (1u << i)) {
+            term->painted_valid = 0;
+        }
+    }
+}
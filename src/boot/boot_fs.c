@@ -0,0 +1,258 @@
+// single pass filesystem provisioning for boot
+// the old way was one exists()+mkdir/open per path, each with its own SPI switch,
+// this lists every parent directory once and only touches what is missing
+
+#include "boot_fs.h"
+#include <string.h>
+
+#define max_manifest_entries 128
+#define max_group_entries 32
+
+// per entry state while provisioning
+#define st_present 0x01
+#define st_created 0x02
+#define st_empty   0x04  // directory had no children (or was just created)
+#define st_failed  0x08
+#define st_grouped 0x10
+
+const boot_fs_entry_t boot_fs_manifest[] = {
+    {"/bin", BOOT_FS_DIR, NULL, NULL},
+    {"/dev", BOOT_FS_DIR, NULL, NULL},
+    {"/etc", BOOT_FS_DIR, NULL, NULL},
+    {"/home", BOOT_FS_DIR, NULL, NULL},
+    {"/proc", BOOT_FS_DIR, NULL, NULL},
+    {"/run", BOOT_FS_DIR, NULL, NULL},
+    {"/tmp", BOOT_FS_DIR, NULL, NULL},
+    {"/usr", BOOT_FS_DIR, NULL, NULL},
+    {"/var", BOOT_FS_DIR, NULL, NULL},
+
+    {"/bin/sh", BOOT_FS_FILE, NULL, NULL},
+    {"/bin/ls", BOOT_FS_FILE, NULL, NULL},
+    {"/bin/cat", BOOT_FS_FILE, NULL, NULL},
+    {"/bin/echo", BOOT_FS_FILE, NULL, NULL},
+    {"/bin/ps", BOOT_FS_FILE, NULL, NULL},
+    {"/bin/kill", BOOT_FS_FILE, NULL, NULL},
+    {"/bin/clear", BOOT_FS_FILE, NULL, NULL},
+    {"/bin/help", BOOT_FS_FILE, NULL, NULL},
+    {"/bin/reboot", BOOT_FS_FILE, NULL, NULL},
+    {"/bin/nano", BOOT_FS_FILE, NULL, NULL},
+    {"/bin/top", BOOT_FS_FILE, NULL, NULL},
+    {"/bin/uptime", BOOT_FS_FILE, NULL, NULL},
+    {"/bin/meminfo", BOOT_FS_FILE, NULL, NULL},
+    {"/bin/logread", BOOT_FS_FILE, NULL, NULL},
+
+    {"/dev/input", BOOT_FS_DIR, NULL, NULL},
+    {"/dev/pipe", BOOT_FS_DIR, NULL, NULL},
+    {"/dev/tty", BOOT_FS_FILE, NULL, NULL},
+    {"/dev/tty0", BOOT_FS_FILE, NULL, NULL},
+    {"/dev/null", BOOT_FS_FILE, NULL, NULL},
+    {"/dev/input/keyboard", BOOT_FS_FILE, NULL, NULL},
+
+    {"/etc/passwd", BOOT_FS_FILE, NULL, NULL},
+    {"/etc/shells", BOOT_FS_FILE, NULL, NULL},
+    {"/etc/system.conf", BOOT_FS_FILE, NULL, NULL},
+    {"/etc/tty.conf", BOOT_FS_FILE, NULL, NULL},
+    {"/etc/keymap.conf", BOOT_FS_FILE, NULL, NULL},
+    {"/etc/motd", BOOT_FS_FILE, NULL, NULL},
+
+    // default user home, only seeded on a card with no users yet
+    {"/home/user", BOOT_FS_DIR, NULL, "/home"},
+    {"/home/user/documents", BOOT_FS_DIR, NULL, "/home"},
+    {"/home/user/.profile", BOOT_FS_FILE, NULL, "/home"},
+    {"/home/user/.history", BOOT_FS_FILE, NULL, "/home"},
+    {"/home/user/.editorrc", BOOT_FS_FILE, NULL, "/home"},
+
+    {"/proc/tasks", BOOT_FS_DIR, NULL, NULL},
+    {"/proc/uptime", BOOT_FS_FILE, NULL, NULL},
+    {"/proc/meminfo", BOOT_FS_FILE, NULL, NULL},
+    {"/proc/version", BOOT_FS_FILE, NULL, NULL},
+    {"/proc/sched", BOOT_FS_FILE, NULL, NULL},
+
+    {"/run/pipes", BOOT_FS_DIR, NULL, NULL},
+    {"/run/tasks", BOOT_FS_DIR, NULL, NULL},
+    {"/run/events", BOOT_FS_DIR, NULL, NULL},
+    {"/run/tty.lock", BOOT_FS_FILE, NULL, NULL},
+    {"/run/scheduler.lock", BOOT_FS_FILE, NULL, NULL},
+    {"/run/pipes/3", BOOT_FS_FILE, NULL, NULL},
+    {"/run/pipes/4", BOOT_FS_FILE, NULL, NULL},
+    {"/run/tasks/1", BOOT_FS_FILE, NULL, NULL},
+    {"/run/tasks/2", BOOT_FS_FILE, NULL, NULL},
+    {"/run/events/queue", BOOT_FS_FILE, NULL, NULL},
+
+    {"/tmp/.keep", BOOT_FS_FILE, NULL, NULL},
+
+    {"/usr/bin", BOOT_FS_DIR, NULL, NULL},
+    {"/usr/share", BOOT_FS_DIR, NULL, NULL},
+    {"/usr/bin/games", BOOT_FS_DIR, NULL, NULL},
+    {"/usr/bin/demos", BOOT_FS_DIR, NULL, NULL},
+    {"/usr/share/help", BOOT_FS_DIR, NULL, NULL},
+    {"/usr/share/fonts", BOOT_FS_DIR, NULL, NULL},
+    {"/usr/share/banners", BOOT_FS_DIR, NULL, NULL},
+
+    {"/var/log", BOOT_FS_DIR, NULL, NULL},
+    {"/var/log/kernel.log", BOOT_FS_FILE, NULL, NULL},
+    {"/var/log/scheduler.log", BOOT_FS_FILE, NULL, NULL},
+    {"/var/log/terminal.log", BOOT_FS_FILE, NULL, NULL},
+    {"/var/log/input.log", BOOT_FS_FILE, NULL, NULL},
+    {"/var/log/boot.log", BOOT_FS_FILE, NULL, NULL},
+};
+
+const size_t boot_fs_manifest_count = sizeof(boot_fs_manifest) / sizeof(boot_fs_manifest[0]);
+
+typedef struct {
+    const boot_fs_entry_t *manifest;
+    uint8_t *state;
+    const uint8_t *group;
+    size_t group_count;
+    size_t parent_len;
+    uint8_t conflict[max_group_entries];
+    int any;
+} scan_ctx_t;
+
+// length of the parent part of a path, "/bin" -> 1 ("/"), "/dev/tty" -> 4
+static size_t parent_len(const char *path) {
+    const char *slash = strrchr(path, '/');
+    if (slash == NULL || slash == path) {
+        return 1;
+    }
+    return (size_t)(slash - path);
+}
+
+static const char* base_name(const char *path, size_t plen) {
+    return path + plen + (plen > 1 ? 1 : 0);
+}
+
+static int same_parent(const char *a, const char *b) {
+    size_t la = parent_len(a);
+    return la == parent_len(b) && strncmp(a, b, la) == 0;
+}
+
+static int find_entry(const boot_fs_entry_t *manifest, size_t count, const char *path, size_t len) {
+    for (size_t i = 0; i < count; i++) {
+        if (strncmp(manifest[i].path, path, len) == 0 && manifest[i].path[len] == '\0') {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+static void scan_found(const char *name, int is_dir, void *ctx) {
+    scan_ctx_t *scan = (scan_ctx_t*)ctx;
+    scan->any = 1;
+    for (size_t g = 0; g < scan->group_count; g++) {
+        const boot_fs_entry_t *e = &scan->manifest[scan->group[g]];
+        if (strcmp(base_name(e->path, scan->parent_len), name) != 0) {
+            continue;
+        }
+        if ((is_dir != 0) == (e->is_dir != 0)) {
+            scan->state[scan->group[g]] |= st_present;
+        } else {
+            scan->conflict[g] = 1;  // a file where a dir should be (or the other way)
+        }
+        return;
+    }
+}
+
+int boot_fs_provision(const boot_fs_entry_t *manifest, size_t count,
+                      const boot_fs_io_t *io, boot_fs_report_t *report) {
+    boot_fs_report_t local = {0};
+    if (report == NULL) {
+        report = &local;
+    }
+    memset(report, 0, sizeof(*report));
+    if (manifest == NULL || io == NULL || count > max_manifest_entries) {
+        return -1;
+    }
+
+    uint8_t state[max_manifest_entries] = {0};
+    uint8_t group[max_group_entries];
+
+    for (size_t i = 0; i < count; i++) {
+        // handle each parent once, at its first entry
+        if (state[i] & st_grouped) {
+            continue;
+        }
+
+        size_t plen = parent_len(manifest[i].path);
+        size_t group_count = 0;
+        for (size_t k = i; k < count && group_count < max_group_entries; k++) {
+            if (!(state[k] & st_grouped) && same_parent(manifest[k].path, manifest[i].path)) {
+                state[k] |= st_grouped;
+                group[group_count++] = (uint8_t)k;
+            }
+        }
+
+        // a parent we just made is known empty, one we couldn't make can't hold anything
+        int pidx = find_entry(manifest, count, manifest[i].path, plen);
+        int need_scan = 1;
+        if (pidx >= 0 && (state[pidx] & st_created)) {
+            need_scan = 0;
+        } else if (pidx >= 0 && !(state[pidx] & st_present)) {
+            for (size_t g = 0; g < group_count; g++) {
+                state[group[g]] |= st_failed;
+                report->skipped++;
+            }
+            continue;
+        }
+
+        scan_ctx_t scan = {0};
+        scan.manifest = manifest;
+        scan.state = state;
+        scan.group = group;
+        scan.group_count = group_count;
+        scan.parent_len = plen;
+        if (need_scan) {
+            char parent[128];
+            if (plen >= sizeof(parent)) {
+                return -1;
+            }
+            memcpy(parent, manifest[i].path, plen);
+            parent[plen] = '\0';
+            report->dirs_scanned++;
+            if (io->list_dir(parent, scan_found, &scan) != 0) {
+                for (size_t g = 0; g < group_count; g++) {
+                    state[group[g]] |= st_failed;
+                    report->failed++;
+                }
+                continue;
+            }
+            if (pidx >= 0 && !scan.any) {
+                state[pidx] |= st_empty;
+            }
+        }
+
+        for (size_t g = 0; g < group_count; g++) {
+            size_t idx = group[g];
+            const boot_fs_entry_t *e = &manifest[idx];
+            if (scan.conflict[g]) {
+                state[idx] |= st_failed;
+                report->failed++;
+                continue;
+            }
+            if (state[idx] & st_present) {
+                report->present++;
+                continue;
+            }
+            if (e->only_if_empty != NULL) {
+                int gate = find_entry(manifest, count, e->only_if_empty, strlen(e->only_if_empty));
+                if (gate < 0 || !(state[gate] & st_empty)) {
+                    report->skipped++;
+                    continue;
+                }
+            }
+            int ret = e->is_dir ? io->make_dir(e->path) : io->make_file(e->path, e->content);
+            if (ret != 0) {
+                state[idx] |= st_failed;
+                report->failed++;
+                continue;
+            }
+            state[idx] |= st_present | st_created;
+            if (e->is_dir) {
+                state[idx] |= st_empty;
+            }
+            report->created++;
+        }
+    }
+
+    return report->failed == 0 ? 0 : -1;
+}
@@ -0,0 +1,174 @@
+#include "boot_logo_cache.h"
+#include <string.h>
+
+enum {
+    rle_header = 0,
+    rle_run_pixel,
+    rle_run,
+    rle_literal
+};
+
+static void put_u16(uint8_t *out, uint16_t v) {
+    out[0] = (uint8_t)(v & 0xFF);
+    out[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *out, uint32_t v) {
+    put_u16(out, (uint16_t)(v & 0xFFFF));
+    put_u16(out + 2, (uint16_t)(v >> 16));
+}
+
+static uint16_t get_u16(const uint8_t *in) {
+    return (uint16_t)(in[0] | (in[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t *in) {
+    return (uint32_t)get_u16(in) | ((uint32_t)get_u16(in + 2) << 16);
+}
+
+void boot_logo_cache_header_pack(const boot_logo_cache_header_t *hdr, uint8_t out[BOOT_LOGO_CACHE_HEADER_SIZE]) {
+    put_u32(out, hdr->magic);
+    put_u16(out + 4, hdr->version);
+    put_u16(out + 6, hdr->encoding);
+    put_u16(out + 8, hdr->width);
+    put_u16(out + 10, hdr->height);
+    put_u32(out + 12, hdr->source_key);
+    put_u32(out + 16, hdr->payload_size);
+}
+
+int boot_logo_cache_header_unpack(const uint8_t in[BOOT_LOGO_CACHE_HEADER_SIZE], boot_logo_cache_header_t *hdr) {
+    hdr->magic = get_u32(in);
+    hdr->version = get_u16(in + 4);
+    hdr->encoding = get_u16(in + 6);
+    hdr->width = get_u16(in + 8);
+    hdr->height = get_u16(in + 10);
+    hdr->source_key = get_u32(in + 12);
+    hdr->payload_size = get_u32(in + 16);
+    return hdr->magic == BOOT_LOGO_CACHE_MAGIC && hdr->version == BOOT_LOGO_CACHE_VERSION &&
+           hdr->encoding == BOOT_LOGO_ENC_RLE && hdr->width > 0 && hdr->height > 0;
+}
+
+int boot_logo_cache_path(const char *source_path, char *out, size_t out_len) {
+    if (source_path == NULL || out == NULL) {
+        return -1;
+    }
+    size_t len = strlen(source_path);
+    if (len + sizeof(BOOT_LOGO_CACHE_SUFFIX) > out_len) {
+        return -1;
+    }
+    memcpy(out, source_path, len);
+    memcpy(out + len, BOOT_LOGO_CACHE_SUFFIX, sizeof(BOOT_LOGO_CACHE_SUFFIX));
+    return 0;
+}
+
+uint32_t boot_logo_hash(uint32_t hash, const void *data, size_t len) {
+    const uint8_t *p = (const uint8_t*)data;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= p[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+void boot_logo_scale_row(const uint8_t *src_row, uint16_t src_w, uint16_t *dst, uint16_t dst_w) {
+    for (uint16_t x = 0; x < dst_w; x++) {
+        uint32_t sx = (uint32_t)x * src_w / dst_w;
+        dst[x] = get_u16(src_row + sx * 2);
+    }
+}
+
+size_t boot_logo_rle_encode(const uint16_t *pixels, size_t count, uint8_t *out, size_t out_cap) {
+    size_t used = 0;
+    size_t i = 0;
+    while (i < count) {
+        // a run pays off from 3 equal pixels on, anything shorter goes into a literal
+        size_t run = 1;
+        while (i + run < count && run < BOOT_LOGO_RLE_MAX_RECORD && pixels[i + run] == pixels[i]) {
+            run++;
+        }
+        if (run >= 3) {
+            if (used + 4 > out_cap) {
+                return 0;
+            }
+            put_u16(out + used, (uint16_t)(0x8000 | (run - 1)));
+            put_u16(out + used + 2, pixels[i]);
+            used += 4;
+            i += run;
+            continue;
+        }
+
+        size_t lit = 0;
+        while (i + lit < count && lit < BOOT_LOGO_RLE_MAX_RECORD) {
+            if (i + lit + 2 < count && pixels[i + lit] == pixels[i + lit + 1] &&
+                pixels[i + lit] == pixels[i + lit + 2]) {
+                break;
+            }
+            lit++;
+        }
+        if (used + 2 + lit * 2 > out_cap) {
+            return 0;
+        }
+        put_u16(out + used, (uint16_t)(lit - 1));
+        used += 2;
+        for (size_t k = 0; k < lit; k++) {
+            put_u16(out + used, pixels[i + k]);
+            used += 2;
+        }
+        i += lit;
+    }
+    return used;
+}
+
+void boot_logo_rle_init(boot_logo_rle_t *dec) {
+    memset(dec, 0, sizeof(*dec));
+    dec->state = rle_header;
+}
+
+size_t boot_logo_rle_decode(boot_logo_rle_t *dec, const uint8_t *in, size_t in_len, size_t *in_used,
+                            uint16_t *out, size_t out_cap) {
+    size_t pos = 0;
+    size_t produced = 0;
+    while (produced < out_cap) {
+        if (dec->state == rle_run) {
+            size_t n = dec->remaining;
+            if (n > out_cap - produced) {
+                n = out_cap - produced;
+            }
+            for (size_t k = 0; k < n; k++) {
+                out[produced++] = dec->run_pixel;
+            }
+            dec->remaining -= (uint32_t)n;
+            if (dec->remaining == 0) {
+                dec->state = rle_header;
+            }
+            continue;
+        }
+
+        // everything else consumes one u16, which may straddle two input chunks
+        while (dec->partial_len < 2 && pos < in_len) {
+            dec->partial[dec->partial_len++] = in[pos++];
+        }
+        if (dec->partial_len < 2) {
+            break;
+        }
+        uint16_t v = get_u16(dec->partial);
+        dec->partial_len = 0;
+
+        if (dec->state == rle_header) {
+            dec->remaining = (uint32_t)(v & 0x7FFF) + 1;
+            dec->state = (v & 0x8000) ? rle_run_pixel : rle_literal;
+        } else if (dec->state == rle_run_pixel) {
+            dec->run_pixel = v;
+            dec->state = rle_run;
+        } else {
+            out[produced++] = v;
+            if (--dec->remaining == 0) {
+                dec->state = rle_header;
+            }
+        }
+    }
+    if (in_used != NULL) {
+        *in_used = pos;
+    }
+    return produced;
+}
@@ -0,0 +1,182 @@
+#include "boot_panel.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef ARDUINO
+#include <esp_heap_caps.h>
+#endif
+
+// tiles are read by the SPI DMA while the CPU works on the other one,
+// internal RAM keeps the bus fed where PSRAM would stall it
+static uint16_t *tile_alloc(size_t bytes) {
+#ifdef ARDUINO
+    return (uint16_t*)heap_caps_malloc(bytes, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+#else
+    return (uint16_t*)malloc(bytes);
+#endif
+}
+
+static void tile_release(uint16_t *p) {
+#ifdef ARDUINO
+    heap_caps_free(p);
+#else
+    free(p);
+#endif
+}
+
+int panel_pipe_init(panel_pipe_t *pipe, const panel_ops_t *ops, int16_t width, int16_t height) {
+    if (pipe == NULL || ops == NULL || ops->start == NULL || ops->wait == NULL ||
+        width <= 0 || height <= 0) {
+        return -1;
+    }
+    memset(pipe, 0, sizeof(*pipe));
+    for (int i = 0; i < panel_tile_count; i++) {
+        pipe->tiles[i].pixels = tile_alloc(panel_tile_pixels * sizeof(uint16_t));
+        if (pipe->tiles[i].pixels == NULL) {
+            for (int j = 0; j < i; j++) {
+                tile_release(pipe->tiles[j].pixels);
+            }
+            memset(pipe, 0, sizeof(*pipe));
+            return -1;
+        }
+    }
+    pipe->ops = *ops;
+    pipe->width = width;
+    pipe->height = height;
+    return 0;
+}
+
+void panel_pipe_free(panel_pipe_t *pipe) {
+    if (pipe == NULL || pipe->ops.wait == NULL) {
+        return;
+    }
+    panel_pipe_sync(pipe);
+    for (int i = 0; i < panel_tile_count; i++) {
+        tile_release(pipe->tiles[i].pixels);
+    }
+    memset(pipe, 0, sizeof(*pipe));
+}
+
+int panel_pipe_done(const panel_pipe_t *pipe, uint32_t fence) {
+    // fences only grow, the subtraction keeps this right across a wrap
+    return (int32_t)(pipe->completed - fence) >= 0;
+}
+
+void panel_pipe_wait(panel_pipe_t *pipe, uint32_t fence) {
+    if (pipe == NULL || pipe->ops.wait == NULL) {
+        return;
+    }
+    while (!panel_pipe_done(pipe, fence)) {
+        pipe->ops.wait(pipe->ops.ctx);
+    }
+}
+
+void panel_pipe_sync(panel_pipe_t *pipe) {
+    if (pipe == NULL) {
+        return;
+    }
+    panel_pipe_wait(pipe, pipe->submitted);
+}
+
+panel_tile_t *panel_pipe_acquire(panel_pipe_t *pipe) {
+    if (pipe == NULL || pipe->ops.wait == NULL) {
+        return NULL;
+    }
+    panel_tile_t *tile = &pipe->tiles[pipe->next];
+    if (!panel_pipe_done(pipe, tile->fence)) {
+        pipe->stalls++;
+        panel_pipe_wait(pipe, tile->fence);
+    }
+    return tile;
+}
+
+uint32_t panel_pipe_submit(panel_pipe_t *pipe, panel_tile_t *tile,
+                           int16_t x, int16_t y, int16_t w, int16_t h) {
+    if (pipe == NULL || tile == NULL || w <= 0 || h <= 0 || (size_t)w * (size_t)h > panel_tile_pixels) {
+        return 0;
+    }
+    tile->x = x;
+    tile->y = y;
+    tile->w = w;
+    tile->h = h;
+    tile->fence = ++pipe->submitted;
+    pipe->next = (uint8_t)((tile - pipe->tiles + 1) % panel_tile_count);
+    pipe->ops.start(pipe->ops.ctx, tile);
+    return tile->fence;
+}
+
+void panel_pipe_complete(panel_pipe_t *pipe, uint32_t fence) {
+    if (pipe == NULL) {
+        return;
+    }
+    pipe->completed = fence;
+}
+
+// clips a block to the panel, sx/sy is where the visible part starts in the source
+static int clip_block(const panel_pipe_t *pipe, int16_t *x, int16_t *y, int16_t *w, int16_t *h,
+                      int16_t *sx, int16_t *sy) {
+    int32_t x0 = *x, y0 = *y;
+    int32_t x1 = x0 + *w, y1 = y0 + *h;
+    *sx = x0 < 0 ? (int16_t)-x0 : 0;
+    *sy = y0 < 0 ? (int16_t)-y0 : 0;
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 > pipe->width) x1 = pipe->width;
+    if (y1 > pipe->height) y1 = pipe->height;
+    if (x0 >= x1 || y0 >= y1) {
+        return 0;
+    }
+    *x = (int16_t)x0;
+    *y = (int16_t)y0;
+    *w = (int16_t)(x1 - x0);
+    *h = (int16_t)(y1 - y0);
+    return 1;
+}
+
+// walks the block in tile sized bands, one column slice at a time if a row doesn't fit a tile
+static uint32_t pipe_blocks(panel_pipe_t *pipe, int16_t x, int16_t y, int16_t w, int16_t h,
+                            const uint16_t *data, int16_t stride, uint16_t color) {
+    int16_t sx, sy;
+    if (pipe == NULL || pipe->ops.start == NULL || w <= 0 || h <= 0 ||
+        !clip_block(pipe, &x, &y, &w, &h, &sx, &sy)) {
+        return 0;
+    }
+    uint32_t fence = 0;
+    for (int16_t cx = 0; cx < w; ) {
+        int16_t cw = w - cx > panel_tile_pixels ? panel_tile_pixels : w - cx;
+        int16_t band = (int16_t)(panel_tile_pixels / cw);
+        for (int16_t ry = 0; ry < h; ) {
+            int16_t rows = h - ry > band ? band : h - ry;
+            panel_tile_t *tile = panel_pipe_acquire(pipe);
+            if (data != NULL) {
+                for (int16_t r = 0; r < rows; r++) {
+                    memcpy(tile->pixels + (size_t)r * cw,
+                           data + (size_t)(sy + ry + r) * stride + sx + cx,
+                           (size_t)cw * sizeof(uint16_t));
+                }
+            } else {
+                size_t count = (size_t)cw * rows;
+                for (size_t i = 0; i < count; i++) {
+                    tile->pixels[i] = color;
+                }
+            }
+            fence = panel_pipe_submit(pipe, tile, x + cx, y + ry, cw, rows);
+            ry += rows;
+        }
+        cx += cw;
+    }
+    return fence;
+}
+
+uint32_t panel_pipe_draw(panel_pipe_t *pipe, int16_t x, int16_t y, const uint16_t *data,
+                         int16_t w, int16_t h) {
+    if (data == NULL) {
+        return 0;
+    }
+    return pipe_blocks(pipe, x, y, w, h, data, w, 0);
+}
+
+uint32_t panel_pipe_fill(panel_pipe_t *pipe, int16_t x, int16_t y, int16_t w, int16_t h,
+                         uint16_t color) {
+    return pipe_blocks(pipe, x, y, w, h, NULL, 0, color);
+}
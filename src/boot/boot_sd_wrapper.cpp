@@ -5,6 +5,8 @@
 #include <SD.h>
 #include <SPI.h>
 #include "boot_sequence.h"
+#include "boot_splash.h"
+#include "boot_trace.h"
 #include "debug_helper.h"
 
 // SD card pin definitions
@@ -19,46 +21,47 @@
 #define TFT_MISO  13
 #define TFT_MOSI  11
 
+// how long a card gets to finish its power up handshake before we call it missing
+#define SD_READY_TIMEOUT_MS 500
+#define SD_READY_POLL_MS 10
+
 extern "C" {
 
+// one attempt at the card init handshake (CMD0/ACMD41 inside SD.begin)
+// a card that's still powering up just fails and gets retried
+static int sd_card_ready(void *ctx) {
+    (void)ctx;
+    if (SD.begin(SD_CS) && SD.cardType() != CARD_NONE) {
+        return 1;
+    }
+    SD.end();
+    return 0;
+}
+
 // init SD card hardware and mount filesystem
 int boot_sd_mount(void) {
     // configure CS pin for SD card
     pinMode(SD_CS, OUTPUT);
     digitalWrite(SD_CS, HIGH);  // deselected
     
-    delay(200);  // allow SD card to stabilize
-    
     // ensure TFT CS is deselected first, redundant since it should already be high from boot_init
     digitalWrite(TFT_CS, HIGH);
     
     // end SPI to clean up TFT configuration before reinitializing for SD
+    // SPI.end()/begin() only reroute pins, there is nothing to wait for here
     SPI.end();
-    delay(50);
-    
-    // init SPI for SD card
     SPI.begin(SD_SCK, SD_MISO, SD_MOSI, SD_CS);
-    delay(100);
     
-    // init SD card
-    if (!SD.begin(SD_CS)) {
-        DEBUG_PRINT("[BOOT] SD.begin() failed\n");
-        // restore SPI for TFT before returning
-        SPI.end();
-        SPI.begin(TFT_SCK, TFT_MISO, TFT_MOSI, TFT_CS);
-        return -1;  // SD card not present or initialization failed
-    }
-    
-    // check card type
-    uint8_t cardType = SD.cardType();
-    if (cardType == CARD_NONE) {
-        DEBUG_PRINT("[BOOT] SD card type is CARD_NONE\n");
+    // poll the card instead of sleeping 350ms up front
+    if (boot_wait_until("SD ready", sd_card_ready, NULL, SD_READY_TIMEOUT_MS, SD_READY_POLL_MS) != 0) {
+        DEBUG_PRINT("[BOOT] SD card not ready (missing or failed init)\n");
         // restore SPI for TFT before returning
         SPI.end();
         SPI.begin(TFT_SCK, TFT_MISO, TFT_MOSI, TFT_CS);
         return -1;  // no SD card (T_T)
     }
     
+    uint8_t cardType = SD.cardType();
     DEBUG_PRINT("[BOOT] SD card mounted successfully (type: %d)\n", cardType);
     
     // SPI is now configured for SD card pins
@@ -74,34 +77,56 @@ int boot_sd_unmount(void) {
     return 0;
 }
 
+// task that switched the bus over to SD, it holds the panel lock until it restores the TFT
+// (directory iterators keep SD mode across calls, so switching again must not lock twice)
+static TaskHandle_t sd_bus_owner = NULL;
+
 // restore SPI configuration for TFT display
 // call this after filesystem initialization is complete
 void boot_sd_restore_tft_spi(void) {
+    uint32_t start = boot_trace_now();
+    
     // ensure SD CS is deselected
     digitalWrite(SD_CS, HIGH);
     
     // end SPI to clean up SD configuration
+    // no settle delays, the bus is usable as soon as begin() returns
     SPI.end();
-    delay(50);
     
     // restore SPI for TFT
     SPI.begin(TFT_SCK, TFT_MISO, TFT_MOSI, TFT_CS);
-    delay(50);
+    
+    boot_trace_add("SPI switch", start, boot_trace_now() - start);
+    if (sd_bus_owner == xTaskGetCurrentTaskHandle()) {
+        sd_bus_owner = NULL;
+        boot_tft_unlock();
+    }
 }
 
 // switch SPI back to SD card configuration
 // call this before SD operations if TFT SPI was restored
 void boot_sd_switch_to_sd_spi(void) {
+    uint32_t start = boot_trace_now();
+    
+    // the render task may be in the middle of a frame
+    if (sd_bus_owner != xTaskGetCurrentTaskHandle()) {
+        boot_tft_lock();
+        sd_bus_owner = xTaskGetCurrentTaskHandle();
+    }
+    
+    // tiles still queued for the panel would go out on the SD pins
+    boot_tft_sync();
+    
     // ensure TFT CS is deselected
     digitalWrite(TFT_CS, HIGH);
     
     // end SPI to clean up TFT configuration
     SPI.end();
-    delay(50);
     
     // switch SPI to SD pins
     SPI.begin(SD_SCK, SD_MISO, SD_MOSI, SD_CS);
-    delay(50);
+    
+    boot_trace_add("SPI switch", start, boot_trace_now() - start);
 }
 
 // check if SD card is available
@@ -288,6 +313,51 @@ int boot_sd_find_bootlogo(const char *username, char *out_path, size_t out_len)
     return 1;
 }
 
+int boot_sd_list_dir(const char *path, void (*found)(const char *name, int is_dir, void *ctx), void *ctx) {
+    File dir = SD.open(path);
+    if (!dir || !dir.isDirectory()) {
+        if (dir) {
+            dir.close();
+        }
+        return -1;
+    }
+    
+    while (true) {
+        File entry = dir.openNextFile();
+        if (!entry) {
+            break;
+        }
+        // older cores hand back the full path here, newer ones just the name
+        found(basename_ptr(entry.name()), entry.isDirectory() ? 1 : 0, ctx);
+        entry.close();
+    }
+    dir.close();
+    return 0;
+}
+
+int boot_sd_make_dir(const char *path) {
+    if (!SD.mkdir(path)) {
+        DEBUG_PRINT("[BOOT] Failed to create directory: %s\n", path);
+        return -1;
+    }
+    DEBUG_PRINT("[BOOT] Created directory: %s\n", path);
+    return 0;
+}
+
+int boot_sd_make_file(const char *path, const char *content) {
+    File f = SD.open(path, FILE_WRITE);
+    if (!f) {
+        DEBUG_PRINT("[BOOT] Failed to create file: %s\n", path);
+        return -1;
+    }
+    if (content) {
+        f.print(content);
+    }
+    f.close();
+    DEBUG_PRINT("[BOOT] Created file: %s\n", path);
+    return 0;
+}
+
 } // extern "C"
 
 #else
@@ -303,6 +373,9 @@ int boot_sd_ensure_directory(const char *path) { (void)path; return 0; }
 int boot_sd_ensure_file(const char *path, const char *content) { (void)path; (void)content; return 0; }
 int boot_sd_get_username(char *out_name, size_t out_len) { (void)out_name; (void)out_len; return 0; }
 int boot_sd_find_bootlogo(const char *username, char *out_path, size_t out_len) { (void)username; (void)out_path; (void)out_len; return 0; }
+int boot_sd_list_dir(const char *path, void (*found)(const char *name, int is_dir, void *ctx), void *ctx) { (void)path; (void)found; (void)ctx; return 0; }
+int boot_sd_make_dir(const char *path) { (void)path; return 0; }
+int boot_sd_make_file(const char *path, const char *content) { (void)path; (void)content; return 0; }
 }
 #endif
 
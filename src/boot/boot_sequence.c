@@ -25,6 +25,8 @@ static inline void delay_ms(unsigned int ms) {
 #endif
 
 #include "boot_sequence.h"
+#include "boot_fs.h"
+#include "boot_trace.h"
 #include "boot_splash.h"
 #include "debug_helper.h"
 #include "process.h"
@@ -166,7 +168,9 @@ boot_step_result_t boot_step(const char *step_name, int (*init_func)(void)) {
         return result;
     }
     
+    int slot = boot_trace_begin(step_name);
     int ret = init_func();
+    boot_trace_end(slot);
     
     if (ret == 0) {
         result.status = BOOT_STATUS_OK;
@@ -271,9 +275,6 @@ void boot_start_desktop(void) {
     DEBUG_PRINT("[BOOT] Starting desktop\n");
     
 #ifdef ARDUINO
-    // wait 2 seconds after boot completes
-    delay_ms(2000);
-    
     // create first terminal (fullscreen)
     #include "terminal.h"
     #include "action_manager.h"
@@ -288,15 +289,14 @@ void boot_start_desktop(void) {
     }
     terminal_set_initial_output_suppressed(0);
 #ifdef ARDUINO
-    extern void terminal_render_all(void);
-    extern void terminal_render_window(terminal_state *term);
     if (firstboot_is_active() || login_is_active()) {
-        terminal_render_window(term);
+        terminal_render_request(term);
     } else {
         terminal_write_line(term, "TILIXI Terminal v1.0");
         terminal_write_string(term, "$ ");
-        terminal_render_all();
+        terminal_render_request_all();
     }
+    terminal_render_flush();  // first frame goes up before the boot finishes
 #endif
     
     DEBUG_PRINT("[BOOT] Desktop started - Terminal ready\n");
@@ -328,7 +328,7 @@ int boot_low_level_bringup(void) {
 #ifdef ARDUINO
     // ESP32 low-level init is handled by Arduino framework
     // additional low-level setup can go here
-    delay_ms(100);  // allow hardware to stabilize
+    // (no settle delay, anything that needs time polls for it itself)
     return 0;
 #else
     // PC: no low-level hardware
@@ -344,8 +344,7 @@ int boot_init_serial(void) {
     // actual serial initialization happens in main_esp32.cpp setup()
     
 #ifdef ARDUINO
-    // serial is already initialized in setup(), just wait a bit for it to stabilize
-    delay_ms(100);  // give serial time to stabilize
+    // serial is already initialized and waited on in setup()
     DEBUG_PRINT("[BOOT] Serial verified and ready for keyboard input\n");
     return 0;
 #else
@@ -368,7 +367,9 @@ int boot_mount_sd(void) {
     // mount micro SD card
     
 #ifdef ARDUINO
+    int slot = boot_trace_begin("SD.begin");
     int ret = boot_sd_mount();
+    boot_trace_end(slot);
     if (ret != 0) {
         DEBUG_PRINT("[BOOT] SD card initialization failed\n");
         return -1;
@@ -381,9 +382,11 @@ int boot_mount_sd(void) {
         char logo_path[256];
         if (boot_sd_get_username(username, sizeof(username)) &&
             boot_sd_find_bootlogo(username, logo_path, sizeof(logo_path))) {
+            slot = boot_trace_begin("boot logo");
             if (boot_show_logo_from_sd(logo_path)) {
                 boot_logo_active = 1;
             }
+            boot_trace_end(slot);
         }
     }
     return 0;
@@ -400,212 +403,36 @@ int boot_init_sd_filesystem(void) {
     // filesystem structure setup. This is a temporary exception during boot.
     // All other filesystem operations MUST go through VFS (see include/vfs.h).
     // This function will be migrated to use VFS in a future update.
+    //
+    // the layout lives in boot_fs_manifest (boot_fs.c), add new paths there
     
 #ifdef ARDUINO
-    // check if SD card is mounted
+    // check if SD card is mounted (this also switches SPI over to the SD card)
     if (boot_sd_available() != 0) {
         DEBUG_PRINT("[BOOT] SD card not available for filesystem init\n");
         return -1;
     }
     
-    // check if root directory is empty
-    int root_empty = boot_sd_is_directory_empty("/");
-    
-    if (root_empty) {
-        DEBUG_PRINT("[BOOT] SD card is empty, creating full filesystem structure\n");
-        
-        // create all required directories
-        boot_sd_ensure_directory("/bin");
-        boot_sd_ensure_directory("/dev");
-        boot_sd_ensure_directory("/dev/input");
-        boot_sd_ensure_directory("/dev/pipe");
-        boot_sd_ensure_directory("/etc");
-        boot_sd_ensure_directory("/home");
-        if (boot_sd_is_directory_empty("/home")) {
-            boot_sd_ensure_directory("/home/user");
-            boot_sd_ensure_directory("/home/user/documents");
-        }
-        boot_sd_ensure_directory("/proc");
-        boot_sd_ensure_directory("/proc/tasks");
-        boot_sd_ensure_directory("/run");
-        boot_sd_ensure_directory("/run/pipes");
-        boot_sd_ensure_directory("/run/tasks");
-        boot_sd_ensure_directory("/run/events");
-        boot_sd_ensure_directory("/tmp");
-        boot_sd_ensure_directory("/usr");
-        boot_sd_ensure_directory("/usr/bin");
-        boot_sd_ensure_directory("/usr/bin/games");
-        boot_sd_ensure_directory("/usr/bin/demos");
-        boot_sd_ensure_directory("/usr/share");
-        boot_sd_ensure_directory("/usr/share/help");
-        boot_sd_ensure_directory("/usr/share/fonts");
-        boot_sd_ensure_directory("/usr/share/banners");
-        boot_sd_ensure_directory("/var");
-        boot_sd_ensure_directory("/var/log");
-        
-        // create all required files in /bin
-        boot_sd_ensure_file("/bin/sh", NULL);
-        boot_sd_ensure_file("/bin/ls", NULL);
-        boot_sd_ensure_file("/bin/cat", NULL);
-        boot_sd_ensure_file("/bin/echo", NULL);
-        boot_sd_ensure_file("/bin/ps", NULL);
-        boot_sd_ensure_file("/bin/kill", NULL);
-        boot_sd_ensure_file("/bin/clear", NULL);
-        boot_sd_ensure_file("/bin/help", NULL);
-        boot_sd_ensure_file("/bin/reboot", NULL);
-        boot_sd_ensure_file("/bin/nano", NULL);
-        boot_sd_ensure_file("/bin/top", NULL);
-        boot_sd_ensure_file("/bin/uptime", NULL);
-        boot_sd_ensure_file("/bin/meminfo", NULL);
-        boot_sd_ensure_file("/bin/logread", NULL);
-        
-        // create all required files in /dev
-        boot_sd_ensure_file("/dev/tty", NULL);
-        boot_sd_ensure_file("/dev/tty0", NULL);
-        boot_sd_ensure_file("/dev/null", NULL);
-        boot_sd_ensure_file("/dev/input/keyboard", NULL);
-        
-        // create all required files in /etc
-        boot_sd_ensure_file("/etc/passwd", NULL);
-        boot_sd_ensure_file("/etc/shells", NULL);
-        boot_sd_ensure_file("/etc/system.conf", NULL);
-        boot_sd_ensure_file("/etc/tty.conf", NULL);
-        boot_sd_ensure_file("/etc/keymap.conf", NULL);
-        boot_sd_ensure_file("/etc/motd", NULL);
-        
-        // create all required files in /home/user (only if we created it)
-        if (boot_sd_is_directory_empty("/home/user") == 0) {
-            boot_sd_ensure_file("/home/user/.profile", NULL);
-            boot_sd_ensure_file("/home/user/.history", NULL);
-            boot_sd_ensure_file("/home/user/.editorrc", NULL);
-        }
-        
-        // create all required files in /proc
-        boot_sd_ensure_file("/proc/uptime", NULL);
-        boot_sd_ensure_file("/proc/meminfo", NULL);
-        boot_sd_ensure_file("/proc/version", NULL);
-        boot_sd_ensure_file("/proc/sched", NULL);
-        
-        // create all required files in /run
-        boot_sd_ensure_file("/run/tty.lock", NULL);
-        boot_sd_ensure_file("/run/scheduler.lock", NULL);
-        boot_sd_ensure_file("/run/pipes/3", NULL);
-        boot_sd_ensure_file("/run/pipes/4", NULL);
-        boot_sd_ensure_file("/run/tasks/1", NULL);
-        boot_sd_ensure_file("/run/tasks/2", NULL);
-        boot_sd_ensure_file("/run/events/queue", NULL);
-        
-        // create all required files in /tmp
-        boot_sd_ensure_file("/tmp/.keep", NULL);
-        
-        // create all required files in /var/log
-        boot_sd_ensure_file("/var/log/kernel.log", NULL);
-        boot_sd_ensure_file("/var/log/scheduler.log", NULL);
-        boot_sd_ensure_file("/var/log/terminal.log", NULL);
-        boot_sd_ensure_file("/var/log/input.log", NULL);
-        boot_sd_ensure_file("/var/log/boot.log", NULL);
-        
-        DEBUG_PRINT("[BOOT] Filesystem structure created successfully\n");
-    } else {
-        DEBUG_PRINT("[BOOT] SD card is not empty, verifying required files exist\n");
-        
-        // verify and create missing directories
-        boot_sd_ensure_directory("/bin");
-        boot_sd_ensure_directory("/dev");
-        boot_sd_ensure_directory("/dev/input");
-        boot_sd_ensure_directory("/dev/pipe");
-        boot_sd_ensure_directory("/etc");
-        boot_sd_ensure_directory("/home");
-        if (boot_sd_is_directory_empty("/home")) {
-            boot_sd_ensure_directory("/home/user");
-            boot_sd_ensure_directory("/home/user/documents");
-        }
-        boot_sd_ensure_directory("/proc");
-        boot_sd_ensure_directory("/proc/tasks");
-        boot_sd_ensure_directory("/run");
-        boot_sd_ensure_directory("/run/pipes");
-        boot_sd_ensure_directory("/run/tasks");
-        boot_sd_ensure_directory("/run/events");
-        boot_sd_ensure_directory("/tmp");
-        boot_sd_ensure_directory("/usr");
-        boot_sd_ensure_directory("/usr/bin");
-        boot_sd_ensure_directory("/usr/bin/games");
-        boot_sd_ensure_directory("/usr/bin/demos");
-        boot_sd_ensure_directory("/usr/share");
-        boot_sd_ensure_directory("/usr/share/help");
-        boot_sd_ensure_directory("/usr/share/fonts");
-        boot_sd_ensure_directory("/usr/share/banners");
-        boot_sd_ensure_directory("/var");
-        boot_sd_ensure_directory("/var/log");
-        
-        // verify and create missing files in /bin
-        boot_sd_ensure_file("/bin/sh", NULL);
-        boot_sd_ensure_file("/bin/ls", NULL);
-        boot_sd_ensure_file("/bin/cat", NULL);
-        boot_sd_ensure_file("/bin/echo", NULL);
-        boot_sd_ensure_file("/bin/ps", NULL);
-        boot_sd_ensure_file("/bin/kill", NULL);
-        boot_sd_ensure_file("/bin/clear", NULL);
-        boot_sd_ensure_file("/bin/help", NULL);
-        boot_sd_ensure_file("/bin/reboot", NULL);
-        boot_sd_ensure_file("/bin/nano", NULL);
-        boot_sd_ensure_file("/bin/top", NULL);
-        boot_sd_ensure_file("/bin/uptime", NULL);
-        boot_sd_ensure_file("/bin/meminfo", NULL);
-        boot_sd_ensure_file("/bin/logread", NULL);
-        
-        // verify and create missing files in /dev
-        boot_sd_ensure_file("/dev/tty", NULL);
-        boot_sd_ensure_file("/dev/tty0", NULL);
-        boot_sd_ensure_file("/dev/null", NULL);
-        boot_sd_ensure_file("/dev/input/keyboard", NULL);
-        
-        // verify and create missing files in /etc
-        boot_sd_ensure_file("/etc/passwd", NULL);
-        boot_sd_ensure_file("/etc/shells", NULL);
-        boot_sd_ensure_file("/etc/system.conf", NULL);
-        boot_sd_ensure_file("/etc/tty.conf", NULL);
-        boot_sd_ensure_file("/etc/keymap.conf", NULL);
-        boot_sd_ensure_file("/etc/motd", NULL);
-        
-        // verify and create missing files in /home/user only if /home/user exists
-        if (boot_sd_is_directory_empty("/home/user") == 0) {
-            boot_sd_ensure_file("/home/user/.profile", NULL);
-            boot_sd_ensure_file("/home/user/.history", NULL);
-            boot_sd_ensure_file("/home/user/.editorrc", NULL);
-        }
-        
-        // verify and create missing files in /proc
-        boot_sd_ensure_file("/proc/uptime", NULL);
-        boot_sd_ensure_file("/proc/meminfo", NULL);
-        boot_sd_ensure_file("/proc/version", NULL);
-        boot_sd_ensure_file("/proc/sched", NULL);
-        
-        // verify and create missing files in /run
-        boot_sd_ensure_file("/run/tty.lock", NULL);
-        boot_sd_ensure_file("/run/scheduler.lock", NULL);
-        boot_sd_ensure_file("/run/pipes/3", NULL);
-        boot_sd_ensure_file("/run/pipes/4", NULL);
-        boot_sd_ensure_file("/run/tasks/1", NULL);
-        boot_sd_ensure_file("/run/tasks/2", NULL);
-        boot_sd_ensure_file("/run/events/queue", NULL);
-        
-        // verify and create missing files in /tmp
-        boot_sd_ensure_file("/tmp/.keep", NULL);
-        
-        // verify and create missing files in /var/log
-        boot_sd_ensure_file("/var/log/kernel.log", NULL);
-        boot_sd_ensure_file("/var/log/scheduler.log", NULL);
-        boot_sd_ensure_file("/var/log/terminal.log", NULL);
-        boot_sd_ensure_file("/var/log/input.log", NULL);
-        boot_sd_ensure_file("/var/log/boot.log", NULL);
-        
-        DEBUG_PRINT("[BOOT] Filesystem structure verified and missing files added\n");
-    }
+    // one bus session for the whole pass, no SPI switching per path
+    const boot_fs_io_t io = {boot_sd_list_dir, boot_sd_make_dir, boot_sd_make_file};
+    boot_fs_report_t report;
+    uint32_t start = get_time_ms();
+    int slot = boot_trace_begin("fs provision");
+    int ret = boot_fs_provision(boot_fs_manifest, boot_fs_manifest_count, &io, &report);
+    boot_trace_end(slot);
+    uint32_t elapsed = get_time_ms() - start;
     
     // restore SPI for TFT display now that filesystem initialization is complete
     boot_sd_restore_tft_spi();
     
+    DEBUG_PRINT("[BOOT] Filesystem: %u dirs scanned, %u present, %u created, %u failed in %lu ms\n",
+               report.dirs_scanned, report.present, report.created, report.failed,
+               (unsigned long)elapsed);
+    if (ret != 0) {
+        DEBUG_PRINT("[BOOT] Some required filesystem entries could not be created\n");
+    }
+    
+    // missing entries aren't fatal, same as before
     return 0;
 #else
     // PC: no SD card filesystem
@@ -639,10 +466,8 @@ int boot_init_os_subsystems(void) {
 
 int boot_register_commands(void) {
     // register built-in terminal commands
-    #include "terminal_cmd.h"
     #include "builtins.h"
     
-    init_terminal_commands();
     builtins_init();
     
     return 0;
@@ -663,6 +488,7 @@ typedef struct {
 
 // maximum number of initial processes
 #define max_boot_processes 8
+#define boot_process_ready_timeout_ms 200
 
 // process health check result
 typedef struct {
@@ -680,6 +506,7 @@ static uint8_t boot_process_count = 0;
 static void system_idle_task(void *args) {
     (void)args;
     DEBUG_PRINT("[BOOT_PROCESS] System idle task started\n");
+    process_signal_ready(scheduler_get_current());
     // idle task runs continuously
     while (1) {
         process_yield();
@@ -774,10 +601,12 @@ static int boot_start_process(boot_process_def_t *def) {
     }
     
     // create the process
+    int slot = boot_trace_begin(def->name);
     process_id_t pid = process_create(def->name, def->entry_point, def->args,
                                      def->priority, def->stack_size_words);
     
     if (pid == 0) {
+        boot_trace_end(slot);
         DEBUG_PRINT("[BOOT] Failed to create process: %s\n", def->name);
         return -1;  // creation failed
     }
@@ -787,8 +616,12 @@ static int boot_start_process(boot_process_def_t *def) {
     
     DEBUG_PRINT("[BOOT] Started process: %s (PID=%d)\n", def->name, pid);
     
-    // give process time to initialize (especially on ESP32)
-    delay_ms(50);
+    // wait for the process to say it's up instead of sleeping a fixed 50ms
+    // a process that never signals just costs the timeout, same as before but bounded
+    if (process_wait_ready(pid, boot_process_ready_timeout_ms) != 0) {
+        DEBUG_PRINT("[BOOT] Process %s did not signal ready\n", def->name);
+    }
+    boot_trace_end(slot);
     
     return 0;
 }
@@ -912,7 +745,7 @@ int boot_init_processes(void) {
     }
     
     // perform initial health check
-    delay_ms(100);  // give processes time to initialize
+    // every process already signalled ready (or timed out) in boot_start_process()
     ret = boot_check_all_processes_health();
     if (ret != 0) {
         DEBUG_PRINT("[BOOT] Warning: Some processes failed health check\n");
@@ -1001,15 +834,22 @@ void boot_sequence_run(void) {
     DEBUG_PRINT("[BOOT] Boot sequence complete!\n");
     
 #ifdef ARDUINO
-    delay_ms(500);  // a short respite before continuing.. {:
+    int slot = boot_trace_begin("Start desktop");
     
     // start desktop!
     boot_start_desktop();
+    boot_trace_end(slot);
     
     // mark boot as complete - keyboard input can now be active
     boot_complete = 1;
     DEBUG_PRINT("[BOOT] Keyboard input now active\n");
 #endif
+    
+    // everything after this is normal runtime, not boot
+    boot_trace_stop();
+    if (boot_trace_save(BOOT_TRACE_PATH) != 0) {
+        DEBUG_PRINT("[BOOT] Could not write %s\n", BOOT_TRACE_PATH);
+    }
 }
 
 int boot_is_complete(void) {
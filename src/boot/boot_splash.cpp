@@ -3,9 +3,15 @@
 #include <SPI.h>
 #include <SD.h>
 #include <math.h>
+#include <driver/spi_master.h>
+#include <esp_rom_gpio.h>
+#include <soc/spi_periph.h>
 #include "boot_splash.h"
 #include "ino_helper.h"
 #include "boot_sequence.h"
+#include "boot_trace.h"
+#include "boot_logo_cache.h"
+#include "boot_panel.h"
 
 // use ST7796S
 // if not available, try ST7789 as fallback (reason for this is that I may be changing to a different board later in the project which is unsupported)
@@ -42,30 +48,195 @@
 #define LOGO_PATH "/boot/logo.raw"
 
 // display object (exported for boot_sequence.c)
+// reset is driven by boot_init() so the library doesn't add its own 400ms of blind reset delays
 #ifdef USE_ST7796S
-    Adafruit_ST7796S tft = Adafruit_ST7796S(&SPI, TFT_CS, TFT_DC, TFT_RST);
+    Adafruit_ST7796S tft = Adafruit_ST7796S(&SPI, TFT_CS, TFT_DC, -1);
 #else
-    Adafruit_ST7789 tft = Adafruit_ST7789(&SPI, TFT_CS, TFT_DC, TFT_RST);
+    Adafruit_ST7789 tft = Adafruit_ST7789(&SPI, TFT_CS, TFT_DC, -1);
 #endif
 
+// panel transfers go out on their own task so whoever draws can compose the next tile
+// while the last one is still on the bus, see boot_panel.h
+// the pixels of a tile are one queued DMA transaction on SPI3, panel_tx sleeps until it's done
+// so it can share core 0 with the render task; Adafruit keeps sending the commands on the
+// Arduino SPI (SPI2), MOSI and SCK are switched between the two around every tile
+// without DMA the tile is polled out by Adafruit and panel_tx moves to the loop's core instead,
+// a busy sender next to the render task would keep it from composing
+#define PANEL_TX_STACK 3072
+#define PANEL_TX_PRIORITY 2
+#define PANEL_TX_CORE_DMA 0
+#define PANEL_TX_CORE_POLL 1
+#define PANEL_DMA_HOST SPI3_HOST
+#define PANEL_ARDUINO_HOST SPI2_HOST  // FSPI, what the SPI object drives on the S3
+#define PANEL_DMA_HZ (40 * 1000 * 1000)
+
+static panel_pipe_t panel_pipe;
+static bool panel_pipe_ready = false;
+static QueueHandle_t panel_tx_queue = NULL;
+static SemaphoreHandle_t panel_tx_done = NULL;
+static spi_device_handle_t panel_dma = NULL;
+
+// the panel and the SD card share one SPI bus and the terminal draws from its own render task,
+// whoever uses the bus holds this (recursive, a frame takes it once and every draw again)
+static SemaphoreHandle_t panel_lock = NULL;
+
+struct panel_guard {
+    panel_guard() { boot_tft_lock(); }
+    ~panel_guard() { boot_tft_unlock(); }
+};
+
+// CS and DC stay plain GPIOs, only the data and clock lines follow whoever sends next
+static void panel_route(spi_host_device_t host) {
+    esp_rom_gpio_connect_out_signal(TFT_MOSI, spi_periph_signal[host].spid_out, false, false);
+    esp_rom_gpio_connect_out_signal(TFT_SCK, spi_periph_signal[host].spiclk_out, false, false);
+}
+
+static bool panel_dma_init(void) {
+    spi_bus_config_t bus = {};
+    bus.mosi_io_num = TFT_MOSI;
+    bus.miso_io_num = -1;
+    bus.sclk_io_num = TFT_SCK;
+    bus.quadwp_io_num = -1;
+    bus.quadhd_io_num = -1;
+    bus.max_transfer_sz = panel_tile_pixels * sizeof(uint16_t);
+    if (spi_bus_initialize(PANEL_DMA_HOST, &bus, SPI_DMA_CH_AUTO) != ESP_OK) {
+        panel_route(PANEL_ARDUINO_HOST);
+        return false;
+    }
+    spi_device_interface_config_t dev = {};
+    dev.clock_speed_hz = PANEL_DMA_HZ;
+    dev.mode = 0;
+    dev.spics_io_num = -1;  // Adafruit holds CS low from startWrite() to endWrite()
+    dev.queue_size = 1;
+    if (spi_bus_add_device(PANEL_DMA_HOST, &dev, &panel_dma) != ESP_OK) {
+        spi_bus_free(PANEL_DMA_HOST);
+        panel_dma = NULL;
+    }
+    // bus init took the pins, the commands still go out on the Arduino SPI
+    panel_route(PANEL_ARDUINO_HOST);
+    return panel_dma != NULL;
+}
+
+static void panel_send(panel_tile_t *tile) {
+    uint32_t count = (uint32_t)tile->w * (uint32_t)tile->h;
+    if (panel_dma == NULL) {
+        tft.startWrite();
+        tft.setAddrWindow(tile->x, tile->y, tile->w, tile->h);
+        tft.writePixels(tile->pixels, count);
+        tft.endWrite();
+        return;
+    }
+    // the panel takes RGB565 high byte first, the tile gets composed again before it's reused
+    for (uint32_t i = 0; i < count; i++) {
+        tile->pixels[i] = (uint16_t)((tile->pixels[i] << 8) | (tile->pixels[i] >> 8));
+    }
+    spi_transaction_t trans = {};
+    trans.length = (size_t)count * 16;
+    trans.tx_buffer = tile->pixels;
+    spi_transaction_t *done = NULL;
+    tft.startWrite();
+    tft.setAddrWindow(tile->x, tile->y, tile->w, tile->h);
+    panel_route(PANEL_DMA_HOST);
+    if (spi_device_queue_trans(panel_dma, &trans, portMAX_DELAY) == ESP_OK) {
+        spi_device_get_trans_result(panel_dma, &done, portMAX_DELAY);
+    }
+    panel_route(PANEL_ARDUINO_HOST);
+    tft.endWrite();
+}
+
+// tiles only get submitted by boot_tft_* calls holding boot_tft_lock(), and everything that
+// takes the bus away from the panel (SD switch, print, shutdown) syncs the pipe under that lock
+// first, so this task sends on behalf of the lock holder; taking the lock here would deadlock
+// with a render task that holds it for the whole frame and waits on these fences
+static void panel_tx_task(void *arg) {
+    (void)arg;
+    panel_tile_t *tile = NULL;
+    for (;;) {
+        if (xQueueReceive(panel_tx_queue, &tile, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        panel_send(tile);
+        panel_pipe_complete(&panel_pipe, tile->fence);
+        xSemaphoreGive(panel_tx_done);
+    }
+}
+
+static void panel_tx_start(void *ctx, panel_tile_t *tile) {
+    (void)ctx;
+    xQueueSend(panel_tx_queue, &tile, portMAX_DELAY);
+}
+
+static void panel_tx_wait(void *ctx) {
+    (void)ctx;
+    xSemaphoreTake(panel_tx_done, portMAX_DELAY);
+}
+
+// if any of this fails the boot_tft_* calls just keep drawing directly
+static void panel_start(void) {
+    panel_lock = xSemaphoreCreateRecursiveMutex();
+    panel_tx_queue = xQueueCreate(panel_tile_count, sizeof(panel_tile_t*));
+    panel_tx_done = xSemaphoreCreateBinary();
+    if (panel_tx_queue == NULL || panel_tx_done == NULL) {
+        ESP_INFO("panel pipe: no queue, drawing synchronously");
+        return;
+    }
+    panel_ops_t ops = { panel_tx_start, panel_tx_wait, NULL };
+    if (panel_pipe_init(&panel_pipe, &ops, tft.width(), tft.height()) != 0) {
+        ESP_INFO("panel pipe: no tile memory, drawing synchronously");
+        return;
+    }
+    if (!panel_dma_init()) {
+        ESP_INFO("panel pipe: no SPI DMA, polling tiles out from core %d", PANEL_TX_CORE_POLL);
+    }
+    int core = panel_dma != NULL ? PANEL_TX_CORE_DMA : PANEL_TX_CORE_POLL;
+    if (xTaskCreatePinnedToCore(panel_tx_task, "panel_tx", PANEL_TX_STACK, NULL,
+                                PANEL_TX_PRIORITY, NULL, core) != pdPASS) {
+        panel_pipe_free(&panel_pipe);
+        ESP_INFO("panel pipe: no task, drawing synchronously");
+        return;
+    }
+    panel_pipe_ready = true;
+}
+
+// panel readiness, polled instead of the old fixed 800ms waits
+#define PANEL_READY_TIMEOUT_MS 800
+#define PANEL_READY_POLL_MS 5
+#define PANEL_CMD_RDDID 0x04  // read display id
+#define PANEL_CMD_RDDPM 0x0A  // read display power mode
+#define PANEL_PM_SLEEP_OUT 0x10
+#define PANEL_PM_DISPLAY_ON 0x04
+#define PANEL_CMD_VSCRDEF 0x33   // vertical scroll definition
+#define PANEL_CMD_VSCRSADD 0x37  // vertical scroll start address
+
+// a panel still in reset (or not there) reads back all 0s or all 1s
+static int panel_id_ready(void *ctx) {
+    (void)ctx;
+    uint8_t id = tft.readcommand8(PANEL_CMD_RDDID, 1);
+    return id != 0x00 && id != 0xFF;
+}
+
+static int panel_on_ready(void *ctx) {
+    (void)ctx;
+    uint8_t pm = tft.readcommand8(PANEL_CMD_RDDPM);
+    return pm != 0xFF && (pm & (PANEL_PM_SLEEP_OUT | PANEL_PM_DISPLAY_ON)) == (PANEL_PM_SLEEP_OUT | PANEL_PM_DISPLAY_ON);
+}
+
 void boot_init(void) {
     // configure pins manually first
     pinMode(TFT_CS, OUTPUT);
     pinMode(TFT_DC, OUTPUT);
     if (TFT_RST >= 0) {
         pinMode(TFT_RST, OUTPUT);
-        // reset sequence: pull low then high
+        // reset sequence: pull low then high, the panel only needs 10us of low
         digitalWrite(TFT_RST, LOW);
-        delay(50);  // longer reset pulse
+        delayMicroseconds(20);
         digitalWrite(TFT_RST, HIGH);
-        delay(50);  // wait after reset release
     }
     digitalWrite(TFT_CS, HIGH);  // CS high = deselected
     digitalWrite(TFT_DC, HIGH);
     
     // initialize SPI - ESP32-S3 SPI.begin(SCK, MISO, MOSI, SS)
     SPI.begin(TFT_SCK, TFT_MISO, TFT_MOSI, TFT_CS);
-    delay(800);  // delay for display power-up
     
     // init display
     #ifdef USE_ST7796S
@@ -75,19 +246,22 @@ void boot_init(void) {
     #endif
     
     // init display - IMPORTANT: (320, 480) NOT (480, 320) per wiring notes
+    // the init list starts with a software reset, so it's fine to send right after the pin reset
     tft.init(320, 480);
-
-    delay(800);
+    
+    // panel answers its ID once it's out of reset, then reports sleep out + display on
+    // if MISO isn't readable these just run to the timeout, which is the old fixed delay
+    boot_wait_until("panel id", panel_id_ready, NULL, PANEL_READY_TIMEOUT_MS, PANEL_READY_POLL_MS);
+    boot_wait_until("panel on", panel_on_ready, NULL, PANEL_READY_TIMEOUT_MS, PANEL_READY_POLL_MS);
     
     // rotate 180 degrees from current landscape orientation
+    // (commands are synchronous on the bus, no need to wait after them)
     tft.setRotation(3);
-    delay(100);
     
     // verify rotation worked - after rotation, dimensions swap
     ESP_INFO("Display after rotation: %dx%d", tft.width(), tft.height());
     
     tft.fillScreen(ST77XX_WHITE);   // this is extremely stupid, white is actually black
-    delay(100);
     
     
     // Set text properties
@@ -95,6 +269,7 @@ void boot_init(void) {
     tft.setTextColor(ST77XX_BLACK, ST77XX_WHITE);  // black text on white background
     tft.setTextWrap(false);
     
+    panel_start();
 }
 
 void boot_refresh(void) {
@@ -111,6 +286,8 @@ void boot_refresh(void) {
 
 void boot_tft_shutdown(void) {
 #ifdef ARDUINO
+    panel_guard guard;
+    boot_tft_sync();
     // blank the display before powering down
     tft.fillScreen(ST77XX_BLACK);
     delay(50);
@@ -131,6 +308,7 @@ int boot_draw_rgb565_scaled(const char *path, int16_t x, int16_t y,
     const int16_t src_w = 480;
     const int16_t src_h = 320;
     const size_t expected = (size_t)src_w * (size_t)src_h * 2;
+    panel_guard guard;  // the bus goes back and forth between SD and panel for every row
     
     boot_sd_switch_to_sd_spi();
     File logo = SD.open(path, FILE_READ);
@@ -189,6 +367,209 @@ int boot_draw_rgb565_scaled(const char *path, int16_t x, int16_t y,
 #endif
 }
 
+#ifdef ARDUINO
+// logo source is 480x320 RGB565 unless it's exactly panel sized
+#define LOGO_SRC_W 480
+#define LOGO_SRC_H 320
+#define LOGO_CHUNK_LINES 20
+#define LOGO_READ_CHUNK 16384
+#define LOGO_KEY_SAMPLES 16
+#define LOGO_KEY_SAMPLE_BYTES 512
+
+// which device owns the shared SPI bus, so a chunk loop only switches when it has to
+static bool logo_on_sd = false;
+
+static void logo_bus_sd(void) {
+    if (!logo_on_sd) {
+        boot_sd_switch_to_sd_spi();
+        logo_on_sd = true;
+    }
+}
+
+static void logo_bus_tft(void) {
+    if (logo_on_sd) {
+        boot_sd_restore_tft_spi();
+        logo_on_sd = false;
+    }
+}
+
+// size, mtime and a spread of sampled blocks, cheap enough to run every boot
+// without reading the whole source again
+static uint32_t logo_source_key(File &src, int16_t width, int16_t height) {
+    uint32_t size = (uint32_t)src.size();
+    uint32_t mtime = (uint32_t)src.getLastWrite();
+    uint16_t dims[2] = { (uint16_t)width, (uint16_t)height };
+    uint32_t key = BOOT_LOGO_HASH_INIT;
+    key = boot_logo_hash(key, &size, sizeof(size));
+    key = boot_logo_hash(key, &mtime, sizeof(mtime));
+    key = boot_logo_hash(key, dims, sizeof(dims));
+
+    uint8_t sample[LOGO_KEY_SAMPLE_BYTES];
+    uint32_t span = size > LOGO_KEY_SAMPLE_BYTES ? size - LOGO_KEY_SAMPLE_BYTES : 0;
+    for (int i = 0; i < LOGO_KEY_SAMPLES; i++) {
+        src.seek((uint32_t)((uint64_t)span * i / (LOGO_KEY_SAMPLES - 1)));
+        int n = src.read(sample, sizeof(sample));
+        if (n > 0) {
+            key = boot_logo_hash(key, sample, (size_t)n);
+        }
+    }
+    return key;
+}
+
+// streams the cached copy straight to the panel, caller holds the SD bus
+static int logo_draw_cached(File &cache, const boot_logo_cache_header_t *hdr) {
+    int16_t width = (int16_t)hdr->width;
+    int16_t height = (int16_t)hdr->height;
+    uint8_t *in = (uint8_t*)malloc(LOGO_READ_CHUNK);
+    uint16_t *lines = (uint16_t*)malloc((size_t)width * LOGO_CHUNK_LINES * 2);
+    if (in == NULL || lines == NULL) {
+        free(in);
+        free(lines);
+        return 0;
+    }
+
+    boot_logo_rle_t dec;
+    boot_logo_rle_init(&dec);
+    uint32_t payload_left = hdr->payload_size;
+    size_t in_len = 0;
+    size_t in_pos = 0;
+    size_t filled = 0;
+    int16_t y = 0;
+    int ok = 1;
+    while (y < height) {
+        int16_t rows = height - y < LOGO_CHUNK_LINES ? height - y : LOGO_CHUNK_LINES;
+        size_t want = (size_t)width * rows;
+        if (in_pos == in_len) {
+            if (payload_left == 0) {
+                ok = 0;
+                break;
+            }
+            logo_bus_sd();
+            size_t ask = payload_left < LOGO_READ_CHUNK ? payload_left : LOGO_READ_CHUNK;
+            int n = cache.read(in, ask);
+            if (n <= 0) {
+                ok = 0;
+                break;
+            }
+            payload_left -= (uint32_t)n;
+            in_len = (size_t)n;
+            in_pos = 0;
+        }
+        size_t used = 0;
+        filled += boot_logo_rle_decode(&dec, in + in_pos, in_len - in_pos, &used,
+                                       lines + filled, want - filled);
+        in_pos += used;
+        if (filled == want) {
+            logo_bus_tft();
+            tft.drawRGBBitmap(0, y, lines, width, rows);
+            y += rows;
+            filled = 0;
+        }
+    }
+    free(in);
+    free(lines);
+    return ok;
+}
+
+// first boot (or changed source): scale from the source while drawing and
+// write the panel sized copy next to it, header last so a cut off write never validates
+static int logo_draw_and_build(File &src, const char *cache_path, uint32_t key,
+                               int16_t width, int16_t height) {
+    int16_t src_w = LOGO_SRC_W;
+    int16_t src_h = LOGO_SRC_H;
+    if ((size_t)src.size() == (size_t)width * (size_t)height * 2) {
+        src_w = width;
+        src_h = height;
+    } else if ((size_t)src.size() < (size_t)LOGO_SRC_W * LOGO_SRC_H * 2) {
+        return 0;
+    }
+
+    size_t src_row_bytes = (size_t)src_w * 2;
+    size_t chunk_pixels = (size_t)width * LOGO_CHUNK_LINES;
+    size_t enc_cap = BOOT_LOGO_RLE_BOUND(chunk_pixels);
+    uint8_t *src_row = (uint8_t*)malloc(src_row_bytes);
+    uint16_t *lines = (uint16_t*)malloc(chunk_pixels * 2);
+    uint8_t *enc = (uint8_t*)malloc(enc_cap);
+    if (src_row == NULL || lines == NULL || enc == NULL) {
+        free(src_row);
+        free(lines);
+        free(enc);
+        return 0;
+    }
+
+    logo_bus_sd();
+    File cache = SD.open(cache_path, FILE_WRITE);
+    boot_logo_cache_header_t hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    uint8_t packed[BOOT_LOGO_CACHE_HEADER_SIZE];
+    if (cache) {
+        boot_logo_cache_header_pack(&hdr, packed);  // zero magic until done
+        if (cache.write(packed, sizeof(packed)) != sizeof(packed)) {
+            cache.close();
+        }
+    }
+
+    int ok = 1;
+    int16_t last_sy = -1;
+    uint32_t payload = 0;
+    src.seek(0);
+    for (int16_t y = 0; y < height && ok; y += LOGO_CHUNK_LINES) {
+        int16_t rows = height - y < LOGO_CHUNK_LINES ? height - y : LOGO_CHUNK_LINES;
+        logo_bus_sd();
+        for (int16_t r = 0; r < rows; r++) {
+            int16_t sy = (int16_t)(((int32_t)(y + r) * src_h) / height);
+            if (sy != last_sy) {
+                if (sy != last_sy + 1) {
+                    src.seek((uint32_t)sy * src_row_bytes);
+                }
+                if ((size_t)src.read(src_row, src_row_bytes) != src_row_bytes) {
+                    ok = 0;
+                    break;
+                }
+                last_sy = sy;
+            }
+            boot_logo_scale_row(src_row, (uint16_t)src_w, lines + (size_t)r * width, (uint16_t)width);
+        }
+        if (!ok) {
+            break;
+        }
+        if (cache) {
+            size_t n = boot_logo_rle_encode(lines, (size_t)width * rows, enc, enc_cap);
+            if (n == 0 || cache.write(enc, n) != n) {
+                cache.close();  // keep drawing, the cache just won't validate
+            } else {
+                payload += (uint32_t)n;
+            }
+        }
+        logo_bus_tft();
+        tft.drawRGBBitmap(0, y, lines, width, rows);
+    }
+
+    if (cache) {
+        logo_bus_sd();
+        if (ok) {
+            hdr.magic = BOOT_LOGO_CACHE_MAGIC;
+            hdr.version = BOOT_LOGO_CACHE_VERSION;
+            hdr.encoding = BOOT_LOGO_ENC_RLE;
+            hdr.width = (uint16_t)width;
+            hdr.height = (uint16_t)height;
+            hdr.source_key = key;
+            hdr.payload_size = payload;
+            boot_logo_cache_header_pack(&hdr, packed);
+            cache.seek(0);
+            cache.write(packed, sizeof(packed));
+        }
+        cache.close();
+        DEBUG_PRINT("[BOOT] Logo cache %s (%lu bytes)\n", ok ? "written" : "abandoned",
+                    (unsigned long)payload);
+    }
+    free(src_row);
+    free(lines);
+    free(enc);
+    return ok;
+}
+#endif
+
 int boot_show_logo_from_sd(const char *path) {
 #ifdef ARDUINO
     if (path == NULL || path[0] == '\0') {
@@ -200,59 +581,47 @@ int boot_show_logo_from_sd(const char *path) {
     if (width <= 0 || height <= 0) {
         return 0;
     }
-    
-    const int16_t max_chunk_lines = 20;
-    int16_t chunk_lines = max_chunk_lines;
-    if (chunk_lines > height) {
-        chunk_lines = height;
-    }
-    size_t chunk_bytes = (size_t)width * (size_t)chunk_lines * 2;
-    uint16_t *chunk = (uint16_t*)malloc(chunk_bytes);
-    if (chunk == NULL) {
+    char cache_path[128];
+    if (boot_logo_cache_path(path, cache_path, sizeof(cache_path)) != 0) {
         return 0;
     }
-    
-    boot_sd_switch_to_sd_spi();
+
+    logo_on_sd = false;
+    logo_bus_sd();
     File logo = SD.open(path, FILE_READ);
     if (!logo) {
-        boot_sd_restore_tft_spi();
-        free(chunk);
+        logo_bus_tft();
         return 0;
     }
-    
-    size_t expected = (size_t)width * (size_t)height * 2;
-    if (logo.size() < expected) {
-        logo.close();
-        boot_sd_restore_tft_spi();
-        free(chunk);
-        return 0;
-    }
-    
-    tft.fillScreen(ST77XX_WHITE);
-    
-    int16_t y = 0;
-    while (y < height) {
-        int16_t lines = chunk_lines;
-        if (y + lines > height) {
-            lines = height - y;
-        }
-        size_t bytes_to_read = (size_t)width * (size_t)lines * 2;
-        
-        boot_sd_switch_to_sd_spi();
-        size_t read_bytes = logo.read((uint8_t*)chunk, bytes_to_read);
-        boot_sd_restore_tft_spi();
-        if (read_bytes != bytes_to_read) {
-            break;
+    uint32_t key = logo_source_key(logo, width, height);
+
+    int shown = 0;
+    File cache = SD.open(cache_path, FILE_READ);
+    if (cache) {
+        uint8_t packed[BOOT_LOGO_CACHE_HEADER_SIZE];
+        boot_logo_cache_header_t hdr;
+        if (cache.read(packed, sizeof(packed)) == sizeof(packed) &&
+            boot_logo_cache_header_unpack(packed, &hdr) &&
+            hdr.source_key == key && hdr.width == (uint16_t)width && hdr.height == (uint16_t)height &&
+            (size_t)cache.size() >= sizeof(packed) + hdr.payload_size) {
+            int slot = boot_trace_begin("Logo from cache");
+            shown = logo_draw_cached(cache, &hdr);
+            boot_trace_end(slot);
         }
-        
-        tft.drawRGBBitmap(0, y, chunk, width, lines);
-        
-        y += lines;
+        logo_bus_sd();
+        cache.close();
     }
-    
+
+    if (!shown) {
+        int slot = boot_trace_begin("Logo cache build");
+        shown = logo_draw_and_build(logo, cache_path, key, width, height);
+        boot_trace_end(slot);
+    }
+
+    logo_bus_sd();
     logo.close();
-    free(chunk);
-    return 1;
+    logo_bus_tft();
+    return shown;
 #else
     (void)path;
     return 0;
@@ -267,42 +636,145 @@ extern "C" {
     #define BOOT_COLOR_GREEN   0x07E0
     #define BOOT_COLOR_RED     0xF800
     
+    // no-ops until boot_init() made the mutex, boot runs on one task anyway
+    void boot_tft_lock(void) {
+        if (panel_lock != NULL) {
+            xSemaphoreTakeRecursive(panel_lock, portMAX_DELAY);
+        }
+    }
+
+    void boot_tft_unlock(void) {
+        if (panel_lock != NULL) {
+            xSemaphoreGiveRecursive(panel_lock);
+        }
+    }
+
     void boot_tft_set_cursor(int16_t x, int16_t y) {
+        panel_guard guard;
         tft.setCursor(x, y);
     }
     
     void boot_tft_set_text_size(uint8_t size) {
+        panel_guard guard;
         tft.setTextSize(size);
     }
     
     void boot_tft_set_text_color(uint16_t color, uint16_t bg) {
+        panel_guard guard;
         tft.setTextColor(color, bg);
     }
     
+    // anything that talks to the panel outside the pipe has to wait for it to drain first
+    void boot_tft_sync(void) {
+        panel_guard guard;
+        if (panel_pipe_ready) {
+            panel_pipe_sync(&panel_pipe);
+        }
+    }
+
     void boot_tft_print(const char *str) {
+        panel_guard guard;
+        boot_tft_sync();
         tft.print(str);
     }
+
+    // classic font columns for the terminal glyph atlas, the font table is private to
+    // Adafruit GFX so each glyph goes through a tiny 1 bit canvas once
+    uint8_t boot_tft_glyph_column(void *ctx, char c, int col) {
+        static GFXcanvas1 glyph_canvas(6, 8);
+        static int rendered = -1;
+        (void)ctx;
+        if (rendered != (unsigned char)c) {
+            glyph_canvas.fillScreen(0);
+            glyph_canvas.drawChar(0, 0, c, 1, 0, 1);
+            rendered = (unsigned char)c;
+        }
+        uint8_t bits = 0;
+        for (int row = 0; row < 8; row++) {
+            if (glyph_canvas.getPixel(col, row)) {
+                bits |= (uint8_t)(1u << row);
+            }
+        }
+        return bits;
+    }
     
     void boot_tft_fill_screen(uint16_t color) {
-        tft.fillScreen(color);
+        boot_tft_fill_rect(0, 0, tft.width(), tft.height(), color);
     }
     
     void boot_tft_fill_rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+        panel_guard guard;
+        if (panel_pipe_ready) {
+            panel_pipe_fill(&panel_pipe, x, y, w, h, color);
+            return;
+        }
         tft.fillRect(x, y, w, h, color);
     }
     
     void boot_tft_draw_rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+        panel_guard guard;
+        if (panel_pipe_ready) {
+            if (w <= 0 || h <= 0) {
+                return;
+            }
+            panel_pipe_fill(&panel_pipe, x, y, w, 1, color);
+            panel_pipe_fill(&panel_pipe, x, y + h - 1, w, 1, color);
+            panel_pipe_fill(&panel_pipe, x, y, 1, h, color);
+            panel_pipe_fill(&panel_pipe, x + w - 1, y, 1, h, color);
+            return;
+        }
         tft.drawRect(x, y, w, h, color);
     }
 
+    // pixels are copied into a tile, so the caller can reuse data right away
     void boot_tft_draw_rgb565(int16_t x, int16_t y, const uint16_t *data,
                               int16_t width, int16_t height) {
         if (data == NULL || width <= 0 || height <= 0) {
             return;
         }
+        panel_guard guard;
+        if (panel_pipe_ready) {
+            panel_pipe_draw(&panel_pipe, x, y, data, width, height);
+            return;
+        }
         tft.drawRGBBitmap(x, y, data, width, height);
     }
     
+    // hardware vertical scroll (VSCRDEF / VSCRSADD) moves the panel along its gate lines,
+    // which is only the screen's vertical axis in rotation 0, in landscape it would move sideways
+    // returns the number of lines that can scroll, 0 if the current rotation can't
+    int16_t boot_tft_vscroll_lines(void) {
+        return tft.getRotation() == 0 ? tft.height() : 0;
+    }
+
+    // lines [top, top + height) scroll, everything above and below stays put
+    void boot_tft_vscroll_define(int16_t top, int16_t height) {
+        int16_t lines = boot_tft_vscroll_lines();
+        if (lines <= 0 || top < 0 || height <= 0 || top + height > lines) {
+            return;
+        }
+        int16_t bottom = lines - top - height;
+        panel_guard guard;
+        uint8_t data[6] = {
+            (uint8_t)(top >> 8), (uint8_t)top,
+            (uint8_t)(height >> 8), (uint8_t)height,
+            (uint8_t)(bottom >> 8), (uint8_t)bottom
+        };
+        boot_tft_sync();
+        tft.sendCommand(PANEL_CMD_VSCRDEF, data, 6);
+    }
+
+    // frame memory line shown at the top of the scroll area
+    void boot_tft_vscroll_to(int16_t line) {
+        if (boot_tft_vscroll_lines() <= 0) {
+            return;
+        }
+        uint8_t data[2] = { (uint8_t)(line >> 8), (uint8_t)line };
+        panel_guard guard;
+        boot_tft_sync();
+        tft.sendCommand(PANEL_CMD_VSCRSADD, data, 2);
+    }
+
     int16_t boot_tft_get_width(void) {
         return tft.width();
     }
@@ -0,0 +1,270 @@
+// host build stand-in for the panel half of boot_splash.cpp, see boot_tft_host.h
+#ifndef ARDUINO
+
+#include "boot_tft_host.h"
+#include "boot_splash.h"
+#include "terminal_glyphs.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static uint16_t *fb = NULL;
+static int16_t fb_width = boot_tft_host_width;
+static int16_t fb_height = boot_tft_host_height;
+static boot_tft_stats_t stats;
+
+// Adafruit GFX text state, only used by the print fallback
+static int16_t text_x = 0;
+static int16_t text_y = 0;
+static uint8_t text_size = 1;
+static uint16_t text_fg = 0x0000;
+static uint16_t text_bg = 0xFFFF;
+
+int boot_tft_host_init(int16_t width, int16_t height) {
+    if (width <= 0 || height <= 0) {
+        return -1;
+    }
+    uint16_t *pixels = (uint16_t*)calloc((size_t)width * (size_t)height, sizeof(uint16_t));
+    if (pixels == NULL) {
+        return -1;
+    }
+    free(fb);
+    fb = pixels;
+    fb_width = width;
+    fb_height = height;
+    memset(&stats, 0, sizeof(stats));
+    return 0;
+}
+
+void boot_tft_host_free(void) {
+    free(fb);
+    fb = NULL;
+    fb_width = boot_tft_host_width;
+    fb_height = boot_tft_host_height;
+}
+
+int boot_tft_host_active(void) {
+    return fb != NULL;
+}
+
+const uint16_t *boot_tft_host_pixels(void) {
+    return fb;
+}
+
+uint16_t boot_tft_host_pixel(int16_t x, int16_t y) {
+    if (fb == NULL || x < 0 || y < 0 || x >= fb_width || y >= fb_height) {
+        return 0;
+    }
+    return fb[(size_t)y * fb_width + x];
+}
+
+void boot_tft_host_take_stats(boot_tft_stats_t *out) {
+    if (out != NULL) {
+        *out = stats;
+    }
+    memset(&stats, 0, sizeof(stats));
+}
+
+uint32_t boot_tft_host_hash(void) {
+    uint32_t hash = 2166136261u;
+    if (fb == NULL) {
+        return hash;
+    }
+    const uint8_t *bytes = (const uint8_t*)fb;
+    size_t len = (size_t)fb_width * (size_t)fb_height * sizeof(uint16_t);
+    for (size_t i = 0; i < len; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+int boot_tft_host_dump_ppm(const char *path) {
+    if (fb == NULL || path == NULL) {
+        return -1;
+    }
+    FILE *f = fopen(path, "wb");
+    if (f == NULL) {
+        return -1;
+    }
+    fprintf(f, "P6\n%d %d\n255\n", fb_width, fb_height);
+    for (size_t i = 0; i < (size_t)fb_width * (size_t)fb_height; i++) {
+        uint16_t pix = fb[i];
+        uint8_t rgb[3] = {
+            (uint8_t)(((pix >> 11) & 0x1F) * 255 / 31),
+            (uint8_t)(((pix >> 5) & 0x3F) * 255 / 63),
+            (uint8_t)((pix & 0x1F) * 255 / 31)
+        };
+        fwrite(rgb, 1, 3, f);
+    }
+    return fclose(f) == 0 ? 0 : -1;
+}
+
+// clips to the panel, returns the pixels that land on it
+static uint32_t clip(int16_t *x, int16_t *y, int16_t *w, int16_t *h) {
+    int32_t x0 = *x, y0 = *y, x1 = (int32_t)*x + *w, y1 = (int32_t)*y + *h;
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 > fb_width) x1 = fb_width;
+    if (y1 > fb_height) y1 = fb_height;
+    if (x0 >= x1 || y0 >= y1) {
+        return 0;
+    }
+    *x = (int16_t)x0;
+    *y = (int16_t)y0;
+    *w = (int16_t)(x1 - x0);
+    *h = (int16_t)(y1 - y0);
+    return (uint32_t)(x1 - x0) * (uint32_t)(y1 - y0);
+}
+
+static void fill(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    stats.fills++;
+    uint32_t count = clip(&x, &y, &w, &h);
+    stats.pixels += count;
+    if (count == 0 || fb == NULL) {
+        return;
+    }
+    for (int16_t row = 0; row < h; row++) {
+        uint16_t *out = fb + (size_t)(y + row) * fb_width + x;
+        for (int16_t col = 0; col < w; col++) {
+            out[col] = color;
+        }
+    }
+}
+
+void boot_tft_sync(void) {
+}
+
+void boot_tft_lock(void) {
+}
+
+void boot_tft_unlock(void) {
+}
+
+void boot_tft_set_cursor(int16_t x, int16_t y) {
+    text_x = x;
+    text_y = y;
+}
+
+void boot_tft_set_text_size(uint8_t size) {
+    text_size = size < 1 ? 1 : size;
+}
+
+void boot_tft_set_text_color(uint16_t color, uint16_t bg) {
+    text_fg = color;
+    text_bg = bg;
+}
+
+// not the real font, any stable pattern does for counting pixels and comparing frames
+uint8_t boot_tft_glyph_column(void *ctx, char c, int col) {
+    (void)ctx;
+    if (c == ' ') {
+        return 0;
+    }
+    return (uint8_t)(((unsigned char)c * 7 + col * 13) & 0x7F);
+}
+
+// classic font cells, opaque background like setTextColor(fg, bg)
+void boot_tft_print(const char *str) {
+    if (str == NULL) {
+        return;
+    }
+    stats.texts++;
+    for (; *str != '\0'; str++) {
+        if (*str == '\n') {
+            text_x = 0;
+            text_y += glyph_base_h * text_size;
+            continue;
+        }
+        for (int col = 0; col < glyph_base_w; col++) {
+            uint8_t bits = col < glyph_base_w - 1 ? boot_tft_glyph_column(NULL, *str, col) : 0;
+            for (int row = 0; row < glyph_base_h; row++) {
+                uint16_t color = (bits >> row) & 1 ? text_fg : text_bg;
+                int16_t x = (int16_t)(text_x + col * text_size);
+                int16_t y = (int16_t)(text_y + row * text_size);
+                int16_t w = text_size, h = text_size;
+                uint32_t count = clip(&x, &y, &w, &h);
+                stats.pixels += count;
+                for (int16_t dy = 0; fb != NULL && count > 0 && dy < h; dy++) {
+                    for (int16_t dx = 0; dx < w; dx++) {
+                        fb[(size_t)(y + dy) * fb_width + x + dx] = color;
+                    }
+                }
+            }
+        }
+        text_x += glyph_base_w * text_size;
+    }
+}
+
+void boot_tft_fill_screen(uint16_t color) {
+    fill(0, 0, fb_width, fb_height, color);
+}
+
+void boot_tft_fill_rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    fill(x, y, w, h, color);
+}
+
+// four fills, the same the panel pipe sends on the device
+void boot_tft_draw_rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    if (w <= 0 || h <= 0) {
+        return;
+    }
+    fill(x, y, w, 1, color);
+    fill(x, (int16_t)(y + h - 1), w, 1, color);
+    fill(x, y, 1, h, color);
+    fill((int16_t)(x + w - 1), y, 1, h, color);
+}
+
+void boot_tft_draw_rgb565(int16_t x, int16_t y, const uint16_t *data, int16_t width, int16_t height) {
+    if (data == NULL || width <= 0 || height <= 0) {
+        return;
+    }
+    stats.transfers++;
+    int16_t cx = x, cy = y, cw = width, ch = height;
+    uint32_t count = clip(&cx, &cy, &cw, &ch);
+    stats.pixels += count;
+    if (count == 0 || fb == NULL) {
+        return;
+    }
+    for (int16_t row = 0; row < ch; row++) {
+        memcpy(fb + (size_t)(cy + row) * fb_width + cx,
+               data + (size_t)(cy - y + row) * width + (cx - x),
+               (size_t)cw * sizeof(uint16_t));
+    }
+}
+
+// no SD card on the host, image views fall back to their cached pixels or nothing
+int boot_draw_rgb565_scaled(const char *path, int16_t x, int16_t y, int16_t width, int16_t height) {
+    (void)path;
+    (void)x;
+    (void)y;
+    (void)width;
+    (void)height;
+    return 0;
+}
+
+int16_t boot_tft_get_width(void) {
+    return fb_width;
+}
+
+int16_t boot_tft_get_height(void) {
+    return fb_height;
+}
+
+// landscape like the device, the panel can't scroll along the screen's vertical axis
+int16_t boot_tft_vscroll_lines(void) {
+    return 0;
+}
+
+void boot_tft_vscroll_define(int16_t top, int16_t height) {
+    (void)top;
+    (void)height;
+    stats.commands++;
+}
+
+void boot_tft_vscroll_to(int16_t line) {
+    (void)line;
+    stats.commands++;
+}
+
+#endif
@@ -0,0 +1,259 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "boot_trace.h"
+#include "debug_helper.h"
+#include "ino_helper.h"
+#include "vfs.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef ARDUINO
+#include <time.h>
+
+static void wait_sleep_ms(uint32_t ms) {
+    struct timespec ts;
+    ts.tv_sec = ms / 1000;
+    ts.tv_nsec = (long)(ms % 1000) * 1000000L;
+    nanosleep(&ts, NULL);
+}
+#else
+#define wait_sleep_ms(ms) delay(ms)
+#endif
+
+// recording starts active so spans taken before boot_sequence_run() (TFT init) count too
+static boot_trace_entry_t trace[BOOT_TRACE_MAX];
+static size_t trace_count = 0;
+static uint8_t trace_depth = 0;
+static uint8_t trace_stopped = 0;
+static uint8_t origin_set = 0;
+static uint32_t origin_ms = 0;
+
+void boot_trace_reset(void) {
+    memset(trace, 0, sizeof(trace));
+    trace_count = 0;
+    trace_depth = 0;
+    trace_stopped = 0;
+    origin_set = 0;
+}
+
+uint32_t boot_trace_now(void) {
+#ifdef ARDUINO
+    // millis() already counts from reset, keep it so time spent before boot shows up
+    return get_time_ms();
+#else
+    if (!origin_set) {
+        origin_ms = get_time_ms();
+        origin_set = 1;
+    }
+    return get_time_ms() - origin_ms;
+#endif
+}
+
+static boot_trace_entry_t* trace_new(const char *name) {
+    if (trace_stopped || trace_count >= BOOT_TRACE_MAX || name == NULL) {
+        return NULL;
+    }
+    boot_trace_entry_t *e = &trace[trace_count++];
+    memset(e, 0, sizeof(*e));
+    strncpy(e->name, name, sizeof(e->name) - 1);
+    e->depth = trace_depth;
+    return e;
+}
+
+int boot_trace_begin(const char *name) {
+    uint32_t now = boot_trace_now();
+    boot_trace_entry_t *e = trace_new(name);
+    if (e == NULL) {
+        return -1;
+    }
+    e->start_ms = now;
+    e->count = 1;
+    e->open = 1;
+    trace_depth++;
+    return (int)(e - trace);
+}
+
+void boot_trace_end(int slot) {
+    if (slot < 0 || (size_t)slot >= trace_count || !trace[slot].open) {
+        return;
+    }
+    boot_trace_entry_t *e = &trace[slot];
+    e->duration_ms = boot_trace_now() - e->start_ms;
+    e->open = 0;
+    if (trace_depth > 0) {
+        trace_depth--;
+    }
+}
+
+void boot_trace_add(const char *name, uint32_t start_ms, uint32_t duration_ms) {
+    if (trace_stopped || name == NULL) {
+        return;
+    }
+    for (size_t i = 0; i < trace_count; i++) {
+        if (!trace[i].open && trace[i].count > 0 && strncmp(trace[i].name, name, sizeof(trace[i].name) - 1) == 0) {
+            trace[i].duration_ms += duration_ms;
+            trace[i].count++;
+            return;
+        }
+    }
+    boot_trace_entry_t *e = trace_new(name);
+    if (e != NULL) {
+        e->start_ms = start_ms;
+        e->duration_ms = duration_ms;
+        e->count = 1;
+    }
+}
+
+int boot_wait_until(const char *name, int (*ready)(void *ctx), void *ctx,
+                    uint32_t timeout_ms, uint32_t poll_ms) {
+    if (ready == NULL) {
+        return -1;
+    }
+    int slot = boot_trace_begin(name);
+    uint32_t start = boot_trace_now();
+    int ok = 0;
+    while (1) {
+        if (ready(ctx)) {
+            ok = 1;
+            break;
+        }
+        uint32_t elapsed = boot_trace_now() - start;
+        if (elapsed >= timeout_ms) {
+            break;
+        }
+        uint32_t nap = poll_ms > 0 ? poll_ms : 1;
+        if (nap > timeout_ms - elapsed) {
+            nap = timeout_ms - elapsed;
+        }
+        wait_sleep_ms(nap);
+    }
+    boot_trace_end(slot);
+    if (!ok) {
+        DEBUG_PRINT("[BOOT] Wait for %s timed out after %lu ms\n",
+                    name ? name : "?", (unsigned long)timeout_ms);
+    }
+    return ok ? 0 : -1;
+}
+
+void boot_trace_stop(void) {
+    // close whatever is still open so the saved trace is complete
+    for (size_t i = 0; i < trace_count; i++) {
+        if (trace[i].open) {
+            boot_trace_end((int)i);
+        }
+    }
+    trace_stopped = 1;
+}
+
+int boot_trace_active(void) {
+    return !trace_stopped;
+}
+
+size_t boot_trace_count(void) {
+    return trace_count;
+}
+
+const boot_trace_entry_t* boot_trace_get(size_t index) {
+    if (index >= trace_count) {
+        return NULL;
+    }
+    return &trace[index];
+}
+
+size_t boot_trace_format(char *out, size_t out_len) {
+    if (out == NULL || out_len == 0) {
+        return 0;
+    }
+    size_t used = 0;
+    int len = snprintf(out, out_len, "# start_ms duration_ms depth count name\n");
+    if (len > 0) {
+        used = (size_t)len < out_len ? (size_t)len : out_len - 1;
+    }
+    for (size_t i = 0; i < trace_count && used + 1 < out_len; i++) {
+        const boot_trace_entry_t *e = &trace[i];
+        len = snprintf(out + used, out_len - used, "%lu %lu %u %u %s\n",
+                       (unsigned long)e->start_ms, (unsigned long)e->duration_ms,
+                       (unsigned)e->depth, (unsigned)e->count, e->name);
+        if (len < 0 || (size_t)len >= out_len - used) {
+            break;  // drop a half written line
+        }
+        used += (size_t)len;
+    }
+    out[used] = '\0';
+    return used;
+}
+
+int boot_trace_save(const char *path) {
+    if (path == NULL) {
+        return -1;
+    }
+    // one buffer, one write, keeps the SD card busy for as short as possible
+    size_t cap = BOOT_TRACE_MAX * 64;
+    char *buf = (char*)malloc(cap);
+    if (buf == NULL) {
+        return -1;
+    }
+    size_t len = boot_trace_format(buf, cap);
+    vfs_file_t *file = vfs_open(path, VFS_O_WRITE | VFS_O_TRUNC | VFS_O_CREATE);
+    if (file == NULL) {
+        free(buf);
+        return -1;
+    }
+    ssize_t written = vfs_write(file, buf, len);
+    vfs_close(file);
+    free(buf);
+    return written == (ssize_t)len ? 0 : -1;
+}
+
+int boot_trace_load(const char *path, boot_trace_entry_t *out, size_t max_entries) {
+    if (path == NULL || out == NULL) {
+        return -1;
+    }
+    vfs_file_t *file = vfs_open(path, VFS_O_READ);
+    if (file == NULL) {
+        return -1;
+    }
+    size_t cap = BOOT_TRACE_MAX * 64;
+    char *buf = (char*)malloc(cap + 1);
+    if (buf == NULL) {
+        vfs_close(file);
+        return -1;
+    }
+    size_t total = 0;
+    while (total < cap) {
+        ssize_t n = vfs_read(file, buf + total, cap - total);
+        if (n <= 0) {
+            break;
+        }
+        total += (size_t)n;
+    }
+    vfs_close(file);
+    buf[total] = '\0';
+
+    size_t count = 0;
+    char *save = NULL;
+    for (char *line = strtok_r(buf, "\n", &save); line != NULL && count < max_entries;
+         line = strtok_r(NULL, "\n", &save)) {
+        if (line[0] == '#') {
+            continue;
+        }
+        unsigned long start = 0;
+        unsigned long dur = 0;
+        unsigned depth = 0;
+        unsigned hits = 0;
+        int name_at = 0;
+        if (sscanf(line, "%lu %lu %u %u %n", &start, &dur, &depth, &hits, &name_at) < 4 || name_at == 0) {
+            continue;
+        }
+        boot_trace_entry_t *e = &out[count++];
+        memset(e, 0, sizeof(*e));
+        e->start_ms = (uint32_t)start;
+        e->duration_ms = (uint32_t)dur;
+        e->depth = (uint8_t)depth;
+        e->count = (uint16_t)hits;
+        strncpy(e->name, line + name_at, sizeof(e->name) - 1);
+    }
+    free(buf);
+    return (int)count;
+}
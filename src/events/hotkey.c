@@ -1,38 +1,55 @@
 #include "hotkey.h"
+#include "registry.h"
 #include <stddef.h>
 
 // hotkeys (:
-#define max_hotkeys 16  // you could have more hotkeys but were working with limited RAM
+// kept in the shared registry (registry.c) under key << 8 | modifiers, no fixed count any more
 typedef struct {
     uint8_t modifiers;
     key_code key;
     const char *action;
 } hotkey;
-static hotkey hotkeys[max_hotkeys];
-static uint8_t hotkey_count = 0;
+
+static uint32_t hotkey_id(uint8_t modifiers, key_code key) {
+    return ((uint32_t)key << 8) | modifiers;
+}
 
 // how user registers a new hotkey
 void register_key(uint8_t modifiers, key_code key, const char *action) {
-    if (max_hotkeys > hotkey_count) {
-        hotkeys[hotkey_count++] = (hotkey){ modifiers, key, action }; 
-    }
+    hotkey entry = { modifiers, key, action };
+    registry_add_id(registry_hotkey, hotkey_id(modifiers, key), &entry, sizeof(entry));
 }
 
 // reset registered hotkeys (primarily for tests)
 void reset_hotkeys(void) {
-    hotkey_count = 0;
+    registry_reset(registry_hotkey);
 }
 
 // check if a key event matches a registered hotkey and return the action name
 // returns NULL if no match found
+// a hotkey matches when its modifiers are all held, each subset of the held ones is one lookup
+// and the binding with the most modifiers wins (ctrl+shift+x over ctrl+x)
 const char *find_hotkey_action(key_event evt) {
-    for (uint8_t i = 0; i < hotkey_count; i++) {
-        if (hotkeys[i].key != evt.key) {
-            continue;
+    const char *action = NULL;
+    int best = -1;
+    uint8_t held = evt.modifiers;
+    uint8_t subset = held;
+    for (;;) {
+        registry_entry *entry = registry_find_id(registry_hotkey, hotkey_id(subset, evt.key));
+        if (entry != NULL) {
+            int bits = 0;
+            for (uint8_t m = subset; m != 0; m &= (uint8_t)(m - 1)) {
+                bits++;
+            }
+            if (bits > best) {
+                best = bits;
+                action = ((hotkey*)entry->item)->action;
+            }
         }
-        if ((evt.modifiers & hotkeys[i].modifiers) == hotkeys[i].modifiers) {
-            return hotkeys[i].action;
+        if (subset == 0) {
+            break;
         }
+        subset = (uint8_t)((subset - 1) & held);
     }
-    return NULL;
+    return action;
 }
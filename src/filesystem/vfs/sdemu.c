@@ -0,0 +1,1529 @@
+// host side SD card emulator, see sdemu.h
+// FAT16/FAT32 over a disk image with long file names, one sector cache for
+// data/dirs and one for the FAT (same shape as the SD library), every cache
+// miss or writeback is charged as one SD command + one sector transfer
+
+#include "sdemu.h"
+#include "vfs.h"
+#include "boot_sequence.h"
+#include "debug_helper.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#define SECTOR_SIZE 512
+#define DIR_ENTRY_SIZE 32
+#define ENTRIES_PER_SECTOR (SECTOR_SIZE / DIR_ENTRY_SIZE)
+#define NAME_MAX_LEN 64
+#define LFN_CHARS 13
+
+#define ATTR_READ_ONLY 0x01
+#define ATTR_HIDDEN    0x02
+#define ATTR_SYSTEM    0x04
+#define ATTR_VOLUME_ID 0x08
+#define ATTR_DIRECTORY 0x10
+#define ATTR_ARCHIVE   0x20
+#define ATTR_LFN       0x0F
+
+#define NTRES_LOWER_BASE 0x08
+#define NTRES_LOWER_EXT  0x10
+
+#define ENTRY_FREE 0xE5
+#define ENTRY_END  0x00
+
+#define CACHE_READ      0   // read sector, caller only reads
+#define CACHE_WRITE     1   // read sector, caller modifies part of it
+#define CACHE_OVERWRITE 2   // caller rewrites all 512 bytes, skip the read
+
+// defaults follow the real hardware:
+// every boot_sd_* switch does SPI.end + delay(50) + SPI.begin + delay(50),
+// a single block at 20MHz SPI is ~205us on the wire, writes wait on card busy
+#define DEFAULT_LATENCY { \
+    .spi_switch_us = 100000, \
+    .command_us = 150, \
+    .sector_read_us = 220, \
+    .sector_write_us = 700 \
+}
+static const sdemu_latency_t default_latency = DEFAULT_LATENCY;
+
+typedef struct {
+    uint32_t lba;
+    int valid;
+    int dirty;
+    uint8_t data[SECTOR_SIZE];
+} sector_cache_t;
+
+static struct {
+    FILE *image;
+    int fat_type;               // 16 or 32
+    uint32_t total_sectors;
+    uint32_t sectors_per_cluster;
+    uint32_t num_fats;
+    uint32_t fat_size;
+    uint32_t fat_start;
+    uint32_t root_dir_start;    // fat16 fixed root region
+    uint32_t root_dir_sectors;
+    uint32_t root_cluster;      // fat32 root, 0 on fat16
+    uint32_t data_start;
+    uint32_t cluster_count;
+    uint32_t alloc_hint;
+} vol;
+
+static sector_cache_t data_cache;
+static sector_cache_t fat_cache;
+static sdemu_latency_t latency = DEFAULT_LATENCY;
+static sdemu_stats_t stats;
+
+// position inside a directory, cluster 0 is the fat16 fixed root
+typedef struct {
+    uint32_t cluster;
+    uint32_t sector;
+    uint32_t index;
+    int end;            // walked past the last slot
+} dir_pos_t;
+
+// byte offsets of the 13 name characters inside an lfn entry
+static const uint8_t lfn_offsets[LFN_CHARS] = {1, 3, 5, 7, 9, 14, 16, 18, 20, 22, 24, 28, 30};
+
+// one resolved directory entry (short entry + where its lfn run starts)
+typedef struct {
+    uint8_t raw[DIR_ENTRY_SIZE];
+    dir_pos_t pos;
+    dir_pos_t first_pos;
+    uint32_t slot_count;
+    int is_root;
+    char name[NAME_MAX_LEN];
+} dir_entry_t;
+
+struct sdemu_file {
+    int is_dir;
+    int writable;
+    uint32_t first_cluster;
+    uint32_t size;
+    uint32_t pos;
+    uint32_t cur_cluster;       // cluster holding pos, 0 if not walked yet
+    uint32_t cur_index;         // index of cur_cluster in the chain
+    int has_entry;              // root has no directory entry
+    dir_pos_t entry_pos;
+    int dirty;
+    dir_pos_t iter;
+};
+
+static uint16_t rd16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t rd32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void wr16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void wr32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)((v >> 8) & 0xFF);
+    p[2] = (uint8_t)((v >> 16) & 0xFF);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+// host versions of the SPI bus switches, vfs_sdemu.c calls them at the
+// same spots vfs_sd.cpp does so the switch count matches the device
+void boot_sd_switch_to_sd_spi(void) {
+    stats.spi_switches++;
+    stats.sim_us += latency.spi_switch_us;
+}
+
+void boot_sd_restore_tft_spi(void) {
+    stats.spi_switches++;
+    stats.sim_us += latency.spi_switch_us;
+}
+
+// block device
+
+static int dev_read(uint32_t lba, uint8_t *buf) {
+    if (vol.image == NULL || lba >= vol.total_sectors) {
+        return VFS_EIO;
+    }
+    stats.commands++;
+    stats.sectors_read++;
+    stats.sim_us += latency.command_us + latency.sector_read_us;
+    if (fseek(vol.image, (long)lba * SECTOR_SIZE, SEEK_SET) != 0) {
+        return VFS_EIO;
+    }
+    if (fread(buf, 1, SECTOR_SIZE, vol.image) != SECTOR_SIZE) {
+        return VFS_EIO;
+    }
+    return VFS_EOK;
+}
+
+static int dev_write(uint32_t lba, const uint8_t *buf) {
+    if (vol.image == NULL || lba >= vol.total_sectors) {
+        return VFS_EIO;
+    }
+    stats.commands++;
+    stats.sectors_written++;
+    stats.sim_us += latency.command_us + latency.sector_write_us;
+    if (fseek(vol.image, (long)lba * SECTOR_SIZE, SEEK_SET) != 0) {
+        return VFS_EIO;
+    }
+    if (fwrite(buf, 1, SECTOR_SIZE, vol.image) != SECTOR_SIZE) {
+        return VFS_EIO;
+    }
+    return VFS_EOK;
+}
+
+static int cache_flush(sector_cache_t *cache) {
+    if (!cache->valid || !cache->dirty) {
+        return VFS_EOK;
+    }
+    int res = dev_write(cache->lba, cache->data);
+    if (res != VFS_EOK) {
+        return res;
+    }
+    // keep the mirror fats in sync, the SD library does the same on sync
+    if (cache == &fat_cache) {
+        for (uint32_t i = 1; i < vol.num_fats; i++) {
+            res = dev_write(cache->lba + i * vol.fat_size, cache->data);
+            if (res != VFS_EOK) {
+                return res;
+            }
+        }
+    }
+    cache->dirty = 0;
+    return VFS_EOK;
+}
+
+static uint8_t* cache_get(sector_cache_t *cache, uint32_t lba, int mode) {
+    if (cache->valid && cache->lba == lba) {
+        stats.cache_hits++;
+        if (mode != CACHE_READ) {
+            cache->dirty = 1;
+        }
+        return cache->data;
+    }
+    if (cache_flush(cache) != VFS_EOK) {
+        return NULL;
+    }
+    if (mode == CACHE_OVERWRITE) {
+        memset(cache->data, 0, SECTOR_SIZE);
+    } else if (dev_read(lba, cache->data) != VFS_EOK) {
+        cache->valid = 0;
+        return NULL;
+    }
+    cache->lba = lba;
+    cache->valid = 1;
+    cache->dirty = (mode != CACHE_READ);
+    return cache->data;
+}
+
+static int cache_sync(void) {
+    int res = cache_flush(&data_cache);
+    if (res != VFS_EOK) {
+        return res;
+    }
+    res = cache_flush(&fat_cache);
+    if (res == VFS_EOK && vol.image != NULL) {
+        fflush(vol.image);
+    }
+    return res;
+}
+
+// fat table
+
+static uint32_t fat_eoc(void) {
+    return vol.fat_type == 32 ? 0x0FFFFFFF : 0xFFFF;
+}
+
+static int fat_is_eoc(uint32_t value) {
+    return vol.fat_type == 32 ? value >= 0x0FFFFFF8 : value >= 0xFFF8;
+}
+
+static int cluster_valid(uint32_t cluster) {
+    return cluster >= 2 && cluster < vol.cluster_count + 2;
+}
+
+static int fat_get(uint32_t cluster, uint32_t *out) {
+    if (!cluster_valid(cluster)) {
+        return VFS_EIO;
+    }
+    uint32_t offset = cluster * (vol.fat_type == 32 ? 4 : 2);
+    uint8_t *sector = cache_get(&fat_cache, vol.fat_start + offset / SECTOR_SIZE, CACHE_READ);
+    if (sector == NULL) {
+        return VFS_EIO;
+    }
+    if (vol.fat_type == 32) {
+        *out = rd32(sector + offset % SECTOR_SIZE) & 0x0FFFFFFF;
+    } else {
+        *out = rd16(sector + offset % SECTOR_SIZE);
+    }
+    return VFS_EOK;
+}
+
+static int fat_set(uint32_t cluster, uint32_t value) {
+    if (!cluster_valid(cluster)) {
+        return VFS_EIO;
+    }
+    uint32_t offset = cluster * (vol.fat_type == 32 ? 4 : 2);
+    uint8_t *sector = cache_get(&fat_cache, vol.fat_start + offset / SECTOR_SIZE, CACHE_WRITE);
+    if (sector == NULL) {
+        return VFS_EIO;
+    }
+    if (vol.fat_type == 32) {
+        uint8_t *p = sector + offset % SECTOR_SIZE;
+        wr32(p, (rd32(p) & 0xF0000000) | (value & 0x0FFFFFFF));
+    } else {
+        wr16(sector + offset % SECTOR_SIZE, (uint16_t)value);
+    }
+    return VFS_EOK;
+}
+
+static uint32_t cluster_lba(uint32_t cluster) {
+    return vol.data_start + (cluster - 2) * vol.sectors_per_cluster;
+}
+
+// allocate one cluster and link it after prev (0 starts a new chain)
+// returns the new cluster or 0 when the card is full
+static uint32_t cluster_alloc(uint32_t prev) {
+    uint32_t first = cluster_valid(vol.alloc_hint) ? vol.alloc_hint : 2;
+    uint32_t cluster = first;
+    do {
+        uint32_t value = 0;
+        if (fat_get(cluster, &value) != VFS_EOK) {
+            return 0;
+        }
+        if (value == 0) {
+            if (fat_set(cluster, fat_eoc()) != VFS_EOK) {
+                return 0;
+            }
+            if (prev != 0 && fat_set(prev, cluster) != VFS_EOK) {
+                return 0;
+            }
+            vol.alloc_hint = cluster + 1;
+            return cluster;
+        }
+        cluster++;
+        if (cluster >= vol.cluster_count + 2) {
+            cluster = 2;
+        }
+    } while (cluster != first);
+    return 0;
+}
+
+static int cluster_free_chain(uint32_t cluster) {
+    while (cluster_valid(cluster)) {
+        uint32_t next = 0;
+        if (fat_get(cluster, &next) != VFS_EOK) {
+            return VFS_EIO;
+        }
+        if (fat_set(cluster, 0) != VFS_EOK) {
+            return VFS_EIO;
+        }
+        if (cluster < vol.alloc_hint) {
+            vol.alloc_hint = cluster;
+        }
+        if (fat_is_eoc(next)) {
+            break;
+        }
+        cluster = next;
+    }
+    return VFS_EOK;
+}
+
+static int cluster_zero(uint32_t cluster) {
+    uint32_t lba = cluster_lba(cluster);
+    for (uint32_t i = 0; i < vol.sectors_per_cluster; i++) {
+        uint8_t *sector = cache_get(&data_cache, lba + i, CACHE_OVERWRITE);
+        if (sector == NULL) {
+            return VFS_EIO;
+        }
+        memset(sector, 0, SECTOR_SIZE);
+    }
+    return VFS_EOK;
+}
+
+// directory walking
+
+static uint32_t root_dir_cluster(void) {
+    return vol.fat_type == 32 ? vol.root_cluster : 0;
+}
+
+static uint32_t entry_cluster(const uint8_t *raw) {
+    uint32_t cluster = rd16(raw + 26);
+    if (vol.fat_type == 32) {
+        cluster |= (uint32_t)rd16(raw + 20) << 16;
+    }
+    return cluster;
+}
+
+static void entry_set_cluster(uint8_t *raw, uint32_t cluster) {
+    wr16(raw + 26, (uint16_t)(cluster & 0xFFFF));
+    wr16(raw + 20, vol.fat_type == 32 ? (uint16_t)(cluster >> 16) : 0);
+}
+
+static uint32_t dir_lba(const dir_pos_t *pos) {
+    if (pos->cluster == 0) {
+        return vol.root_dir_start + pos->sector;
+    }
+    return cluster_lba(pos->cluster) + pos->sector;
+}
+
+static uint8_t* dir_entry_ptr(const dir_pos_t *pos, int mode) {
+    uint8_t *sector = cache_get(&data_cache, dir_lba(pos), mode);
+    if (sector == NULL) {
+        return NULL;
+    }
+    return sector + pos->index * DIR_ENTRY_SIZE;
+}
+
+// step to the next entry slot, grows cluster directories when extend is set
+// returns VFS_EOK, VFS_ENOENT at the end of the directory (VFS_ENOSPC if it
+// can not grow) or an error, pos is left marked as ended in the first two cases
+static int dir_advance(dir_pos_t *pos, int extend) {
+    if (pos->end) {
+        return VFS_ENOENT;
+    }
+    if (pos->index + 1 < ENTRIES_PER_SECTOR) {
+        pos->index++;
+        return VFS_EOK;
+    }
+    if (pos->cluster == 0) {
+        if (pos->sector + 1 >= vol.root_dir_sectors) {
+            pos->end = 1;
+            return extend ? VFS_ENOSPC : VFS_ENOENT;
+        }
+        pos->sector++;
+        pos->index = 0;
+        return VFS_EOK;
+    }
+    if (pos->sector + 1 < vol.sectors_per_cluster) {
+        pos->sector++;
+        pos->index = 0;
+        return VFS_EOK;
+    }
+    uint32_t next = 0;
+    if (fat_get(pos->cluster, &next) != VFS_EOK) {
+        return VFS_EIO;
+    }
+    if (fat_is_eoc(next) || !cluster_valid(next)) {
+        if (!extend) {
+            pos->end = 1;
+            return VFS_ENOENT;
+        }
+        next = cluster_alloc(pos->cluster);
+        if (next == 0) {
+            pos->end = 1;
+            return VFS_ENOSPC;
+        }
+        if (cluster_zero(next) != VFS_EOK) {
+            return VFS_EIO;
+        }
+    }
+    pos->cluster = next;
+    pos->sector = 0;
+    pos->index = 0;
+    return VFS_EOK;
+}
+
+static uint8_t lfn_checksum(const uint8_t *short_name) {
+    uint8_t sum = 0;
+    for (int i = 0; i < 11; i++) {
+        sum = (uint8_t)(((sum & 1) << 7) + (sum >> 1) + short_name[i]);
+    }
+    return sum;
+}
+
+static void short_name_to_string(const uint8_t *raw, char *out) {
+    size_t len = 0;
+    for (int i = 0; i < 8 && raw[i] != ' '; i++) {
+        char c = (char)raw[i];
+        if (i == 0 && raw[i] == 0x05) {
+            c = (char)0xE5;
+        }
+        out[len++] = (raw[12] & NTRES_LOWER_BASE) ? (char)tolower((unsigned char)c) : c;
+    }
+    if (raw[8] != ' ') {
+        out[len++] = '.';
+        for (int i = 8; i < 11 && raw[i] != ' '; i++) {
+            char c = (char)raw[i];
+            out[len++] = (raw[12] & NTRES_LOWER_EXT) ? (char)tolower((unsigned char)c) : c;
+        }
+    }
+    out[len] = '\0';
+}
+
+// read forward from pos to the next live short entry, assembling its long name
+// returns 1 with an entry, 0 at the end of the directory, < 0 on error
+static int dir_read_next(dir_pos_t *pos, dir_entry_t *out) {
+    char lfn[NAME_MAX_LEN];
+    int lfn_valid = 0;
+    uint8_t lfn_sum = 0;
+    uint8_t lfn_expect = 0;
+    dir_pos_t lfn_start = *pos;
+    uint32_t lfn_slots = 0;
+
+    while (1) {
+        if (pos->end) {
+            return 0;
+        }
+        uint8_t *raw = dir_entry_ptr(pos, CACHE_READ);
+        if (raw == NULL) {
+            return VFS_EIO;
+        }
+        if (raw[0] == ENTRY_END) {
+            return 0;
+        }
+
+        dir_pos_t here = *pos;
+        int done = 0;
+
+        if (raw[0] == ENTRY_FREE) {
+            lfn_valid = 0;
+        } else if ((raw[11] & 0x3F) == ATTR_LFN) {
+            uint8_t ord = raw[0] & 0x1F;
+            if (raw[0] & 0x40) {
+                memset(lfn, 0, sizeof(lfn));
+                lfn_valid = (ord > 0);
+                lfn_sum = raw[13];
+                lfn_expect = ord;
+                lfn_start = here;
+                lfn_slots = 0;
+            }
+            if (lfn_valid && ord == lfn_expect && raw[13] == lfn_sum) {
+                size_t base = (size_t)(ord - 1) * LFN_CHARS;
+                for (int i = 0; i < LFN_CHARS; i++) {
+                    uint16_t ch = rd16(raw + lfn_offsets[i]);
+                    if (ch == 0x0000 || ch == 0xFFFF) {
+                        break;
+                    }
+                    if (base + i < sizeof(lfn) - 1) {
+                        lfn[base + i] = ch < 0x80 ? (char)ch : '?';
+                    }
+                }
+                lfn_expect--;
+                lfn_slots++;
+            } else {
+                lfn_valid = 0;
+            }
+        } else if (!(raw[11] & ATTR_VOLUME_ID)) {
+            memcpy(out->raw, raw, DIR_ENTRY_SIZE);
+            out->pos = here;
+            out->is_root = 0;
+            if (lfn_valid && lfn_expect == 0 && lfn_checksum(raw) == lfn_sum && lfn[0] != '\0') {
+                strncpy(out->name, lfn, sizeof(out->name) - 1);
+                out->name[sizeof(out->name) - 1] = '\0';
+                out->first_pos = lfn_start;
+                out->slot_count = lfn_slots + 1;
+            } else {
+                short_name_to_string(raw, out->name);
+                out->first_pos = here;
+                out->slot_count = 1;
+            }
+            done = 1;
+        } else {
+            lfn_valid = 0;
+        }
+
+        int res = dir_advance(pos, 0);
+        if (done) {
+            return 1;
+        }
+        if (res == VFS_ENOENT) {
+            return 0;
+        }
+        if (res != VFS_EOK) {
+            return res;
+        }
+    }
+}
+
+static int name_equal(const char *a, const char *b) {
+    while (*a != '\0' && *b != '\0') {
+        if (tolower((unsigned char)*a) != tolower((unsigned char)*b)) {
+            return 0;
+        }
+        a++;
+        b++;
+    }
+    return *a == *b;
+}
+
+static int dir_find(uint32_t dir_cluster, const char *name, dir_entry_t *out) {
+    dir_pos_t pos = {dir_cluster, 0, 0, 0};
+    while (1) {
+        int res = dir_read_next(&pos, out);
+        if (res <= 0) {
+            return res == 0 ? VFS_ENOENT : res;
+        }
+        if (name_equal(out->name, name)) {
+            return VFS_EOK;
+        }
+    }
+}
+
+static void make_root_entry(dir_entry_t *out) {
+    memset(out, 0, sizeof(*out));
+    out->raw[11] = ATTR_DIRECTORY;
+    entry_set_cluster(out->raw, root_dir_cluster());
+    out->is_root = 1;
+    strcpy(out->name, "/");
+}
+
+static int entry_is_dir(const dir_entry_t *entry) {
+    return (entry->raw[11] & ATTR_DIRECTORY) != 0;
+}
+
+// cluster a directory entry points at, ".." entries store 0 for the root
+static uint32_t entry_dir_cluster(const dir_entry_t *entry) {
+    uint32_t cluster = entry_cluster(entry->raw);
+    return cluster == 0 ? root_dir_cluster() : cluster;
+}
+
+// walk an absolute path, out gets the final entry and parent the cluster of
+// the directory holding it, when only the final component is missing the
+// result is VFS_ENOENT with *missing_last set so callers can create it there
+static int path_lookup(const char *path, dir_entry_t *out, uint32_t *parent,
+                       int *missing_last) {
+    if (missing_last != NULL) {
+        *missing_last = 0;
+    }
+    if (vol.image == NULL) {
+        return VFS_ENODEV;
+    }
+    if (path == NULL || path[0] != '/') {
+        return VFS_EINVAL;
+    }
+
+    dir_entry_t current;
+    make_root_entry(&current);
+    uint32_t parent_cluster = root_dir_cluster();
+    const char *p = path;
+
+    while (1) {
+        while (*p == '/') {
+            p++;
+        }
+        if (*p == '\0') {
+            break;
+        }
+
+        char segment[NAME_MAX_LEN];
+        size_t seg_len = 0;
+        while (*p != '\0' && *p != '/') {
+            if (seg_len + 1 >= sizeof(segment)) {
+                return VFS_ENAMETOOLONG;
+            }
+            segment[seg_len++] = *p++;
+        }
+        segment[seg_len] = '\0';
+
+        if (!entry_is_dir(&current)) {
+            return VFS_ENOTDIR;
+        }
+        parent_cluster = entry_dir_cluster(&current);
+
+        int res = dir_find(parent_cluster, segment, &current);
+        if (res != VFS_EOK) {
+            const char *rest = p;
+            while (*rest == '/') {
+                rest++;
+            }
+            if (res == VFS_ENOENT && *rest == '\0') {
+                if (parent != NULL) {
+                    *parent = parent_cluster;
+                }
+                if (missing_last != NULL) {
+                    *missing_last = 1;
+                }
+            }
+            return res;
+        }
+    }
+
+    if (out != NULL) {
+        *out = current;
+    }
+    if (parent != NULL) {
+        *parent = parent_cluster;
+    }
+    return VFS_EOK;
+}
+
+// name of the final path component without trailing slashes
+static int path_basename(const char *path, char *out, size_t out_len) {
+    size_t len = strlen(path);
+    while (len > 1 && path[len - 1] == '/') {
+        len--;
+    }
+    size_t start = len;
+    while (start > 0 && path[start - 1] != '/') {
+        start--;
+    }
+    if (len == start || len - start >= out_len) {
+        return VFS_ENAMETOOLONG;
+    }
+    memcpy(out, path + start, len - start);
+    out[len - start] = '\0';
+    return VFS_EOK;
+}
+
+// short name handling
+
+static int short_char_ok(char c) {
+    if ((unsigned char)c < 0x20 || (unsigned char)c > 0x7E) {
+        return 0;
+    }
+    return strchr(" \"*+,./:;<=>?[\\]|", c) == NULL;
+}
+
+// fill an 8.3 name if the long name fits exactly, otherwise return 0
+static int short_name_exact(const char *name, uint8_t *sfn, uint8_t *ntres) {
+    memset(sfn, ' ', 11);
+    *ntres = 0;
+    if (strcmp(name, ".") == 0 || strcmp(name, "..") == 0) {
+        return 0;
+    }
+    const char *dot = strrchr(name, '.');
+    size_t base_len = dot ? (size_t)(dot - name) : strlen(name);
+    size_t ext_len = dot ? strlen(dot + 1) : 0;
+    if (base_len == 0 || base_len > 8 || ext_len > 3 || (dot && ext_len == 0)) {
+        return 0;
+    }
+
+    int base_lower = 0, base_upper = 0, ext_lower = 0, ext_upper = 0;
+    for (size_t i = 0; i < base_len; i++) {
+        char c = name[i];
+        if (!short_char_ok(c)) {
+            return 0;
+        }
+        base_lower |= islower((unsigned char)c) != 0;
+        base_upper |= isupper((unsigned char)c) != 0;
+        sfn[i] = (uint8_t)toupper((unsigned char)c);
+    }
+    for (size_t i = 0; i < ext_len; i++) {
+        char c = dot[1 + i];
+        if (!short_char_ok(c)) {
+            return 0;
+        }
+        ext_lower |= islower((unsigned char)c) != 0;
+        ext_upper |= isupper((unsigned char)c) != 0;
+        sfn[8 + i] = (uint8_t)toupper((unsigned char)c);
+    }
+    if ((base_lower && base_upper) || (ext_lower && ext_upper)) {
+        return 0;
+    }
+    if (base_lower) {
+        *ntres |= NTRES_LOWER_BASE;
+    }
+    if (ext_lower) {
+        *ntres |= NTRES_LOWER_EXT;
+    }
+    if (sfn[0] == 0xE5) {
+        sfn[0] = 0x05;
+    }
+    return 1;
+}
+
+static int short_name_in_use(uint32_t dir_cluster, const uint8_t *sfn) {
+    dir_pos_t pos = {dir_cluster, 0, 0, 0};
+    dir_entry_t entry;
+    while (1) {
+        int res = dir_read_next(&pos, &entry);
+        if (res <= 0) {
+            return res < 0 ? res : 0;
+        }
+        if (memcmp(entry.raw, sfn, 11) == 0) {
+            return 1;
+        }
+    }
+}
+
+// build a BASE~N.EXT alias for a name that needs an lfn run
+static int short_name_alias(uint32_t dir_cluster, const char *name, uint8_t *sfn) {
+    const char *dot = strrchr(name, '.');
+    if (dot == name) {
+        dot = NULL;     // dotfiles have no extension
+    }
+    char base[9];
+    size_t base_len = 0;
+    for (const char *p = name; *p != '\0' && (dot == NULL || p < dot) && base_len < 6; p++) {
+        if (short_char_ok(*p)) {
+            base[base_len++] = (char)toupper((unsigned char)*p);
+        }
+    }
+    if (base_len == 0) {
+        base[base_len++] = '_';
+    }
+    char ext[4];
+    size_t ext_len = 0;
+    if (dot != NULL) {
+        for (const char *p = dot + 1; *p != '\0' && ext_len < 3; p++) {
+            if (short_char_ok(*p)) {
+                ext[ext_len++] = (char)toupper((unsigned char)*p);
+            }
+        }
+    }
+
+    for (int n = 1; n < 100000; n++) {
+        char tail[8];
+        int tail_len = snprintf(tail, sizeof(tail), "~%d", n);
+        size_t keep = base_len;
+        if (keep + (size_t)tail_len > 8) {
+            keep = 8 - (size_t)tail_len;
+        }
+        memset(sfn, ' ', 11);
+        memcpy(sfn, base, keep);
+        memcpy(sfn + keep, tail, (size_t)tail_len);
+        memcpy(sfn + 8, ext, ext_len);
+        int used = short_name_in_use(dir_cluster, sfn);
+        if (used < 0) {
+            return used;
+        }
+        if (!used) {
+            return VFS_EOK;
+        }
+    }
+    return VFS_EEXIST;
+}
+
+// write a new entry (lfn run + short entry) into a directory
+static int dir_add_entry(uint32_t dir_cluster, const char *name, uint8_t attr,
+                         uint32_t first_cluster, uint32_t size, dir_pos_t *out_pos) {
+    size_t name_len = strlen(name);
+    if (name_len == 0) {
+        return VFS_EINVAL;
+    }
+    if (name_len >= NAME_MAX_LEN) {
+        return VFS_ENAMETOOLONG;
+    }
+    for (size_t i = 0; i < name_len; i++) {
+        if ((unsigned char)name[i] < 0x20 || strchr("\"*/:<>?\\|", name[i]) != NULL) {
+            return VFS_EINVAL;
+        }
+    }
+
+    uint8_t sfn[11];
+    uint8_t ntres = 0;
+    uint32_t lfn_count = 0;
+    if (!short_name_exact(name, sfn, &ntres)) {
+        int res = short_name_alias(dir_cluster, name, sfn);
+        if (res != VFS_EOK) {
+            return res;
+        }
+        lfn_count = (uint32_t)((name_len + LFN_CHARS - 1) / LFN_CHARS);
+    }
+    uint32_t needed = lfn_count + 1;
+
+    // find a run of free slots, growing the directory if it runs out
+    dir_pos_t pos = {dir_cluster, 0, 0, 0};
+    dir_pos_t run_start = pos;
+    uint32_t run_len = 0;
+    while (1) {
+        uint8_t *raw = dir_entry_ptr(&pos, CACHE_READ);
+        if (raw == NULL) {
+            return VFS_EIO;
+        }
+        if (raw[0] == ENTRY_FREE || raw[0] == ENTRY_END) {
+            if (run_len == 0) {
+                run_start = pos;
+            }
+            run_len++;
+            if (run_len == needed) {
+                break;
+            }
+        } else {
+            run_len = 0;
+        }
+        int res = dir_advance(&pos, 1);
+        if (res != VFS_EOK) {
+            return res;
+        }
+    }
+
+    uint8_t sum = lfn_checksum(sfn);
+    pos = run_start;
+    for (uint32_t ord = lfn_count; ord >= 1; ord--) {
+        uint8_t *raw = dir_entry_ptr(&pos, CACHE_WRITE);
+        if (raw == NULL) {
+            return VFS_EIO;
+        }
+        memset(raw, 0, DIR_ENTRY_SIZE);
+        raw[0] = (uint8_t)(ord | (ord == lfn_count ? 0x40 : 0));
+        raw[11] = ATTR_LFN;
+        raw[13] = sum;
+        size_t base = (size_t)(ord - 1) * LFN_CHARS;
+        for (int i = 0; i < LFN_CHARS; i++) {
+            uint16_t ch;
+            if (base + i < name_len) {
+                ch = (uint8_t)name[base + i];
+            } else if (base + i == name_len) {
+                ch = 0x0000;
+            } else {
+                ch = 0xFFFF;
+            }
+            wr16(raw + lfn_offsets[i], ch);
+        }
+        if (dir_advance(&pos, 0) != VFS_EOK) {
+            return VFS_EIO;
+        }
+    }
+
+    uint8_t *raw = dir_entry_ptr(&pos, CACHE_WRITE);
+    if (raw == NULL) {
+        return VFS_EIO;
+    }
+    memset(raw, 0, DIR_ENTRY_SIZE);
+    memcpy(raw, sfn, 11);
+    raw[11] = attr;
+    raw[12] = ntres;
+    entry_set_cluster(raw, first_cluster);
+    wr32(raw + 28, size);
+    if (out_pos != NULL) {
+        *out_pos = pos;
+    }
+    return VFS_EOK;
+}
+
+static int dir_delete_entry(const dir_entry_t *entry) {
+    dir_pos_t pos = entry->first_pos;
+    for (uint32_t i = 0; i < entry->slot_count; i++) {
+        uint8_t *raw = dir_entry_ptr(&pos, CACHE_WRITE);
+        if (raw == NULL) {
+            return VFS_EIO;
+        }
+        raw[0] = ENTRY_FREE;
+        if (i + 1 < entry->slot_count && dir_advance(&pos, 0) != VFS_EOK) {
+            return VFS_EIO;
+        }
+    }
+    return VFS_EOK;
+}
+
+static int dir_is_empty(uint32_t dir_cluster) {
+    dir_pos_t pos = {dir_cluster, 0, 0, 0};
+    dir_entry_t entry;
+    while (1) {
+        int res = dir_read_next(&pos, &entry);
+        if (res < 0) {
+            return res;
+        }
+        if (res == 0) {
+            return 1;
+        }
+        if (strcmp(entry.name, ".") != 0 && strcmp(entry.name, "..") != 0) {
+            return 0;
+        }
+    }
+}
+
+// image management
+
+int sdemu_format(const char *image_path, uint32_t sectors) {
+    if (image_path == NULL || sectors < 4096) {
+        return VFS_EINVAL;
+    }
+
+    int fat_type = sectors < 131072 ? 16 : 32;
+    uint32_t reserved = fat_type == 32 ? 32 : 1;
+    uint32_t root_entries = fat_type == 32 ? 0 : 512;
+    uint32_t root_dir_sectors = (root_entries * DIR_ENTRY_SIZE + SECTOR_SIZE - 1) / SECTOR_SIZE;
+    uint32_t num_fats = 2;
+    uint32_t spc = 1;
+    uint32_t fat_size = 0;
+    uint32_t clusters = 0;
+
+    if (fat_type == 32) {
+        spc = sectors < 532480 ? 1 : (sectors < 16777216 ? 8 : 32);
+    }
+    while (1) {
+        // fat size formula from the fat spec
+        uint32_t tmp1 = sectors - (reserved + root_dir_sectors);
+        uint32_t tmp2 = 256 * spc + num_fats;
+        if (fat_type == 32) {
+            tmp2 /= 2;
+        }
+        fat_size = (tmp1 + tmp2 - 1) / tmp2;
+        clusters = (sectors - reserved - num_fats * fat_size - root_dir_sectors) / spc;
+        if (fat_type == 16 && clusters >= 65525 && spc < 64) {
+            spc *= 2;
+            continue;
+        }
+        break;
+    }
+    if (fat_type == 16 && (clusters < 4085 || clusters >= 65525)) {
+        return VFS_EINVAL;
+    }
+    if (fat_type == 32 && clusters < 65525) {
+        return VFS_EINVAL;
+    }
+
+    FILE *img = fopen(image_path, "wb");
+    if (img == NULL) {
+        return VFS_EIO;
+    }
+
+    // size the image sparse, everything not written below reads as zero
+    uint8_t sector[SECTOR_SIZE];
+    memset(sector, 0, sizeof(sector));
+    if (fseek(img, (long)sectors * SECTOR_SIZE - 1, SEEK_SET) != 0 || fputc(0, img) == EOF) {
+        fclose(img);
+        return VFS_EIO;
+    }
+
+    // boot sector + bpb
+    sector[0] = 0xEB;
+    sector[1] = fat_type == 32 ? 0x58 : 0x3C;
+    sector[2] = 0x90;
+    memcpy(sector + 3, "TILIXI  ", 8);
+    wr16(sector + 11, SECTOR_SIZE);
+    sector[13] = (uint8_t)spc;
+    wr16(sector + 14, (uint16_t)reserved);
+    sector[16] = (uint8_t)num_fats;
+    wr16(sector + 17, (uint16_t)root_entries);
+    wr16(sector + 19, sectors < 65536 ? (uint16_t)sectors : 0);
+    sector[21] = 0xF8;
+    wr16(sector + 24, 63);
+    wr16(sector + 26, 255);
+    wr32(sector + 32, sectors < 65536 ? 0 : sectors);
+    if (fat_type == 32) {
+        wr32(sector + 36, fat_size);
+        wr32(sector + 44, 2);       // root cluster
+        wr16(sector + 48, 1);       // fsinfo sector
+        wr16(sector + 50, 6);       // backup boot sector
+        sector[64] = 0x80;
+        sector[66] = 0x29;
+        wr32(sector + 67, 0x7111C5A1);
+        memcpy(sector + 71, "TILIXI     ", 11);
+        memcpy(sector + 82, "FAT32   ", 8);
+    } else {
+        wr16(sector + 22, (uint16_t)fat_size);
+        sector[36] = 0x80;
+        sector[38] = 0x29;
+        wr32(sector + 39, 0x7111C5A1);
+        memcpy(sector + 43, "TILIXI     ", 11);
+        memcpy(sector + 54, "FAT16   ", 8);
+    }
+    sector[510] = 0x55;
+    sector[511] = 0xAA;
+
+    int ok = fseek(img, 0, SEEK_SET) == 0 && fwrite(sector, 1, SECTOR_SIZE, img) == SECTOR_SIZE;
+    if (ok && fat_type == 32) {
+        ok = fseek(img, 6L * SECTOR_SIZE, SEEK_SET) == 0 &&
+             fwrite(sector, 1, SECTOR_SIZE, img) == SECTOR_SIZE;
+
+        uint8_t info[SECTOR_SIZE];
+        memset(info, 0, sizeof(info));
+        wr32(info, 0x41615252);
+        wr32(info + 484, 0x61417272);
+        wr32(info + 488, 0xFFFFFFFF);
+        wr32(info + 492, 0xFFFFFFFF);
+        wr32(info + 508, 0xAA550000);
+        ok = ok && fseek(img, 1L * SECTOR_SIZE, SEEK_SET) == 0 &&
+             fwrite(info, 1, SECTOR_SIZE, img) == SECTOR_SIZE;
+    }
+
+    // reserved fat entries (+ the fat32 root cluster)
+    uint8_t fat[SECTOR_SIZE];
+    memset(fat, 0, sizeof(fat));
+    if (fat_type == 32) {
+        wr32(fat, 0x0FFFFFF8);
+        wr32(fat + 4, 0x0FFFFFFF);
+        wr32(fat + 8, 0x0FFFFFFF);
+    } else {
+        wr16(fat, 0xFFF8);
+        wr16(fat + 2, 0xFFFF);
+    }
+    for (uint32_t i = 0; ok && i < num_fats; i++) {
+        long offset = (long)(reserved + i * fat_size) * SECTOR_SIZE;
+        ok = fseek(img, offset, SEEK_SET) == 0 && fwrite(fat, 1, SECTOR_SIZE, img) == SECTOR_SIZE;
+    }
+
+    if (fclose(img) != 0) {
+        ok = 0;
+    }
+    return ok ? VFS_EOK : VFS_EIO;
+}
+
+int sdemu_attach(const char *image_path) {
+    if (image_path == NULL) {
+        return VFS_EINVAL;
+    }
+    sdemu_detach();
+
+    FILE *img = fopen(image_path, "r+b");
+    if (img == NULL) {
+        return VFS_ENOENT;
+    }
+
+    uint8_t boot[SECTOR_SIZE];
+    if (fread(boot, 1, SECTOR_SIZE, img) != SECTOR_SIZE ||
+        boot[510] != 0x55 || boot[511] != 0xAA || rd16(boot + 11) != SECTOR_SIZE) {
+        fclose(img);
+        return VFS_EIO;
+    }
+
+    uint32_t spc = boot[13];
+    uint32_t reserved = rd16(boot + 14);
+    uint32_t num_fats = boot[16];
+    uint32_t root_entries = rd16(boot + 17);
+    uint32_t total = rd16(boot + 19) ? rd16(boot + 19) : rd32(boot + 32);
+    uint32_t fat_size = rd16(boot + 22) ? rd16(boot + 22) : rd32(boot + 36);
+    if (spc == 0 || num_fats == 0 || fat_size == 0 || total == 0) {
+        fclose(img);
+        return VFS_EIO;
+    }
+
+    memset(&vol, 0, sizeof(vol));
+    vol.image = img;
+    vol.total_sectors = total;
+    vol.sectors_per_cluster = spc;
+    vol.num_fats = num_fats;
+    vol.fat_size = fat_size;
+    vol.fat_start = reserved;
+    vol.root_dir_sectors = (root_entries * DIR_ENTRY_SIZE + SECTOR_SIZE - 1) / SECTOR_SIZE;
+    vol.root_dir_start = reserved + num_fats * fat_size;
+    vol.data_start = vol.root_dir_start + vol.root_dir_sectors;
+    vol.cluster_count = (total - vol.data_start) / spc;
+    vol.alloc_hint = 2;
+
+    if (vol.cluster_count < 4085) {
+        DEBUG_PRINT("[SDEMU] FAT12 images are not supported");
+        sdemu_detach();
+        return VFS_EIO;
+    }
+    vol.fat_type = vol.cluster_count < 65525 ? 16 : 32;
+    vol.root_cluster = vol.fat_type == 32 ? rd32(boot + 44) : 0;
+
+    memset(&data_cache, 0, sizeof(data_cache));
+    memset(&fat_cache, 0, sizeof(fat_cache));
+
+    DEBUG_PRINT("[SDEMU] attached %s: FAT%d, %u clusters of %u sectors",
+                image_path, vol.fat_type, (unsigned)vol.cluster_count, (unsigned)spc);
+    return VFS_EOK;
+}
+
+void sdemu_detach(void) {
+    if (vol.image != NULL) {
+        cache_sync();
+        fclose(vol.image);
+    }
+    memset(&vol, 0, sizeof(vol));
+    memset(&data_cache, 0, sizeof(data_cache));
+    memset(&fat_cache, 0, sizeof(fat_cache));
+}
+
+int sdemu_is_attached(void) {
+    return vol.image != NULL;
+}
+
+void sdemu_set_latency(const sdemu_latency_t *model) {
+    latency = model != NULL ? *model : default_latency;
+}
+
+void sdemu_get_latency(sdemu_latency_t *out) {
+    if (out != NULL) {
+        *out = latency;
+    }
+}
+
+void sdemu_stats_reset(void) {
+    memset(&stats, 0, sizeof(stats));
+}
+
+void sdemu_stats_get(sdemu_stats_t *out) {
+    if (out != NULL) {
+        *out = stats;
+    }
+}
+
+uint32_t sdemu_stats_ms(const sdemu_stats_t *s) {
+    if (s == NULL) {
+        return 0;
+    }
+    return (uint32_t)((s->sim_us + 500) / 1000);
+}
+
+// SD.h style api
+
+int sdemu_exists(const char *path) {
+    return path_lookup(path, NULL, NULL, NULL) == VFS_EOK;
+}
+
+int sdemu_mkdir(const char *path) {
+    uint32_t parent = 0;
+    int missing_last = 0;
+    int res = path_lookup(path, NULL, &parent, &missing_last);
+    if (res == VFS_EOK) {
+        return VFS_EEXIST;
+    }
+    if (!missing_last) {
+        return res;
+    }
+    char name[NAME_MAX_LEN];
+    res = path_basename(path, name, sizeof(name));
+    if (res != VFS_EOK) {
+        return res;
+    }
+
+    uint32_t cluster = cluster_alloc(0);
+    if (cluster == 0) {
+        return VFS_ENOSPC;
+    }
+    if (cluster_zero(cluster) != VFS_EOK) {
+        return VFS_EIO;
+    }
+
+    // "." and ".." go into the first sector of the new cluster
+    uint8_t *sector = cache_get(&data_cache, cluster_lba(cluster), CACHE_WRITE);
+    if (sector == NULL) {
+        return VFS_EIO;
+    }
+    memset(sector, ' ', 11);
+    sector[0] = '.';
+    sector[11] = ATTR_DIRECTORY;
+    entry_set_cluster(sector, cluster);
+    memset(sector + DIR_ENTRY_SIZE, ' ', 11);
+    sector[DIR_ENTRY_SIZE] = '.';
+    sector[DIR_ENTRY_SIZE + 1] = '.';
+    sector[DIR_ENTRY_SIZE + 11] = ATTR_DIRECTORY;
+    entry_set_cluster(sector + DIR_ENTRY_SIZE, parent == root_dir_cluster() ? 0 : parent);
+
+    res = dir_add_entry(parent, name, ATTR_DIRECTORY, cluster, 0, NULL);
+    if (res != VFS_EOK) {
+        cluster_free_chain(cluster);
+        return res;
+    }
+    return cache_sync();
+}
+
+int sdemu_rmdir(const char *path) {
+    dir_entry_t entry;
+    int res = path_lookup(path, &entry, NULL, NULL);
+    if (res != VFS_EOK) {
+        return res;
+    }
+    if (entry.is_root) {
+        return VFS_EBUSY;
+    }
+    if (!entry_is_dir(&entry)) {
+        return VFS_ENOTDIR;
+    }
+    int empty = dir_is_empty(entry_dir_cluster(&entry));
+    if (empty < 0) {
+        return empty;
+    }
+    if (!empty) {
+        return VFS_EPERM;
+    }
+    res = dir_delete_entry(&entry);
+    if (res == VFS_EOK) {
+        res = cluster_free_chain(entry_cluster(entry.raw));
+    }
+    return res == VFS_EOK ? cache_sync() : res;
+}
+
+int sdemu_remove(const char *path) {
+    dir_entry_t entry;
+    int res = path_lookup(path, &entry, NULL, NULL);
+    if (res != VFS_EOK) {
+        return res;
+    }
+    if (entry.is_root || entry_is_dir(&entry)) {
+        return VFS_EISDIR;
+    }
+    res = dir_delete_entry(&entry);
+    if (res == VFS_EOK && entry_cluster(entry.raw) != 0) {
+        res = cluster_free_chain(entry_cluster(entry.raw));
+    }
+    return res == VFS_EOK ? cache_sync() : res;
+}
+
+int sdemu_rename(const char *from, const char *to) {
+    dir_entry_t entry;
+    int res = path_lookup(from, &entry, NULL, NULL);
+    if (res != VFS_EOK) {
+        return res;
+    }
+    if (entry.is_root) {
+        return VFS_EBUSY;
+    }
+    uint32_t new_parent = 0;
+    int missing_last = 0;
+    res = path_lookup(to, NULL, &new_parent, &missing_last);
+    if (res == VFS_EOK) {
+        return VFS_EEXIST;
+    }
+    if (!missing_last) {
+        return res;
+    }
+    char name[NAME_MAX_LEN];
+    res = path_basename(to, name, sizeof(name));
+    if (res != VFS_EOK) {
+        return res;
+    }
+
+    // a directory can not move below itself
+    uint32_t cluster = entry_cluster(entry.raw);
+    if (entry_is_dir(&entry)) {
+        size_t from_len = strlen(from);
+        if (strncmp(from, to, from_len) == 0 && to[from_len] == '/') {
+            return VFS_EINVAL;
+        }
+    }
+
+    // new entry first, then drop the old one so a failure never loses the file
+    dir_pos_t new_pos;
+    res = dir_add_entry(new_parent, name, entry.raw[11], cluster, rd32(entry.raw + 28), &new_pos);
+    if (res != VFS_EOK) {
+        return res;
+    }
+    res = dir_delete_entry(&entry);
+    if (res != VFS_EOK) {
+        return res;
+    }
+
+    // moved directories point ".." at their new parent
+    if (entry_is_dir(&entry) && cluster_valid(cluster)) {
+        dir_pos_t dotdot = {cluster, 0, 1, 0};
+        uint8_t *raw = dir_entry_ptr(&dotdot, CACHE_WRITE);
+        if (raw == NULL) {
+            return VFS_EIO;
+        }
+        entry_set_cluster(raw, new_parent == root_dir_cluster() ? 0 : new_parent);
+    }
+    return cache_sync();
+}
+
+sdemu_file_t* sdemu_open(const char *path, int write, int create) {
+    dir_entry_t entry;
+    uint32_t parent = 0;
+    int missing_last = 0;
+    int res = path_lookup(path, &entry, &parent, &missing_last);
+
+    sdemu_file_t *file = (sdemu_file_t*)calloc(1, sizeof(*file));
+    if (file == NULL) {
+        return NULL;
+    }
+
+    if (missing_last && write && create) {
+        char name[NAME_MAX_LEN];
+        dir_pos_t pos;
+        if (path_basename(path, name, sizeof(name)) != VFS_EOK ||
+            dir_add_entry(parent, name, ATTR_ARCHIVE, 0, 0, &pos) != VFS_EOK ||
+            cache_sync() != VFS_EOK) {
+            free(file);
+            return NULL;
+        }
+        file->has_entry = 1;
+        file->entry_pos = pos;
+    } else if (res == VFS_EOK) {
+        if (entry_is_dir(&entry)) {
+            file->is_dir = 1;
+            file->first_cluster = entry_dir_cluster(&entry);
+            file->iter.cluster = file->first_cluster;
+        } else {
+            file->first_cluster = entry_cluster(entry.raw);
+            file->size = rd32(entry.raw + 28);
+        }
+        file->has_entry = !entry.is_root;
+        file->entry_pos = entry.pos;
+    } else {
+        free(file);
+        return NULL;
+    }
+
+    if (write && file->is_dir) {
+        free(file);
+        return NULL;
+    }
+    file->writable = write;
+    return file;
+}
+
+void sdemu_close(sdemu_file_t *file) {
+    if (file == NULL) {
+        return;
+    }
+    if (file->writable) {
+        sdemu_flush(file);
+    }
+    free(file);
+}
+
+int sdemu_is_directory(sdemu_file_t *file) {
+    return file != NULL && file->is_dir;
+}
+
+// cluster number for a cluster index in the file chain, walking forward from
+// the last visited cluster when possible, extend allocates missing clusters
+static int file_cluster_at(sdemu_file_t *file, uint32_t index, int extend, uint32_t *out) {
+    if (file->first_cluster == 0) {
+        if (!extend) {
+            return VFS_EIO;
+        }
+        uint32_t cluster = cluster_alloc(0);
+        if (cluster == 0) {
+            return VFS_ENOSPC;
+        }
+        file->first_cluster = cluster;
+        file->dirty = 1;
+    }
+
+    uint32_t cluster = file->first_cluster;
+    uint32_t at = 0;
+    if (file->cur_cluster != 0 && file->cur_index <= index) {
+        cluster = file->cur_cluster;
+        at = file->cur_index;
+    }
+    while (at < index) {
+        uint32_t next = 0;
+        if (fat_get(cluster, &next) != VFS_EOK) {
+            return VFS_EIO;
+        }
+        if (fat_is_eoc(next) || !cluster_valid(next)) {
+            if (!extend) {
+                return VFS_EIO;
+            }
+            next = cluster_alloc(cluster);
+            if (next == 0) {
+                return VFS_ENOSPC;
+            }
+        }
+        cluster = next;
+        at++;
+    }
+    file->cur_cluster = cluster;
+    file->cur_index = index;
+    *out = cluster;
+    return VFS_EOK;
+}
+
+ssize_t sdemu_read(sdemu_file_t *file, void *buf, size_t size) {
+    if (file == NULL || buf == NULL || file->is_dir) {
+        return VFS_EINVAL;
+    }
+    uint32_t cluster_bytes = vol.sectors_per_cluster * SECTOR_SIZE;
+    uint8_t *out = (uint8_t*)buf;
+    size_t done = 0;
+
+    while (done < size && file->pos < file->size) {
+        uint32_t cluster = 0;
+        if (file_cluster_at(file, file->pos / cluster_bytes, 0, &cluster) != VFS_EOK) {
+            return done > 0 ? (ssize_t)done : VFS_EIO;
+        }
+        uint32_t in_cluster = file->pos % cluster_bytes;
+        uint32_t offset = in_cluster % SECTOR_SIZE;
+        size_t chunk = SECTOR_SIZE - offset;
+        if (chunk > size - done) {
+            chunk = size - done;
+        }
+        if (chunk > file->size - file->pos) {
+            chunk = file->size - file->pos;
+        }
+        uint8_t *sector = cache_get(&data_cache, cluster_lba(cluster) + in_cluster / SECTOR_SIZE, CACHE_READ);
+        if (sector == NULL) {
+            return done > 0 ? (ssize_t)done : VFS_EIO;
+        }
+        memcpy(out + done, sector + offset, chunk);
+        done += chunk;
+        file->pos += (uint32_t)chunk;
+    }
+    return (ssize_t)done;
+}
+
+ssize_t sdemu_write(sdemu_file_t *file, const void *buf, size_t size) {
+    if (file == NULL || buf == NULL || file->is_dir) {
+        return VFS_EINVAL;
+    }
+    if (!file->writable) {
+        return VFS_EBADF;
+    }
+    uint32_t cluster_bytes = vol.sectors_per_cluster * SECTOR_SIZE;
+    const uint8_t *in = (const uint8_t*)buf;
+    size_t done = 0;
+
+    while (done < size) {
+        uint32_t cluster = 0;
+        int res = file_cluster_at(file, file->pos / cluster_bytes, 1, &cluster);
+        if (res != VFS_EOK) {
+            return done > 0 ? (ssize_t)done : res;
+        }
+        uint32_t in_cluster = file->pos % cluster_bytes;
+        uint32_t offset = in_cluster % SECTOR_SIZE;
+        size_t chunk = SECTOR_SIZE - offset;
+        if (chunk > size - done) {
+            chunk = size - done;
+        }
+        // whole sectors or sectors past the old end never need a read
+        int mode = CACHE_WRITE;
+        uint32_t sector_start = file->pos - offset;
+        if (chunk == SECTOR_SIZE || sector_start >= file->size) {
+            mode = CACHE_OVERWRITE;
+        }
+        uint8_t *sector = cache_get(&data_cache, cluster_lba(cluster) + in_cluster / SECTOR_SIZE, mode);
+        if (sector == NULL) {
+            return done > 0 ? (ssize_t)done : VFS_EIO;
+        }
+        memcpy(sector + offset, in + done, chunk);
+        done += chunk;
+        file->pos += (uint32_t)chunk;
+        if (file->pos > file->size) {
+            file->size = file->pos;
+            file->dirty = 1;
+        }
+    }
+    return (ssize_t)done;
+}
+
+int sdemu_flush(sdemu_file_t *file) {
+    if (file == NULL) {
+        return VFS_EINVAL;
+    }
+    if (file->dirty && file->has_entry) {
+        uint8_t *raw = dir_entry_ptr(&file->entry_pos, CACHE_WRITE);
+        if (raw == NULL) {
+            return VFS_EIO;
+        }
+        entry_set_cluster(raw, file->first_cluster);
+        wr32(raw + 28, file->size);
+        file->dirty = 0;
+    }
+    return cache_sync();
+}
+
+int sdemu_seek(sdemu_file_t *file, size_t pos) {
+    if (file == NULL || file->is_dir || pos > file->size) {
+        return VFS_EINVAL;
+    }
+    file->pos = (uint32_t)pos;
+    return VFS_EOK;
+}
+
+size_t sdemu_position(sdemu_file_t *file) {
+    return file != NULL ? file->pos : 0;
+}
+
+size_t sdemu_size(sdemu_file_t *file) {
+    return (file != NULL && !file->is_dir) ? file->size : 0;
+}
+
+int sdemu_next_entry(sdemu_file_t *dir, char *name, size_t name_len, int *is_dir) {
+    if (dir == NULL || !dir->is_dir || name == NULL || name_len == 0) {
+        return VFS_EINVAL;
+    }
+    dir_entry_t entry;
+    int res = dir_read_next(&dir->iter, &entry);
+    if (res <= 0) {
+        return res;
+    }
+    strncpy(name, entry.name, name_len - 1);
+    name[name_len - 1] = '\0';
+    if (is_dir != NULL) {
+        *is_dir = entry_is_dir(&entry);
+    }
+    return 1;
+}
@@ -0,0 +1,742 @@
+// PC vfs backend on a real host directory
+// same node model as vfs_sd.cpp (backend_data is the vfs path string, so
+// shell_get_path works unchanged) but nodes live in a small hash table and
+// are malloc'd, so trees with thousands of files are fine
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "vfs.h"
+#include "vfs_posix.h"
+#include "debug_helper.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#define MAX_PATH_LEN 256
+#define MAX_ENTRY_NAME_LEN 64
+#define NODE_BUCKETS 64
+
+typedef struct posix_node {
+    vfs_node_t node;
+    struct posix_node *next;
+    char path[MAX_PATH_LEN];    // vfs path, backend_data points here
+} posix_node_t;
+
+typedef struct {
+    int fd;
+} posix_handle_t;
+
+typedef struct {
+    DIR *dir;
+    char current_name_buffer[MAX_ENTRY_NAME_LEN];
+} posix_iter_state_t;
+
+static char host_root[MAX_PATH_LEN] = ".";
+static posix_node_t *node_buckets[NODE_BUCKETS];
+
+static int map_errno(int err) {
+    switch (err) {
+        case ENOENT: return VFS_ENOENT;
+        case EEXIST: return VFS_EEXIST;
+        case ENOTDIR: return VFS_ENOTDIR;
+        case EISDIR: return VFS_EISDIR;
+        case EACCES: return VFS_EACCES;
+        case EPERM: return VFS_EPERM;
+        case ENOSPC: return VFS_ENOSPC;
+        case ENAMETOOLONG: return VFS_ENAMETOOLONG;
+        case ENOTEMPTY: return VFS_EPERM;
+        case EBUSY: return VFS_EBUSY;
+        case EROFS: return VFS_EROFS;
+        case EINVAL: return VFS_EINVAL;
+        default: return VFS_EIO;
+    }
+}
+
+static unsigned path_hash(const char *path) {
+    unsigned h = 5381;
+    while (*path != '\0') {
+        h = h * 33 + (unsigned char)*path++;
+    }
+    return h % NODE_BUCKETS;
+}
+
+// vfs path -> host path
+static int host_path(const char *path, char *out, size_t out_len) {
+    size_t root_len = strlen(host_root);
+    size_t path_len = strlen(path);
+    if (root_len + path_len + 1 > out_len) {
+        return 0;
+    }
+    memcpy(out, host_root, root_len);
+    memcpy(out + root_len, path, path_len + 1);
+    return 1;
+}
+
+static int join_path(const char *dir_path, const char *name, char *out) {
+    size_t dir_path_len = strlen(dir_path);
+    size_t name_len = strlen(name);
+    if (dir_path_len + name_len + 2 >= MAX_PATH_LEN) {
+        return 0;
+    }
+    memcpy(out, dir_path, dir_path_len);
+    if (dir_path_len > 0 && dir_path[dir_path_len - 1] != '/') {
+        out[dir_path_len++] = '/';
+    }
+    memcpy(out + dir_path_len, name, name_len);
+    out[dir_path_len + name_len] = '\0';
+    return 1;
+}
+
+static int valid_name(const char *name) {
+    return name != NULL && name[0] != '\0' && strchr(name, '/') == NULL &&
+           strcmp(name, ".") != 0 && strcmp(name, "..") != 0;
+}
+
+static vfs_node_t* create_posix_node(const char *path, vfs_node_type_t type);
+
+static vfs_dir_iter_t* posix_dir_iter_create(vfs_node_t *dir_node) {
+    if (dir_node == NULL || dir_node->type != VFS_NODE_DIR) {
+        return NULL;
+    }
+
+    char host[MAX_PATH_LEN * 2];
+    if (!host_path((const char*)dir_node->backend_data, host, sizeof(host))) {
+        return NULL;
+    }
+
+    posix_iter_state_t *state = (posix_iter_state_t*)malloc(sizeof(*state));
+    if (state == NULL) {
+        return NULL;
+    }
+    state->dir = opendir(host);
+    if (state->dir == NULL) {
+        free(state);
+        return NULL;
+    }
+
+    vfs_dir_iter_t *iter = (vfs_dir_iter_t*)malloc(sizeof(vfs_dir_iter_t));
+    if (iter == NULL) {
+        closedir(state->dir);
+        free(state);
+        return NULL;
+    }
+
+    iter->dir_node = dir_node;
+    iter->backend_iter = state;
+    iter->current_name = NULL;
+    iter->name_len = 0;
+    return iter;
+}
+
+static int posix_dir_iter_next(vfs_dir_iter_t *iter) {
+    if (iter == NULL || iter->backend_iter == NULL) {
+        return -1;
+    }
+    posix_iter_state_t *state = (posix_iter_state_t*)iter->backend_iter;
+
+    while (1) {
+        errno = 0;
+        struct dirent *entry = readdir(state->dir);
+        if (entry == NULL) {
+            return errno == 0 ? 0 : -1;
+        }
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+            continue;
+        }
+        size_t name_len = strlen(entry->d_name);
+        if (name_len >= MAX_ENTRY_NAME_LEN) {
+            name_len = MAX_ENTRY_NAME_LEN - 1;
+        }
+        memcpy(state->current_name_buffer, entry->d_name, name_len);
+        state->current_name_buffer[name_len] = '\0';
+        iter->current_name = state->current_name_buffer;
+        iter->name_len = name_len;
+        return 1;
+    }
+}
+
+static void posix_dir_iter_destroy(vfs_dir_iter_t *iter) {
+    if (iter == NULL || iter->backend_iter == NULL) {
+        return;
+    }
+    posix_iter_state_t *state = (posix_iter_state_t*)iter->backend_iter;
+    closedir(state->dir);
+    free(state);
+    iter->backend_iter = NULL;
+}
+
+static vfs_node_t* posix_dir_create(vfs_node_t *dir_node, const char *name, vfs_node_type_t type) {
+    if (dir_node == NULL || dir_node->type != VFS_NODE_DIR || !valid_name(name)) {
+        return NULL;
+    }
+
+    char full_path[MAX_PATH_LEN];
+    char host[MAX_PATH_LEN * 2];
+    if (!join_path((const char*)dir_node->backend_data, name, full_path) ||
+        !host_path(full_path, host, sizeof(host))) {
+        return NULL;
+    }
+
+    struct stat st;
+    if (stat(host, &st) == 0) {
+        // entry exists - resolve and return it
+        return vfs_resolve(full_path);
+    }
+
+    if (type == VFS_NODE_DIR) {
+        if (mkdir(host, 0755) != 0) {
+            return NULL;
+        }
+    } else if (type == VFS_NODE_FILE) {
+        int fd = open(host, O_WRONLY | O_CREAT | O_EXCL, 0644);
+        if (fd < 0) {
+            return NULL;
+        }
+        close(fd);
+    } else {
+        return NULL;
+    }
+
+    return create_posix_node(full_path, type);
+}
+
+static int posix_dir_remove(vfs_node_t *dir_node, const char *name) {
+    if (dir_node == NULL || dir_node->type != VFS_NODE_DIR || !valid_name(name)) {
+        return VFS_EINVAL;
+    }
+
+    char full_path[MAX_PATH_LEN];
+    char host[MAX_PATH_LEN * 2];
+    if (!join_path((const char*)dir_node->backend_data, name, full_path) ||
+        !host_path(full_path, host, sizeof(host))) {
+        return VFS_ENAMETOOLONG;
+    }
+
+    struct stat st;
+    if (stat(host, &st) != 0) {
+        return map_errno(errno);
+    }
+    int res = S_ISDIR(st.st_mode) ? rmdir(host) : unlink(host);
+    return res == 0 ? VFS_EOK : map_errno(errno);
+}
+
+static int posix_dir_rename(vfs_node_t *old_dir, const char *old_name,
+                            vfs_node_t *new_dir, const char *new_name) {
+    if (old_dir == NULL || new_dir == NULL || !valid_name(old_name) || !valid_name(new_name)) {
+        return VFS_EINVAL;
+    }
+
+    char old_full[MAX_PATH_LEN];
+    char new_full[MAX_PATH_LEN];
+    char old_host[MAX_PATH_LEN * 2];
+    char new_host[MAX_PATH_LEN * 2];
+    if (!join_path((const char*)old_dir->backend_data, old_name, old_full) ||
+        !join_path((const char*)new_dir->backend_data, new_name, new_full) ||
+        !host_path(old_full, old_host, sizeof(old_host)) ||
+        !host_path(new_full, new_host, sizeof(new_host))) {
+        return VFS_ENAMETOOLONG;
+    }
+
+    // same no-clobber rule as SD.rename
+    struct stat st;
+    if (stat(new_host, &st) == 0) {
+        return VFS_EEXIST;
+    }
+    return rename(old_host, new_host) == 0 ? VFS_EOK : map_errno(errno);
+}
+
+static void* posix_open(vfs_node_t *node, int flags) {
+    if (node == NULL || node->type != VFS_NODE_FILE || node->backend_data == NULL) {
+        return NULL;
+    }
+
+    char host[MAX_PATH_LEN * 2];
+    if (!host_path((const char*)node->backend_data, host, sizeof(host))) {
+        return NULL;
+    }
+
+    int oflags = 0;
+    int want_write = (flags & (VFS_O_WRITE | VFS_O_CREATE | VFS_O_APPEND)) != 0;
+    if (want_write && (flags & VFS_O_READ)) {
+        oflags = O_RDWR;
+    } else if (want_write) {
+        oflags = O_WRONLY;
+    } else {
+        oflags = O_RDONLY;
+    }
+    if (flags & VFS_O_CREATE) {
+        oflags |= O_CREAT;
+    }
+    if ((flags & VFS_O_TRUNC) && want_write) {
+        oflags |= O_TRUNC;
+    }
+    if (flags & VFS_O_APPEND) {
+        oflags |= O_APPEND;
+    }
+
+    posix_handle_t *handle = (posix_handle_t*)malloc(sizeof(*handle));
+    if (handle == NULL) {
+        return NULL;
+    }
+    handle->fd = open(host, oflags, 0644);
+    if (handle->fd < 0) {
+        free(handle);
+        return NULL;
+    }
+    return handle;
+}
+
+static int posix_close(void *handle) {
+    if (handle == NULL) {
+        return VFS_EINVAL;
+    }
+    posix_handle_t *h = (posix_handle_t*)handle;
+    int res = close(h->fd);
+    free(h);
+    return res == 0 ? VFS_EOK : VFS_EIO;
+}
+
+static ssize_t posix_read(void *handle, void *buf, size_t size) {
+    if (handle == NULL || buf == NULL) {
+        return VFS_EINVAL;
+    }
+    ssize_t n;
+    do {
+        n = read(((posix_handle_t*)handle)->fd, buf, size);
+    } while (n < 0 && errno == EINTR);
+    return n < 0 ? map_errno(errno) : n;
+}
+
+static ssize_t posix_write(void *handle, const void *buf, size_t size) {
+    if (handle == NULL || buf == NULL) {
+        return VFS_EINVAL;
+    }
+    int fd = ((posix_handle_t*)handle)->fd;
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = write(fd, (const char*)buf + done, size - done);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return done > 0 ? (ssize_t)done : map_errno(errno);
+        }
+        done += (size_t)n;
+    }
+    return (ssize_t)done;
+}
+
+static ssize_t posix_size(vfs_node_t *node) {
+    if (node == NULL || node->backend_data == NULL) {
+        return VFS_EINVAL;
+    }
+    char host[MAX_PATH_LEN * 2];
+    if (!host_path((const char*)node->backend_data, host, sizeof(host))) {
+        return VFS_ENAMETOOLONG;
+    }
+    struct stat st;
+    if (stat(host, &st) != 0) {
+        return map_errno(errno);
+    }
+    return S_ISDIR(st.st_mode) ? 0 : (ssize_t)st.st_size;
+}
+
+static int posix_seek(void *handle, size_t offset) {
+    if (handle == NULL) {
+        return VFS_EINVAL;
+    }
+    off_t res = lseek(((posix_handle_t*)handle)->fd, (off_t)offset, SEEK_SET);
+    return res < 0 ? VFS_EIO : VFS_EOK;
+}
+
+static ssize_t posix_tell(void *handle) {
+    if (handle == NULL) {
+        return VFS_EINVAL;
+    }
+    off_t res = lseek(((posix_handle_t*)handle)->fd, 0, SEEK_CUR);
+    return res < 0 ? VFS_EIO : (ssize_t)res;
+}
+
+static const vfs_ops_t posix_ops = {
+    .open = posix_open,
+    .close = posix_close,
+    .read = posix_read,
+    .write = posix_write,
+    .size = posix_size,
+    .seek = posix_seek,
+    .tell = posix_tell,
+    .dir_iter_create = posix_dir_iter_create,
+    .dir_iter_next = posix_dir_iter_next,
+    .dir_iter_destroy = posix_dir_iter_destroy,
+    .dir_create = posix_dir_create,
+    .dir_remove = posix_dir_remove
+};
+
+// same normalisation as the other backends, ".." never climbs above "/"
+// so nothing outside the mounted host directory is reachable
+static int normalize_absolute_path(const char *in_path, char *out_path) {
+    if (in_path == NULL || out_path == NULL || in_path[0] != '/') {
+        return 0;
+    }
+    size_t out_len = 0;
+    out_path[out_len++] = '/';
+    out_path[out_len] = '\0';
+
+    const char *p = in_path;
+    while (*p == '/') {
+        p++;
+    }
+
+    while (*p != '\0') {
+        char segment[MAX_PATH_LEN];
+        size_t seg_len = 0;
+        while (*p != '\0' && *p != '/') {
+            if (seg_len + 1 >= sizeof(segment)) {
+                return 0;
+            }
+            segment[seg_len++] = *p++;
+        }
+        segment[seg_len] = '\0';
+        while (*p == '/') {
+            p++;
+        }
+
+        if (seg_len == 0 || strcmp(segment, ".") == 0) {
+            continue;
+        }
+        if (strcmp(segment, "..") == 0) {
+            if (out_len > 1) {
+                size_t i = out_len - 1;
+                if (out_path[i] == '/' && i > 0) {
+                    i--;
+                }
+                while (i > 0 && out_path[i] != '/') {
+                    i--;
+                }
+                out_len = i + 1;
+                out_path[out_len] = '\0';
+            }
+            continue;
+        }
+
+        if (out_len + seg_len + 1 >= MAX_PATH_LEN) {
+            return 0;
+        }
+        if (out_len > 1 && out_path[out_len - 1] != '/') {
+            out_path[out_len++] = '/';
+        }
+        memcpy(out_path + out_len, segment, seg_len);
+        out_len += seg_len;
+        out_path[out_len] = '\0';
+    }
+
+    if (out_len > 1 && out_path[out_len - 1] == '/') {
+        out_path[out_len - 1] = '\0';
+    }
+    return 1;
+}
+
+static posix_node_t* find_node(const char *path) {
+    for (posix_node_t *n = node_buckets[path_hash(path)]; n != NULL; n = n->next) {
+        if (strcmp(n->path, path) == 0) {
+            return n;
+        }
+    }
+    return NULL;
+}
+
+static vfs_node_t* create_posix_node(const char *path, vfs_node_type_t type) {
+    posix_node_t *n = find_node(path);
+    if (n != NULL) {
+        n->node.type = type;
+        n->node.refcount++;
+        return &n->node;
+    }
+
+    n = (posix_node_t*)calloc(1, sizeof(*n));
+    if (n == NULL) {
+        return NULL;
+    }
+    strncpy(n->path, path, MAX_PATH_LEN - 1);
+    n->node.type = type;
+    n->node.ops = &posix_ops;
+    n->node.backend_data = (void*)n->path;
+    n->node.refcount = 1;
+
+    unsigned bucket = path_hash(path);
+    n->next = node_buckets[bucket];
+    node_buckets[bucket] = n;
+    return &n->node;
+}
+
+int vfs_posix_mount(const char *root) {
+    if (root == NULL || root[0] == '\0' || strlen(root) >= sizeof(host_root)) {
+        return VFS_EINVAL;
+    }
+    struct stat st;
+    if (stat(root, &st) != 0 || !S_ISDIR(st.st_mode)) {
+        return VFS_ENOTDIR;
+    }
+
+    for (int i = 0; i < NODE_BUCKETS; i++) {
+        posix_node_t *n = node_buckets[i];
+        while (n != NULL) {
+            posix_node_t *next = n->next;
+            free(n);
+            n = next;
+        }
+        node_buckets[i] = NULL;
+    }
+
+    strncpy(host_root, root, sizeof(host_root) - 1);
+    host_root[sizeof(host_root) - 1] = '\0';
+    // "/" is appended by every vfs path, keep the root without a trailing one
+    size_t len = strlen(host_root);
+    while (len > 1 && host_root[len - 1] == '/') {
+        host_root[--len] = '\0';
+    }
+    if (strcmp(host_root, "/") == 0) {
+        host_root[0] = '\0';
+    }
+    DEBUG_PRINT("[VFS] posix root: %s", root);
+    return VFS_EOK;
+}
+
+const char* vfs_posix_root(void) {
+    return host_root[0] != '\0' ? host_root : "/";
+}
+
+int vfs_init(void) {
+    const char *root = getenv("TILIXI_ROOT");
+    return vfs_posix_mount(root != NULL ? root : ".");
+}
+
+vfs_node_t* vfs_resolve(const char *path) {
+    if (path == NULL) {
+        return NULL;
+    }
+
+    char normalized[MAX_PATH_LEN];
+    if (!normalize_absolute_path(path, normalized)) {
+        return NULL;
+    }
+
+    // always stat, the host tree can change under a cached node
+    char host[MAX_PATH_LEN * 2];
+    if (!host_path(normalized, host, sizeof(host))) {
+        return NULL;
+    }
+    struct stat st;
+    if (stat(host, &st) != 0) {
+        return NULL;
+    }
+    if (!S_ISDIR(st.st_mode) && !S_ISREG(st.st_mode)) {
+        return NULL;    // sockets, fifos etc are not exposed
+    }
+
+    return create_posix_node(normalized, S_ISDIR(st.st_mode) ? VFS_NODE_DIR : VFS_NODE_FILE);
+}
+
+vfs_node_t* vfs_resolve_at(vfs_node_t *base, const char *path) {
+    if (path == NULL) {
+        return NULL;
+    }
+    if (path[0] == '/') {
+        return vfs_resolve(path);
+    }
+
+    const char *base_path = "/";
+    if (base != NULL && base->backend_data != NULL) {
+        base_path = (const char*)base->backend_data;
+    }
+    char raw_path[MAX_PATH_LEN];
+    if (!join_path(base_path, path, raw_path)) {
+        return NULL;
+    }
+    return vfs_resolve(raw_path);
+}
+
+void vfs_node_release(vfs_node_t *node) {
+    if (node == NULL || node->refcount == 0) {
+        return;
+    }
+    node->refcount--;
+    if (node->refcount > 0) {
+        return;
+    }
+
+    posix_node_t **link = &node_buckets[path_hash((const char*)node->backend_data)];
+    while (*link != NULL) {
+        if (&(*link)->node == node) {
+            posix_node_t *dead = *link;
+            *link = dead->next;
+            free(dead);
+            return;
+        }
+        link = &(*link)->next;
+    }
+}
+
+vfs_dir_iter_t* vfs_dir_iter_create_node(vfs_node_t *dir_node) {
+    if (dir_node == NULL || dir_node->ops == NULL || dir_node->ops->dir_iter_create == NULL) {
+        return NULL;
+    }
+    return dir_node->ops->dir_iter_create(dir_node);
+}
+
+int vfs_dir_iter_next(vfs_dir_iter_t *iter) {
+    if (iter == NULL || iter->dir_node == NULL || iter->dir_node->ops == NULL ||
+        iter->dir_node->ops->dir_iter_next == NULL) {
+        return -1;
+    }
+    return iter->dir_node->ops->dir_iter_next(iter);
+}
+
+void vfs_dir_iter_destroy(vfs_dir_iter_t *iter) {
+    if (iter == NULL || iter->dir_node == NULL || iter->dir_node->ops == NULL) {
+        return;
+    }
+    if (iter->dir_node->ops->dir_iter_destroy != NULL) {
+        iter->dir_node->ops->dir_iter_destroy(iter);
+    }
+    free(iter);
+}
+
+vfs_node_t* vfs_dir_create_node(vfs_node_t *dir_node, const char *name, vfs_node_type_t type) {
+    if (dir_node == NULL || dir_node->ops == NULL || dir_node->ops->dir_create == NULL) {
+        return NULL;
+    }
+    return dir_node->ops->dir_create(dir_node, name, type);
+}
+
+int vfs_dir_remove_node(vfs_node_t *dir_node, const char *name) {
+    if (dir_node == NULL || dir_node->ops == NULL || name == NULL) {
+        return VFS_EINVAL;
+    }
+    if (dir_node->ops->dir_remove == NULL) {
+        return VFS_EPERM;
+    }
+    return dir_node->ops->dir_remove(dir_node, name);
+}
+
+int vfs_dir_rename_node(vfs_node_t *old_dir, const char *old_name,
+                        vfs_node_t *new_dir, const char *new_name) {
+    if (old_dir == NULL || new_dir == NULL || old_name == NULL || new_name == NULL) {
+        return VFS_EINVAL;
+    }
+    if (old_dir->ops == NULL || old_dir->ops != new_dir->ops) {
+        return VFS_EPERM;
+    }
+    return posix_dir_rename(old_dir, old_name, new_dir, new_name);
+}
+
+vfs_file_t* vfs_open(const char *path, int flags) {
+    vfs_node_t *node = vfs_resolve(path);
+    if (node == NULL) {
+        return NULL;
+    }
+    vfs_file_t *file = vfs_open_node(node, flags);
+    vfs_node_release(node);
+    return file;
+}
+
+vfs_file_t* vfs_open_node(vfs_node_t *node, int flags) {
+    if (node == NULL || node->ops == NULL || node->ops->open == NULL) {
+        return NULL;
+    }
+
+    void *handle = node->ops->open(node, flags);
+    if (handle == NULL) {
+        return NULL;
+    }
+
+    vfs_file_t *file = (vfs_file_t*)malloc(sizeof(vfs_file_t));
+    if (file == NULL) {
+        node->ops->close(handle);
+        return NULL;
+    }
+
+    node->refcount++;
+    file->node = node;
+    file->handle = handle;
+    file->position = 0;
+    return file;
+}
+
+int vfs_close(vfs_file_t *file) {
+    if (file == NULL || file->node == NULL || file->node->ops == NULL) {
+        return VFS_EINVAL;
+    }
+    int result = VFS_EOK;
+    if (file->node->ops->close != NULL) {
+        result = file->node->ops->close(file->handle);
+    }
+    vfs_node_release(file->node);
+    free(file);
+    return result;
+}
+
+ssize_t vfs_read(vfs_file_t *file, void *buf, size_t size) {
+    if (file == NULL || file->node == NULL || file->node->ops == NULL ||
+        file->node->ops->read == NULL) {
+        return VFS_EINVAL;
+    }
+    ssize_t result = file->node->ops->read(file->handle, buf, size);
+    if (result > 0) {
+        file->position += (size_t)result;
+    }
+    return result;
+}
+
+ssize_t vfs_write(vfs_file_t *file, const void *buf, size_t size) {
+    if (file == NULL || file->node == NULL || file->node->ops == NULL ||
+        file->node->ops->write == NULL) {
+        return VFS_EINVAL;
+    }
+    ssize_t result = file->node->ops->write(file->handle, buf, size);
+    if (result > 0) {
+        file->position += (size_t)result;
+    }
+    return result;
+}
+
+ssize_t vfs_size(const char *path) {
+    vfs_node_t *node = vfs_resolve(path);
+    if (node == NULL) {
+        return VFS_ENOENT;
+    }
+    ssize_t size = vfs_size_node(node);
+    vfs_node_release(node);
+    return size;
+}
+
+ssize_t vfs_size_node(vfs_node_t *node) {
+    if (node == NULL || node->ops == NULL || node->ops->size == NULL) {
+        return VFS_EINVAL;
+    }
+    return node->ops->size(node);
+}
+
+int vfs_seek(vfs_file_t *file, size_t offset) {
+    if (file == NULL || file->node == NULL || file->node->ops == NULL ||
+        file->node->ops->seek == NULL) {
+        return VFS_EINVAL;
+    }
+    int result = file->node->ops->seek(file->handle, offset);
+    if (result == VFS_EOK) {
+        file->position = offset;
+    }
+    return result;
+}
+
+ssize_t vfs_tell(vfs_file_t *file) {
+    if (file == NULL || file->node == NULL || file->node->ops == NULL ||
+        file->node->ops->tell == NULL) {
+        return VFS_EINVAL;
+    }
+    return file->node->ops->tell(file->handle);
+}
@@ -0,0 +1,752 @@
+// host build of the SD vfs backend
+// straight C port of vfs_sd.cpp with SD.* swapped for the sdemu.h image api,
+// the boot_sd_* bus switches sit at the same spots so the emulator charges
+// the same SPI/command/sector pattern the device would see
+// keep the two files in step when changing either
+
+#include "vfs.h"
+#include "sdemu.h"
+#include "boot_sequence.h"
+#include "debug_helper.h"
+#include <stdlib.h>
+#include <string.h>
+
+// maximum path length
+#define MAX_PATH_LEN 256
+#define MAX_ENTRY_NAME_LEN 64
+
+// directory iterator state
+typedef struct {
+    sdemu_file_t *dir_file;  // directory handle (kept open for iteration)
+    char current_name_buffer[MAX_ENTRY_NAME_LEN];
+    int initialized;
+} sd_dir_iter_state_t;
+
+static sd_dir_iter_state_t iter_states[4];  // support up to 4 concurrent iterators
+
+static sd_dir_iter_state_t* alloc_iter_state(void) {
+    for (int i = 0; i < 4; i++) {
+        if (!iter_states[i].initialized) {
+            iter_states[i].initialized = 1;
+            memset(iter_states[i].current_name_buffer, 0, MAX_ENTRY_NAME_LEN);
+            return &iter_states[i];
+        }
+    }
+    return NULL;  // no free iterator states
+}
+
+static void free_iter_state(sd_dir_iter_state_t *state) {
+    if (state) {
+        if (state->dir_file) {
+            boot_sd_switch_to_sd_spi();
+            sdemu_close(state->dir_file);
+            boot_sd_restore_tft_spi();
+        }
+        memset(state, 0, sizeof(sd_dir_iter_state_t));
+    }
+}
+
+static int join_path(const char *dir_path, const char *name, char *out) {
+    size_t dir_path_len = strlen(dir_path);
+    size_t name_len = strlen(name);
+    if (dir_path_len + name_len + 2 >= MAX_PATH_LEN) {
+        return 0;
+    }
+    memcpy(out, dir_path, dir_path_len);
+    if (dir_path_len > 0 && dir_path[dir_path_len - 1] != '/') {
+        out[dir_path_len++] = '/';
+    }
+    memcpy(out + dir_path_len, name, name_len);
+    out[dir_path_len + name_len] = '\0';
+    return 1;
+}
+
+static vfs_dir_iter_t* sd_dir_iter_create(vfs_node_t *dir_node) {
+    if (dir_node == NULL || dir_node->type != VFS_NODE_DIR) {
+        return NULL;
+    }
+
+    boot_sd_switch_to_sd_spi();
+
+    const char *path = (const char*)dir_node->backend_data;
+    if (path == NULL) {
+        path = "/";
+    }
+
+    sdemu_file_t *dir = sdemu_open(path, 0, 0);
+    if (dir == NULL || !sdemu_is_directory(dir)) {
+        sdemu_close(dir);
+        boot_sd_restore_tft_spi();
+        return NULL;
+    }
+
+    sd_dir_iter_state_t *state = alloc_iter_state();
+    if (state == NULL) {
+        sdemu_close(dir);
+        boot_sd_restore_tft_spi();
+        return NULL;
+    }
+
+    state->dir_file = dir;
+
+    vfs_dir_iter_t *iter = (vfs_dir_iter_t*)malloc(sizeof(vfs_dir_iter_t));
+    if (iter == NULL) {
+        free_iter_state(state);
+        boot_sd_restore_tft_spi();
+        return NULL;
+    }
+
+    iter->dir_node = dir_node;
+    iter->backend_iter = state;
+    iter->current_name = NULL;
+    iter->name_len = 0;
+
+    return iter;
+}
+
+static int sd_dir_iter_next(vfs_dir_iter_t *iter) {
+    if (iter == NULL || iter->backend_iter == NULL) {
+        return -1;
+    }
+
+    sd_dir_iter_state_t *state = (sd_dir_iter_state_t*)iter->backend_iter;
+
+    boot_sd_switch_to_sd_spi();
+
+    while (1) {
+        char name_buf[MAX_ENTRY_NAME_LEN];
+        int res = sdemu_next_entry(state->dir_file, name_buf, sizeof(name_buf), NULL);
+        if (res < 0) {
+            return -1;
+        }
+        if (res == 0) {
+            return 0;  // end of directory
+        }
+
+        // skip "." and ".." entries
+        if (name_buf[0] == '\0' || strcmp(name_buf, ".") == 0 || strcmp(name_buf, "..") == 0) {
+            continue;
+        }
+
+        size_t name_len = strlen(name_buf);
+        memcpy(state->current_name_buffer, name_buf, name_len + 1);
+        iter->current_name = state->current_name_buffer;
+        iter->name_len = name_len;
+        return 1;
+    }
+}
+
+static void sd_dir_iter_destroy(vfs_dir_iter_t *iter) {
+    if (iter == NULL || iter->backend_iter == NULL) {
+        return;
+    }
+    free_iter_state((sd_dir_iter_state_t*)iter->backend_iter);
+}
+
+static vfs_node_t* create_sd_node(const char *path, vfs_node_type_t type);
+
+static vfs_node_t* sd_dir_create(vfs_node_t *dir_node, const char *name, vfs_node_type_t type) {
+    if (dir_node == NULL || dir_node->type != VFS_NODE_DIR || name == NULL) {
+        return NULL;
+    }
+
+    boot_sd_switch_to_sd_spi();
+
+    const char *dir_path = (const char*)dir_node->backend_data;
+    if (dir_path == NULL) {
+        dir_path = "/";
+    }
+
+    char full_path[MAX_PATH_LEN];
+    if (!join_path(dir_path, name, full_path)) {
+        boot_sd_restore_tft_spi();
+        return NULL;  // path too long
+    }
+
+    if (sdemu_exists(full_path)) {
+        boot_sd_restore_tft_spi();
+        return vfs_resolve(full_path);
+    }
+
+    int success = 0;
+    if (type == VFS_NODE_DIR) {
+        success = sdemu_mkdir(full_path) == VFS_EOK;
+    } else if (type == VFS_NODE_FILE) {
+        sdemu_file_t *f = sdemu_open(full_path, 1, 1);
+        if (f) {
+            sdemu_close(f);
+            success = 1;
+        }
+    }
+
+    boot_sd_restore_tft_spi();
+
+    if (!success) {
+        return NULL;
+    }
+
+    return create_sd_node(full_path, type);
+}
+
+static int sd_dir_remove(vfs_node_t *dir_node, const char *name) {
+    if (dir_node == NULL || dir_node->type != VFS_NODE_DIR || name == NULL || name[0] == '\0') {
+        return VFS_EINVAL;
+    }
+
+    boot_sd_switch_to_sd_spi();
+
+    const char *dir_path = (const char*)dir_node->backend_data;
+    if (dir_path == NULL) {
+        dir_path = "/";
+    }
+
+    char full_path[MAX_PATH_LEN];
+    if (!join_path(dir_path, name, full_path)) {
+        boot_sd_restore_tft_spi();
+        return VFS_ENAMETOOLONG;
+    }
+
+    if (!sdemu_exists(full_path)) {
+        boot_sd_restore_tft_spi();
+        return VFS_ENOENT;
+    }
+
+    sdemu_file_t *f = sdemu_open(full_path, 0, 0);
+    if (!f) {
+        boot_sd_restore_tft_spi();
+        return VFS_EIO;
+    }
+
+    int is_dir = sdemu_is_directory(f);
+    sdemu_close(f);
+
+    int res = is_dir ? sdemu_rmdir(full_path) : sdemu_remove(full_path);
+
+    boot_sd_restore_tft_spi();
+
+    return res == VFS_EOK ? VFS_EOK : VFS_EPERM;
+}
+
+static int sd_dir_rename(vfs_node_t *old_dir, const char *old_name,
+                         vfs_node_t *new_dir, const char *new_name) {
+    if (old_dir == NULL || new_dir == NULL || old_name == NULL || new_name == NULL) {
+        return VFS_EINVAL;
+    }
+
+    const char *old_dir_path = (const char*)old_dir->backend_data;
+    if (old_dir_path == NULL) {
+        old_dir_path = "/";
+    }
+    const char *new_dir_path = (const char*)new_dir->backend_data;
+    if (new_dir_path == NULL) {
+        new_dir_path = "/";
+    }
+
+    char old_full[MAX_PATH_LEN];
+    char new_full[MAX_PATH_LEN];
+    if (!join_path(old_dir_path, old_name, old_full) ||
+        !join_path(new_dir_path, new_name, new_full)) {
+        return VFS_ENAMETOOLONG;
+    }
+
+    boot_sd_switch_to_sd_spi();
+    int res = sdemu_rename(old_full, new_full);
+    boot_sd_restore_tft_spi();
+
+    return res == VFS_EOK ? VFS_EOK : VFS_EPERM;
+}
+
+static void* sd_open(vfs_node_t *node, int flags) {
+    if (node == NULL || node->type != VFS_NODE_FILE || node->backend_data == NULL) {
+        return NULL;
+    }
+
+    const char *path = (const char*)node->backend_data;
+    if (path[0] == '\0') {
+        return NULL;
+    }
+
+    boot_sd_switch_to_sd_spi();
+
+    int write = (flags & (VFS_O_WRITE | VFS_O_CREATE)) != 0;
+    int create = (flags & VFS_O_CREATE) != 0;
+
+    if ((flags & VFS_O_TRUNC) && write) {
+        if (sdemu_exists(path)) {
+            sdemu_remove(path);
+        }
+        create = 1;
+    }
+
+    sdemu_file_t *handle = sdemu_open(path, write, create);
+    if (handle == NULL) {
+        boot_sd_restore_tft_spi();
+        return NULL;
+    }
+
+    if (flags & VFS_O_APPEND) {
+        sdemu_seek(handle, sdemu_size(handle));
+    } else if (flags & VFS_O_WRITE) {
+        sdemu_seek(handle, 0);
+    }
+
+    boot_sd_restore_tft_spi();
+    return handle;
+}
+
+static int sd_close(void *handle) {
+    if (handle == NULL) {
+        return VFS_EINVAL;
+    }
+    boot_sd_switch_to_sd_spi();
+    sdemu_close((sdemu_file_t*)handle);
+    boot_sd_restore_tft_spi();
+    return VFS_EOK;
+}
+
+static ssize_t sd_read(void *handle, void *buf, size_t size) {
+    if (handle == NULL || buf == NULL) {
+        return VFS_EINVAL;
+    }
+    boot_sd_switch_to_sd_spi();
+    ssize_t read_bytes = sdemu_read((sdemu_file_t*)handle, buf, size);
+    boot_sd_restore_tft_spi();
+    return read_bytes < 0 ? VFS_EIO : read_bytes;
+}
+
+static ssize_t sd_write(void *handle, const void *buf, size_t size) {
+    if (handle == NULL || buf == NULL) {
+        return VFS_EINVAL;
+    }
+    sdemu_file_t *file = (sdemu_file_t*)handle;
+    boot_sd_switch_to_sd_spi();
+    ssize_t written = sdemu_write(file, buf, size);
+    sdemu_flush(file);
+    boot_sd_restore_tft_spi();
+    return (written >= 0 && (size_t)written == size) ? written : VFS_EIO;
+}
+
+static ssize_t sd_size(vfs_node_t *node) {
+    if (node == NULL || node->backend_data == NULL) {
+        return VFS_EINVAL;
+    }
+    const char *path = (const char*)node->backend_data;
+    boot_sd_switch_to_sd_spi();
+    sdemu_file_t *f = sdemu_open(path, 0, 0);
+    if (!f) {
+        boot_sd_restore_tft_spi();
+        return VFS_EIO;
+    }
+    size_t size = sdemu_size(f);
+    sdemu_close(f);
+    boot_sd_restore_tft_spi();
+    return (ssize_t)size;
+}
+
+static int sd_seek(void *handle, size_t offset) {
+    if (handle == NULL) {
+        return VFS_EINVAL;
+    }
+    boot_sd_switch_to_sd_spi();
+    int res = sdemu_seek((sdemu_file_t*)handle, offset);
+    boot_sd_restore_tft_spi();
+    return res == VFS_EOK ? VFS_EOK : VFS_EIO;
+}
+
+static ssize_t sd_tell(void *handle) {
+    if (handle == NULL) {
+        return VFS_EINVAL;
+    }
+    boot_sd_switch_to_sd_spi();
+    size_t pos = sdemu_position((sdemu_file_t*)handle);
+    boot_sd_restore_tft_spi();
+    return (ssize_t)pos;
+}
+
+static const vfs_ops_t sd_ops = {
+    .open = sd_open,
+    .close = sd_close,
+    .read = sd_read,
+    .write = sd_write,
+    .size = sd_size,
+    .seek = sd_seek,
+    .tell = sd_tell,
+    .dir_iter_create = sd_dir_iter_create,
+    .dir_iter_next = sd_dir_iter_next,
+    .dir_iter_destroy = sd_dir_iter_destroy,
+    .dir_create = sd_dir_create,
+    .dir_remove = sd_dir_remove
+};
+
+static int normalize_absolute_path(const char *in_path, char *out_path) {
+    if (in_path == NULL || out_path == NULL || in_path[0] != '/') {
+        return 0;
+    }
+    size_t out_len = 0;
+    out_path[out_len++] = '/';
+    out_path[out_len] = '\0';
+
+    const char *p = in_path;
+    while (*p == '/') {
+        p++;
+    }
+
+    while (*p != '\0') {
+        char segment[MAX_PATH_LEN];
+        size_t seg_len = 0;
+        while (*p != '\0' && *p != '/') {
+            if (seg_len + 1 >= sizeof(segment)) {
+                return 0;
+            }
+            segment[seg_len++] = *p++;
+        }
+        segment[seg_len] = '\0';
+        while (*p == '/') {
+            p++;
+        }
+
+        if (seg_len == 0 || strcmp(segment, ".") == 0) {
+            continue;
+        }
+        if (strcmp(segment, "..") == 0) {
+            if (out_len > 1) {
+                size_t i = out_len - 1;
+                if (out_path[i] == '/' && i > 0) {
+                    i--;
+                }
+                while (i > 0 && out_path[i] != '/') {
+                    i--;
+                }
+                out_len = i + 1;
+                out_path[out_len] = '\0';
+            }
+            continue;
+        }
+
+        if (out_len + seg_len + 1 >= MAX_PATH_LEN) {
+            return 0;
+        }
+        if (out_len > 1 && out_path[out_len - 1] != '/') {
+            out_path[out_len++] = '/';
+        }
+        memcpy(out_path + out_len, segment, seg_len);
+        out_len += seg_len;
+        out_path[out_len] = '\0';
+    }
+
+    if (out_len > 1 && out_path[out_len - 1] == '/') {
+        out_path[out_len - 1] = '\0';
+    }
+    return 1;
+}
+
+static const char* resolve_path_to_node_cache(vfs_node_t *base, const char *path, char *out_path) {
+    if (path == NULL || out_path == NULL) {
+        return NULL;
+    }
+
+    char raw_path[MAX_PATH_LEN];
+    if (path[0] == '/') {
+        if (strlen(path) >= sizeof(raw_path)) {
+            return NULL;
+        }
+        strncpy(raw_path, path, sizeof(raw_path) - 1);
+        raw_path[sizeof(raw_path) - 1] = '\0';
+    } else {
+        const char *base_path = "/";
+        if (base != NULL && base->backend_data != NULL) {
+            base_path = (const char*)base->backend_data;
+        }
+        if (!join_path(base_path, path, raw_path)) {
+            return NULL;
+        }
+    }
+
+    if (!normalize_absolute_path(raw_path, out_path)) {
+        return NULL;
+    }
+    return out_path;
+}
+
+// node storage (we need to track nodes with their paths)
+#define MAX_NODES 32
+static struct {
+    vfs_node_t node;
+    char path[MAX_PATH_LEN];
+    int in_use;
+} node_cache[MAX_NODES];
+
+static vfs_node_t* create_sd_node(const char *path, vfs_node_type_t type) {
+    int slot = -1;
+    for (int i = 0; i < MAX_NODES; i++) {
+        if (!node_cache[i].in_use) {
+            slot = i;
+            break;
+        }
+    }
+
+    if (slot == -1) {
+        return NULL;  // no free slots
+    }
+
+    strncpy(node_cache[slot].path, path, MAX_PATH_LEN - 1);
+    node_cache[slot].path[MAX_PATH_LEN - 1] = '\0';
+
+    node_cache[slot].node.type = type;
+    node_cache[slot].node.ops = &sd_ops;
+    node_cache[slot].node.backend_data = (void*)node_cache[slot].path;
+    node_cache[slot].node.is_readonly = 0;
+    node_cache[slot].node.is_hidden = 0;
+    node_cache[slot].node.reserved = 0;
+    node_cache[slot].node.refcount = 1;
+    node_cache[slot].in_use = 1;
+
+    return &node_cache[slot].node;
+}
+
+int vfs_init(void) {
+    memset(node_cache, 0, sizeof(node_cache));
+    memset(iter_states, 0, sizeof(iter_states));
+
+    // on the device boot_sd_mount() has mounted the card by now, here the
+    // image comes from the environment unless a test attached one already
+    if (!sdemu_is_attached()) {
+        const char *image = getenv("TILIXI_SD_IMAGE");
+        if (image != NULL && sdemu_attach(image) != VFS_EOK) {
+            DEBUG_PRINT("[VFS] failed to attach SD image %s", image);
+            return VFS_ENODEV;
+        }
+    }
+
+    return VFS_EOK;
+}
+
+vfs_node_t* vfs_resolve(const char *path) {
+    if (path == NULL) {
+        return NULL;
+    }
+
+    for (int i = 0; i < MAX_NODES; i++) {
+        if (node_cache[i].in_use && strcmp(node_cache[i].path, path) == 0) {
+            node_cache[i].node.refcount++;
+            return &node_cache[i].node;
+        }
+    }
+
+    boot_sd_switch_to_sd_spi();
+
+    if (!sdemu_exists(path)) {
+        boot_sd_restore_tft_spi();
+        return NULL;
+    }
+
+    sdemu_file_t *f = sdemu_open(path, 0, 0);
+    if (!f) {
+        boot_sd_restore_tft_spi();
+        return NULL;
+    }
+
+    vfs_node_type_t type = sdemu_is_directory(f) ? VFS_NODE_DIR : VFS_NODE_FILE;
+    sdemu_close(f);
+
+    vfs_node_t *node = create_sd_node(path, type);
+
+    boot_sd_restore_tft_spi();
+
+    return node;
+}
+
+vfs_node_t* vfs_resolve_at(vfs_node_t *base, const char *path) {
+    if (path == NULL) {
+        return NULL;
+    }
+
+    char temp_path[MAX_PATH_LEN];
+    const char *full_path = resolve_path_to_node_cache(base, path, temp_path);
+    if (full_path == NULL) {
+        return NULL;
+    }
+
+    return vfs_resolve(full_path);
+}
+
+void vfs_node_release(vfs_node_t *node) {
+    if (node == NULL) {
+        return;
+    }
+
+    if (node->refcount > 0) {
+        node->refcount--;
+
+        if (node->refcount == 0) {
+            for (int i = 0; i < MAX_NODES; i++) {
+                if (&node_cache[i].node == node) {
+                    node_cache[i].in_use = 0;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+vfs_dir_iter_t* vfs_dir_iter_create_node(vfs_node_t *dir_node) {
+    if (dir_node == NULL || dir_node->ops == NULL || dir_node->ops->dir_iter_create == NULL) {
+        return NULL;
+    }
+    return dir_node->ops->dir_iter_create(dir_node);
+}
+
+int vfs_dir_iter_next(vfs_dir_iter_t *iter) {
+    if (iter == NULL || iter->dir_node == NULL || iter->dir_node->ops == NULL ||
+        iter->dir_node->ops->dir_iter_next == NULL) {
+        return -1;
+    }
+    return iter->dir_node->ops->dir_iter_next(iter);
+}
+
+void vfs_dir_iter_destroy(vfs_dir_iter_t *iter) {
+    if (iter == NULL || iter->dir_node == NULL || iter->dir_node->ops == NULL) {
+        return;
+    }
+    if (iter->dir_node->ops->dir_iter_destroy != NULL) {
+        iter->dir_node->ops->dir_iter_destroy(iter);
+    }
+    free(iter);
+}
+
+vfs_node_t* vfs_dir_create_node(vfs_node_t *dir_node, const char *name, vfs_node_type_t type) {
+    if (dir_node == NULL || dir_node->ops == NULL || dir_node->ops->dir_create == NULL) {
+        return NULL;
+    }
+    return dir_node->ops->dir_create(dir_node, name, type);
+}
+
+int vfs_dir_remove_node(vfs_node_t *dir_node, const char *name) {
+    if (dir_node == NULL || dir_node->ops == NULL || name == NULL) {
+        return VFS_EINVAL;
+    }
+    if (dir_node->ops->dir_remove == NULL) {
+        return VFS_EPERM;
+    }
+    return dir_node->ops->dir_remove(dir_node, name);
+}
+
+int vfs_dir_rename_node(vfs_node_t *old_dir, const char *old_name,
+                        vfs_node_t *new_dir, const char *new_name) {
+    if (old_dir == NULL || new_dir == NULL || old_name == NULL || new_name == NULL) {
+        return VFS_EINVAL;
+    }
+    if (old_dir->ops == NULL || old_dir->ops != new_dir->ops) {
+        return VFS_EPERM;
+    }
+    return sd_dir_rename(old_dir, old_name, new_dir, new_name);
+}
+
+vfs_file_t* vfs_open(const char *path, int flags) {
+    vfs_node_t *node = vfs_resolve(path);
+    if (node == NULL) {
+        return NULL;
+    }
+    vfs_file_t *file = vfs_open_node(node, flags);
+    vfs_node_release(node);
+    return file;
+}
+
+vfs_file_t* vfs_open_node(vfs_node_t *node, int flags) {
+    if (node == NULL || node->ops == NULL || node->ops->open == NULL) {
+        return NULL;
+    }
+
+    void *handle = node->ops->open(node, flags);
+    if (handle == NULL) {
+        return NULL;
+    }
+
+    vfs_file_t *file = (vfs_file_t*)malloc(sizeof(vfs_file_t));
+    if (file == NULL) {
+        if (node->ops->close != NULL) {
+            node->ops->close(handle);
+        }
+        return NULL;
+    }
+
+    node->refcount++;
+    file->node = node;
+    file->handle = handle;
+    file->position = 0;
+    return file;
+}
+
+int vfs_close(vfs_file_t *file) {
+    if (file == NULL || file->node == NULL || file->node->ops == NULL) {
+        return VFS_EINVAL;
+    }
+    int result = VFS_EOK;
+    if (file->node->ops->close != NULL) {
+        result = file->node->ops->close(file->handle);
+    }
+    vfs_node_release(file->node);
+    free(file);
+    return result;
+}
+
+ssize_t vfs_read(vfs_file_t *file, void *buf, size_t size) {
+    if (file == NULL || file->node == NULL || file->node->ops == NULL ||
+        file->node->ops->read == NULL) {
+        return VFS_EINVAL;
+    }
+    ssize_t result = file->node->ops->read(file->handle, buf, size);
+    if (result > 0) {
+        file->position += (size_t)result;
+    }
+    return result;
+}
+
+ssize_t vfs_write(vfs_file_t *file, const void *buf, size_t size) {
+    if (file == NULL || file->node == NULL || file->node->ops == NULL ||
+        file->node->ops->write == NULL) {
+        return VFS_EINVAL;
+    }
+    ssize_t result = file->node->ops->write(file->handle, buf, size);
+    if (result > 0) {
+        file->position += (size_t)result;
+    }
+    return result;
+}
+
+ssize_t vfs_size(const char *path) {
+    vfs_node_t *node = vfs_resolve(path);
+    if (node == NULL) {
+        return VFS_ENOENT;
+    }
+    ssize_t size = vfs_size_node(node);
+    vfs_node_release(node);
+    return size;
+}
+
+ssize_t vfs_size_node(vfs_node_t *node) {
+    if (node == NULL || node->ops == NULL || node->ops->size == NULL) {
+        return VFS_EINVAL;
+    }
+    return node->ops->size(node);
+}
+
+int vfs_seek(vfs_file_t *file, size_t offset) {
+    if (file == NULL || file->node == NULL || file->node->ops == NULL ||
+        file->node->ops->seek == NULL) {
+        return VFS_EINVAL;
+    }
+    int result = file->node->ops->seek(file->handle, offset);
+    if (result == VFS_EOK) {
+        file->position = offset;
+    }
+    return result;
+}
+
+ssize_t vfs_tell(vfs_file_t *file) {
+    if (file == NULL || file->node == NULL || file->node->ops == NULL ||
+        file->node->ops->tell == NULL) {
+        return VFS_EINVAL;
+    }
+    return file->node->ops->tell(file->handle);
+}
@@ -330,8 +330,10 @@ void keyboard_esp_scan(void) {
     if (needs_render) {
         terminal_state *term = get_active_terminal();
         if (term != NULL && term->active) {
+            // echo shouldn't wait for the next frame, this draws whatever the keys damaged
             KEYBOARD_DBG("[KEYBOARD] rendering terminal window...\n");
-            terminal_render_window(term);
+            terminal_render_request(term);
+            terminal_render_flush();
         } else {
             KEYBOARD_DBG("[KEYBOARD] terminal not active, skipping render (term=%p, active=%d)\n",
                          term, term ? term->active : 0);
@@ -2,6 +2,7 @@
 #include "ino_helper.h"
 #include "boot_splash.h"
 #include "boot_sequence.h"
+#include "boot_trace.h"
 #include "action_manager.h"
 #include "event_processor.h"
 #include "hotkey.h"
@@ -13,17 +14,28 @@
 #include "terminal_cmd.h"
 
 #ifdef PLATFORM_ESP32
+    // USB CDC serial reports false until the host side opens it, UART is ready right away
+    static int serial_ready(void *ctx) {
+        (void)ctx;
+        return Serial ? 1 : 0;
+    }
+    
     void setup(void) {
         // initialize serial for debug output
         Serial.begin(115200);
-        delay_ms(1000);
+        boot_wait_until("serial", serial_ready, NULL, 1000, 10);
         
         // initialize boot display (TFT) - show TILIXI text
+        int slot = boot_trace_begin("TFT init");
         boot_init();
+        boot_trace_end(slot);
         
         // run boot sequence (handles all initialization)
         boot_sequence_run();
         
+        // from here on terminal frames are composed on core 0, inline if the task can't start
+        terminal_render_start_task();
+        
         // initialize keyboard (for serial input)
         keyboard_esp_init();
         
@@ -41,6 +53,8 @@
         register_key(mod_ctrl, key_dash, "close_terminal");
         register_key(mod_ctrl, key_a, "zoom_out");
         register_key(mod_ctrl, key_s, "zoom_in");
+        register_key(mod_shift, key_up, "scroll_back");
+        register_key(mod_shift, key_down, "scroll_forward");
         // add more hotkeys as needed
     }
     
@@ -55,6 +69,8 @@
         // this ensures keys are only processed when terminal is ready
         if (boot_is_complete()) {
             keyboard_esp_scan();
+            // output from scripts and background processes, drawn at most once per frame
+            terminal_render_tick(get_time_ms());
         }
         
         // small delay to prevent CPU spinning in the main loop
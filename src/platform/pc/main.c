@@ -7,6 +7,7 @@
 #include "process_scheduler.h"
 #include "process_script.h"
 #include "builtins.h"
+#include "vfs.h"
 
 int main(void) {
     // initialize process system
@@ -14,9 +15,14 @@ int main(void) {
     init_scheduler();
     init_script_system();
     
+    // mount whatever vfs backend this build links (see VFS_BACKEND in the makefile)
+    if (vfs_init() != VFS_EOK) {
+        printf("vfs init failed\n");
+        return 1;
+    }
+    
     // initialize terminal system
     init_terminal_system();
-    init_terminal_commands();
     builtins_init();
     
     init_actions();
@@ -30,6 +36,8 @@ int main(void) {
     register_key(mod_ctrl, key_down, "select_down");
     register_key(mod_ctrl, key_nine, "zoom_out");
     register_key(mod_ctrl, key_zero, "zoom_in");
+    register_key(mod_shift, key_up, "scroll_back");
+    register_key(mod_shift, key_down, "scroll_forward");
     sdlread();
     return 0;
 }
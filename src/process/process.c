@@ -1,6 +1,7 @@
 #include "process.h"
 #include "process_script.h"
 #include "debug_helper.h"
+#include "ino_helper.h"
 #include <string.h>
 
 // process registry - following the same pattern as actions/commands
@@ -95,8 +96,10 @@ void init_process_system(void) {
         process_table[i].runtime        = 0;
         process_table[i].active         = 0;
         process_table[i].cwd            = NULL;
+        process_table[i].initialized    = 0;
 #ifdef PLATFORM_ESP32
         process_table[i].task_handle    = NULL;
+        process_table[i].ready_waiter   = NULL;
 #endif
     }
     process_count = 0;
@@ -140,9 +143,11 @@ process_id_t process_create(const char *name, void (*entry_point)(void *args),
     process_table[slot_idx].runtime        = 0;
     process_table[slot_idx].active         = 1;
     process_table[slot_idx].cwd            = NULL;
+    process_table[slot_idx].initialized    = 0;
     
 #ifdef PLATFORM_ESP32
     process_table[slot_idx].task_handle    = NULL;
+    process_table[slot_idx].ready_waiter   = NULL;
     
     // determine stack size (use default if invalid)
     uint16_t stack_size = stack_size_words;
@@ -290,6 +295,79 @@ process_control_block_t *process_get_pcb(process_id_t pid) {
     return NULL;
 }
 
+void process_signal_ready(process_id_t pid) {
+#ifdef PLATFORM_ESP32
+    TaskHandle_t waiter = NULL;
+#endif
+    ENTER_CRITICAL();
+    for (uint8_t i = 0; i < max_processes; i++) {
+        if (process_table[i].active && process_table[i].pid == pid) {
+            process_table[i].initialized = 1;
+#ifdef PLATFORM_ESP32
+            waiter = process_table[i].ready_waiter;
+            process_table[i].ready_waiter = NULL;
+#endif
+            break;
+        }
+    }
+    EXIT_CRITICAL();
+    
+#ifdef PLATFORM_ESP32
+    if (waiter != NULL) {
+        xTaskNotifyGive(waiter);
+    }
+#endif
+}
+
+// 1 = signalled, 0 = not yet, -1 = process is gone
+static int process_ready_state(process_id_t pid) {
+    int ready = -1;
+    ENTER_CRITICAL();
+    for (uint8_t i = 0; i < max_processes; i++) {
+        if (process_table[i].active && process_table[i].pid == pid) {
+            ready = process_table[i].initialized ? 1 : 0;
+#ifdef PLATFORM_ESP32
+            // register before sleeping so a signal in between isn't lost
+            if (!ready) {
+                process_table[i].ready_waiter = xTaskGetCurrentTaskHandle();
+            }
+#endif
+            break;
+        }
+    }
+    EXIT_CRITICAL();
+    return ready;
+}
+
+int process_wait_ready(process_id_t pid, uint32_t timeout_ms) {
+    uint32_t start = get_time_ms();
+    while (1) {
+        int ready = process_ready_state(pid);
+        if (ready != 0) {
+            return ready == 1 ? 0 : -1;
+        }
+        uint32_t elapsed = get_time_ms() - start;
+        if (elapsed >= timeout_ms) {
+#ifdef PLATFORM_ESP32
+            process_control_block_t *pcb = process_get_pcb(pid);
+            ENTER_CRITICAL();
+            if (pcb != NULL) {
+                pcb->ready_waiter = NULL;
+            }
+            EXIT_CRITICAL();
+#endif
+            return -1;
+        }
+#ifdef PLATFORM_ESP32
+        // woken by process_signal_ready(), a stale notification just loops once more
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeout_ms - elapsed));
+#else
+        // PC processes only run inside scheduler_run(), nothing can signal while we wait
+        return -1;
+#endif
+    }
+}
+
 uint8_t get_process_count(void) {
     ENTER_CRITICAL();
     uint8_t count = process_count;
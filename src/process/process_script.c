@@ -2,48 +2,27 @@
 #include "process.h"
 #include "process_scheduler.h"
 #include "debug_helper.h"
-#include <string.h>
+#include "registry.h"
 #include <stdlib.h>
 
-// script handler registry (following the same pattern as actions/commands)
-#define max_script_handlers 16
-typedef struct {
-    const char *name;
-    script_handler_t handler;
-} script_handler_entry_t;
-
-static script_handler_entry_t script_handlers[max_script_handlers];
-static uint8_t script_handler_count = 0;
-
+// script handlers share the registry with actions and commands (registry.c)
 void init_script_system(void) {
-    script_handler_count = 0;
-    for (uint8_t i = 0; i < max_script_handlers; i++) {
-        script_handlers[i].name = NULL;
-        script_handlers[i].handler = NULL;
-    }
+    registry_reset(registry_script);
     DEBUG_PRINT("[SCRIPT] Script system initialized\n");
 }
 
 void register_script_handler(const char *name, script_handler_t handler) {
-    if (script_handler_count >= max_script_handlers) {
-        DEBUG_PRINT("[SCRIPT] Max script handler count reached\n");
+    if (name == NULL || handler == NULL) {
         return;
     }
-    
-    script_handlers[script_handler_count].name = name;
-    script_handlers[script_handler_count].handler = handler;
-    script_handler_count++;
-    DEBUG_PRINT("[SCRIPT] Registered handler: %s\n", name);
+    if (registry_add(registry_script, name, &handler, sizeof(handler)) != NULL) {
+        DEBUG_PRINT("[SCRIPT] Registered handler: %s\n", name);
+    }
 }
 
 script_handler_t find_script_handler(const char *name) {
-    for (uint8_t i = 0; i < script_handler_count; i++) {
-        if (script_handlers[i].name != NULL && 
-            strcmp(script_handlers[i].name, name) == 0) {
-            return script_handlers[i].handler;
-        }
-    }
-    return NULL;
+    registry_entry *entry = registry_find(registry_script, name);
+    return entry != NULL ? *(script_handler_t*)entry->item : NULL;
 }
 
 // simple script entry point wrapper
@@ -1,51 +1,52 @@
 #include "builtins.h"
 #include "shell.h"
-#include <string.h>
+#include "registry.h"
 
 extern void builtins_register_all(void);
 
-#define max_builtins 32
+// builtins live in the shared registry (registry.c), found by hash instead of a strcmp per entry
 
-static builtin_cmd builtins[max_builtins];
-static int builtin_count = 0;
+static void register_builtin(const builtin_cmd *cmd) {
+    registry_entry *entry = registry_add(registry_builtin, cmd->name, cmd, sizeof(*cmd));
+    if (entry != NULL) {
+        entry->help = cmd->help;
+        entry->flags = cmd->filter != NULL ? registry_flag_streams : 0;
+    }
+}
 
 void builtins_register(const char *name, builtin_handler handler, const char *help) {
-    if (builtin_count >= max_builtins || name == NULL || handler == NULL) {
+    if (name == NULL || handler == NULL) {
         return;
     }
-    
-    builtins[builtin_count].name = name;
-    builtins[builtin_count].handler = handler;
-    builtins[builtin_count].help = help;
-    builtin_count++;
+    builtin_cmd cmd = { name, handler, help, NULL, 0 };
+    register_builtin(&cmd);
 }
 
 void builtins_register_descriptor(const builtin_cmd *cmd) {
-    if (builtin_count >= max_builtins || cmd == NULL || cmd->name == NULL || cmd->handler == NULL) {
+    if (cmd == NULL || cmd->name == NULL || cmd->handler == NULL) {
         return;
     }
-    
-    builtins[builtin_count] = *cmd;
-    builtin_count++;
+    register_builtin(cmd);
 }
 
 builtin_cmd *builtins_find(const char *name) {
-    if (name == NULL) {
+    registry_entry *entry = registry_find(registry_builtin, name);
+    return entry != NULL ? (builtin_cmd*)entry->item : NULL;
+}
+
+int builtins_count(void) {
+    return (int)registry_count(registry_builtin);
+}
+
+const builtin_cmd *builtins_at(int index) {
+    if (index < 0) {
         return NULL;
     }
-    
-    for (int i = 0; i < builtin_count; i++) {
-        if (strcmp(builtins[i].name, name) == 0) {
-            return &builtins[i];
-        }
-    }
-    
-    return NULL;
+    registry_entry *entry = registry_at(registry_builtin, (uint32_t)index);
+    return entry != NULL ? (const builtin_cmd*)entry->item : NULL;
 }
 
 void builtins_init(void) {
-    builtin_count = 0;
-    memset(builtins, 0, sizeof(builtins));
+    registry_reset(registry_builtin);
     builtins_register_all();
 }
-
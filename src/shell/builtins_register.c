@@ -22,6 +22,7 @@ extern const builtin_cmd cmd_wc_def;
 extern const builtin_cmd cmd_passwd_def;
 extern const builtin_cmd cmd_qimgv_def;
 extern const builtin_cmd cmd_reload_def;
+extern const builtin_cmd cmd_bootchart_def;
 #ifdef ARDUINO
 extern const builtin_cmd cmd_fastfetch_def;
 #endif
@@ -49,6 +50,7 @@ void builtins_register_all(void) {
     builtins_register_descriptor(&cmd_passwd_def);
     builtins_register_descriptor(&cmd_qimgv_def);
     builtins_register_descriptor(&cmd_reload_def);
+    builtins_register_descriptor(&cmd_bootchart_def);
 #ifdef ARDUINO
     builtins_register_descriptor(&cmd_fastfetch_def);
 #endif
@@ -0,0 +1,117 @@
+#include "builtins.h"
+#include "terminal.h"
+#include "boot_trace.h"
+#include "shell_codes.h"
+#include "shell_error.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int cmd_bootchart(terminal_state *term, int argc, char **argv);
+
+const builtin_cmd cmd_bootchart_def = {
+    .name = "bootchart",
+    .handler = cmd_bootchart,
+    .help = "Show boot timeline (bootchart [trace file])"
+};
+
+#define chart_width 24
+#define chart_name_width 22
+
+static void draw_entry(terminal_state *term, const boot_trace_entry_t *e,
+                       uint32_t origin, uint32_t span) {
+    char name[chart_name_width + 1];
+    int indent = e->depth * 2;
+    if (indent > chart_name_width - 4) {
+        indent = chart_name_width - 4;
+    }
+    if (e->count > 1) {
+        snprintf(name, sizeof(name), "%*s%s x%u", indent, "", e->name, (unsigned)e->count);
+    } else {
+        snprintf(name, sizeof(name), "%*s%s", indent, "", e->name);
+    }
+
+    // bar starts where the entry starts, at least one cell wide
+    char bar[chart_width + 1];
+    uint32_t rel = e->start_ms >= origin ? e->start_ms - origin : 0;
+    int from = (int)((uint64_t)rel * chart_width / span);
+    int len = (int)(((uint64_t)e->duration_ms * chart_width + span - 1) / span);
+    if (from >= chart_width) {
+        from = chart_width - 1;
+    }
+    if (len < 1) {
+        len = 1;
+    }
+    for (int i = 0; i < chart_width; i++) {
+        bar[i] = (i >= from && i < from + len) ? '#' : '.';
+    }
+    bar[chart_width] = '\0';
+
+    char line[terminal_cols];
+    snprintf(line, sizeof(line), "%6lu %6lu  %-*s |%s|",
+             (unsigned long)rel, (unsigned long)e->duration_ms,
+             chart_name_width, name, bar);
+    terminal_write_line(term, line);
+}
+
+int cmd_bootchart(terminal_state *term, int argc, char **argv) {
+    if (term == NULL) {
+        return SHELL_ERR;
+    }
+    if (argc > 2) {
+        shell_error(term, "bootchart: too many arguments");
+        return SHELL_EINVAL;
+    }
+    const char *path = argc == 2 ? argv[1] : BOOT_TRACE_PATH;
+
+    boot_trace_entry_t *entries = (boot_trace_entry_t*)malloc(sizeof(boot_trace_entry_t) * BOOT_TRACE_MAX);
+    if (entries == NULL) {
+        shell_error(term, "bootchart: out of memory");
+        return SHELL_ERR;
+    }
+
+    // last saved boot, or this boot's trace if nothing was saved yet
+    int count = boot_trace_load(path, entries, BOOT_TRACE_MAX);
+    const char *source = path;
+    if (count < 0 && argc == 2) {
+        free(entries);
+        shell_error(term, "bootchart: %s: unable to read", path);
+        return SHELL_ENOENT;
+    }
+    if (count < 0) {
+        count = 0;
+        for (size_t i = 0; i < boot_trace_count() && i < BOOT_TRACE_MAX; i++) {
+            entries[count++] = *boot_trace_get(i);
+        }
+        source = "(live)";
+    }
+    if (count == 0) {
+        free(entries);
+        shell_error(term, "bootchart: no boot trace recorded");
+        return SHELL_ENOENT;
+    }
+
+    uint32_t origin = entries[0].start_ms;
+    uint32_t end = 0;
+    for (int i = 0; i < count; i++) {
+        if (entries[i].start_ms < origin) {
+            origin = entries[i].start_ms;
+        }
+        if (entries[i].start_ms + entries[i].duration_ms > end) {
+            end = entries[i].start_ms + entries[i].duration_ms;
+        }
+    }
+    uint32_t span = end > origin ? end - origin : 1;
+
+    char header[terminal_cols];
+    snprintf(header, sizeof(header), "boot trace %s, %lu ms", source, (unsigned long)span);
+    terminal_write_line(term, header);
+    snprintf(header, sizeof(header), "%6s %6s  %-*s", "start", "ms", chart_name_width, "step");
+    terminal_write_line(term, header);
+    for (int i = 0; i < count; i++) {
+        draw_entry(term, &entries[i], origin, span);
+    }
+
+    free(entries);
+    return SHELL_OK;
+}
@@ -33,24 +33,21 @@ int cmd_clear(terminal_state *term, int argc, char **argv) {
     term->fastfetch_line_count = 0;
 #ifdef ARDUINO
     if (term->fastfetch_image_pixels != NULL) {
+        terminal_render_lock();  // the render task may be drawing it
         free(term->fastfetch_image_pixels);
         term->fastfetch_image_pixels = NULL;
+        terminal_render_unlock();
     }
     term->fastfetch_image_w = 0;
     term->fastfetch_image_h = 0;
 #endif
     
-    // clear terminal history
-    term->history_count = 0;
-    term->history_pos = 0;
-    for (uint8_t i = 0; i < max_input_history; i++) {
-        memset(term->history[i], 0, terminal_cols);
-    }
+    // clear the command history, it's shared by every window
+    terminal_history_clear();
+    term->history_pos = terminal_history_live;
     
-    #ifdef ARDUINO
-    extern void terminal_render_all(void);
-    terminal_render_all();
-    #endif
+    // only this window repaints (terminal_clear marked it), the rest of the panel stays
+    terminal_render_request(term);
     return SHELL_OK;
 }
 
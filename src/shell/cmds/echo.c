@@ -2,6 +2,7 @@
 #include "terminal.h"
 #include "shell_codes.h"
 #include <ctype.h>
+#include <string.h>
 
 int cmd_echo(terminal_state *term, int argc, char **argv);
 
@@ -41,7 +42,10 @@ static void terminal_write_escaped(terminal_state *term, const char *text,
     const char *p = text;
     while (*p != '\0') {
         if (*p != '\\') {
-            terminal_write_char(term, *p++);
+            // plain text up to the next escape in one go
+            size_t run = strcspn(p, "\\");
+            terminal_write_n(term, p, run);
+            p += run;
             continue;
         }
         p++;
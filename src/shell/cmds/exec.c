@@ -435,7 +435,7 @@ static void execute_command_string(terminal_state *term, char *cmd) {
         return;
     }
     terminal_parse_command(cmd, tokens);
-    if (tokens->token_count == 0) {
+    if (tokens->token_count == 0 && !terminal_redirect_has(tokens)) {
         free(tokens);
         return;
     }
@@ -460,11 +460,12 @@ static int execute_condition(terminal_state *term, script_ctx_t *ctx,
     }
     terminal_parse_command(expanded, tokens);
     if (tokens->token_count == 0) {
+        int result = terminal_redirect_has(tokens) ? terminal_redirect_only(term, tokens) : SHELL_ERR;
         free(tokens);
         free(expanded);
-        return SHELL_ERR;
+        return result;
     }
-    if (tokens->has_pipe) {
+    if (tokens->has_pipe || tokens->redirect_in[0] != '\0') {
         terminal_execute_pipeline(term, tokens);
         free(tokens);
         free(expanded);
@@ -480,7 +481,12 @@ static int execute_condition(terminal_state *term, script_ctx_t *ctx,
         free(expanded);
         return SHELL_ERR;
     }
-    int result = builtin->handler(term, tokens->token_count, (char**)tokens->tokens);
+    terminal_redirect_t redirect;
+    int result = terminal_redirect_begin(term, tokens, &redirect);
+    if (result == SHELL_OK) {
+        result = builtin->handler(term, tokens->token_count, (char**)tokens->tokens);
+        terminal_redirect_end(term, &redirect);
+    }
     free(tokens);
     free(expanded);
     return result;
@@ -226,8 +226,10 @@ extern "C" void fastfetch_rescale_image(terminal_state *term) {
         return;
     }
     if (term->fastfetch_image_pixels != NULL) {
+        terminal_render_lock();
         free(term->fastfetch_image_pixels);
         term->fastfetch_image_pixels = NULL;
+        terminal_render_unlock();
     }
     term->fastfetch_image_w = 0;
     term->fastfetch_image_h = 0;
@@ -348,8 +350,10 @@ int cmd_fastfetch(terminal_state *term, int argc, char **argv) {
     term->fastfetch_text_lines = 0;
 #ifdef ARDUINO
     if (term->fastfetch_image_pixels != NULL) {
+        terminal_render_lock();
         free(term->fastfetch_image_pixels);
         term->fastfetch_image_pixels = NULL;
+        terminal_render_unlock();
     }
     term->fastfetch_image_w = 0;
     term->fastfetch_image_h = 0;
@@ -8,11 +8,14 @@
 #include <string.h>
 
 int cmd_grep(terminal_state *term, int argc, char **argv);
+static const builtin_filter grep_filter;
 
 const builtin_cmd cmd_grep_def = {
     .name = "grep",
     .handler = cmd_grep,
-    .help = "Search for PATTERN in files"
+    .help = "Search for PATTERN in files",
+    .filter = &grep_filter,
+    .reads_input = 1
 };
 
 static int parse_flags(int argc, char **argv, int *ignore_case, int *invert,
@@ -101,9 +104,7 @@ static void grep_output_line(terminal_state *term, const char *filename,
         snprintf(buf, sizeof(buf), "%lu:", (unsigned long)line_no);
         terminal_write_string(term, buf);
     }
-    for (size_t i = 0; i < len; i++) {
-        terminal_write_char(term, line[i]);
-    }
+    terminal_write_n(term, line, len);
     terminal_newline(term);
 }
 
@@ -142,70 +143,134 @@ static int grep_process_line(terminal_state *term, const char *line, size_t len,
     return 1;
 }
 
+// matching state across chunks of input, a line may be split between two of them
+typedef struct {
+    const char *pattern;
+    int ignore_case;
+    int invert;
+    int show_line;
+    const char *filename;
+    int show_filename;
+    line_accum_t acc;
+} grep_scan_t;
+
+static int grep_scan(terminal_state *term, grep_scan_t *scan, const char *buf, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        char c = buf[i];
+        if (c == '\n') {
+            if (!grep_process_line(term, scan->acc.buf ? scan->acc.buf : "",
+                                   scan->acc.len, scan->pattern, scan->ignore_case, scan->invert,
+                                   scan->show_line, scan->filename, scan->show_filename,
+                                   scan->acc.line_no)) {
+                return 0;
+            }
+            scan->acc.len = 0;
+            scan->acc.line_no++;
+        } else if (!line_accum_append(&scan->acc, c)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// the last line may have no newline
+static int grep_scan_end(terminal_state *term, grep_scan_t *scan) {
+    int ok = 1;
+    if (scan->acc.len > 0) {
+        ok = grep_process_line(term, scan->acc.buf ? scan->acc.buf : "",
+                               scan->acc.len, scan->pattern, scan->ignore_case, scan->invert,
+                               scan->show_line, scan->filename, scan->show_filename,
+                               scan->acc.line_no);
+    }
+    free(scan->acc.buf);
+    memset(&scan->acc, 0, sizeof(scan->acc));
+    return ok;
+}
+
 static int grep_process_stream(terminal_state *term, const char *pattern,
                                int ignore_case, int invert, int show_line,
                                const char *filename, int show_filename,
                                const char *data, size_t data_len,
                                vfs_file_t *file) {
-    line_accum_t acc = {0};
-    acc.line_no = 1;
+    grep_scan_t scan = { pattern, ignore_case, invert, show_line, filename, show_filename, {0} };
+    scan.acc.line_no = 1;
     char buffer[128];
     
+    if (file == NULL) {
+        if (!grep_scan(term, &scan, data, data_len)) {
+            grep_scan_end(term, &scan);
+            return 0;
+        }
+        return grep_scan_end(term, &scan);
+    }
     while (1) {
-        ssize_t read_bytes = 0;
-        if (file != NULL) {
-            read_bytes = vfs_read(file, buffer, sizeof(buffer));
-            if (read_bytes < 0) {
-                free(acc.buf);
-                return 0;
-            }
-            if (read_bytes == 0) {
-                break;
-            }
-        } else {
-            if (data_len == 0) {
-                break;
-            }
-            size_t chunk = data_len < sizeof(buffer) ? data_len : sizeof(buffer);
-            memcpy(buffer, data, chunk);
-            data += chunk;
-            data_len -= chunk;
-            read_bytes = (ssize_t)chunk;
+        ssize_t read_bytes = vfs_read(file, buffer, sizeof(buffer));
+        if (read_bytes < 0) {
+            free(scan.acc.buf);
+            return 0;
         }
-        
-        for (ssize_t i = 0; i < read_bytes; i++) {
-            char c = buffer[i];
-            if (c == '\n') {
-                if (!grep_process_line(term, acc.buf ? acc.buf : "",
-                                       acc.len, pattern, ignore_case, invert,
-                                       show_line, filename, show_filename, acc.line_no)) {
-                    free(acc.buf);
-                    return 0;
-                }
-                acc.len = 0;
-                acc.line_no++;
-            } else {
-                if (!line_accum_append(&acc, c)) {
-                    free(acc.buf);
-                    return 0;
-                }
-            }
+        if (read_bytes == 0) {
+            break;
         }
-    }
-    
-    if (acc.len > 0) {
-        if (!grep_process_line(term, acc.buf ? acc.buf : "",
-                               acc.len, pattern, ignore_case, invert,
-                               show_line, filename, show_filename, acc.line_no)) {
-            free(acc.buf);
+        if (!grep_scan(term, &scan, buffer, (size_t)read_bytes)) {
+            free(scan.acc.buf);
             return 0;
         }
     }
-    
-    free(acc.buf);
-    return 1;
+    return grep_scan_end(term, &scan);
+}
+
+// grep PATTERN after a '|', matches lines as they come in
+static int grep_filter_open(terminal_state *term, void *state, int argc, char **argv) {
+    grep_scan_t *scan = (grep_scan_t*)state;
+    int first_pattern = 1;
+    int parse_res = parse_flags(argc, argv, &scan->ignore_case, &scan->invert,
+                                &scan->show_line, &first_pattern);
+    if (parse_res == SHELL_EINVAL) {
+        shell_error(term, "grep: invalid option");
+        return SHELL_EINVAL;
+    }
+    if (parse_res != SHELL_OK) {
+        return parse_res;
+    }
+    if (first_pattern >= argc || argv[first_pattern] == NULL) {
+        shell_error(term, "grep: missing pattern");
+        return SHELL_EINVAL;
+    }
+    if (first_pattern + 1 < argc) {
+        return SHELL_ENOTSUP;  // reads its files, not the input
+    }
+    scan->pattern = argv[first_pattern];
+    scan->acc.line_no = 1;
+    return SHELL_OK;
+}
+
+static int grep_filter_feed(terminal_state *term, void *state, const char *buf, size_t len) {
+    grep_scan_t *scan = (grep_scan_t*)state;
+    if (!grep_scan(term, scan, buf, len)) {
+        free(scan->acc.buf);
+        memset(&scan->acc, 0, sizeof(scan->acc));
+        shell_error(term, "grep: read error");
+        return SHELL_ERR;
+    }
+    return SHELL_OK;
 }
 
+static int grep_filter_close(terminal_state *term, void *state) {
+    if (!grep_scan_end(term, (grep_scan_t*)state)) {
+        shell_error(term, "grep: read error");
+        return SHELL_ERR;
+    }
+    return SHELL_OK;
+}
+
+static const builtin_filter grep_filter = {
+    .state_size = sizeof(grep_scan_t),
+    .open = grep_filter_open,
+    .feed = grep_filter_feed,
+    .close = grep_filter_close
+};
+
 int cmd_grep(terminal_state *term, int argc, char **argv) {
     if (term == NULL) {
         return SHELL_ERR;
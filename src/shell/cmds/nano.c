@@ -46,20 +46,27 @@ const builtin_cmd cmd_nano_def = {
 };
 
 static void nano_write_line(terminal_state *term, int row, const char *text) {
-    if (term == NULL || row < 0 || row >= terminal_rows) {
+    if (term == NULL || row < 0 || row >= term->grid_rows) {
         return;
     }
     
-    char *line = &term->buffer[row * terminal_cols];
-    memset(line, ' ', terminal_cols);
+    // the whole screen is rewritten on every key, only rows whose text changed need a repaint
+    size_t cols = term->grid_cols;
+    char line[terminal_cols];
+    memset(line, ' ', cols);
     
     if (text != NULL) {
         size_t len = strlen(text);
-        if (len > terminal_cols) {
-            len = terminal_cols;
+        if (len > cols) {
+            len = cols;
         }
         memcpy(line, text, len);
     }
+    char *dest = terminal_row(term, row);
+    if (dest != NULL && memcmp(dest, line, cols) != 0) {
+        memcpy(dest, line, cols);
+        terminal_mark_row_dirty(term, row);
+    }
 }
 
 static char nano_key_to_char(key_code key, uint8_t modifiers) {
@@ -143,8 +150,10 @@ static void nano_exit_to_shell(void) {
     term->fastfetch_line_count = 0;
 #ifdef ARDUINO
     if (term->fastfetch_image_pixels != NULL) {
+        terminal_render_lock();  // the render task may be drawing it
         free(term->fastfetch_image_pixels);
         term->fastfetch_image_pixels = NULL;
+        terminal_render_unlock();
     }
     term->fastfetch_image_w = 0;
     term->fastfetch_image_h = 0;
@@ -222,8 +231,8 @@ static void nano_render(void) {
     if (visible_rows < 4) {
         visible_rows = 4;
     }
-    if (visible_rows > terminal_rows) {
-        visible_rows = terminal_rows;
+    if (visible_rows > term->grid_rows) {
+        visible_rows = term->grid_rows;
     }
     
     char header[terminal_cols + 1];
@@ -294,8 +303,9 @@ static void nano_render(void) {
     if (cursor_col_text < 0) {
         cursor_col_text = 0;
     }
-    if (cursor_col_text > terminal_cols - prefix_width - 1) {
-        cursor_col_text = terminal_cols - prefix_width - 1;
+    int max_col_text = term->grid_cols - prefix_width - 1;  // the caret stays inside the window's grid
+    if (cursor_col_text > max_col_text) {
+        cursor_col_text = max_col_text > 0 ? max_col_text : 0;
     }
     cursor_row = 1 + (cursor_line - nano_state.scroll_row);
     if (cursor_row < 1) {
@@ -201,9 +201,10 @@ void passwd_handle_key_event(key_event evt) {
             passwd_state.input[passwd_state.input_len] = '\0';
             terminal_state *term = passwd_state.term;
             if (term->cursor_col > 0) {
-                uint16_t pos = term->cursor_row * terminal_cols + (term->cursor_col - 1);
-                if (pos < terminal_buffer_size) {
-                    term->buffer[pos] = ' ';
+                char *line = terminal_row(term, term->cursor_row);
+                if (line != NULL) {
+                    line[term->cursor_col - 1] = ' ';
+                    terminal_mark_row_dirty(term, term->cursor_row);
                 }
                 term->cursor_col--;
             }
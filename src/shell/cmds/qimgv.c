@@ -89,9 +89,7 @@ int cmd_qimgv(terminal_state *term, int argc, char **argv) {
     viewer->image_view_path[copy_len] = '\0';
     viewer->fastfetch_image_active = 0;
     
-#ifdef ARDUINO
-    terminal_render_window(viewer);
-#endif
+    terminal_render_request(viewer);
     
     return SHELL_OK;
 }
@@ -7,17 +7,47 @@
 #include <stdlib.h>
 
 int cmd_wc(terminal_state *term, int argc, char **argv);
+static const builtin_filter wc_filter;
 
 const builtin_cmd cmd_wc_def = {
     .name = "wc",
     .handler = cmd_wc,
-    .help = "Count lines, words, and bytes"
+    .help = "Count lines, words, and bytes",
+    .filter = &wc_filter,
+    .reads_input = 1
 };
 
+typedef struct {
+    size_t lines;
+    size_t words;
+    size_t bytes;
+    int in_word;
+    int show_lines;
+    int show_words;
+    int show_bytes;
+} wc_counts_t;
+
 static int is_whitespace(char c) {
     return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
 }
 
+// a word split between two chunks is still one word
+static void wc_count(wc_counts_t *counts, const char *buf, size_t len) {
+    counts->bytes += len;
+    for (size_t i = 0; i < len; i++) {
+        char c = buf[i];
+        if (c == '\n') {
+            counts->lines++;
+        }
+        if (is_whitespace(c)) {
+            counts->in_word = 0;
+        } else if (!counts->in_word) {
+            counts->in_word = 1;
+            counts->words++;
+        }
+    }
+}
+
 static int parse_flags(int argc, char **argv, int *show_lines, int *show_words,
                        int *show_bytes, int *first_path) {
     *show_lines = 0;
@@ -89,6 +119,44 @@ static void format_counts(char *out, size_t out_size, size_t lines, size_t words
     }
 }
 
+// wc after a '|' counts its input as it comes, nothing of it is kept
+static int wc_filter_open(terminal_state *term, void *state, int argc, char **argv) {
+    wc_counts_t *counts = (wc_counts_t*)state;
+    int first_path = 1;
+    int parse_res = parse_flags(argc, argv, &counts->show_lines, &counts->show_words,
+                                &counts->show_bytes, &first_path);
+    if (parse_res == SHELL_EINVAL) {
+        shell_error(term, "wc: invalid option");
+        return SHELL_EINVAL;
+    }
+    if (parse_res != SHELL_OK) {
+        return parse_res;
+    }
+    return first_path < argc ? SHELL_ENOTSUP : SHELL_OK;
+}
+
+static int wc_filter_feed(terminal_state *term, void *state, const char *buf, size_t len) {
+    (void)term;
+    wc_count((wc_counts_t*)state, buf, len);
+    return SHELL_OK;
+}
+
+static int wc_filter_close(terminal_state *term, void *state) {
+    wc_counts_t *counts = (wc_counts_t*)state;
+    char line_out[128];
+    format_counts(line_out, sizeof(line_out), counts->lines, counts->words, counts->bytes, NULL,
+                  counts->show_lines, counts->show_words, counts->show_bytes);
+    terminal_write_string(term, line_out);
+    return SHELL_OK;
+}
+
+static const builtin_filter wc_filter = {
+    .state_size = sizeof(wc_counts_t),
+    .open = wc_filter_open,
+    .feed = wc_filter_feed,
+    .close = wc_filter_close
+};
+
 int cmd_wc(terminal_state *term, int argc, char **argv) {
     if (term == NULL) {
         return SHELL_ERR;
@@ -113,24 +181,10 @@ int cmd_wc(terminal_state *term, int argc, char **argv) {
     }
     if (first_path >= argc) {
         if (term->pipe_input != NULL && term->pipe_input_len > 0) {
-            size_t lines = 0;
-            size_t words = 0;
-            size_t bytes = term->pipe_input_len;
-            int in_word = 0;
-            for (size_t i = 0; i < term->pipe_input_len; i++) {
-                char c = term->pipe_input[i];
-                if (c == '\n') {
-                    lines++;
-                }
-                if (is_whitespace(c)) {
-                    in_word = 0;
-                } else if (!in_word) {
-                    in_word = 1;
-                    words++;
-                }
-            }
+            wc_counts_t counts = {0};
+            wc_count(&counts, term->pipe_input, term->pipe_input_len);
             char line_out[128];
-            format_counts(line_out, sizeof(line_out), lines, words, bytes, NULL,
+            format_counts(line_out, sizeof(line_out), counts.lines, counts.words, counts.bytes, NULL,
                           show_lines, show_words, show_bytes);
             terminal_write_string(term, line_out);
             return SHELL_OK;
@@ -168,11 +222,7 @@ int cmd_wc(terminal_state *term, int argc, char **argv) {
             return SHELL_ERR;
         }
         
-        size_t lines = 0;
-        size_t words = 0;
-        size_t bytes = 0;
-        int in_word = 0;
-        
+        wc_counts_t counts = {0};
         while (1) {
             ssize_t read_bytes = vfs_read(file, buffer, sizeof(buffer));
             if (read_bytes < 0) {
@@ -184,30 +234,18 @@ int cmd_wc(terminal_state *term, int argc, char **argv) {
                 break;
             }
             
-            bytes += (size_t)read_bytes;
-            for (ssize_t j = 0; j < read_bytes; j++) {
-                char c = buffer[j];
-                if (c == '\n') {
-                    lines++;
-                }
-                if (is_whitespace(c)) {
-                    in_word = 0;
-                } else if (!in_word) {
-                    in_word = 1;
-                    words++;
-                }
-            }
+            wc_count(&counts, buffer, (size_t)read_bytes);
         }
         
         vfs_close(file);
         
-        total_lines += lines;
-        total_words += words;
-        total_bytes += bytes;
+        total_lines += counts.lines;
+        total_words += counts.words;
+        total_bytes += counts.bytes;
         file_count++;
         
         char line_out[128];
-        format_counts(line_out, sizeof(line_out), lines, words, bytes, path,
+        format_counts(line_out, sizeof(line_out), counts.lines, counts.words, counts.bytes, path,
                       show_lines, show_words, show_bytes);
         terminal_write_string(term, line_out);
     }
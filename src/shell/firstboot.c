@@ -215,9 +215,10 @@ static void firstboot_backspace(void) {
     firstboot_state.input_len--;
     firstboot_state.input[firstboot_state.input_len] = '\0';
     
-    uint16_t pos = term->cursor_row * terminal_cols + (term->cursor_col - 1);
-    if (pos < terminal_buffer_size) {
-        term->buffer[pos] = ' ';
+    char *line = terminal_row(term, term->cursor_row);
+    if (line != NULL) {
+        line[term->cursor_col - 1] = ' ';
+        terminal_mark_row_dirty(term, term->cursor_row);
     }
     term->cursor_col--;
 }
@@ -75,10 +75,7 @@ static void login_show_screen(void) {
     terminal_write_line(term, login_state.username);
     terminal_write_string(term, "password: ");
     login_clear_input();
-#ifdef ARDUINO
-    extern void terminal_render_window(terminal_state *term);
-    terminal_render_window(term);
-#endif
+    terminal_render_request(term);
 }
 
 static void login_finish(void) {
@@ -163,9 +160,10 @@ void login_handle_key_event(key_event evt) {
         if (login_state.input_len > 0 && term->cursor_col > 0) {
             login_state.input_len--;
             login_state.input[login_state.input_len] = '\0';
-            uint16_t pos = term->cursor_row * terminal_cols + (term->cursor_col - 1);
-            if (pos < terminal_buffer_size) {
-                term->buffer[pos] = ' ';
+            char *line = terminal_row(term, term->cursor_row);
+            if (line != NULL) {
+                line[term->cursor_col - 1] = ' ';
+                terminal_mark_row_dirty(term, term->cursor_row);
             }
             term->cursor_col--;
         }
@@ -14,10 +14,14 @@ void shell_error(terminal_state *term, const char *fmt, ...) {
     vsnprintf(error_msg, sizeof(error_msg), fmt, args);
     va_end(args);
     
-    terminal_write_string(term, error_msg);
     size_t len = strlen(error_msg);
     if (len == 0 || error_msg[len - 1] != '\n') {
-        terminal_newline(term);
+        if (len + 1 < sizeof(error_msg)) {
+            error_msg[len++] = '\n';
+        } else {
+            error_msg[len - 1] = '\n';
+        }
     }
+    terminal_write_error(term, error_msg, len);
 }
 
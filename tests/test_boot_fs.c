@@ -0,0 +1,197 @@
+#include <stdio.h>
+#include <string.h>
+#include "boot_fs.h"
+
+// boot_fs_provision against an in-memory card
+
+static int test_count = 0;
+static int test_passed = 0;
+static int test_failed = 0;
+
+#define TEST_ASSERT(cond, msg) \
+    do { \
+        test_count++; \
+        if (cond) { \
+            test_passed++; \
+            printf("  PASS: %s\n", msg); \
+        } else { \
+            test_failed++; \
+            printf("  FAIL: %s\n", msg); \
+            printf("    at %s:%d\n", __FILE__, __LINE__); \
+        } \
+    } while(0)
+
+#define max_fake_paths 256
+
+static char fake_paths[max_fake_paths][64];
+static int fake_is_dir[max_fake_paths];
+static int fake_count = 0;
+static int list_calls = 0;
+static int make_calls = 0;
+
+static void fake_reset(void) {
+    fake_count = 0;
+    list_calls = 0;
+    make_calls = 0;
+}
+
+static int fake_find(const char *path) {
+    for (int i = 0; i < fake_count; i++) {
+        if (strcmp(fake_paths[i], path) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static int fake_add(const char *path, int is_dir) {
+    if (fake_count >= max_fake_paths || fake_find(path) >= 0) {
+        return -1;
+    }
+    strncpy(fake_paths[fake_count], path, sizeof(fake_paths[0]) - 1);
+    fake_is_dir[fake_count] = is_dir;
+    fake_count++;
+    return 0;
+}
+
+static void fake_remove(const char *path) {
+    int idx = fake_find(path);
+    if (idx >= 0) {
+        fake_count--;
+        memcpy(fake_paths[idx], fake_paths[fake_count], sizeof(fake_paths[0]));
+        fake_is_dir[idx] = fake_is_dir[fake_count];
+    }
+}
+
+static int fake_list_dir(const char *path, void (*found)(const char *name, int is_dir, void *ctx), void *ctx) {
+    list_calls++;
+    if (strcmp(path, "/") != 0) {
+        int idx = fake_find(path);
+        if (idx < 0 || !fake_is_dir[idx]) {
+            return -1;
+        }
+    }
+    size_t len = strcmp(path, "/") == 0 ? 0 : strlen(path);
+    for (int i = 0; i < fake_count; i++) {
+        const char *p = fake_paths[i];
+        if (strncmp(p, path, len) == 0 && p[len] == '/' && strchr(p + len + 1, '/') == NULL) {
+            found(p + len + 1, fake_is_dir[i], ctx);
+        }
+    }
+    return 0;
+}
+
+static int fake_parent_ok(const char *path) {
+    char parent[64];
+    strncpy(parent, path, sizeof(parent) - 1);
+    parent[sizeof(parent) - 1] = '\0';
+    char *slash = strrchr(parent, '/');
+    if (slash == parent) {
+        return 1;
+    }
+    *slash = '\0';
+    int idx = fake_find(parent);
+    return idx >= 0 && fake_is_dir[idx];
+}
+
+static int fake_make_dir(const char *path) {
+    make_calls++;
+    return fake_parent_ok(path) ? fake_add(path, 1) : -1;
+}
+
+static int fake_make_file(const char *path, const char *content) {
+    (void)content;
+    make_calls++;
+    return fake_parent_ok(path) ? fake_add(path, 0) : -1;
+}
+
+static const boot_fs_io_t fake_io = {fake_list_dir, fake_make_dir, fake_make_file};
+
+void test_empty_card(void) {
+    printf("test_empty_card:\n");
+    fake_reset();
+
+    boot_fs_report_t report;
+    int ret = boot_fs_provision(boot_fs_manifest, boot_fs_manifest_count, &fake_io, &report);
+    TEST_ASSERT(ret == 0, "provision succeeds");
+    TEST_ASSERT(report.created == boot_fs_manifest_count, "every entry created");
+    TEST_ASSERT(list_calls == 1, "only the root is scanned on a blank card");
+    TEST_ASSERT(fake_find("/home/user/.profile") >= 0, "default home seeded");
+    TEST_ASSERT(fake_find("/var/log/boot.log") >= 0, "nested file created");
+
+    printf("\n");
+}
+
+void test_second_boot(void) {
+    printf("test_second_boot:\n");
+    list_calls = 0;
+    make_calls = 0;
+
+    boot_fs_report_t report;
+    int ret = boot_fs_provision(boot_fs_manifest, boot_fs_manifest_count, &fake_io, &report);
+    TEST_ASSERT(ret == 0 && make_calls == 0, "nothing created when layout is complete");
+    TEST_ASSERT(report.present + report.skipped == boot_fs_manifest_count, "every entry accounted for");
+    TEST_ASSERT(report.dirs_scanned == list_calls && list_calls < 20, "each parent listed once");
+
+    // lose a few entries, only those come back
+    fake_remove("/etc/motd");
+    fake_remove("/var/log/boot.log");
+    fake_remove("/var/log/input.log");
+    make_calls = 0;
+    ret = boot_fs_provision(boot_fs_manifest, boot_fs_manifest_count, &fake_io, &report);
+    TEST_ASSERT(ret == 0 && report.created == 3 && make_calls == 3, "only missing entries recreated");
+    TEST_ASSERT(fake_find("/etc/motd") >= 0, "/etc/motd is back");
+
+    printf("\n");
+}
+
+void test_existing_users(void) {
+    printf("test_existing_users:\n");
+    fake_reset();
+    fake_add("/home", 1);
+    fake_add("/home/alice", 1);
+
+    boot_fs_report_t report;
+    int ret = boot_fs_provision(boot_fs_manifest, boot_fs_manifest_count, &fake_io, &report);
+    TEST_ASSERT(ret == 0, "provision succeeds");
+    TEST_ASSERT(fake_find("/home/user") < 0, "default home not seeded next to a real user");
+    TEST_ASSERT(report.skipped == 5, "home entries skipped");
+
+    printf("\n");
+}
+
+void test_conflict(void) {
+    printf("test_conflict:\n");
+    fake_reset();
+    fake_add("/tmp", 0);  // a file where a directory should be
+
+    boot_fs_report_t report;
+    int ret = boot_fs_provision(boot_fs_manifest, boot_fs_manifest_count, &fake_io, &report);
+    TEST_ASSERT(ret == -1 && report.failed == 1, "file in place of a dir is reported");
+    TEST_ASSERT(fake_find("/tmp/.keep") < 0, "nothing created under it");
+    TEST_ASSERT(fake_find("/var/log/boot.log") >= 0, "rest of the layout still provisioned");
+
+    printf("\n");
+}
+
+int main(void) {
+    printf("[BOOT FS TESTS]\n\n");
+
+    test_empty_card();
+    test_second_boot();
+    test_existing_users();
+    test_conflict();
+
+    printf("\n[TEST SUMMARY]\n");
+    printf("  Total: %d\n", test_count);
+    printf("  Passed: %d\n", test_passed);
+    printf("  Failed: %d\n", test_failed);
+
+    if (test_failed == 0) {
+        printf("\nAll tests passed!\n");
+        return 0;
+    } else {
+        printf("\nSome tests failed!\n");
+        return 1;
+    }
+}
@@ -0,0 +1,170 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "boot_logo_cache.h"
+
+static int test_count = 0;
+static int test_passed = 0;
+static int test_failed = 0;
+
+#define TEST_ASSERT(cond, msg) \
+    do { \
+        test_count++; \
+        if (cond) { \
+            test_passed++; \
+            printf("  PASS: %s\n", msg); \
+        } else { \
+            test_failed++; \
+            printf("  FAIL: %s\n", msg); \
+            printf("    at %s:%d\n", __FILE__, __LINE__); \
+        } \
+    } while(0)
+
+void test_header(void) {
+    printf("test_header:\n");
+
+    boot_logo_cache_header_t hdr = {
+        BOOT_LOGO_CACHE_MAGIC, BOOT_LOGO_CACHE_VERSION, BOOT_LOGO_ENC_RLE, 480, 320, 0xDEADBEEF, 12345
+    };
+    uint8_t packed[BOOT_LOGO_CACHE_HEADER_SIZE];
+    boot_logo_cache_header_pack(&hdr, packed);
+    TEST_ASSERT(memcmp(packed, "TLXC", 4) == 0, "magic reads TLXC on disk");
+
+    boot_logo_cache_header_t back;
+    TEST_ASSERT(boot_logo_cache_header_unpack(packed, &back), "packed header validates");
+    TEST_ASSERT(back.width == 480 && back.height == 320 && back.source_key == 0xDEADBEEF &&
+                back.payload_size == 12345, "fields round trip");
+
+    hdr.magic = 0;
+    boot_logo_cache_header_pack(&hdr, packed);
+    TEST_ASSERT(!boot_logo_cache_header_unpack(packed, &back), "unfinished header (zero magic) rejected");
+    hdr.magic = BOOT_LOGO_CACHE_MAGIC;
+    hdr.version = BOOT_LOGO_CACHE_VERSION + 1;
+    boot_logo_cache_header_pack(&hdr, packed);
+    TEST_ASSERT(!boot_logo_cache_header_unpack(packed, &back), "other version rejected");
+
+    char path[32];
+    TEST_ASSERT(boot_logo_cache_path("/home/u/.config/boot/a.rgb565", path, sizeof(path)) != 0,
+                "cache path too long for buffer fails");
+    char big[64];
+    TEST_ASSERT(boot_logo_cache_path("/boot/a.rgb565", big, sizeof(big)) == 0 &&
+                strcmp(big, "/boot/a.rgb565.cache") == 0, "cache sits next to the source");
+
+    printf("\n");
+}
+
+void test_hash(void) {
+    printf("test_hash:\n");
+
+    uint32_t a = boot_logo_hash(BOOT_LOGO_HASH_INIT, "a", 1);
+    TEST_ASSERT(a == 0xE40C292Cu, "matches FNV-1a");
+    uint32_t split = boot_logo_hash(boot_logo_hash(BOOT_LOGO_HASH_INIT, "lo", 2), "go", 2);
+    TEST_ASSERT(split == boot_logo_hash(BOOT_LOGO_HASH_INIT, "logo", 4), "hash can be fed in pieces");
+    TEST_ASSERT(boot_logo_hash(BOOT_LOGO_HASH_INIT, "logp", 4) != split, "changed byte changes key");
+
+    printf("\n");
+}
+
+void test_scale_row(void) {
+    printf("test_scale_row:\n");
+
+    uint8_t src[8];
+    for (int i = 0; i < 4; i++) {
+        src[i * 2] = (uint8_t)(0x10 + i);
+        src[i * 2 + 1] = 0xA0;
+    }
+    uint16_t dst[8];
+    boot_logo_scale_row(src, 4, dst, 8);
+    TEST_ASSERT(dst[0] == 0xA010 && dst[1] == 0xA010 && dst[7] == 0xA013, "upscale repeats pixels");
+    boot_logo_scale_row(src, 4, dst, 2);
+    TEST_ASSERT(dst[0] == 0xA010 && dst[1] == 0xA012, "downscale picks nearest");
+    boot_logo_scale_row(src, 4, dst, 4);
+    TEST_ASSERT(dst[2] == 0xA012 && dst[3] == 0xA013, "same size copies");
+
+    printf("\n");
+}
+
+void test_rle(void) {
+    printf("test_rle:\n");
+
+    // flat background with a noisy band, roughly what a logo looks like
+    size_t count = 480 * 20;
+    uint16_t *px = (uint16_t*)malloc(count * 2);
+    for (size_t i = 0; i < count; i++) {
+        px[i] = (i / 480 >= 8 && i / 480 < 12) ? (uint16_t)(i * 2654435761u >> 16) : 0x0000;
+    }
+    size_t cap = BOOT_LOGO_RLE_BOUND(count);
+    uint8_t *enc = (uint8_t*)malloc(cap);
+    size_t len = boot_logo_rle_encode(px, count, enc, cap);
+    TEST_ASSERT(len > 0 && len < count * 2 / 2, "flat areas compress");
+    TEST_ASSERT(boot_logo_rle_encode(px, count, enc, 16) == 0, "too small output reported");
+
+    // decode with awkward sizes on both sides so records split everywhere
+    uint16_t *out = (uint16_t*)calloc(count, 2);
+    boot_logo_rle_t dec;
+    boot_logo_rle_init(&dec);
+    size_t in_pos = 0;
+    size_t produced = 0;
+    while (produced < count) {
+        size_t in_len = len - in_pos < 7 ? len - in_pos : 7;
+        size_t want = count - produced < 333 ? count - produced : 333;
+        size_t used = 0;
+        size_t got = boot_logo_rle_decode(&dec, enc + in_pos, in_len, &used, out + produced, want);
+        in_pos += used;
+        produced += got;
+        if (got == 0 && used == 0) {
+            break;
+        }
+    }
+    TEST_ASSERT(produced == count && in_pos == len, "decoder consumes everything in odd chunks");
+    TEST_ASSERT(memcmp(out, px, count * 2) == 0, "pixels round trip");
+
+    // worst case, nothing repeats
+    for (size_t i = 0; i < count; i++) {
+        px[i] = (uint16_t)i;
+    }
+    len = boot_logo_rle_encode(px, count, enc, cap);
+    TEST_ASSERT(len == count * 2 + 2, "incompressible data costs one record header");
+
+    // a run longer than one record
+    size_t long_count = BOOT_LOGO_RLE_MAX_RECORD + 100;
+    uint16_t *flat = (uint16_t*)malloc(long_count * 2);
+    for (size_t i = 0; i < long_count; i++) {
+        flat[i] = 0xF800;
+    }
+    uint16_t *flat_out = (uint16_t*)malloc(long_count * 2);
+    len = boot_logo_rle_encode(flat, long_count, enc, cap);
+    boot_logo_rle_init(&dec);
+    size_t used = 0;
+    size_t got = boot_logo_rle_decode(&dec, enc, len, &used, flat_out, long_count);
+    TEST_ASSERT(len == 8 && got == long_count && flat_out[long_count - 1] == 0xF800, "long run split in two records");
+
+    free(flat);
+    free(flat_out);
+    free(px);
+    free(enc);
+    free(out);
+    printf("\n");
+}
+
+int main(void) {
+    printf("[BOOT LOGO CACHE TESTS]\n\n");
+
+    test_header();
+    test_hash();
+    test_scale_row();
+    test_rle();
+
+    printf("\n[TEST SUMMARY]\n");
+    printf("  Total: %d\n", test_count);
+    printf("  Passed: %d\n", test_passed);
+    printf("  Failed: %d\n", test_failed);
+
+    if (test_failed == 0) {
+        printf("\nAll tests passed!\n");
+        return 0;
+    } else {
+        printf("\nSome tests failed!\n");
+        return 1;
+    }
+}
@@ -0,0 +1,232 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "boot_panel.h"
+#include "terminal_glyphs.h"
+
+static int test_count = 0;
+static int test_passed = 0;
+static int test_failed = 0;
+
+#define TEST_ASSERT(cond, msg) \
+    do { \
+        test_count++; \
+        if (cond) { \
+            test_passed++; \
+            printf("  PASS: %s\n", msg); \
+        } else { \
+            test_failed++; \
+            printf("  FAIL: %s\n", msg); \
+            printf("    at %s:%d\n", __FILE__, __LINE__); \
+        } \
+    } while(0)
+
+// stand in for the transmit task: tiles queue up and only land in the
+// framebuffer when the pipe waits, like a transfer still on the wire
+typedef struct {
+    panel_pipe_t *pipe;
+    glyph_fb_t fb;
+    panel_tile_t *queue[panel_tile_count + 1];
+    int queued;
+    int max_queued;
+    int started;
+    int started_busy;  // started while another tile was still in flight
+} fake_bus_t;
+
+static void fake_start(void *ctx, panel_tile_t *tile) {
+    fake_bus_t *bus = (fake_bus_t*)ctx;
+    if (bus->queued > 0) {
+        bus->started_busy++;
+    }
+    bus->queue[bus->queued++] = tile;
+    if (bus->queued > bus->max_queued) {
+        bus->max_queued = bus->queued;
+    }
+    bus->started++;
+}
+
+static void fake_wait(void *ctx) {
+    fake_bus_t *bus = (fake_bus_t*)ctx;
+    if (bus->queued == 0) {
+        return;
+    }
+    panel_tile_t *tile = bus->queue[0];
+    glyph_fb_push(&bus->fb, tile->x, tile->y, tile->w, tile->h, tile->pixels);
+    memmove(bus->queue, bus->queue + 1, (size_t)(bus->queued - 1) * sizeof(bus->queue[0]));
+    bus->queued--;
+    panel_pipe_complete(bus->pipe, tile->fence);
+}
+
+static int setup(panel_pipe_t *pipe, fake_bus_t *bus, int16_t width, int16_t height) {
+    memset(bus, 0, sizeof(*bus));
+    bus->pipe = pipe;
+    if (glyph_fb_init(&bus->fb, width, height) != 0) {
+        return -1;
+    }
+    panel_ops_t ops = { fake_start, fake_wait, bus };
+    return panel_pipe_init(pipe, &ops, width, height);
+}
+
+static void teardown(panel_pipe_t *pipe, fake_bus_t *bus) {
+    panel_pipe_free(pipe);
+    glyph_fb_free(&bus->fb);
+}
+
+static uint16_t pattern(int x, int y) {
+    return (uint16_t)(x * 31 + y * 7 + 1);
+}
+
+void test_init(void) {
+    printf("test_init:\n");
+
+    panel_pipe_t pipe;
+    panel_ops_t none = { NULL, NULL, NULL };
+    TEST_ASSERT(panel_pipe_init(&pipe, &none, 480, 320) != 0, "missing ops rejected");
+
+    fake_bus_t bus;
+    TEST_ASSERT(setup(&pipe, &bus, 480, 320) == 0, "pipe created");
+    TEST_ASSERT(pipe.tiles[0].pixels != NULL && pipe.tiles[1].pixels != NULL, "both tiles allocated");
+    TEST_ASSERT(panel_pipe_done(&pipe, pipe.submitted), "empty pipe is synced");
+    teardown(&pipe, &bus);
+    TEST_ASSERT(pipe.tiles[0].pixels == NULL, "tiles freed");
+    printf("\n");
+}
+
+void test_full_frame(void) {
+    printf("test_full_frame:\n");
+
+    panel_pipe_t pipe;
+    fake_bus_t bus;
+    setup(&pipe, &bus, 480, 320);
+    uint16_t *frame = (uint16_t*)malloc((size_t)480 * 320 * sizeof(uint16_t));
+    for (int y = 0; y < 320; y++) {
+        for (int x = 0; x < 480; x++) {
+            frame[(size_t)y * 480 + x] = pattern(x, y);
+        }
+    }
+
+    uint32_t fence = panel_pipe_draw(&pipe, 0, 0, frame, 480, 320);
+    TEST_ASSERT(bus.started == 32, "frame split into 10 line tiles");
+    TEST_ASSERT(bus.max_queued <= panel_tile_count, "never more than two tiles in flight");
+    TEST_ASSERT(bus.started_busy > 0, "next tile composed while the previous one was sending");
+    TEST_ASSERT(pipe.stalls > 0, "composer waited on a tile fence");
+    TEST_ASSERT(!panel_pipe_done(&pipe, fence), "draw returns before the last tile is out");
+
+    // the caller's buffer is free to reuse once draw returns
+    memset(frame, 0, (size_t)480 * 320 * sizeof(uint16_t));
+    panel_pipe_sync(&pipe);
+    TEST_ASSERT(panel_pipe_done(&pipe, fence) && bus.queued == 0, "sync drains the pipe");
+
+    int ok = 1;
+    for (int y = 0; y < 320 && ok; y++) {
+        for (int x = 0; x < 480; x++) {
+            if (bus.fb.pixels[(size_t)y * 480 + x] != pattern(x, y)) {
+                ok = 0;
+                break;
+            }
+        }
+    }
+    TEST_ASSERT(ok, "panel holds the frame as it was when drawn");
+
+    free(frame);
+    teardown(&pipe, &bus);
+    printf("\n");
+}
+
+void test_clip_and_fill(void) {
+    printf("test_clip_and_fill:\n");
+
+    panel_pipe_t pipe;
+    fake_bus_t bus;
+    setup(&pipe, &bus, 480, 320);
+
+    uint16_t block[40 * 40];
+    for (int y = 0; y < 40; y++) {
+        for (int x = 0; x < 40; x++) {
+            block[y * 40 + x] = pattern(x, y);
+        }
+    }
+    panel_pipe_draw(&pipe, -10, 300, block, 40, 40);
+    panel_pipe_sync(&pipe);
+    TEST_ASSERT(bus.fb.pixels[(size_t)300 * 480 + 0] == pattern(10, 0), "left edge clipped");
+    TEST_ASSERT(bus.fb.pixels[(size_t)319 * 480 + 29] == pattern(39, 19), "bottom edge clipped");
+    TEST_ASSERT(bus.fb.pixels[(size_t)299 * 480 + 0] == 0 && bus.fb.pixels[(size_t)300 * 480 + 30] == 0,
+                "nothing outside the block");
+    TEST_ASSERT(panel_pipe_draw(&pipe, 480, 0, block, 40, 40) == 0, "fully off panel sends nothing");
+
+    int before = bus.started;
+    panel_pipe_fill(&pipe, 100, 50, 200, 100, 0xF800);
+    panel_pipe_sync(&pipe);
+    TEST_ASSERT(bus.started - before == 5, "fill goes out in tiles too");
+    TEST_ASSERT(bus.fb.pixels[(size_t)50 * 480 + 100] == 0xF800 &&
+                bus.fb.pixels[(size_t)149 * 480 + 299] == 0xF800 &&
+                bus.fb.pixels[(size_t)150 * 480 + 299] == 0, "fill covers exactly its rect");
+
+    teardown(&pipe, &bus);
+    printf("\n");
+}
+
+void test_wide_rows(void) {
+    printf("test_wide_rows:\n");
+
+    // a row wider than a tile has to be cut into column slices
+    panel_pipe_t pipe;
+    fake_bus_t bus;
+    setup(&pipe, &bus, 6000, 2);
+    uint16_t *rows = (uint16_t*)malloc((size_t)6000 * 2 * sizeof(uint16_t));
+    for (int y = 0; y < 2; y++) {
+        for (int x = 0; x < 6000; x++) {
+            rows[(size_t)y * 6000 + x] = pattern(x, y);
+        }
+    }
+    panel_pipe_draw(&pipe, 0, 0, rows, 6000, 2);
+    panel_pipe_sync(&pipe);
+    TEST_ASSERT(bus.started == 3, "two full width slices and the rest");
+    TEST_ASSERT(memcmp(bus.fb.pixels, rows, (size_t)6000 * 2 * sizeof(uint16_t)) == 0, "slices line up");
+
+    free(rows);
+    teardown(&pipe, &bus);
+    printf("\n");
+}
+
+void test_fence_wrap(void) {
+    printf("test_fence_wrap:\n");
+
+    panel_pipe_t pipe;
+    fake_bus_t bus;
+    setup(&pipe, &bus, 480, 320);
+    pipe.submitted = 0xFFFFFFFEu;
+    pipe.completed = 0xFFFFFFFEu;
+    pipe.tiles[0].fence = pipe.tiles[1].fence = 0xFFFFFFFEu;
+    uint32_t fence = panel_pipe_fill(&pipe, 0, 0, 480, 30, 0x1234);
+    TEST_ASSERT(fence == 1, "fence counter wrapped");
+    TEST_ASSERT(!panel_pipe_done(&pipe, fence), "wrapped fence still pending");
+    panel_pipe_sync(&pipe);
+    TEST_ASSERT(panel_pipe_done(&pipe, fence), "wrapped fence completes");
+
+    teardown(&pipe, &bus);
+    printf("\n");
+}
+
+int main(void) {
+    printf("[BOOT PANEL TESTS]\n\n");
+
+    test_init();
+    test_full_frame();
+    test_clip_and_fill();
+    test_wide_rows();
+    test_fence_wrap();
+
+    printf("\n[TEST SUMMARY]\n");
+    printf("  Total: %d\n", test_count);
+    printf("  Passed: %d\n", test_passed);
+    printf("  Failed: %d\n", test_failed);
+
+    if (test_failed == 0) {
+        printf("\nAll tests passed!\n");
+        return 0;
+    } else {
+        printf("\nSome tests failed!\n");
+        return 1;
+    }
+}
@@ -0,0 +1,168 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "terminal.h"
+#include "boot_trace.h"
+#include "builtins.h"
+#include "shell_codes.h"
+
+extern int vfs_stub_register_file(const char *path, const char *content);
+
+static int test_count = 0;
+static int test_passed = 0;
+static int test_failed = 0;
+
+#define TEST_ASSERT(cond, msg) \
+    do { \
+        test_count++; \
+        if (cond) { \
+            test_passed++; \
+            printf("  PASS: %s\n", msg); \
+        } else { \
+            test_failed++; \
+            printf("  FAIL: %s\n", msg); \
+            printf("    at %s:%d\n", __FILE__, __LINE__); \
+        } \
+    } while(0)
+
+void test_record(void) {
+    printf("test_record:\n");
+    boot_trace_reset();
+
+    int step = boot_trace_begin("Mount micro SD");
+    int sub = boot_trace_begin("SD.begin");
+    boot_trace_add("SPI switch", boot_trace_now(), 50);
+    boot_trace_add("SPI switch", boot_trace_now(), 50);
+    boot_trace_end(sub);
+    boot_trace_add("SPI switch", boot_trace_now(), 50);
+    boot_trace_end(step);
+
+    TEST_ASSERT(boot_trace_count() == 3, "three entries recorded");
+    TEST_ASSERT(boot_trace_get(0)->depth == 0 && boot_trace_get(1)->depth == 1, "sub operation nests under step");
+    const boot_trace_entry_t *spi = boot_trace_get(2);
+    TEST_ASSERT(spi != NULL && spi->count == 3 && spi->duration_ms == 150, "repeated operation summed");
+    TEST_ASSERT(spi->depth == 2, "counted entry keeps depth of first hit");
+
+    int open_slot = boot_trace_begin("Start desktop");
+    boot_trace_stop();
+    TEST_ASSERT(!boot_trace_get(open_slot)->open, "stop closes open spans");
+    boot_trace_add("SPI switch", 0, 50);
+    TEST_ASSERT(boot_trace_begin("late") == -1 && boot_trace_get(2)->count == 3, "nothing recorded after stop");
+
+    printf("\n");
+}
+
+static int polls_until_ready = 0;
+
+static int ready_after_polls(void *ctx) {
+    int *polls = (int*)ctx;
+    (*polls)++;
+    return *polls >= polls_until_ready;
+}
+
+void test_wait_until(void) {
+    printf("test_wait_until:\n");
+    boot_trace_reset();
+
+    int polls = 0;
+    polls_until_ready = 3;
+    uint32_t start = boot_trace_now();
+    TEST_ASSERT(boot_wait_until("card ready", ready_after_polls, &polls, 1000, 1) == 0, "wait returns once ready");
+    TEST_ASSERT(polls == 3 && boot_trace_now() - start < 500, "stops polling as soon as the condition holds");
+
+    polls = 0;
+    polls_until_ready = 1000000;
+    start = boot_trace_now();
+    TEST_ASSERT(boot_wait_until("never", ready_after_polls, &polls, 30, 5) == -1, "wait times out");
+    uint32_t took = boot_trace_now() - start;
+    TEST_ASSERT(took >= 30 && took < 500, "timeout is honoured");
+
+    TEST_ASSERT(boot_trace_count() == 2 && strcmp(boot_trace_get(0)->name, "card ready") == 0 &&
+                boot_trace_get(1)->duration_ms >= 30, "each wait is traced");
+
+    printf("\n");
+}
+
+void test_save_load(void) {
+    printf("test_save_load:\n");
+
+    // the stub tree is read only, so hand the formatted trace to it directly
+    char text[BOOT_TRACE_MAX * 64];
+    size_t len = boot_trace_format(text, sizeof(text));
+    TEST_ASSERT(len > 0 && text[len - 1] == '\n', "trace formatted");
+    vfs_stub_register_file("/boot.trace", text);
+    TEST_ASSERT(boot_trace_save("/boot.trace") != 0, "save failure is reported");
+
+    boot_trace_entry_t loaded[BOOT_TRACE_MAX];
+    int count = boot_trace_load("/boot.trace", loaded, BOOT_TRACE_MAX);
+    TEST_ASSERT(count == (int)boot_trace_count(), "same number of entries loaded");
+    TEST_ASSERT(count >= 3 && strcmp(loaded[2].name, "SPI switch") == 0 && loaded[2].count == 3 &&
+                loaded[2].duration_ms == 150, "entry round trips");
+    TEST_ASSERT(strcmp(loaded[0].name, "Mount micro SD") == 0, "names with spaces survive");
+
+    printf("\n");
+}
+
+void test_bootchart(void) {
+    printf("test_bootchart:\n");
+
+    init_terminal_system();
+    builtins_init();
+    new_terminal();
+    terminal_state *term = get_active_terminal();
+
+    vfs_stub_register_file("/chart.trace",
+        "# start_ms duration_ms depth count name\n"
+        "1000 1600 0 1 TFT init\n"
+        "2600 400 0 1 Mount micro SD\n"
+        "2650 300 1 1 SD.begin\n"
+        "2700 900 1 6 SPI switch\n");
+
+    builtin_cmd *cmd = builtins_find("bootchart");
+    TEST_ASSERT(cmd != NULL, "bootchart registered");
+
+    char *argv[] = {"bootchart", "/chart.trace", NULL};
+    terminal_capture_start();
+    int res = cmd->handler(term, 2, argv);
+    size_t len = 0;
+    char *out = terminal_capture_stop(&len);
+    TEST_ASSERT(res == SHELL_OK, "bootchart succeeds");
+    TEST_ASSERT(out != NULL && strstr(out, "2600 ms") != NULL, "total span measured from first entry");
+    TEST_ASSERT(out != NULL && strstr(out, "  SPI switch x6") != NULL, "sub operations indented with hit count");
+    TEST_ASSERT(out != NULL && strstr(out, "|###############.........|") != NULL, "first step drawn from the left edge");
+    if (out != NULL) {
+        printf("%s", out);
+    }
+    free(out);
+
+    char *missing[] = {"bootchart", "/nope.trace", NULL};
+    terminal_capture_start();
+    res = cmd->handler(term, 2, missing);
+    free(terminal_capture_stop(NULL));
+    TEST_ASSERT(res == SHELL_ENOENT, "missing trace file is an error");
+
+    close_terminal();
+    printf("\n");
+}
+
+int main(void) {
+    printf("[BOOT TRACE TESTS]\n\n");
+
+    test_wait_until();
+    test_record();
+    test_save_load();
+    test_bootchart();
+
+    printf("\n[TEST SUMMARY]\n");
+    printf("  Total: %d\n", test_count);
+    printf("  Passed: %d\n", test_passed);
+    printf("  Failed: %d\n", test_failed);
+
+    if (test_failed == 0) {
+        printf("\nAll tests passed!\n");
+        return 0;
+    } else {
+        printf("\nSome tests failed!\n");
+        return 1;
+    }
+}
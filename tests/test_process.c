@@ -166,6 +166,30 @@ void test_process_max_limit(void) {
     teardown_process();
 }
 
+// test 7: startup handshake
+void test_process_ready_handshake(void) {
+    setup_process();
+    printf("  test_process_ready_handshake... ");
+    
+    void test_task(void *args) {
+        (void)args;
+    }
+    
+    process_id_t pid = process_create("test_task", test_task, NULL, process_priority_normal, 0);
+    assert(process_get_pcb(pid)->initialized == 0);
+    assert(process_wait_ready(pid, 10) == -1);  // never signalled
+    
+    process_signal_ready(pid);
+    assert(process_get_pcb(pid)->initialized == 1);
+    assert(process_wait_ready(pid, 10) == 0);
+    
+    process_terminate(pid);
+    assert(process_wait_ready(pid, 10) == -1);  // gone
+    
+    printf("FUNCTIONAL\n");
+    teardown_process();
+}
+
 int main(void) {
     printf("[PROCESS TESTS]\n");
     test_process_create();
@@ -174,6 +198,7 @@ int main(void) {
     test_process_multiple();
     test_process_iterate();
     test_process_max_limit();
+    test_process_ready_handshake();
     return 0;
 }
 
@@ -0,0 +1,107 @@
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include "registry.h"
+#include "builtins.h"
+#include "action_manager.h"
+#include "hotkey.h"
+
+static int calls = 0;
+
+static void count_action(void) {
+    calls++;
+}
+
+static int cmd_nop(terminal_state *term, int argc, char **argv) {
+    (void)term;
+    (void)argc;
+    (void)argv;
+    return 0;
+}
+
+// test 1: far more entries than the old fixed arrays held, all found, in registration order
+void test_registry_no_cap(void) {
+    printf("  test_registry_no_cap... ");
+    static char names[300][16];
+    reset_actions();
+    for (int i = 0; i < 300; i++) {
+        snprintf(names[i], sizeof(names[i]), "action%d", i);
+        register_action(names[i], count_action);
+    }
+    assert(registry_count(registry_action) == 300);
+    calls = 0;
+    for (int i = 0; i < 300; i++) {
+        execute_action(names[i]);
+    }
+    assert(calls == 300);
+    assert(strcmp(registry_at(registry_action, 0)->name, "action0") == 0);
+    assert(strcmp(registry_at(registry_action, 299)->name, "action299") == 0);
+    assert(registry_at(registry_action, 300) == NULL);
+
+    // the same name again replaces the entry instead of adding a second one
+    register_action("action7", count_action);
+    assert(registry_count(registry_action) == 300);
+    reset_actions();
+    assert(registry_count(registry_action) == 0 && registry_find(registry_action, "action7") == NULL);
+    printf("FUNCTIONAL\n");
+}
+
+// test 2: kinds are separate namespaces, resetting one leaves the others alone
+void test_registry_kinds(void) {
+    printf("  test_registry_kinds... ");
+    builtins_init();
+    int builtin_count = builtins_count();
+    assert(builtin_count > 0);
+    register_action("ls", count_action);
+    assert(builtins_find("ls") != NULL && builtins_find("ls")->handler != NULL);
+
+    builtins_register("nop", cmd_nop, "does nothing");
+    registry_entry *entry = registry_find(registry_builtin, "nop");
+    assert(entry != NULL && strcmp(entry->help, "does nothing") == 0);
+    assert(strcmp(entry->category, "builtin") == 0 && entry->flags == 0);
+    assert(builtins_at(builtin_count) == entry->item);
+    assert(registry_find(registry_builtin, "cat")->flags & registry_flag_streams);
+
+    reset_actions();
+    assert(builtins_find("ls") != NULL);
+    builtins_init();
+    assert(builtins_count() == builtin_count && builtins_find("nop") == NULL);
+    printf("FUNCTIONAL\n");
+}
+
+// test 3: hotkeys are keyed by number, the binding with the most held modifiers wins
+void test_registry_hotkeys(void) {
+    printf("  test_registry_hotkeys... ");
+    reset_hotkeys();
+    register_key(mod_ctrl, key_x, "cut");
+    register_key(mod_ctrl | mod_shift, key_x, "cut_all");
+    register_key(0, key_f, "find");
+
+    key_event evt = { key_x, mod_ctrl };
+    assert(strcmp(find_hotkey_action(evt), "cut") == 0);
+    evt.modifiers = mod_ctrl | mod_shift;
+    assert(strcmp(find_hotkey_action(evt), "cut_all") == 0);
+    evt.modifiers = mod_ctrl | mod_super;
+    assert(strcmp(find_hotkey_action(evt), "cut") == 0);
+    evt.modifiers = mod_shift;
+    assert(find_hotkey_action(evt) == NULL);
+    evt.key = key_f;
+    assert(strcmp(find_hotkey_action(evt), "find") == 0);
+
+    register_key(mod_ctrl, key_x, "cut_line");
+    evt.key = key_x;
+    evt.modifiers = mod_ctrl;
+    assert(strcmp(find_hotkey_action(evt), "cut_line") == 0);
+    assert(registry_count(registry_hotkey) == 3);
+    reset_hotkeys();
+    assert(find_hotkey_action(evt) == NULL);
+    printf("FUNCTIONAL\n");
+}
+
+int main(void) {
+    printf("[REGISTRY TESTS]\n");
+    test_registry_no_cap();
+    test_registry_kinds();
+    test_registry_hotkeys();
+    return 0;
+}
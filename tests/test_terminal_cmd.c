@@ -6,7 +6,7 @@
 
 void setup_terminal_cmd(void) {
     init_terminal_system();
-    init_terminal_commands();
+    builtins_init();
     new_terminal();
 }
 
@@ -23,8 +23,9 @@ void test_cmd_register(void) {
     assert(cmd != NULL);
     assert(strcmp(cmd->name, "echo") == 0);
     
-    term_cmd *cmd2 = find_cmd("help");
-    assert(cmd2 != NULL);
+    // the shell's own entry, not a copy
+    term_cmd *cmd2 = find_cmd("ls");
+    assert(cmd2 != NULL && cmd2 == builtins_find("ls"));
     
     term_cmd *cmd3 = find_cmd("nonexistent");
     assert(cmd3 == NULL);
@@ -45,7 +46,7 @@ void test_cmd_echo(void) {
     term_cmd *cmd = find_cmd("echo");
     assert(cmd != NULL);
     
-    int result = cmd->handler(3, argv);
+    int result = cmd->handler(term, 3, argv);
     assert(result == 0);
     
     printf("FUNCTIONAL\n");
@@ -67,7 +68,7 @@ void test_cmd_clear(void) {
     term_cmd *cmd = find_cmd("clear");
     assert(cmd != NULL);
     
-    int result = cmd->handler(1, argv);
+    int result = cmd->handler(term, 1, argv);
     assert(result == 0);
     assert(term->cursor_row == 0);
     assert(term->cursor_col == 0);
@@ -76,20 +77,18 @@ void test_cmd_clear(void) {
     teardown_terminal_cmd();
 }
 
-// test 4: help command
-void test_cmd_help(void) {
+// test 4: every builtin resolves, and nothing outside them does
+void test_cmd_builtins(void) {
     setup_terminal_cmd();
-    printf("  test_cmd_help... ");
+    printf("  test_cmd_builtins... ");
     
-    terminal_state *term = get_active_terminal();
-    assert(term != NULL);
-    
-    char *argv[] = {"help", NULL};
-    term_cmd *cmd = find_cmd("help");
-    assert(cmd != NULL);
-    
-    int result = cmd->handler(1, argv);
-    assert(result == 0);
+    assert(builtins_count() > 0);
+    for (int i = 0; i < builtins_count(); i++) {
+        const builtin_cmd *builtin = builtins_at(i);
+        assert(find_cmd(builtin->name) == builtins_find(builtin->name));
+    }
+    // help was only ever a placeholder in the old command table
+    assert(find_cmd("help") == NULL);
     
     printf("FUNCTIONAL\n");
     teardown_terminal_cmd();
@@ -107,7 +106,7 @@ void test_cmd_pwd(void) {
     term_cmd *cmd = find_cmd("pwd");
     assert(cmd != NULL);
     
-    int result = cmd->handler(1, argv);
+    int result = cmd->handler(term, 1, argv);
     assert(result == 0);
     
     printf("FUNCTIONAL\n");
@@ -127,7 +126,7 @@ void test_cmd_exit(void) {
     term_cmd *cmd = find_cmd("exit");
     assert(cmd != NULL);
     
-    int result = cmd->handler(1, argv);
+    int result = cmd->handler(term, 1, argv);
     assert(result == 0);
     
     // terminal should be closed
@@ -143,7 +142,7 @@ int main(void) {
     test_cmd_register();
     test_cmd_echo();
     test_cmd_clear();
-    test_cmd_help();
+    test_cmd_builtins();
     test_cmd_pwd();
     test_cmd_exit();
     return 0;
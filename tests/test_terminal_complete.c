@@ -0,0 +1,101 @@
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include "terminal.h"
+#include "builtins.h"
+
+static terminal_state *setup_complete(void) {
+    builtins_init();
+    init_terminal_system();
+    terminal_set_initial_output_suppressed(1);
+    new_terminal();
+    terminal_set_initial_output_suppressed(0);
+    terminal_state *term = get_active_terminal();
+    assert(term != NULL);
+    return term;
+}
+
+static void type(terminal_state *term, const char *keys) {
+    while (*keys) {
+        terminal_handle_key(term, *keys++);
+    }
+}
+
+// test 1: the first word completes to a builtin, the newest history line that continues it wins
+void test_complete_commands(void) {
+    printf("  test_complete_commands... ");
+    terminal_state *term = setup_complete();
+    type(term, "ec");
+    assert(strcmp(term->autocomplete_suffix, "ho") == 0);
+
+    terminal_history_add("echo one");
+    terminal_history_add("echo two");
+    terminal_history_add("pwd");
+    char suffix[terminal_cols];
+    assert(terminal_complete(term, "ec", 2, 0, suffix, sizeof(suffix)) == 1);
+    assert(strcmp(suffix, "ho two") == 0);
+    assert(terminal_complete(term, "ec", 2, 1, suffix, sizeof(suffix)) == 1);
+    assert(strcmp(suffix, "ho") == 0);
+    assert(terminal_complete(term, "ec", 2, 2, suffix, sizeof(suffix)) == 0);
+
+    // a longer prefix searches inside the last range and still finds the right line
+    assert(terminal_complete(term, "echo o", 6, 0, suffix, sizeof(suffix)) == 1);
+    assert(strcmp(suffix, "ne") == 0);
+    assert(terminal_complete(term, "zz", 2, 0, suffix, sizeof(suffix)) == 0);
+
+    close_terminal();
+    printf("FUNCTIONAL\n");
+}
+
+// test 2: later words complete to paths, directories get their slash
+void test_complete_paths(void) {
+    printf("  test_complete_paths... ");
+    terminal_state *term = setup_complete();
+    char suffix[terminal_cols];
+    assert(terminal_complete(term, "cat di", 6, 0, suffix, sizeof(suffix)) == 1);
+    assert(strcmp(suffix, "r1/") == 0);
+    assert(terminal_complete(term, "cat dir1/f", 10, 0, suffix, sizeof(suffix)) == 1);
+    assert(strcmp(suffix, "ile3.txt") == 0);
+    assert(terminal_complete(term, "cat nope/f", 10, 0, suffix, sizeof(suffix)) == 0);
+
+    assert(terminal_complete(term, "cat fi", 6, 0, suffix, sizeof(suffix)) == 1);
+    assert(strcmp(suffix, "le1.txt") == 0);
+    assert(terminal_complete(term, "cat fi", 6, 1, suffix, sizeof(suffix)) == 1);
+    assert(strcmp(suffix, "le2.txt") == 0);
+    assert(terminal_complete(term, "cat fi", 6, 2, suffix, sizeof(suffix)) == 0);
+    close_terminal();
+    printf("FUNCTIONAL\n");
+}
+
+// test 3: tab takes the suggestion, more tabs step through the others and wrap around
+void test_complete_tab(void) {
+    printf("  test_complete_tab... ");
+    terminal_state *term = setup_complete();
+    type(term, "cat fi");
+    assert(strcmp(term->autocomplete_suffix, "le1.txt") == 0);
+    terminal_handle_tab(term);
+    assert(strcmp(term->input_line, "cat file1.txt") == 0);
+    assert(term->input_pos == term->input_len && term->autocomplete_applied);
+    terminal_handle_tab(term);
+    assert(strcmp(term->input_line, "cat file2.txt") == 0);
+    terminal_handle_tab(term);
+    assert(strcmp(term->input_line, "cat file1.txt") == 0);
+
+    // typing on starts over from the new prefix
+    type(term, " d");
+    assert(strcmp(term->autocomplete_suffix, "ir1/") == 0);
+    terminal_handle_tab(term);
+    assert(strcmp(term->input_line, "cat file1.txt dir1/") == 0);
+    close_terminal();
+    printf("FUNCTIONAL\n");
+}
+
+int main(void) {
+    printf("[TERMINAL COMPLETE TESTS]\n");
+    test_complete_commands();
+    test_complete_paths();
+    test_complete_tab();
+    terminal_complete_free();
+    terminal_history_free();
+    return 0;
+}
@@ -0,0 +1,132 @@
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include "terminal.h"
+
+static terminal_state windows[max_windows];
+
+static void place(uint8_t i, int16_t x, int16_t y, int16_t w, int16_t h) {
+    windows[i].active = 1;
+    windows[i].x = x;
+    windows[i].y = y;
+    windows[i].width = w;
+    windows[i].height = h;
+}
+
+static long damage_area(const terminal_damage_t *damage) {
+    long area = 0;
+    for (uint8_t i = 0; i < damage->count; i++) {
+        area += (long)damage->rects[i].w * damage->rects[i].h;
+    }
+    return area;
+}
+
+static int damage_hits(const terminal_damage_t *damage, const terminal_rect_t *r) {
+    for (uint8_t i = 0; i < damage->count; i++) {
+        const terminal_rect_t *d = &damage->rects[i];
+        if (d->x < r->x + r->w && r->x < d->x + d->w && d->y < r->y + r->h && r->y < d->y + d->h) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// settle the layout as if a frame painted it
+static void paint(void) {
+    terminal_damage_t exposed;
+    terminal_compose_layout(windows, &exposed);
+    for (uint8_t i = 0; i < max_windows; i++) {
+        windows[i].painted_valid = 1;
+    }
+}
+
+// test 1: cutting one rect out of another leaves exactly the difference
+void test_compose_subtract(void) {
+    printf("  test_compose_subtract... ");
+    terminal_damage_t damage;
+    damage.count = 0;
+    terminal_rect_t a = { 0, 0, 100, 100 };
+    terminal_damage_add(&damage, &a);
+
+    terminal_rect_t hole = { 25, 25, 50, 50 };
+    assert(terminal_damage_subtract(&damage, &hole) == 0);
+    assert(damage.count == 4);
+    assert(damage_area(&damage) == 100 * 100 - 50 * 50);
+    assert(!damage_hits(&damage, &hole));
+
+    terminal_rect_t apart = { 200, 0, 10, 10 };
+    assert(terminal_damage_subtract(&damage, &apart) == 0);
+    assert(damage.count == 4);
+
+    terminal_rect_t all = { -10, -10, 200, 200 };
+    assert(terminal_damage_subtract(&damage, &all) == 0);
+    assert(damage.count == 0);
+
+    terminal_rect_t none = { 5, 5, 0, 10 };
+    terminal_damage_add(&damage, &none);
+    assert(damage.count == 0);
+    printf("FUNCTIONAL\n");
+}
+
+// test 2: a split repaints the two halves and clears nothing
+void test_compose_split(void) {
+    printf("  test_compose_split... ");
+    memset(windows, 0, sizeof(windows));
+    place(0, 5, 5, 470, 310);
+    terminal_damage_t exposed;
+    assert(terminal_compose_layout(windows, &exposed) == 0x01);
+    assert(exposed.count == 0);  // never painted anywhere, nothing to clear
+    paint();
+
+    // nothing moved: nothing to do
+    assert(terminal_compose_layout(windows, &exposed) == 0);
+    assert(windows[0].painted_valid == 1);
+
+    place(1, 5, 5, 233, 310);
+    place(0, 242, 5, 233, 310);
+    assert(terminal_compose_layout(windows, &exposed) == 0x03);
+    assert(windows[0].painted_valid == 0 && windows[1].painted_valid == 0);
+    // the 4px gap between the halves is the only thing left uncovered
+    assert(damage_area(&exposed) == 4L * 310);
+    terminal_rect_t gap = { 238, 5, 4, 310 };
+    assert(damage_hits(&exposed, &gap));
+    printf("FUNCTIONAL\n");
+}
+
+// test 3: closing clears the old area without touching windows that stayed put
+void test_compose_close(void) {
+    printf("  test_compose_close... ");
+    memset(windows, 0, sizeof(windows));
+    place(0, 5, 5, 233, 150);
+    place(1, 242, 5, 233, 150);
+    place(2, 5, 160, 470, 150);
+    paint();
+
+    windows[2].active = 0;
+    terminal_damage_t exposed;
+    assert(terminal_compose_layout(windows, &exposed) == 0);
+    assert(damage_area(&exposed) == 470L * 150);
+    assert(windows[0].painted_valid == 1 && windows[1].painted_valid == 1);
+    assert(terminal_rect_empty(&windows[2].painted_rect));
+
+    // the gone window's area is only reported once
+    assert(terminal_compose_layout(windows, &exposed) == 0);
+    assert(exposed.count == 0);
+
+    // the others grow into it: they repaint, and they cover what was exposed
+    place(0, 5, 5, 233, 305);
+    place(1, 242, 5, 233, 305);
+    assert(terminal_compose_layout(windows, &exposed) == 0x03);
+    terminal_rect_t left = { 5, 5, 233, 305 };
+    terminal_rect_t right = { 242, 5, 233, 305 };
+    assert(!damage_hits(&exposed, &left) && !damage_hits(&exposed, &right));
+    printf("FUNCTIONAL\n");
+}
+
+int main(void) {
+    printf("[TERMINAL COMPOSE TESTS]\n");
+    test_compose_subtract();
+    test_compose_split();
+    test_compose_close();
+    return 0;
+}
@@ -0,0 +1,95 @@
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include "terminal.h"
+
+static terminal_state *setup_frame(void) {
+    init_terminal_system();
+    terminal_set_initial_output_suppressed(1);
+    new_terminal();
+    terminal_set_initial_output_suppressed(0);
+    terminal_render_flush();
+    return get_active_terminal();
+}
+
+// test 1: output only marks damage, nothing is pending once a frame drew it
+void test_frame_output_damages(void) {
+    printf("  test_frame_output_damages... ");
+    terminal_state *term = setup_frame();
+    assert(term != NULL);
+    assert(!terminal_render_pending());
+
+    terminal_write_string(term, "hello");
+    assert(terminal_render_pending());
+    assert(terminal_render_tick(1000) == 1);
+    assert(!terminal_render_pending());
+
+    terminal_clear(term);
+    assert(terminal_render_pending());
+    terminal_render_flush();
+    assert(!terminal_render_pending());
+
+    close_terminal();
+    printf("FUNCTIONAL\n");
+}
+
+// test 2: a flood of output costs at most one frame per terminal_frame_ms
+void test_frame_coalesces(void) {
+    printf("  test_frame_coalesces... ");
+    terminal_state *term = setup_frame();
+
+    uint32_t now = 5000;
+    int frames = 0;
+    // 1000 lines over 100ms of loop iterations, one every 100us
+    for (int i = 0; i < 1000; i++) {
+        terminal_write_line(term, "line of output from a big cat");
+        if (i % 10 == 0) {
+            now += 1;
+        }
+        frames += terminal_render_tick(now);
+    }
+    assert(frames >= 1 && frames <= 100 / terminal_frame_ms + 1);
+
+    // an idle loop never draws
+    terminal_render_flush();
+    assert(terminal_render_tick(now + 1000) == 0);
+
+    close_terminal();
+    printf("FUNCTIONAL\n");
+}
+
+// test 3: flush skips the frame wait, layout requests stay pending until drawn
+void test_frame_flush_now(void) {
+    printf("  test_frame_flush_now... ");
+    terminal_state *term = setup_frame();
+
+    terminal_write_string(term, "$ ");
+    assert(terminal_render_tick(20000) == 1);
+    terminal_handle_key(term, 'l');
+    assert(terminal_render_pending());
+    assert(terminal_render_tick(20001) == 0);  // frame budget not up yet
+    terminal_render_flush();                   // echo goes out anyway
+    assert(!terminal_render_pending());
+
+    terminal_render_request_all();
+    assert(terminal_render_pending());
+    assert(terminal_render_tick(20000 + terminal_frame_ms) == 1);
+    assert(!terminal_render_pending());
+
+    // windows outside the table are ignored
+    terminal_state stray;
+    memset(&stray, 0, sizeof(stray));
+    terminal_render_request(&stray);
+    assert(!terminal_render_pending());
+
+    close_terminal();
+    printf("FUNCTIONAL\n");
+}
+
+int main(void) {
+    printf("[TERMINAL FRAME TESTS]\n");
+    test_frame_output_damages();
+    test_frame_coalesces();
+    test_frame_flush_now();
+    return 0;
+}
@@ -1,12 +1,13 @@
 #include <stdio.h>
 #include <string.h>
+#include <stdlib.h>
 #include <assert.h>
 #include "terminal.h"
 #include "terminal_cmd.h"
 
 void setup_terminal_full(void) {
     init_terminal_system();
-    init_terminal_commands();
+    builtins_init();
 }
 
 void teardown_terminal_full(void) {
@@ -154,14 +155,73 @@ void test_terminal_history(void) {
     term->input_len = strlen("command2");
     terminal_handle_enter(term);
     
-    assert(term->history_count == 2);
-    assert(strcmp(term->history[0], "command1") == 0);
-    assert(strcmp(term->history[1], "command2") == 0);
+    assert(terminal_history_count() == 2);
+    uint32_t pos = terminal_history_live;
+    assert(strcmp(terminal_history_prev(&pos), "command2") == 0);
+    assert(strcmp(terminal_history_prev(&pos), "command1") == 0);
+    assert(terminal_history_prev(&pos) == NULL);
     
     printf("FUNCTIONAL\n");
     teardown_terminal_full();
 }
 
+// test 8: bulk writes land exactly where byte by byte writes do
+void test_terminal_write_n(void) {
+    setup_terminal_full();
+    printf("  test_terminal_write_n... ");
+
+    new_terminal();
+    new_terminal();
+    terminal_state *bytes = &terminals[0];
+    terminal_state *bulk = &terminals[1];
+    terminal_clear(bytes);
+    terminal_clear(bulk);
+
+    // short lines, lines that wrap, empty lines, enough of them to scroll
+    static char text[terminal_rows * terminal_cols * 2];
+    size_t len = 0;
+    for (int i = 0; len + 3 * terminal_cols < sizeof(text); i++) {
+        size_t line_len = (size_t)(i * 37) % (2 * terminal_cols + 5);
+        for (size_t j = 0; j < line_len; j++) {
+            text[len++] = (char)('a' + (i + j) % 26);
+        }
+        text[len++] = '\n';
+        if (i % 7 == 0) {
+            text[len++] = '\n';
+        }
+    }
+    for (size_t i = 0; i < len; i++) {
+        terminal_write_char(bytes, text[i]);
+    }
+    terminal_write_n(bulk, text, len);
+
+    assert(bytes->cursor_row == bulk->cursor_row && bytes->cursor_col == bulk->cursor_col);
+    assert(bytes->scrolled_rows == bulk->scrolled_rows && bulk->scrolled_rows > 0);
+    for (int row = -(int)bulk->scrollback_count; row < terminal_rows; row++) {
+        assert(memcmp(terminal_view_row(bytes, row), terminal_view_row(bulk, row), terminal_cols) == 0);
+    }
+
+    // a run that fills the row to the edge wraps like the per byte path
+    char row[terminal_cols];
+    memset(row, 'x', sizeof(row));
+    terminal_clear(bulk);
+    terminal_write_n(bulk, row, 10);
+    terminal_write_n(bulk, row, terminal_cols - 10);
+    assert(bulk->cursor_col == 0 && bulk->cursor_row == 1);
+
+    // captured output is taken whole
+    terminal_capture_start();
+    terminal_write_n(bulk, text, len);
+    size_t captured_len = 0;
+    char *captured = terminal_capture_stop(&captured_len);
+    assert(captured != NULL && captured_len == len);
+    assert(memcmp(captured, text, len) == 0);
+    free(captured);
+
+    printf("FUNCTIONAL\n");
+    teardown_terminal_full();
+}
+
 int main(void) {
     printf("[TERMINAL FULL TESTS]\n");
     test_terminal_init();
@@ -171,6 +231,7 @@ int main(void) {
     test_terminal_parse_command();
     test_terminal_parse_pipe();
     test_terminal_history();
+    test_terminal_write_n();
     return 0;
 }
 
@@ -0,0 +1,242 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include "terminal_glyphs.h"
+
+static int test_count = 0;
+static int test_passed = 0;
+static int test_failed = 0;
+
+#define TEST_ASSERT(cond, msg) \
+    do { \
+        test_count++; \
+        if (cond) { \
+            test_passed++; \
+            printf("  PASS: %s\n", msg); \
+        } else { \
+            test_failed++; \
+            printf("  FAIL: %s\n", msg); \
+            printf("    at %s:%d\n", __FILE__, __LINE__); \
+        } \
+    } while(0)
+
+#define FG 0x07E0
+#define BG 0xFFFF
+
+// made up font, any deterministic pattern will do for checking the blitter
+static uint8_t fake_column(void *ctx, char c, int col) {
+    (void)ctx;
+    if (c == ' ') {
+        return 0;
+    }
+    return (uint8_t)(((unsigned char)c * 7 + col * 13) & 0x7F);
+}
+
+static int font_pixel(char c, int x, int y) {
+    if (x >= glyph_base_w - 1) {
+        return 0;
+    }
+    return (fake_column(NULL, c, x) >> y) & 1;
+}
+
+void test_atlas(void) {
+    printf("test_atlas:\n");
+
+    glyph_atlas_t atlas;
+    memset(&atlas, 0, sizeof(atlas));
+    TEST_ASSERT(glyph_atlas_build(&atlas, 0, FG, BG, fake_column, NULL) != 0, "zoom 0 rejected");
+    TEST_ASSERT(glyph_atlas_build(&atlas, glyph_max_zoom + 1, FG, BG, fake_column, NULL) != 0, "zoom above max rejected");
+
+    for (uint8_t zoom = 1; zoom <= glyph_max_zoom; zoom++) {
+        TEST_ASSERT(glyph_atlas_build(&atlas, zoom, FG, BG, fake_column, NULL) == 0, "atlas built");
+        const uint16_t *g = glyph_atlas_glyph(&atlas, 'A');
+        int ok = g != NULL && atlas.glyph_w == glyph_base_w * zoom && atlas.glyph_h == glyph_base_h * zoom;
+        for (int y = 0; ok && y < atlas.glyph_h; y++) {
+            for (int x = 0; x < atlas.glyph_w; x++) {
+                uint16_t want = font_pixel('A', x / zoom, y / zoom) ? FG : BG;
+                if (g[y * atlas.glyph_w + x] != want) {
+                    ok = 0;
+                    break;
+                }
+            }
+        }
+        TEST_ASSERT(ok, "glyph pixels scaled by zoom, spacing column left blank");
+    }
+    TEST_ASSERT(glyph_atlas_glyph(&atlas, '\t') == glyph_atlas_glyph(&atlas, ' '), "unprintable maps to space");
+
+    glyph_atlas_free(&atlas);
+    TEST_ASSERT(atlas.pixels == NULL, "atlas freed");
+    printf("\n");
+}
+
+void test_span(void) {
+    printf("test_span:\n");
+
+    glyph_atlas_t atlas;
+    memset(&atlas, 0, sizeof(atlas));
+    glyph_atlas_build(&atlas, 2, FG, BG, fake_column, NULL);
+    glyph_fb_t fb;
+    TEST_ASSERT(glyph_fb_init(&fb, 480, 320) == 0, "framebuffer allocated");
+    glyph_target_t target = { glyph_fb_push, &fb };
+
+    const char *text = "$ ls -la";
+    int16_t len = (int16_t)strlen(text);
+    size_t need = glyph_span_pixels(&atlas, len);
+    uint16_t *line = (uint16_t*)malloc(need * sizeof(uint16_t));
+    TEST_ASSERT(glyph_draw_span(&atlas, &target, 10, 20, text, len, line, need - 1) == 0, "short line buffer refused");
+    TEST_ASSERT(glyph_draw_span(&atlas, &target, 10, 20, text, len, line, need) == need, "span drawn");
+    TEST_ASSERT(fb.pushes == 1, "whole span is one push");
+
+    int ok = 1;
+    for (int16_t i = 0; i < len && ok; i++) {
+        const uint16_t *g = glyph_atlas_glyph(&atlas, text[i]);
+        for (int y = 0; y < atlas.glyph_h && ok; y++) {
+            const uint16_t *fb_row = fb.pixels + (size_t)(20 + y) * fb.width + 10 + i * atlas.glyph_w;
+            ok = memcmp(fb_row, g + y * atlas.glyph_w, (size_t)atlas.glyph_w * 2) == 0;
+        }
+    }
+    TEST_ASSERT(ok, "framebuffer holds each glyph in place");
+    TEST_ASSERT(fb.pixels[(size_t)20 * fb.width + 9] == 0, "nothing drawn left of the span");
+
+    // off the right edge gets clipped instead of wrapping
+    glyph_draw_span(&atlas, &target, 470, 0, text, len, line, need);
+    TEST_ASSERT(fb.pixels[(size_t)1 * fb.width + 0] == 0, "clipped at the framebuffer edge");
+
+    free(line);
+    glyph_fb_free(&fb);
+    glyph_atlas_free(&atlas);
+    printf("\n");
+}
+
+// like fake_column but with descenders, so the cell's bottom line isn't all background
+static uint8_t descender_column(void *ctx, char c, int col) {
+    (void)ctx;
+    return c == 'g' ? (uint8_t)(0x80 | (col & 1)) : fake_column(NULL, c, col);
+}
+
+void test_caret(void) {
+    printf("test_caret:\n");
+
+    glyph_atlas_t atlas;
+    memset(&atlas, 0, sizeof(atlas));
+    glyph_atlas_build(&atlas, 2, FG, BG, descender_column, NULL);
+    glyph_fb_t fb;
+    glyph_fb_init(&fb, 100, 40);
+    glyph_target_t target = { glyph_fb_push, &fb };
+    uint16_t line[2 * (glyph_base_w * 2) * (glyph_base_h * 2)];  // two cells at zoom 2
+    glyph_draw_span(&atlas, &target, 0, 0, "ag", 2, line, sizeof(line) / sizeof(line[0]));
+    uint16_t *clean = (uint16_t*)malloc((size_t)100 * 40 * sizeof(uint16_t));
+    memcpy(clean, fb.pixels, (size_t)100 * 40 * sizeof(uint16_t));
+
+    int16_t w = atlas.glyph_w, h = atlas.glyph_h;
+    glyph_caret_t caret;
+    memset(&caret, 0, sizeof(caret));
+    TEST_ASSERT(glyph_caret_place(&caret, &target, &atlas, 'g', w, 0, glyph_caret_max_w + 1, h, 0xF800) != 0,
+                "cell wider than the saved line refused");
+    uint32_t before = fb.pushes;
+    TEST_ASSERT(glyph_caret_place(&caret, &target, &atlas, 'g', w, 0, w, h, 0xF800) == 0, "caret placed");
+    TEST_ASSERT(fb.pushes - before == 1, "placing it is one push");
+    const uint16_t *under = fb.pixels + (size_t)(h - 1) * fb.width + w;
+    int ok = 1;
+    for (int16_t i = 0; i < w; i++) {
+        ok = ok && under[i] == 0xF800;
+    }
+    TEST_ASSERT(ok && under[-1] != 0xF800 && under[w] != 0xF800, "underline covers exactly its cell");
+
+    glyph_caret_hide(&caret, &target);
+    TEST_ASSERT(memcmp(fb.pixels, clean, (size_t)100 * 40 * sizeof(uint16_t)) == 0,
+                "hiding restores the descender underneath");
+    before = fb.pushes;
+    glyph_caret_hide(&caret, &target);
+    TEST_ASSERT(fb.pushes == before, "hiding twice does nothing");
+    glyph_caret_show(&caret, &target);
+    TEST_ASSERT(under[0] == 0xF800, "blinks back on");
+
+    // moving: put the old line back, place on the next cell
+    glyph_caret_hide(&caret, &target);
+    glyph_caret_place(&caret, &target, &atlas, 'a', 0, 0, w, h, 0xF800);
+    glyph_caret_hide(&caret, &target);
+    TEST_ASSERT(memcmp(fb.pixels, clean, (size_t)100 * 40 * sizeof(uint16_t)) == 0, "moving leaves no trail");
+
+    glyph_caret_forget(&caret);
+    before = fb.pushes;
+    glyph_caret_show(&caret, &target);
+    TEST_ASSERT(fb.pushes == before, "forgotten caret draws nothing");
+
+    free(clean);
+    glyph_fb_free(&fb);
+    glyph_atlas_free(&atlas);
+    printf("\n");
+}
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// not a pass/fail check, prints how many full text rows per second the blitter composes
+void bench_rows(void) {
+    printf("bench_rows:\n");
+
+    glyph_fb_t fb;
+    glyph_fb_init(&fb, 480, 320);
+    glyph_target_t target = { glyph_fb_push, &fb };
+    char text[81];
+    for (int i = 0; i < 80; i++) {
+        text[i] = (char)(glyph_first + (i * 7) % glyph_count);
+    }
+    text[80] = '\0';
+
+    for (uint8_t zoom = 1; zoom <= glyph_max_zoom; zoom++) {
+        glyph_atlas_t atlas;
+        memset(&atlas, 0, sizeof(atlas));
+        glyph_atlas_build(&atlas, zoom, FG, BG, fake_column, NULL);
+        int16_t cols = (int16_t)(470 / atlas.glyph_w);
+        int16_t rows = (int16_t)(310 / atlas.glyph_h);
+        size_t need = glyph_span_pixels(&atlas, cols);
+        uint16_t *line = (uint16_t*)malloc(need * sizeof(uint16_t));
+
+        const int frames = 200;
+        double start = now_s();
+        for (int f = 0; f < frames; f++) {
+            for (int16_t r = 0; r < rows; r++) {
+                glyph_draw_span(&atlas, &target, 5, (int16_t)(5 + r * atlas.glyph_h), text, cols, line, need);
+            }
+        }
+        double took = now_s() - start;
+        double per_s = took > 0 ? (frames * rows) / took : 0;
+        printf("  zoom %u: %d cols x %d rows, %.0f rows/s\n", (unsigned)zoom, cols, rows, per_s);
+        TEST_ASSERT(per_s > 0, "benchmark ran");
+
+        free(line);
+        glyph_atlas_free(&atlas);
+    }
+    glyph_fb_free(&fb);
+    printf("\n");
+}
+
+int main(void) {
+    printf("[TERMINAL GLYPH TESTS]\n\n");
+
+    test_atlas();
+    test_span();
+    test_caret();
+    bench_rows();
+
+    printf("\n[TEST SUMMARY]\n");
+    printf("  Total: %d\n", test_count);
+    printf("  Passed: %d\n", test_passed);
+    printf("  Failed: %d\n", test_failed);
+
+    if (test_failed == 0) {
+        printf("\nAll tests passed!\n");
+        return 0;
+    } else {
+        printf("\nSome tests failed!\n");
+        return 1;
+    }
+}
@@ -0,0 +1,218 @@
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include "terminal.h"
+
+static void enter(terminal_state *term, const char *line) {
+    strncpy(term->input_line, line, terminal_cols - 1);
+    term->input_len = (uint8_t)strlen(term->input_line);
+    term->input_pos = term->input_len;
+    terminal_handle_enter(term);
+}
+
+// test 1: a line entered again moves to the newest spot instead of showing up twice
+void test_history_dedup(void) {
+    printf("  test_history_dedup... ");
+    init_terminal_system();
+    assert(terminal_history_count() == 0);
+    assert(terminal_history_add("ls") == 0);
+    assert(terminal_history_add("pwd") == 0);
+    assert(terminal_history_add("ls") == 0);
+    assert(terminal_history_add("") == -1);
+    assert(terminal_history_count() == 2);
+
+    uint32_t pos = terminal_history_live;
+    assert(strcmp(terminal_history_prev(&pos), "ls") == 0);
+    assert(strcmp(terminal_history_prev(&pos), "pwd") == 0);
+    assert(terminal_history_prev(&pos) == NULL);
+    assert(strcmp(terminal_history_next(&pos), "ls") == 0);
+    assert(terminal_history_next(&pos) == NULL && pos == terminal_history_live);
+
+    terminal_history_clear();
+    pos = terminal_history_live;
+    assert(terminal_history_count() == 0 && terminal_history_prev(&pos) == NULL);
+    printf("FUNCTIONAL\n");
+}
+
+// test 2: a full ring drops its oldest entries, the index keeps finding the rest
+void test_history_ring(void) {
+    printf("  test_history_ring... ");
+    init_terminal_system();
+    char line[32];
+    for (int i = 0; i < terminal_history_size + 10; i++) {
+        snprintf(line, sizeof(line), "cmd %d", i);
+        assert(terminal_history_add(line) == 0);
+    }
+    assert(terminal_history_count() == terminal_history_size);
+
+    // the oldest one still there comes back on top, one that dropped off is simply new again
+    assert(terminal_history_add("cmd 10") == 0);
+    assert(terminal_history_add("cmd 3") == 0);
+    assert(terminal_history_count() == terminal_history_size);
+    uint32_t pos = terminal_history_live;
+    assert(strcmp(terminal_history_prev(&pos), "cmd 3") == 0);
+    assert(strcmp(terminal_history_prev(&pos), "cmd 10") == 0);
+
+    int seen = 0;
+    pos = terminal_history_live;
+    const char *entry;
+    while ((entry = terminal_history_prev(&pos)) != NULL) {
+        assert(strcmp(entry, "cmd 11") != 0);  // pushed out by the two above
+        seen++;
+    }
+    assert(seen == terminal_history_size);
+
+    // the byte ordered view is sorted again on the first lookup after the pushes
+    const char *prev = terminal_history_sorted(0, NULL);
+    for (uint32_t i = 1; i < terminal_history_count(); i++) {
+        const char *next = terminal_history_sorted(i, NULL);
+        assert(strcmp(prev, next) < 0 && strcmp(next, "cmd 11") != 0);
+        prev = next;
+    }
+    assert(terminal_history_add("cmd 10") == 0);
+    assert(terminal_history_sorted(terminal_history_count(), NULL) == NULL);
+    printf("FUNCTIONAL\n");
+}
+
+// test 3: every window sees the same history but walks it on its own
+void test_history_windows(void) {
+    printf("  test_history_windows... ");
+    init_terminal_system();
+    terminal_set_initial_output_suppressed(1);
+    new_terminal();
+    terminal_state *a = get_active_terminal();
+    new_terminal();
+    terminal_state *b = get_active_terminal();
+    terminal_set_initial_output_suppressed(0);
+    assert(a != NULL && b != NULL && a != b);
+
+    enter(a, "echo one");
+    enter(b, "echo two");
+    assert(terminal_history_count() == 2);
+
+    terminal_handle_arrow_up(a);
+    terminal_handle_arrow_up(a);
+    assert(strcmp(a->input_line, "echo one") == 0);
+    terminal_handle_arrow_up(b);
+    assert(strcmp(b->input_line, "echo two") == 0);
+
+    // a line a enters lands in b's history too, b's own position stays
+    terminal_handle_arrow_down(a);
+    assert(strcmp(a->input_line, "echo two") == 0);
+    terminal_handle_arrow_down(a);
+    assert(a->input_len == 0 && a->history_pos == terminal_history_live);
+    enter(a, "echo one");
+    terminal_handle_arrow_down(b);
+    assert(strcmp(b->input_line, "echo one") == 0);
+
+    close_terminal();
+    close_terminal();
+    printf("FUNCTIONAL\n");
+}
+
+static void press(key_code key, uint8_t modifiers) {
+    key_event evt = { key, modifiers };
+    terminal_handle_key_event(evt);
+}
+
+// test 4: ctrl-r finds the newest line containing the query, again steps to older ones
+void test_history_search(void) {
+    printf("  test_history_search... ");
+    init_terminal_system();
+    char line[32];
+    for (int i = 0; i < terminal_history_size; i++) {
+        snprintf(line, sizeof(line), "echo %d", i);
+        assert(terminal_history_add(line) == 0);
+    }
+    assert(terminal_history_add("ls /home/dir1") == 0);
+    assert(terminal_history_add("cat /home/file1.txt") == 0);
+
+    uint32_t pos = terminal_history_live;
+    assert(strcmp(terminal_history_search("home", &pos), "cat /home/file1.txt") == 0);
+    assert(strcmp(terminal_history_search("home", &pos), "ls /home/dir1") == 0);
+    assert(terminal_history_search("home", &pos) == NULL);
+    pos = terminal_history_live;
+    assert(strcmp(terminal_history_search("o 1", &pos), "echo 1999") == 0);
+    pos = terminal_history_live;
+    assert(terminal_history_search("echo 2048", &pos) == NULL);
+
+    terminal_set_initial_output_suppressed(1);
+    new_terminal();
+    terminal_set_initial_output_suppressed(0);
+    terminal_state *term = get_active_terminal();
+    assert(term != NULL);
+    press(key_r, mod_ctrl);
+    assert(term->search_active);
+    press(key_d, 0);
+    press(key_i, 0);
+    press(key_r, 0);
+    assert(strcmp(terminal_history_at(term->search_pos), "ls /home/dir1") == 0);
+    press(key_x, 0);
+    assert(term->search_failed);
+    assert(strcmp(terminal_history_at(term->search_pos), "ls /home/dir1") == 0);
+    for (int i = 0; i < 4; i++) {
+        press(key_backspace, 0);
+    }
+    press(key_h, 0);
+    assert(!term->search_failed);
+    assert(strcmp(terminal_history_at(term->search_pos), "cat /home/file1.txt") == 0);
+    press(key_r, mod_ctrl);
+    assert(strcmp(terminal_history_at(term->search_pos), "ls /home/dir1") == 0);
+    press(key_right, 0);
+    assert(!term->search_active && strcmp(term->input_line, "ls /home/dir1") == 0);
+
+    // esc leaves the line as it was
+    press(key_r, mod_ctrl);
+    press(key_c, 0);
+    press(key_a, 0);
+    press(key_esc, 0);
+    assert(!term->search_active && strcmp(term->input_line, "ls /home/dir1") == 0);
+    close_terminal();
+    printf("FUNCTIONAL\n");
+}
+
+// test 5: the search reaches lines the ring dropped (the loaded file), short needles too, each line once
+void test_history_search_log(void) {
+    printf("  test_history_search_log... ");
+    init_terminal_system();
+    assert(terminal_history_add("git commit -m fix") == 0);
+    assert(terminal_history_add("make flash") == 0);
+    char line[32];
+    for (int i = 0; i < terminal_history_size; i++) {
+        snprintf(line, sizeof(line), "echo %d", i);
+        assert(terminal_history_add(line) == 0);
+    }
+    assert(terminal_history_count() == terminal_history_size);
+
+    uint32_t pos = terminal_history_live;
+    assert(strcmp(terminal_history_search("flash", &pos), "make flash") == 0);
+    assert(strcmp(terminal_history_at(pos), "make flash") == 0);
+    assert(strcmp(terminal_history_search("git", &pos), "git commit -m fix") == 0);
+    pos = terminal_history_live;
+    assert(strcmp(terminal_history_search("fl", &pos), "make flash") == 0);
+    pos = terminal_history_live;
+    assert(strcmp(terminal_history_search("k", &pos), "make flash") == 0);
+    assert(terminal_history_search("k", &pos) == NULL);
+
+    // entered again it's found at the new spot only
+    assert(terminal_history_add("make flash") == 0);
+    pos = terminal_history_live;
+    assert(strcmp(terminal_history_search("flash", &pos), "make flash") == 0);
+    assert(terminal_history_search("flash", &pos) == NULL);
+
+    terminal_history_clear();
+    pos = terminal_history_live;
+    assert(terminal_history_search("git", &pos) == NULL);
+    printf("FUNCTIONAL\n");
+}
+
+int main(void) {
+    printf("[TERMINAL HISTORY TESTS]\n");
+    test_history_dedup();
+    test_history_ring();
+    test_history_windows();
+    test_history_search();
+    test_history_search_log();
+    terminal_history_free();
+    return 0;
+}
@@ -99,7 +99,7 @@ void test_key_enter(void) {
     // input should be cleared and added to history
     assert(term->input_pos == 0);
     assert(term->input_len == 0);
-    assert(term->history_count > 0);
+    assert(terminal_history_count() > 0);
     
     printf("FUNCTIONAL\n");
     teardown_terminal_input();
@@ -158,7 +158,7 @@ void test_key_arrows(void) {
     term->input_len = strlen("command2");
     terminal_handle_enter(term);
     
-    assert(term->history_count == 2);
+    assert(terminal_history_count() == 2);
     
     // press up arrow
     key_event evt;
@@ -199,6 +199,43 @@ void test_key_special_chars(void) {
     teardown_terminal_input();
 }
 
+// test 7: editing the input line only dirties the prompt row
+void test_key_dirty_rows(void) {
+    setup_terminal_input();
+    printf("  test_key_dirty_rows... ");
+    
+    terminal_state *term = get_active_terminal();
+    assert(term != NULL);
+    assert(term->painted_valid == 0);  // never painted, first paint is a full one
+    
+    terminal_clear_dirty(term);
+    term->painted_valid = 1;
+    uint8_t row = term->cursor_row;
+    terminal_handle_key(term, 'x');
+    assert(terminal_row_is_dirty(term, row));
+    for (int r = 0; r < terminal_rows; r++) {
+        if (r != row) {
+            assert(!terminal_row_is_dirty(term, r));
+        }
+    }
+    
+    // cursor movement alone doesn't touch the buffer
+    terminal_clear_dirty(term);
+    terminal_handle_arrow_left(term);
+    assert(!terminal_row_is_dirty(term, row));
+    
+    terminal_write_string(term, "\nout");
+    assert(terminal_row_is_dirty(term, row + 1));
+    assert(term->painted_valid == 1);
+    
+    terminal_clear(term);
+    assert(term->painted_valid == 0);
+    assert(terminal_row_is_dirty(term, terminal_rows - 1));
+    
+    printf("FUNCTIONAL\n");
+    teardown_terminal_input();
+}
+
 int main(void) {
     printf("[TERMINAL INPUT TESTS]\n");
     test_key_to_char_basic();
@@ -207,6 +244,7 @@ int main(void) {
     test_key_backspace();
     test_key_arrows();
     test_key_special_chars();
+    test_key_dirty_rows();
     return 0;
 }
 
@@ -0,0 +1,242 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "terminal.h"
+#include "builtins.h"
+#include "shell_codes.h"
+
+extern int vfs_stub_register_file(const char *path, const char *content);
+
+// what went into the "count" stage so far, "spam" checks it while it is still writing
+static size_t spam_written = 0;
+static size_t count_fed = 0;
+static size_t spam_ahead = 0;
+
+static int cmd_spam(terminal_state *term, int argc, char **argv) {
+    int lines = argc > 1 ? atoi(argv[1]) : 1;
+    char line[32];
+    for (int i = 0; i < lines; i++) {
+        int len = snprintf(line, sizeof(line), "line %d%s\n", i, i % 10 == 0 ? " x" : "");
+        terminal_write_n(term, line, (size_t)len);
+        spam_written += (size_t)len;
+        if (spam_written - count_fed > spam_ahead) {
+            spam_ahead = spam_written - count_fed;
+        }
+    }
+    return SHELL_OK;
+}
+
+static int count_open(terminal_state *term, void *state, int argc, char **argv) {
+    (void)term;
+    (void)state;
+    (void)argc;
+    (void)argv;
+    return SHELL_OK;
+}
+
+static int count_feed(terminal_state *term, void *state, const char *buf, size_t len) {
+    (void)term;
+    (void)state;
+    (void)buf;
+    count_fed += len;
+    return SHELL_OK;
+}
+
+static int count_close(terminal_state *term, void *state) {
+    (void)state;
+    char out[32];
+    snprintf(out, sizeof(out), "%lu\n", (unsigned long)count_fed);
+    terminal_write_string(term, out);
+    return SHELL_OK;
+}
+
+static int cmd_count(terminal_state *term, int argc, char **argv) {
+    (void)term;
+    (void)argc;
+    (void)argv;
+    return SHELL_ERR;  // only runs in a pipeline
+}
+
+static const builtin_filter count_filter = { 0, count_open, count_feed, count_close };
+static const builtin_cmd count_def = { "count", cmd_count, "count piped bytes", &count_filter, 0 };
+
+// prints how much piped input it was handed whole
+static int cmd_peek(terminal_state *term, int argc, char **argv) {
+    (void)argc;
+    (void)argv;
+    char out[32];
+    snprintf(out, sizeof(out), "%s %lu\n", term->pipe_input != NULL ? "whole" : "none",
+             (unsigned long)term->pipe_input_len);
+    terminal_write_string(term, out);
+    return SHELL_OK;
+}
+
+static const builtin_cmd slurp_def = { "slurp", cmd_peek, "reads piped input whole", NULL, 1 };
+
+static terminal_state *setup_pipe(void) {
+    builtins_init();
+    builtins_register("spam", cmd_spam, "write numbered lines");
+    builtins_register_descriptor(&count_def);
+    builtins_register("peek", cmd_peek, "ignores piped input");
+    builtins_register_descriptor(&slurp_def);
+    init_terminal_system();
+    terminal_set_initial_output_suppressed(1);
+    new_terminal();
+    terminal_set_initial_output_suppressed(0);
+    terminal_state *term = get_active_terminal();
+    assert(term != NULL);
+    return term;
+}
+
+// runs line and returns what it printed, caller frees
+static char *run(terminal_state *term, const char *line) {
+    command_tokens_t tokens;
+    terminal_parse_command(line, &tokens);
+    terminal_capture_start();
+    if (tokens.has_pipe) {
+        terminal_execute_pipeline(term, &tokens);
+    } else {
+        terminal_execute_command(term, &tokens);
+    }
+    char *out = terminal_capture_stop(NULL);
+    assert(out != NULL);
+    return out;
+}
+
+// test 1: every '|' starts a stage
+void test_pipe_parse(void) {
+    printf("  test_pipe_parse... ");
+    command_tokens_t tokens;
+    terminal_parse_command("cat a | grep -i x | wc -l", &tokens);
+    assert(tokens.has_pipe && tokens.pipe_count == 2);
+    assert(tokens.pipe_pos == 2);
+    assert(tokens.pipe_positions[0] == 2 && tokens.pipe_positions[1] == 5);
+    assert(tokens.token_count == 7);
+    printf("FUNCTIONAL\n");
+}
+
+// test 2: three stages, filters and a command that takes its input whole mixed
+void test_pipe_stages(void) {
+    printf("  test_pipe_stages... ");
+    terminal_state *term = setup_pipe();
+    char *out = run(term, "spam 100 | grep x | wc -l");
+    assert(strcmp(out, "10\n") == 0);
+    free(out);
+    out = run(term, "spam 3 | cat | grep -n line | cat");
+    assert(strcmp(out, "1:line 0 x\n2:line 1\n3:line 2\n") == 0);
+    free(out);
+    out = run(term, "echo a b | wc");
+    assert(strcmp(out, "1 2 4\n") == 0);
+    free(out);
+
+    out = run(term, "spam 1 | nope");
+    assert(strstr(out, "unknown command: nope") != NULL);
+    free(out);
+    out = run(term, "spam 1 | | wc");
+    assert(strcmp(out, "Invalid pipe syntax\n") == 0);
+    free(out);
+    out = run(term, "echo 1 | cat | cat | cat | cat | cat | cat | cat | cat");
+    assert(strcmp(out, "pipe: too many commands\n") == 0);
+    free(out);
+    close_terminal();
+    printf("FUNCTIONAL\n");
+}
+
+// test 3: the producer never gets more than one buffer ahead of the stage it feeds
+void test_pipe_streaming(void) {
+    printf("  test_pipe_streaming... ");
+    terminal_state *term = setup_pipe();
+    spam_written = 0;
+    count_fed = 0;
+    spam_ahead = 0;
+    char *out = run(term, "spam 20000 | count");
+    char expect[32];
+    snprintf(expect, sizeof(expect), "%lu\n", (unsigned long)spam_written);
+    assert(strcmp(out, expect) == 0);
+    free(out);
+    printf("[%lu bytes, at most %lu ahead] ", (unsigned long)spam_written, (unsigned long)spam_ahead);
+    assert(spam_written > 100000);
+    assert(spam_ahead <= terminal_pipe_buffer_size);
+    close_terminal();
+    printf("FUNCTIONAL\n");
+}
+
+// test 4: redirections come out of the tokens, < feeds the first stage
+void test_pipe_redirect(void) {
+    printf("  test_pipe_redirect... ");
+    command_tokens_t tokens;
+    terminal_parse_command("grep -n x < in.txt | wc -l >> out.txt 2>err", &tokens);
+    assert(tokens.token_count == 5 && tokens.pipe_count == 1 && tokens.pipe_positions[0] == 3);
+    assert(strcmp(tokens.redirect_in, "in.txt") == 0);
+    assert(strcmp(tokens.redirect_out, "out.txt") == 0 && tokens.redirect_out_append);
+    assert(strcmp(tokens.redirect_err, "err") == 0 && !tokens.redirect_err_append);
+    assert(!tokens.redirect_invalid);
+    terminal_parse_command("ls >", &tokens);
+    assert(tokens.redirect_invalid && tokens.token_count == 1);
+
+    terminal_state *term = setup_pipe();
+    assert(vfs_stub_register_file("/lines.txt", "one x\ntwo\nthree x\n"));
+    char *out = run(term, "grep x < /lines.txt");
+    assert(strcmp(out, "one x\nthree x\n") == 0);
+    free(out);
+    out = run(term, "wc -l < /lines.txt");
+    assert(strcmp(out, "3\n") == 0);
+    free(out);
+    out = run(term, "cat < /lines.txt | grep -n t");
+    assert(strcmp(out, "2:two\n3:three x\n") == 0);
+    free(out);
+    out = run(term, "cat < /missing.txt");
+    assert(strstr(out, "missing.txt: no such file") != NULL);
+    free(out);
+    out = run(term, "echo hi >");
+    assert(strstr(out, "syntax error") != NULL);
+    free(out);
+
+    // no command, the redirect alone is still checked
+    terminal_parse_command("> /new.txt", &tokens);
+    assert(tokens.token_count == 0 && terminal_redirect_has(&tokens));
+    terminal_parse_command("", &tokens);
+    assert(!terminal_redirect_has(&tokens));
+    out = run(term, "< /missing.txt");
+    assert(strstr(out, "missing.txt: no such file") != NULL);
+    free(out);
+    out = run(term, ">");
+    assert(strstr(out, "syntax error") != NULL);
+    free(out);
+    close_terminal();
+    printf("FUNCTIONAL\n");
+}
+
+// test 5: only a command that reads pipe_input gets the input kept whole, the rest never see it
+void test_pipe_unread_input(void) {
+    printf("  test_pipe_unread_input... ");
+    terminal_state *term = setup_pipe();
+    char *out = run(term, "spam 20000 | peek");
+    assert(strcmp(out, "none 0\n") == 0);
+    free(out);
+    out = run(term, "spam 20000 | echo x");
+    assert(strcmp(out, "x\n") == 0);
+    free(out);
+    out = run(term, "spam 2 | slurp");
+    assert(strcmp(out, "whole 16\n") == 0);
+    free(out);
+
+    // a filter that reads files with these arguments drops the input too
+    assert(vfs_stub_register_file("/lines.txt", "one x\ntwo\nthree x\n"));
+    out = run(term, "spam 20000 | grep x /lines.txt");
+    assert(strcmp(out, "one x\nthree x\n") == 0);
+    free(out);
+    close_terminal();
+    printf("FUNCTIONAL\n");
+}
+
+int main(void) {
+    printf("[TERMINAL PIPE TESTS]\n");
+    test_pipe_parse();
+    test_pipe_stages();
+    test_pipe_streaming();
+    test_pipe_unread_input();
+    test_pipe_redirect();
+    return 0;
+}
@@ -0,0 +1,168 @@
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include "terminal.h"
+#include "terminal_glyphs.h"
+#include "boot_tft_host.h"
+
+// golden frame of test_render_golden, only valid for the emulator's stand-in font
+#define golden_frame_hash 0x0630f7b5u
+
+static terminal_state *setup_render(void) {
+    assert(boot_tft_host_init(boot_tft_host_width, boot_tft_host_height) == 0);
+    init_terminal_system();
+    terminal_set_initial_output_suppressed(1);
+    new_terminal();
+    terminal_set_initial_output_suppressed(0);
+    terminal_state *term = get_active_terminal();
+    assert(term != NULL);
+    // the layout code only places windows on the device, same spot as its first window
+    term->x = 5;
+    term->y = 5;
+    term->width = boot_tft_host_width - 10;
+    term->height = boot_tft_host_height - 10;
+    terminal_clear(term);
+    return term;
+}
+
+static void frame(boot_tft_stats_t *stats) {
+    boot_tft_host_take_stats(NULL);
+    terminal_render_flush();
+    boot_tft_host_take_stats(stats);
+}
+
+// types at the prompt, a frame per key like the keyboard handler on the device
+static void type(terminal_state *term, const char *keys, boot_tft_stats_t *stats) {
+    boot_tft_host_take_stats(NULL);
+    while (*keys) {
+        terminal_handle_key(term, *keys++);
+        terminal_render_request(term);
+        terminal_render_flush();
+    }
+    boot_tft_host_take_stats(stats);
+}
+
+// test 1: a full frame covers the panel once, a frame with nothing new costs nothing
+void test_render_full_frame(void) {
+    printf("  test_render_full_frame... ");
+    setup_render();
+    boot_tft_stats_t stats;
+    terminal_render_request_all();
+    frame(&stats);
+    uint32_t panel = (uint32_t)boot_tft_host_width * boot_tft_host_height;
+    printf("[%u px, %u fills, %u transfers] ", stats.pixels, stats.fills, stats.transfers);
+    assert(stats.pixels >= panel);
+    assert(stats.pixels < 3 * panel);
+    assert(stats.texts == 0);  // all text goes through the glyph atlas
+    assert(boot_tft_host_pixel(0, 0) == 0xFFFF);
+
+    frame(&stats);
+    assert(stats.pixels == 0 && stats.fills == 0 && stats.transfers == 0);
+
+    close_terminal();
+    boot_tft_host_free();
+    printf("FUNCTIONAL\n");
+}
+
+// test 2: a keystroke sends about one cell, a caret move only the lines under the two carets
+void test_render_keystroke(void) {
+    printf("  test_render_keystroke... ");
+    terminal_state *term = setup_render();
+    boot_tft_stats_t stats;
+    terminal_render_request_all();
+    frame(&stats);
+
+    type(term, "x", &stats);
+    uint32_t zoom = terminal_get_zoom();
+    uint32_t cell = glyph_base_w * glyph_base_h * zoom * zoom;
+    printf("[key %u px, %u transfers] ", stats.pixels, stats.transfers);
+    assert(stats.pixels > 0);
+    assert(stats.pixels <= 3 * cell);
+    assert(stats.fills == 0 && stats.commands == 0);
+
+    terminal_handle_arrow_left(term);
+    terminal_render_request(term);
+    frame(&stats);
+    printf("[caret %u px, %u transfers] ", stats.pixels, stats.transfers);
+    assert(stats.pixels > 0);
+    assert(stats.pixels <= 2 * glyph_base_w * zoom);
+    assert(stats.fills == 0);
+
+    close_terminal();
+    boot_tft_host_free();
+    printf("FUNCTIONAL\n");
+}
+
+// test 3: a known screen renders to the same pixels every time, however it got there
+void test_render_golden(void) {
+    printf("  test_render_golden... ");
+    terminal_state *term = setup_render();
+    boot_tft_stats_t stats;
+    terminal_write_line(term, "tilixi golden frame");
+    type(term, "echo 42", &stats);
+    terminal_render_request_all();
+    frame(&stats);
+
+    uint32_t hash = boot_tft_host_hash();
+    printf("[hash 0x%08x] ", hash);
+    if (hash != golden_frame_hash) {
+        boot_tft_host_dump_ppm("build/test_terminal_render.ppm");
+        printf("mismatch, frame written to build/test_terminal_render.ppm\n");
+        fflush(stdout);
+    }
+    assert(hash == golden_frame_hash);
+
+    // same screen again, one frame per keystroke from an empty window
+    setup_render();
+    terminal_render_request_all();
+    frame(&stats);
+    terminal_write_line(term, "tilixi golden frame");
+    terminal_render_request(term);
+    frame(&stats);
+    type(term, "echo 4", &stats);
+    type(term, "2", &stats);
+    assert(boot_tft_host_hash() == golden_frame_hash);
+
+    close_terminal();
+    boot_tft_host_free();
+    printf("FUNCTIONAL\n");
+}
+
+// test 4: paging back redraws the rows from the scrollback, paging forward restores the frame
+void test_render_scrollback(void) {
+    printf("  test_render_scrollback... ");
+    terminal_state *term = setup_render();
+    boot_tft_stats_t stats;
+    char line[32];
+    for (int i = 0; i < terminal_rows + 20; i++) {
+        snprintf(line, sizeof(line), "line %d", i);
+        terminal_write_line(term, line);
+    }
+    terminal_render_request_all();
+    frame(&stats);
+    uint32_t live = boot_tft_host_hash();
+
+    terminal_scroll_back();
+    assert(term->view_offset > 0);
+    frame(&stats);
+    printf("[page %u px, %u fills] ", stats.pixels, stats.fills);
+    assert(stats.fills == 0);  // rows are diffed, the window itself is not cleared
+    assert(boot_tft_host_hash() != live);
+
+    terminal_scroll_forward();
+    frame(&stats);
+    assert(boot_tft_host_hash() == live);
+
+    close_terminal();
+    boot_tft_host_free();
+    printf("FUNCTIONAL\n");
+}
+
+int main(void) {
+    printf("[TERMINAL RENDER TESTS]\n");
+    test_render_full_frame();
+    test_render_keystroke();
+    test_render_golden();
+    test_render_scrollback();
+    return 0;
+}
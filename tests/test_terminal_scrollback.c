@@ -0,0 +1,160 @@
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include "terminal.h"
+#include "terminal_glyphs.h"
+
+static terminal_state *setup_scrollback(void) {
+    init_terminal_system();
+    terminal_set_initial_output_suppressed(1);
+    new_terminal();
+    terminal_set_initial_output_suppressed(0);
+    terminal_state *term = get_active_terminal();
+    assert(term != NULL);
+    terminal_clear(term);
+    return term;
+}
+
+static void write_lines(terminal_state *term, int from, int to) {
+    char line[32];
+    for (int i = from; i < to; i++) {
+        snprintf(line, sizeof(line), "line %d", i);
+        terminal_write_line(term, line);
+    }
+}
+
+static int row_is(const char *row, const char *text) {
+    size_t len = strlen(text);
+    return row != NULL && memcmp(row, text, len) == 0 && row[len] == ' ';
+}
+
+// test 1: scrolling moves the ring, the row that fell off is the newest scrollback row
+void test_scrollback_ring(void) {
+    printf("  test_scrollback_ring... ");
+    terminal_state *term = setup_scrollback();
+    assert(term->scrollback == NULL);  // nothing scrolled yet, nothing allocated
+    write_lines(term, 0, terminal_rows + 10);
+
+    assert(term->cursor_row == terminal_rows);
+    assert(term->scrolled_rows == 10);
+    assert(term->row_base == 10);
+    assert(row_is(terminal_row(term, 0), "line 10"));
+    assert(row_is(terminal_row(term, terminal_rows - 1), "line 69"));
+    assert(terminal_row(term, terminal_rows) == NULL && terminal_row(term, -1) == NULL);
+
+    assert(term->scrollback_count == 10);
+    assert(row_is(terminal_view_row(term, -1), "line 9"));
+    assert(row_is(terminal_view_row(term, -10), "line 0"));
+    assert(terminal_view_row(term, -11) == NULL);
+
+    // the next write scrolls once more and lands on a blank last row
+    terminal_write_string(term, "x");
+    assert(row_is(terminal_row(term, terminal_rows - 1), "x"));
+    assert(row_is(terminal_view_row(term, -1), "line 10"));
+
+    // clear empties the grid but the history stays
+    terminal_clear(term);
+    assert(term->row_base == 0 && term->scrollback_count == 11);
+    assert(row_is(terminal_row(term, 0), ""));
+
+    close_terminal();
+    assert(term->scrollback == NULL && term->scrollback_count == 0);
+    printf("FUNCTIONAL\n");
+}
+
+// test 2: a full scrollback drops its oldest rows
+void test_scrollback_full(void) {
+    printf("  test_scrollback_full... ");
+    terminal_state *term = setup_scrollback();
+    write_lines(term, 0, terminal_scrollback_rows + terminal_rows + 5);
+    assert(term->scrollback_count == terminal_scrollback_rows);
+    assert(row_is(terminal_view_row(term, -terminal_scrollback_rows), "line 5"));
+    assert(row_is(terminal_view_row(term, -1), "line 504"));
+    assert(terminal_view_row(term, -terminal_scrollback_rows - 1) == NULL);
+    close_terminal();
+    printf("FUNCTIONAL\n");
+}
+
+// test 3: paging stays inside the history, output and keys go back to the live grid
+void test_scrollback_view(void) {
+    printf("  test_scrollback_view... ");
+    terminal_state *term = setup_scrollback();
+    term->height = 10 + 20 * glyph_base_h * terminal_get_zoom();  // 20 text rows
+    write_lines(term, 0, 30);
+
+    // the cursor sits on row 30, 11 grid rows are above the window and nothing scrolled yet
+    terminal_scroll_back();
+    assert(term->view_offset == 11);
+    terminal_scroll_forward();
+    assert(term->view_offset == 0);
+    terminal_scroll_forward();
+    assert(term->view_offset == 0);
+
+    write_lines(term, 30, terminal_rows + 40);
+    assert(term->scrollback_count == 40);
+    terminal_scroll_back();
+    assert(term->view_offset == 19);  // a page keeps one row
+    terminal_scroll_view(term, 1000);
+    assert(term->view_offset == 40 + terminal_rows + 1 - 20);
+
+    terminal_write_char(term, 'y');
+    assert(term->view_offset == 0);
+
+    terminal_scroll_back();
+    key_event evt = { key_a, 0 };
+    terminal_handle_key_event(evt);
+    assert(term->view_offset == 0);
+
+    close_terminal();
+    printf("FUNCTIONAL\n");
+}
+
+// test 4: the grid follows the window's cell area, rows that don't fit any more go to the scrollback
+void test_scrollback_grid_fit(void) {
+    printf("  test_scrollback_grid_fit... ");
+    terminal_state *term = setup_scrollback();
+    assert(term->buffer != NULL);
+    assert(term->grid_rows == terminal_rows && term->grid_cols == terminal_cols);  // no layout on the host
+    write_lines(term, 0, 30);
+
+    uint8_t zoom = terminal_get_zoom();
+    term->width = 10 + 40 * glyph_base_w * zoom;
+    term->height = 10 + 20 * glyph_base_h * zoom;
+    assert(terminal_grid_fit(term) == 0);
+    assert(term->grid_rows == 20 && term->grid_cols == 40);
+    assert(term->cursor_row == 19 && term->scrollback_count == 11);
+    assert(row_is(terminal_row(term, 0), "line 11"));
+    assert(row_is(terminal_row(term, 18), "line 29"));
+    assert(row_is(terminal_view_row(term, -1), "line 10"));
+
+    // output wraps at the window's width now
+    char wide[46];
+    memset(wide, 'x', 45);
+    wide[45] = '\0';
+    terminal_write_string(term, wide);
+    assert(memcmp(terminal_row(term, 18), wide, 40) == 0);
+    assert(row_is(terminal_row(term, 19), "xxxxx"));
+    assert(term->cursor_row == 19 && term->cursor_col == 5);
+
+    // a full window that grows takes its newest rows back out of the scrollback
+    term->width = 10 + terminal_cols * glyph_base_w * zoom;
+    term->height = 10 + 30 * glyph_base_h * zoom;
+    assert(terminal_grid_fit(term) == 0);
+    assert(term->grid_rows == 30 && term->grid_cols == terminal_cols);
+    assert(term->cursor_row == 29 && term->scrollback_count == 2);
+    assert(row_is(terminal_row(term, 0), "line 2"));
+    assert(memcmp(terminal_row(term, 28), wide, 40) == 0 && terminal_row(term, 28)[40] == ' ');
+
+    close_terminal();
+    assert(term->buffer == NULL && term->grid_rows == 0);
+    printf("FUNCTIONAL\n");
+}
+
+int main(void) {
+    printf("[TERMINAL SCROLLBACK TESTS]\n");
+    test_scrollback_ring();
+    test_scrollback_full();
+    test_scrollback_view();
+    test_scrollback_grid_fit();
+    return 0;
+}
@@ -0,0 +1,245 @@
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include "terminal.h"
+
+typedef struct {
+    int spans;
+    int cells;
+    int16_t last_col;
+    char last_text[terminal_cols + 1];
+    uint8_t last_attr;
+} span_log_t;
+
+static void log_span(void *ctx, int16_t row, int16_t col, const char *text, int16_t len, uint8_t attr) {
+    span_log_t *log = (span_log_t*)ctx;
+    (void)row;
+    log->spans++;
+    log->cells += len;
+    log->last_col = col;
+    log->last_attr = attr;
+    strncpy(log->last_text, text, terminal_cols);
+    log->last_text[terminal_cols] = '\0';
+}
+
+static void fill_cells(terminal_cell_t *cells, int16_t cols, const char *text, uint8_t attr) {
+    size_t len = strlen(text);
+    for (int16_t i = 0; i < cols; i++) {
+        cells[i].ch = (size_t)i < len ? text[i] : ' ';
+        cells[i].attr = attr;
+    }
+}
+
+static terminal_state *setup_shadow(void) {
+    init_terminal_system();
+    terminal_set_initial_output_suppressed(1);
+    new_terminal();
+    terminal_set_initial_output_suppressed(0);
+    return get_active_terminal();
+}
+
+// test 1: unknown grid draws everything once, then nothing
+void test_shadow_first_paint(void) {
+    printf("  test_shadow_first_paint... ");
+    terminal_state *term = setup_shadow();
+    assert(term != NULL);
+
+    assert(terminal_shadow_prepare(term, 4, 20, 1) == 1);
+    assert(terminal_shadow_prepare(term, 4, 20, 1) == 0);
+
+    terminal_cell_t cells[20];
+    fill_cells(cells, 20, "$ ls", terminal_attr_text);
+    span_log_t log = {0};
+    terminal_shadow_diff_row(term, 0, cells, log_span, &log);
+    assert(log.spans == 1 && log.cells == 20);
+
+    memset(&log, 0, sizeof(log));
+    terminal_shadow_diff_row(term, 0, cells, log_span, &log);
+    assert(log.spans == 0);
+
+    close_terminal();
+    printf("FUNCTIONAL\n");
+}
+
+// test 2: a typed character is one cell, far apart edits are separate spans
+void test_shadow_minimal_spans(void) {
+    printf("  test_shadow_minimal_spans... ");
+    terminal_state *term = setup_shadow();
+    terminal_shadow_prepare(term, 4, 20, 1);
+    terminal_shadow_fill(term, ' ', terminal_attr_text);
+
+    terminal_cell_t cells[20];
+    fill_cells(cells, 20, "$ l", terminal_attr_text);
+    span_log_t log = {0};
+    terminal_shadow_diff_row(term, 1, cells, log_span, &log);
+    assert(log.spans == 1 && log.cells == 3 && log.last_col == 0);  // the blank between is bridged
+
+    memset(&log, 0, sizeof(log));
+    fill_cells(cells, 20, "$ ls", terminal_attr_text);
+    terminal_shadow_diff_row(term, 1, cells, log_span, &log);
+    assert(log.spans == 1 && log.cells == 1 && log.last_col == 3 && strcmp(log.last_text, "s") == 0);
+
+    memset(&log, 0, sizeof(log));
+    fill_cells(cells, 20, "X ls          Y", terminal_attr_text);
+    terminal_shadow_diff_row(term, 1, cells, log_span, &log);
+    assert(log.spans == 2 && log.cells == 2);
+
+    // a one cell gap is cheaper to redraw than to start a new span
+    memset(&log, 0, sizeof(log));
+    fill_cells(cells, 20, "ABCs          Y", terminal_attr_text);
+    terminal_shadow_diff_row(term, 1, cells, log_span, &log);
+    assert(log.spans == 1 && strcmp(log.last_text, "ABC") == 0);
+
+    // exactly terminal_span_gap unchanged cells are bridged, one more splits the span
+    memset(&log, 0, sizeof(log));
+    fill_cells(cells, 20, "A  B", terminal_attr_text);
+    terminal_shadow_diff_row(term, 2, cells, log_span, &log);
+    assert(terminal_span_gap == 2);
+    assert(log.spans == 1 && log.cells == 4 && strcmp(log.last_text, "A  B") == 0);
+
+    memset(&log, 0, sizeof(log));
+    fill_cells(cells, 20, "A  B   C", terminal_attr_text);
+    terminal_shadow_diff_row(term, 2, cells, log_span, &log);
+    assert(log.spans == 1 && log.cells == 1 && log.last_col == 7);
+
+    memset(&log, 0, sizeof(log));
+    fill_cells(cells, 20, "D  E   F", terminal_attr_text);
+    terminal_shadow_diff_row(term, 2, cells, log_span, &log);
+    assert(log.spans == 2 && log.cells == 5 && log.last_col == 7 && strcmp(log.last_text, "F") == 0);
+
+    close_terminal();
+    printf("FUNCTIONAL\n");
+}
+
+// test 3: attr changes split spans, image cells are never drawn
+void test_shadow_attrs(void) {
+    printf("  test_shadow_attrs... ");
+    terminal_state *term = setup_shadow();
+    terminal_shadow_prepare(term, 2, 10, 1);
+    terminal_shadow_fill(term, ' ', terminal_attr_text);
+
+    terminal_cell_t cells[10];
+    fill_cells(cells, 10, "$ ca", terminal_attr_text);
+    cells[4].ch = 't';
+    cells[4].attr = terminal_attr_hint;
+    span_log_t log = {0};
+    terminal_shadow_diff_row(term, 0, cells, log_span, &log);
+    assert(log.spans == 2 && log.last_attr == terminal_attr_hint && log.last_col == 4);
+
+    // suggestion accepted, same char now drawn as text
+    memset(&log, 0, sizeof(log));
+    cells[4].attr = terminal_attr_text;
+    terminal_shadow_diff_row(term, 0, cells, log_span, &log);
+    assert(log.spans == 1 && log.cells == 1 && log.last_attr == terminal_attr_text);
+
+    // fastfetch rows: the bitmap columns are skipped, text after them still diffs
+    memset(&log, 0, sizeof(log));
+    fill_cells(cells, 10, "", terminal_attr_image);
+    fill_cells(cells + 6, 4, "os", terminal_attr_text);
+    terminal_shadow_diff_row(term, 1, cells, log_span, &log);
+    assert(log.spans == 1 && log.last_col == 6 && log.cells == 2);
+
+    // image gone, its cells are repainted
+    memset(&log, 0, sizeof(log));
+    fill_cells(cells, 10, "os", terminal_attr_text);
+    terminal_shadow_diff_row(term, 1, cells, log_span, &log);
+    assert(log.cells >= 6);
+
+    close_terminal();
+    printf("FUNCTIONAL\n");
+}
+
+// test 4: zoom or resize throws the old grid away, forgotten cells repaint
+void test_shadow_reset(void) {
+    printf("  test_shadow_reset... ");
+    terminal_state *term = setup_shadow();
+    terminal_shadow_prepare(term, 4, 20, 1);
+    terminal_shadow_fill(term, ' ', terminal_attr_text);
+    assert(terminal_shadow_prepare(term, 4, 20, 2) == 1);
+    assert(terminal_shadow_prepare(term, 2, 10, 2) == 1);
+    assert(term->shadow_rows == 2 && term->shadow_cols == 10);
+
+    terminal_cell_t cells[10];
+    fill_cells(cells, 10, "", terminal_attr_text);
+    span_log_t log = {0};
+    terminal_shadow_diff_row(term, 0, cells, log_span, &log);
+    assert(log.cells == 10);
+
+    // cursor underline drawn over a cell, forgetting it forces just that cell back
+    terminal_shadow_forget_cell(term, 0, 5);
+    memset(&log, 0, sizeof(log));
+    terminal_shadow_diff_row(term, 0, cells, log_span, &log);
+    assert(log.spans == 1 && log.cells == 1 && log.last_col == 5);
+
+    close_terminal();
+    assert(term->shadow == NULL);
+    printf("FUNCTIONAL\n");
+}
+
+// test 5: a hardware scroll moves the shadow with the panel, only new rows are unknown
+void test_shadow_scroll(void) {
+    printf("  test_shadow_scroll... ");
+    terminal_state *term = setup_shadow();
+    terminal_shadow_prepare(term, 4, 10, 1);
+
+    terminal_cell_t cells[10];
+    const char *lines[4] = { "one", "two", "three", "four" };
+    for (int16_t row = 0; row < 4; row++) {
+        fill_cells(cells, 10, lines[row], terminal_attr_text);
+        terminal_shadow_diff_row(term, row, cells, NULL, NULL);
+    }
+
+    terminal_shadow_scroll(term, 1);
+    span_log_t log = {0};
+    for (int16_t row = 0; row < 3; row++) {
+        fill_cells(cells, 10, lines[row + 1], terminal_attr_text);
+        terminal_shadow_diff_row(term, row, cells, log_span, &log);
+    }
+    assert(log.spans == 0);  // rows that moved up are already on the panel
+
+    fill_cells(cells, 10, "five", terminal_attr_text);
+    terminal_shadow_diff_row(term, 3, cells, log_span, &log);
+    assert(log.spans == 1 && log.cells == 10);  // incoming row is drawn whole, stale pixels included
+
+    // scrolling further than the window forgets everything
+    terminal_shadow_scroll(term, 9);
+    memset(&log, 0, sizeof(log));
+    terminal_shadow_diff_row(term, 0, cells, log_span, &log);
+    assert(log.cells == 10);
+
+    close_terminal();
+    printf("FUNCTIONAL\n");
+}
+
+// test 6: draws into a rotated scroll area land where the panel shows them
+void test_vscroll_map(void) {
+    printf("  test_vscroll_map... ");
+    assert(terminal_vscroll_map(50, 10, 0, 16) == 50);    // no scroll area
+    assert(terminal_vscroll_map(5, 10, 80, 16) == 5);     // above the area
+    assert(terminal_vscroll_map(95, 10, 80, 16) == 95);   // below it
+    assert(terminal_vscroll_map(10, 10, 80, 16) == 26);   // top row lives 2 rows down
+    assert(terminal_vscroll_map(74, 10, 80, 16) == 10);   // last rows wrap to the top
+    assert(terminal_vscroll_map(82, 10, 80, 16) == 18);
+
+    // the buffer counts rows scrolled off the top so the renderer can tell how far text moved
+    terminal_state *term = setup_shadow();
+    terminal_clear(term);
+    uint16_t before = term->scrolled_rows;
+    for (int i = 0; i < terminal_rows + 3; i++) {
+        terminal_write_line(term, "x");
+    }
+    assert((uint16_t)(term->scrolled_rows - before) == 3);  // the last newline only scrolls on the next write
+    close_terminal();
+    printf("FUNCTIONAL\n");
+}
+
+int main(void) {
+    printf("[TERMINAL SHADOW TESTS]\n");
+    test_shadow_first_paint();
+    test_shadow_minimal_spans();
+    test_shadow_attrs();
+    test_shadow_reset();
+    test_shadow_scroll();
+    test_vscroll_map();
+    return 0;
+}
@@ -0,0 +1,111 @@
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include "terminal.h"
+
+static terminal_state *setup_snapshot(void) {
+    init_terminal_system();
+    terminal_set_initial_output_suppressed(1);
+    new_terminal();
+    terminal_set_initial_output_suppressed(0);
+    assert(terminal_snapshot_init() == 0);
+    // drain whatever an earlier test left behind
+    while (terminal_snapshot_take() != NULL) {
+    }
+    return get_active_terminal();
+}
+
+// test 1: a publish hands the damaged window over and takes the damage with it
+void test_snapshot_publish_take(void) {
+    printf("  test_snapshot_publish_take... ");
+    terminal_state *term = setup_snapshot();
+    assert(term == &terminals[0]);
+    terminal_clear(term);
+    terminal_write_string(term, "hello");
+
+    assert(terminal_snapshot_publish(0x01, 0) == 0);
+    assert(!terminal_row_is_dirty(term, 0));
+    assert(term->painted_valid == 1);
+
+    const terminal_snapshot_t *snap = terminal_snapshot_take();
+    assert(snap != NULL);
+    assert(snap->damaged == 0x01 && !snap->full);
+    assert(snap->invalid == 0x01);  // cleared window was never painted
+    assert(memcmp(snap->windows[0].buffer, "hello", 5) == 0);
+    assert(terminal_row_is_dirty(&snap->windows[0], 0));
+    assert(snap->env.zoom == terminal_get_zoom());
+
+    // nothing new, nothing to take
+    assert(terminal_snapshot_take() == NULL);
+
+    close_terminal();
+    printf("FUNCTIONAL\n");
+}
+
+// test 2: a snapshot replaced before the render task took it loses no damage
+void test_snapshot_replaced(void) {
+    printf("  test_snapshot_replaced... ");
+    terminal_state *term = setup_snapshot();
+    terminal_clear(term);
+    terminal_snapshot_publish(0x01, 1);
+    terminal_snapshot_take();
+
+    terminal_write_string(term, "first");
+    terminal_snapshot_publish(0x01, 1);   // full repaint, never taken
+    terminal_newline(term);
+    terminal_newline(term);
+    terminal_write_string(term, "second");
+    terminal_snapshot_publish(0x00, 0);   // damage only went into the dropped one
+
+    const terminal_snapshot_t *snap = terminal_snapshot_take();
+    assert(snap != NULL);
+    assert(snap->full);
+    assert(snap->damaged & 0x01);
+    assert(terminal_row_is_dirty(&snap->windows[0], 0));
+    assert(memcmp(snap->windows[0].buffer + 2 * terminal_cols, "second", 6) == 0);
+    assert(terminal_snapshot_take() == NULL);
+
+    close_terminal();
+    printf("FUNCTIONAL\n");
+}
+
+// test 3: applying only replaces content, the copy keeps its own painted state
+void test_snapshot_apply(void) {
+    printf("  test_snapshot_apply... ");
+    terminal_state *term = setup_snapshot();
+    static terminal_state copy[max_windows];
+    memset(copy, 0, sizeof(copy));
+    copy[0].painted_valid = 1;
+    copy[0].painted_start_row = 7;
+    copy[0].shadow_rows = 12;
+    terminal_mark_row_dirty(&copy[0], 40);
+
+    terminal_clear(term);
+    terminal_snapshot_publish(0x01, 0);
+    terminal_snapshot_take();
+    terminal_write_string(term, "abc");
+    terminal_snapshot_publish(0x01, 0);
+    const terminal_snapshot_t *snap = terminal_snapshot_take();
+    assert(snap != NULL && snap->invalid == 0);
+
+    terminal_snapshot_apply(copy, snap);
+    assert(copy[0].active);
+    assert(memcmp(copy[0].buffer, "abc", 3) == 0);
+    assert(copy[0].width == term->width && copy[0].cursor_col == 3);
+    assert(copy[0].painted_valid == 1);
+    assert(copy[0].painted_start_row == 7 && copy[0].shadow_rows == 12);
+    assert(terminal_row_is_dirty(&copy[0], 0) && terminal_row_is_dirty(&copy[0], 40));
+    assert(!copy[1].active);  // windows outside the snapshot are left alone
+
+    close_terminal();
+    terminal_snapshot_free();
+    printf("FUNCTIONAL\n");
+}
+
+int main(void) {
+    printf("[TERMINAL SNAPSHOT TESTS]\n");
+    test_snapshot_publish_take();
+    test_snapshot_replaced();
+    test_snapshot_apply();
+    return 0;
+}
@@ -0,0 +1,302 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include "terminal.h"
+#include "vfs.h"
+#include "vfs_posix.h"
+#include "builtins.h"
+#include "shell_codes.h"
+
+// vfs_posix against a scratch directory under build/
+
+#define TEST_ROOT "build/test_vfs_posix_root"
+#define MANY_FILES 2000
+
+static int test_count = 0;
+static int test_passed = 0;
+static int test_failed = 0;
+
+#define TEST_ASSERT(cond, msg) \
+    do { \
+        test_count++; \
+        if (cond) { \
+            test_passed++; \
+            printf("  PASS: %s\n", msg); \
+        } else { \
+            test_failed++; \
+            printf("  FAIL: %s\n", msg); \
+            printf("    at %s:%d\n", __FILE__, __LINE__); \
+        } \
+    } while(0)
+
+static int count_entries(const char *path) {
+    vfs_node_t *dir = vfs_resolve(path);
+    if (dir == NULL) {
+        return -1;
+    }
+    vfs_dir_iter_t *iter = vfs_dir_iter_create_node(dir);
+    int count = 0;
+    while (iter != NULL && vfs_dir_iter_next(iter) > 0) {
+        count++;
+    }
+    if (iter != NULL) {
+        vfs_dir_iter_destroy(iter);
+    }
+    vfs_node_release(dir);
+    return count;
+}
+
+// depth first delete through the vfs itself
+static void remove_tree(const char *path) {
+    vfs_node_t *dir = vfs_resolve(path);
+    if (dir == NULL) {
+        return;
+    }
+    char names[64][64];
+    int found;
+    do {
+        found = 0;
+        vfs_dir_iter_t *iter = vfs_dir_iter_create_node(dir);
+        while (iter != NULL && found < 64 && vfs_dir_iter_next(iter) > 0) {
+            strncpy(names[found], iter->current_name, sizeof(names[found]) - 1);
+            names[found][sizeof(names[found]) - 1] = '\0';
+            found++;
+        }
+        if (iter != NULL) {
+            vfs_dir_iter_destroy(iter);
+        }
+        for (int i = 0; i < found; i++) {
+            char child[4160];
+            snprintf(child, sizeof(child), "%s/%s", strcmp(path, "/") == 0 ? "" : path, names[i]);
+            vfs_node_t *node = vfs_resolve(child);
+            if (node != NULL && node->type == VFS_NODE_DIR) {
+                vfs_node_release(node);
+                remove_tree(child);
+            } else if (node != NULL) {
+                vfs_node_release(node);
+            }
+            vfs_dir_remove_node(dir, names[i]);
+        }
+    } while (found > 0);
+    vfs_node_release(dir);
+}
+
+void test_mount(void) {
+    printf("test_mount:\n");
+
+    mkdir(TEST_ROOT, 0755);
+    TEST_ASSERT(vfs_posix_mount(TEST_ROOT) == VFS_EOK, "mount scratch directory");
+    remove_tree("/");
+    TEST_ASSERT(count_entries("/") == 0, "root starts empty");
+    TEST_ASSERT(vfs_posix_mount("build/does/not/exist") == VFS_ENOTDIR, "mount of missing dir fails");
+    vfs_posix_mount(TEST_ROOT);
+
+    vfs_node_t *up = vfs_resolve("/../..");
+    TEST_ASSERT(up != NULL && strcmp((const char*)up->backend_data, "/") == 0, ".. can not escape the root");
+    vfs_node_release(up);
+
+    printf("\n");
+}
+
+void test_ops(void) {
+    printf("test_ops:\n");
+
+    vfs_node_t *root = vfs_resolve("/");
+    vfs_node_t *etc = vfs_dir_create_node(root, "etc", VFS_NODE_DIR);
+    TEST_ASSERT(etc != NULL && etc->type == VFS_NODE_DIR, "create directory");
+
+    vfs_node_t *node = vfs_dir_create_node(etc, "motd", VFS_NODE_FILE);
+    TEST_ASSERT(node != NULL && node->type == VFS_NODE_FILE, "create file");
+    vfs_file_t *file = vfs_open_node(node, VFS_O_WRITE | VFS_O_TRUNC);
+    vfs_node_release(node);
+    TEST_ASSERT(file != NULL && vfs_write(file, "hello\n", 6) == 6, "write file");
+    vfs_close(file);
+
+    file = vfs_open("/etc/motd", VFS_O_WRITE | VFS_O_APPEND);
+    vfs_write(file, "world\n", 6);
+    vfs_close(file);
+    TEST_ASSERT(vfs_size("/etc/motd") == 12, "append");
+
+    char buf[32] = {0};
+    file = vfs_open("/etc/motd", VFS_O_READ);
+    TEST_ASSERT(vfs_seek(file, 6) == VFS_EOK && vfs_tell(file) == 6, "seek + tell");
+    TEST_ASSERT(vfs_read(file, buf, sizeof(buf)) == 6 && strcmp(buf, "world\n") == 0, "read from offset");
+    vfs_close(file);
+
+    TEST_ASSERT(vfs_dir_rename_node(etc, "motd", root, "motd.old") == VFS_EOK, "rename across dirs");
+    TEST_ASSERT(vfs_size("/motd.old") == 12 && vfs_resolve("/etc/motd") == NULL, "rename moved the file");
+    TEST_ASSERT(vfs_dir_rename_node(root, "motd.old", root, "etc") == VFS_EEXIST, "rename does not clobber");
+    TEST_ASSERT(vfs_dir_remove_node(root, "motd.old") == VFS_EOK, "remove file");
+    TEST_ASSERT(vfs_dir_remove_node(root, "motd.old") == VFS_ENOENT, "remove missing file");
+    TEST_ASSERT(vfs_dir_remove_node(root, "etc") == VFS_EOK, "remove empty directory");
+
+    vfs_node_release(etc);
+    vfs_node_release(root);
+    printf("\n");
+}
+
+void test_many_files(void) {
+    printf("test_many_files:\n");
+
+    vfs_node_t *root = vfs_resolve("/");
+    vfs_node_t *dir = vfs_dir_create_node(root, "many", VFS_NODE_DIR);
+    vfs_node_release(root);
+    int created = 0;
+    for (int i = 0; i < MANY_FILES; i++) {
+        char name[32];
+        snprintf(name, sizeof(name), "f%04d.txt", i);
+        vfs_node_t *node = vfs_dir_create_node(dir, name, VFS_NODE_FILE);
+        if (node != NULL) {
+            created++;
+            vfs_node_release(node);
+        }
+    }
+    vfs_node_release(dir);
+    TEST_ASSERT(created == MANY_FILES, "created 2000 files");
+    TEST_ASSERT(count_entries("/many") == MANY_FILES, "listed 2000 files");
+
+    printf("\n");
+}
+
+void test_shell_on_host_tree(void) {
+    printf("test_shell_on_host_tree:\n");
+
+    init_terminal_system();
+    builtins_init();
+    new_terminal();
+    terminal_state *term = get_active_terminal();
+
+    const char *lines[] = {
+        "mkdir /docs",
+        "cd /docs",
+        "touch notes.txt",
+        "mv notes.txt renamed.txt",
+        "ls",
+        "rm renamed.txt",
+        "cd /",
+        "rmdir /docs",
+    };
+    int ok = 1;
+    for (size_t i = 0; i < sizeof(lines) / sizeof(lines[0]); i++) {
+        command_tokens_t tokens;
+        terminal_parse_command(lines[i], &tokens);
+        builtin_cmd *cmd = builtins_find(tokens.tokens[0]);
+        if (cmd == NULL || cmd->handler(term, tokens.token_count, tokens.tokens) != SHELL_OK) {
+            printf("    command failed: %s\n", lines[i]);
+            ok = 0;
+        }
+    }
+    TEST_ASSERT(ok, "mkdir/cd/touch/mv/ls/rm/rmdir run on the host tree");
+    TEST_ASSERT(vfs_resolve("/docs") == NULL, "shell cleaned up after itself");
+
+    if (term->cwd != NULL) {
+        vfs_node_release(term->cwd);
+        term->cwd = NULL;
+    }
+    close_terminal();
+    printf("\n");
+}
+
+static void run_line(terminal_state *term, const char *line) {
+    command_tokens_t tokens;
+    terminal_parse_command(line, &tokens);
+    if (tokens.has_pipe) {
+        terminal_execute_pipeline(term, &tokens);
+    } else {
+        terminal_execute_command(term, &tokens);
+    }
+}
+
+static size_t read_file(const char *path, char *buf, size_t size) {
+    vfs_file_t *file = vfs_open(path, VFS_O_READ);
+    if (file == NULL) {
+        return 0;
+    }
+    ssize_t len = vfs_read(file, buf, size - 1);
+    vfs_close(file);
+    buf[len > 0 ? len : 0] = '\0';
+    return len > 0 ? (size_t)len : 0;
+}
+
+void test_redirect_on_host_tree(void) {
+    printf("test_redirect_on_host_tree:\n");
+
+    init_terminal_system();
+    builtins_init();
+    new_terminal();
+    terminal_state *term = get_active_terminal();
+    char buf[256];
+
+    uint8_t row = term->cursor_row;
+    uint8_t col = term->cursor_col;
+    run_line(term, "echo hello world > /out.txt");
+    run_line(term, "echo again >> /out.txt");
+    TEST_ASSERT(term->cursor_row == row && term->cursor_col == col, "redirected output never reaches the window");
+    read_file("/out.txt", buf, sizeof(buf));
+    TEST_ASSERT(strcmp(buf, "hello world\nagain\n") == 0, "> creates the file, >> appends to it");
+
+    run_line(term, "grep again < /out.txt > /out2.txt");
+    read_file("/out2.txt", buf, sizeof(buf));
+    TEST_ASSERT(strcmp(buf, "again\n") == 0, "< and > on the same command");
+
+    run_line(term, "cat /out.txt | wc -w > /out.txt");
+    read_file("/out.txt", buf, sizeof(buf));
+    TEST_ASSERT(strcmp(buf, "0\n") == 0, "> truncates before the pipeline runs");
+
+    run_line(term, "cat /missing.txt 2> /err.txt > /out.txt");
+    read_file("/err.txt", buf, sizeof(buf));
+    TEST_ASSERT(strstr(buf, "cat: /missing.txt: no such file or directory") != NULL, "2> takes the error message");
+    // only the shell's own "Command failed" line shows up
+    TEST_ASSERT(strstr(terminal_row(term, row), "missing.txt") == NULL, "errors went to the file, not the window");
+
+    // a redirect without a command truncates or creates the file, like sh
+    run_line(term, "> /out.txt");
+    vfs_node_t *node = vfs_resolve("/out.txt");
+    TEST_ASSERT(node != NULL && read_file("/out.txt", buf, sizeof(buf)) == 0, "> alone truncates");
+    if (node != NULL) {
+        vfs_node_release(node);
+    }
+    run_line(term, "> /empty.txt");
+    node = vfs_resolve("/empty.txt");
+    TEST_ASSERT(node != NULL, "> alone creates the file");
+    if (node != NULL) {
+        vfs_node_release(node);
+    }
+
+    run_line(term, "rm /empty.txt");
+    run_line(term, "rm /out.txt");
+    run_line(term, "rm /out2.txt");
+    run_line(term, "rm /err.txt");
+    TEST_ASSERT(vfs_resolve("/out.txt") == NULL, "cleaned up");
+    close_terminal();
+    printf("\n");
+}
+
+int main(void) {
+    printf("[VFS POSIX TESTS]\n\n");
+
+    test_mount();
+    test_ops();
+    test_many_files();
+    test_shell_on_host_tree();
+    test_redirect_on_host_tree();
+
+    remove_tree("/");
+    remove(TEST_ROOT);
+
+    printf("\n[TEST SUMMARY]\n");
+    printf("  Total: %d\n", test_count);
+    printf("  Passed: %d\n", test_passed);
+    printf("  Failed: %d\n", test_failed);
+
+    if (test_failed == 0) {
+        printf("\nAll tests passed!\n");
+        return 0;
+    } else {
+        printf("\nSome tests failed!\n");
+        return 1;
+    }
+}
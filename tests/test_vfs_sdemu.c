@@ -0,0 +1,318 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "terminal.h"
+#include "vfs.h"
+#include "sdemu.h"
+#include "builtins.h"
+#include "shell_codes.h"
+
+// runs the vfs + shell against a real FAT image through the SD emulator
+// and prints the simulated bus cost of each shell command
+
+#define TEST_IMAGE "build/test_vfs_sdemu.img"
+
+static int test_count = 0;
+static int test_passed = 0;
+static int test_failed = 0;
+
+#define TEST_ASSERT(cond, msg) \
+    do { \
+        test_count++; \
+        if (cond) { \
+            test_passed++; \
+            printf("  PASS: %s\n", msg); \
+        } else { \
+            test_failed++; \
+            printf("  FAIL: %s\n", msg); \
+            printf("    at %s:%d\n", __FILE__, __LINE__); \
+        } \
+    } while(0)
+
+static int write_file(const char *dir, const char *name, const char *content) {
+    vfs_node_t *parent = vfs_resolve(dir);
+    if (parent == NULL) {
+        return 0;
+    }
+    vfs_node_t *node = vfs_dir_create_node(parent, name, VFS_NODE_FILE);
+    vfs_node_release(parent);
+    if (node == NULL) {
+        return 0;
+    }
+    vfs_file_t *file = vfs_open_node(node, VFS_O_WRITE | VFS_O_TRUNC | VFS_O_CREATE);
+    vfs_node_release(node);
+    if (file == NULL) {
+        return 0;
+    }
+    size_t len = strlen(content);
+    ssize_t written = vfs_write(file, content, len);
+    vfs_close(file);
+    return written == (ssize_t)len;
+}
+
+static int read_file(const char *path, char *buf, size_t buf_len) {
+    vfs_file_t *file = vfs_open(path, VFS_O_READ);
+    if (file == NULL) {
+        return -1;
+    }
+    size_t total = 0;
+    while (total + 1 < buf_len) {
+        ssize_t n = vfs_read(file, buf + total, buf_len - 1 - total);
+        if (n <= 0) {
+            break;
+        }
+        total += (size_t)n;
+    }
+    buf[total] = '\0';
+    vfs_close(file);
+    return (int)total;
+}
+
+static int dir_contains(const char *path, const char *name, int *count) {
+    vfs_node_t *dir = vfs_resolve(path);
+    if (dir == NULL) {
+        return 0;
+    }
+    vfs_dir_iter_t *iter = vfs_dir_iter_create_node(dir);
+    int found = 0;
+    int entries = 0;
+    while (iter != NULL && vfs_dir_iter_next(iter) > 0) {
+        entries++;
+        if (strcmp(iter->current_name, name) == 0) {
+            found = 1;
+        }
+    }
+    if (iter != NULL) {
+        vfs_dir_iter_destroy(iter);
+    }
+    vfs_node_release(dir);
+    if (count != NULL) {
+        *count = entries;
+    }
+    return found;
+}
+
+void test_format_and_attach(void) {
+    printf("test_format_and_attach:\n");
+
+    TEST_ASSERT(sdemu_format(TEST_IMAGE, 16384) == VFS_EOK, "format 8MB FAT16 image");
+    TEST_ASSERT(sdemu_attach(TEST_IMAGE) == VFS_EOK, "attach image");
+    TEST_ASSERT(vfs_init() == VFS_EOK, "vfs_init with attached image");
+
+    vfs_node_t *root = vfs_resolve("/");
+    TEST_ASSERT(root != NULL && root->type == VFS_NODE_DIR, "root resolves as directory");
+    vfs_node_release(root);
+
+    int count = -1;
+    dir_contains("/", "nothing", &count);
+    TEST_ASSERT(count == 0, "fresh image has an empty root");
+
+    printf("\n");
+}
+
+void test_files_and_dirs(void) {
+    printf("test_files_and_dirs:\n");
+
+    vfs_node_t *root = vfs_resolve("/");
+    vfs_node_t *etc = vfs_dir_create_node(root, "etc", VFS_NODE_DIR);
+    TEST_ASSERT(etc != NULL && etc->type == VFS_NODE_DIR, "mkdir /etc");
+    vfs_node_release(etc);
+    vfs_node_t *home = vfs_dir_create_node(root, "home", VFS_NODE_DIR);
+    vfs_node_release(home);
+    vfs_node_release(root);
+
+    TEST_ASSERT(write_file("/etc", "passwd", "root:x:0:0\nuser:x:1000:1000\n"), "write /etc/passwd");
+
+    char buf[256];
+    int len = read_file("/etc/passwd", buf, sizeof(buf));
+    TEST_ASSERT(len == 28 && strcmp(buf, "root:x:0:0\nuser:x:1000:1000\n") == 0, "read back /etc/passwd");
+    TEST_ASSERT(vfs_size("/etc/passwd") == 28, "size of /etc/passwd");
+
+    // names that need long file name entries
+    home = vfs_resolve("/home");
+    vfs_node_t *cfg = vfs_dir_create_node(home, ".config", VFS_NODE_DIR);
+    TEST_ASSERT(cfg != NULL, "mkdir dotfile directory");
+    vfs_node_release(cfg);
+    vfs_node_release(home);
+    TEST_ASSERT(write_file("/home/.config", "Mixed Case Long Name.txt", "lfn"), "write long mixed case name");
+    TEST_ASSERT(dir_contains("/home/.config", "Mixed Case Long Name.txt", NULL), "long name listed as written");
+    len = read_file("/home/.config/mixed case long name.txt", buf, sizeof(buf));
+    TEST_ASSERT(len == 3 && strcmp(buf, "lfn") == 0, "lookup is case insensitive");
+
+    // append keeps existing data
+    vfs_file_t *file = vfs_open("/etc/passwd", VFS_O_WRITE | VFS_O_APPEND);
+    TEST_ASSERT(file != NULL, "open for append");
+    vfs_write(file, "x", 1);
+    vfs_close(file);
+    TEST_ASSERT(vfs_size("/etc/passwd") == 29, "append grows file");
+
+    printf("\n");
+}
+
+void test_large_file_and_directory(void) {
+    printf("test_large_file_and_directory:\n");
+
+    // spans many clusters, written in odd sized chunks
+    vfs_node_t *root = vfs_resolve("/");
+    vfs_node_t *node = vfs_dir_create_node(root, "big.bin", VFS_NODE_FILE);
+    vfs_node_release(root);
+    vfs_file_t *file = vfs_open_node(node, VFS_O_WRITE);
+    vfs_node_release(node);
+    TEST_ASSERT(file != NULL, "open big.bin");
+    char chunk[700];
+    for (int i = 0; i < 100; i++) {
+        for (size_t j = 0; j < sizeof(chunk); j++) {
+            chunk[j] = (char)((i * 7 + j) & 0xFF);
+        }
+        vfs_write(file, chunk, sizeof(chunk));
+    }
+    vfs_close(file);
+    TEST_ASSERT(vfs_size("/big.bin") == 70000, "big.bin is 70000 bytes");
+
+    file = vfs_open("/big.bin", VFS_O_READ);
+    int ok = 1;
+    vfs_seek(file, 699 * 50 + 3);
+    char c = 0;
+    vfs_read(file, &c, 1);
+    size_t pos = 699 * 50 + 3;
+    if (c != (char)(((pos / 700) * 7 + pos % 700) & 0xFF)) {
+        ok = 0;
+    }
+    vfs_close(file);
+    TEST_ASSERT(ok, "seek + read lands on the right byte");
+
+    // enough entries to grow the directory past one cluster
+    root = vfs_resolve("/");
+    vfs_node_t *many = vfs_dir_create_node(root, "many", VFS_NODE_DIR);
+    vfs_node_release(root);
+    vfs_node_release(many);
+    int created = 0;
+    for (int i = 0; i < 60; i++) {
+        char name[32];
+        snprintf(name, sizeof(name), "file_number_%02d.log", i);
+        created += write_file("/many", name, "x");
+    }
+    int count = 0;
+    TEST_ASSERT(created == 60, "created 60 long named files");
+    TEST_ASSERT(dir_contains("/many", "file_number_59.log", &count) && count == 60, "all 60 listed");
+
+    printf("\n");
+}
+
+void test_rename_remove_persist(void) {
+    printf("test_rename_remove_persist:\n");
+
+    vfs_node_t *root = vfs_resolve("/");
+    vfs_node_t *etc = vfs_resolve("/etc");
+    TEST_ASSERT(vfs_dir_rename_node(root, "big.bin", etc, "moved.bin") == VFS_EOK, "rename across dirs");
+    TEST_ASSERT(vfs_size("/etc/moved.bin") == 70000, "moved file keeps its data");
+    TEST_ASSERT(vfs_resolve("/big.bin") == NULL, "old name is gone");
+    TEST_ASSERT(vfs_dir_remove_node(etc, "moved.bin") == VFS_EOK, "remove file");
+    TEST_ASSERT(vfs_dir_remove_node(root, "etc") == VFS_EPERM, "rmdir refuses non empty dir");
+    vfs_node_release(etc);
+    vfs_node_release(root);
+
+    // everything survives a detach/attach cycle
+    sdemu_detach();
+    TEST_ASSERT(sdemu_attach(TEST_IMAGE) == VFS_EOK, "re-attach image");
+    vfs_init();
+    char buf[64];
+    TEST_ASSERT(read_file("/home/.config/Mixed Case Long Name.txt", buf, sizeof(buf)) == 3, "data persisted");
+    TEST_ASSERT(vfs_resolve("/etc/moved.bin") == NULL, "removed file stays removed");
+
+    printf("\n");
+}
+
+// run one command line, print its simulated SD cost
+static void bench_cmd(terminal_state *term, const char *line) {
+    command_tokens_t tokens;
+    terminal_parse_command(line, &tokens);
+
+    sdemu_stats_t s;
+    sdemu_stats_reset();
+    terminal_capture_start();
+    if (tokens.has_pipe) {
+        terminal_execute_pipeline(term, &tokens);
+    } else {
+        terminal_execute_command(term, &tokens);
+    }
+    size_t out_len = 0;
+    free(terminal_capture_stop(&out_len));
+    sdemu_stats_get(&s);
+
+    printf("  %-28s %6u %6u %6u %6u %8u ms\n", line,
+           (unsigned)s.spi_switches, (unsigned)s.commands,
+           (unsigned)s.sectors_read, (unsigned)s.sectors_written,
+           (unsigned)sdemu_stats_ms(&s));
+}
+
+void test_command_costs(void) {
+    printf("test_command_costs:\n");
+
+    init_terminal_system();
+    builtins_init();
+    new_terminal();
+    terminal_state *term = get_active_terminal();
+    TEST_ASSERT(term != NULL, "terminal exists");
+
+    printf("  %-28s %6s %6s %6s %6s %11s\n", "command", "spi", "cmds", "rd", "wr", "simulated");
+    bench_cmd(term, "ls /");
+    bench_cmd(term, "ls /many");
+    bench_cmd(term, "cat /etc/passwd");
+    bench_cmd(term, "grep user /etc/passwd");
+    bench_cmd(term, "wc /etc/passwd");
+    bench_cmd(term, "touch /home/notes");
+    bench_cmd(term, "mkdir /tmp");
+    bench_cmd(term, "cat /etc/passwd | grep root");
+
+    sdemu_stats_t s;
+    sdemu_stats_reset();
+    char *argv[] = {"ls", "/many", NULL};
+    builtin_cmd *ls = builtins_find("ls");
+    terminal_capture_start();
+    int res = ls->handler(term, 2, argv);
+    free(terminal_capture_stop(NULL));
+    sdemu_stats_get(&s);
+    TEST_ASSERT(res == SHELL_OK, "ls on the image succeeds");
+    TEST_ASSERT(s.spi_switches > 0 && s.sectors_read > 0, "ls is charged bus time");
+
+    // zero latency model still counts I/O
+    sdemu_latency_t free_bus = {0, 0, 0, 0};
+    sdemu_set_latency(&free_bus);
+    sdemu_stats_reset();
+    terminal_capture_start();
+    ls->handler(term, 2, argv);
+    free(terminal_capture_stop(NULL));
+    sdemu_stats_get(&s);
+    TEST_ASSERT(s.sim_us == 0 && s.spi_switches > 0, "latency model is configurable");
+    sdemu_set_latency(NULL);
+
+    close_terminal();
+    printf("\n");
+}
+
+int main(void) {
+    printf("[VFS SDEMU TESTS]\n\n");
+
+    test_format_and_attach();
+    test_files_and_dirs();
+    test_large_file_and_directory();
+    test_rename_remove_persist();
+    test_command_costs();
+
+    sdemu_detach();
+    remove(TEST_IMAGE);
+
+    printf("\n[TEST SUMMARY]\n");
+    printf("  Total: %d\n", test_count);
+    printf("  Passed: %d\n", test_passed);
+    printf("  Failed: %d\n", test_failed);
+
+    if (test_failed == 0) {
+        printf("\nAll tests passed!\n");
+        return 0;
+    } else {
+        printf("\nSome tests failed!\n");
+        return 1;
+    }
+}